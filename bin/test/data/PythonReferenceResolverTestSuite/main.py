@@ -0,0 +1,15 @@
+class A:
+	def foo(self):
+		pass
+
+class B:
+	def foo(self):
+		pass
+
+class C(A):
+	def bar(self):
+		super().foo()
+
+def f(x):
+	x.foo()
+	A.foo()
@@ -42,6 +42,7 @@ function(configureLicenseFile outputFile)
 	AddLicense("SQLite" "${SQLite3_VERSION}" "https://www.sqlite.org/" "${LICENSEFOLDER}/license_sqlite.txt")
 	AddLicense("Qt" "${Qt6_VERSION}" "https://www.qt.io/" "${LICENSEFOLDER}/license_qt.txt")
 	AddLicense("TinyXML" "${tinyxml_VERSION}" "https://sourceforge.net/projects/tinyxml/" "${LICENSEFOLDER}/license_tinyxml.txt")
+	AddLicense("Zstandard" "${zstd_VERSION}" "https://github.com/facebook/zstd" "${LICENSEFOLDER}/license_zstd.txt")
 
 	set(LICENSE_ARRAY "${LICENSE_ARRAY}\n")
 
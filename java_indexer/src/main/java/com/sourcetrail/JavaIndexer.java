@@ -7,11 +7,14 @@ import java.io.InputStream;
 import java.io.OutputStream;
 import java.io.PrintWriter;
 import java.io.StringWriter;
+import java.nio.ByteBuffer;
 import java.nio.file.Path;
 import java.nio.file.Paths;
 import java.util.ArrayList;
 import java.util.Hashtable;
 import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
 import java.util.jar.JarFile;
 import java.util.zip.ZipEntry;
 import org.eclipse.jdt.core.JavaCore;
@@ -35,13 +38,15 @@ public class JavaIndexer
 		String classPath,
 		int verbose)
 	{
-		processFile(
-			new JavaIndexerAstVisitorClient(address),
-			filePath,
-			fileContent,
-			languageStandard,
-			classPath,
-			verbose);
+		JavaIndexerAstVisitorClient astVisitorClient = new JavaIndexerAstVisitorClient(address);
+		try
+		{
+			processFile(astVisitorClient, filePath, fileContent, languageStandard, classPath, verbose);
+		}
+		finally
+		{
+			astVisitorClient.flush();
+		}
 	}
 
 	public static void processFile(
@@ -83,32 +88,11 @@ public class JavaIndexer
 
 			parser.setUnitName(path.getFileName().toString());
 
-			List<String> classpath = new ArrayList<>();
-			List<String> sources = new ArrayList<>();
-
-			for (String classPathEntry: classPath.split("\\;"))
-			{
-				if (classPathEntry.endsWith(".jar"))
-				{
-					classpath.add(classPathEntry);
-				}
-				else if (classPathEntry.endsWith(".aar"))
-				{
-					File extractedJarFile = extractClassesJarFileFromAarFile(
-						Paths.get(classPathEntry), astVisitorClient);
-					if (extractedJarFile != null)
-					{
-						classpath.add(extractedJarFile.getAbsolutePath());
-					}
-				}
-				else if (!classPathEntry.isEmpty())
-				{
-					sources.add(classPathEntry);
-				}
-			}
+			ResolvedClassPath resolvedClassPath = s_resolvedClassPaths.computeIfAbsent(
+				classPath, key -> resolveClassPath(key, astVisitorClient));
 
 			parser.setEnvironment(
-				classpath.toArray(new String[0]), sources.toArray(new String[0]), null, true);
+				resolvedClassPath.classpath, resolvedClassPath.sources, null, true);
 			parser.setSource(fileContent.toCharArray());
 
 			CompilationUnit cu = (CompilationUnit)parser.createAST(null);
@@ -179,9 +163,63 @@ public class JavaIndexer
 
 	public static void clearCaches()
 	{
+		s_resolvedClassPaths.clear();
 		Runtime.getRuntime().gc();
 	}
 
+	private static class ResolvedClassPath
+	{
+		public String[] classpath;
+		public String[] sources;
+	}
+
+	// All indexer threads share one JVM and usually index with the same classpath, so the resolved
+	// classpath (including the 'classes.jar' files extracted from .aar entries) is only built once.
+	private static final Map<String, ResolvedClassPath> s_resolvedClassPaths =
+		new ConcurrentHashMap<>();
+
+	private static ResolvedClassPath resolveClassPath(
+		String classPath, AstVisitorClient astVisitorClient)
+	{
+		List<String> classpath = new ArrayList<>();
+		List<String> sources = new ArrayList<>();
+
+		for (String classPathEntry: classPath.split("\\;"))
+		{
+			if (classPathEntry.endsWith(".jar"))
+			{
+				classpath.add(classPathEntry);
+			}
+			else if (classPathEntry.endsWith(".aar"))
+			{
+				try
+				{
+					File extractedJarFile = extractClassesJarFileFromAarFile(
+						Paths.get(classPathEntry), astVisitorClient);
+					if (extractedJarFile != null)
+					{
+						classpath.add(extractedJarFile.getAbsolutePath());
+					}
+				}
+				catch (IOException e)
+				{
+					astVisitorClient.logError(
+						"Unable to extract classes.jar file from \"" + classPathEntry +
+						"\": " + e.getMessage());
+				}
+			}
+			else if (!classPathEntry.isEmpty())
+			{
+				sources.add(classPathEntry);
+			}
+		}
+
+		ResolvedClassPath resolvedClassPath = new ResolvedClassPath();
+		resolvedClassPath.classpath = classpath.toArray(new String[0]);
+		resolvedClassPath.sources = sources.toArray(new String[0]);
+		return resolvedClassPath;
+	}
+
 	private static String convertLanguageStandard(String s)
 	{
 		// Must be in sync with 'SourceGroupSettingsWithJavaStandard::getAvailableJavaStandards'
@@ -285,80 +323,5 @@ public class JavaIndexer
 
 	static public native void logError(int address, String error);
 
-	static public native void recordSymbol(
-		int address, String symbolName, int symbolType, int access, int definitionKind);
-
-	static public native void recordSymbolWithLocation(
-		int address,
-		String symbolName,
-		int symbolType,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn,
-		int access,
-		int definitionKind);
-
-	static public native void recordSymbolWithLocationAndScope(
-		int address,
-		String symbolName,
-		int symbolType,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn,
-		int scopeBeginLine,
-		int scopeBeginColumn,
-		int scopeEndLine,
-		int scopeEndColumn,
-		int access,
-		int definitionKind);
-
-	static public native void recordSymbolWithLocationAndScopeAndSignature(
-		int address,
-		String symbolName,
-		int symbolType,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn,
-		int scopeBeginLine,
-		int scopeBeginColumn,
-		int scopeEndLine,
-		int scopeEndColumn,
-		int signatureBeginLine,
-		int signatureBeginColumn,
-		int signatureEndLine,
-		int signatureEndColumn,
-		int access,
-		int definitionKind);
-
-	static public native void recordReference(
-		int address,
-		int referenceKind,
-		String referencedName,
-		String contextName,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn);
-
-	static public native void recordQualifierLocation(
-		int address, String qualifierName, int beginLine, int beginColumn, int endLine, int endColumn);
-
-	static public native void recordLocalSymbol(
-		int address, String symbolName, int beginLine, int beginColumn, int endLine, int endColumn);
-
-	static public native void recordComment(
-		int address, int beginLine, int beginColumn, int endLine, int endColumn);
-
-	static public native void recordError(
-		int address,
-		String message,
-		int fatal,
-		int indexed,
-		int beginLine,
-		int beginColumn,
-		int endLine,
-		int endColumn);
-}
\ No newline at end of file
+	static public native void recordBatch(int address, ByteBuffer buffer, int size);
+}
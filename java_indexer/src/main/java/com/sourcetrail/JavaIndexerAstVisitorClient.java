@@ -6,12 +6,14 @@ import com.sourcetrail.name.NameHierarchy;
 public class JavaIndexerAstVisitorClient extends AstVisitorClient
 {
 	private int m_address;
+	private RecordBuffer m_recordBuffer;
 	private String m_javaLangPackageName;
 	private boolean m_javaLangPackageRecorded;
 
 	public JavaIndexerAstVisitorClient(int address)
 	{
 		m_address = address;
+		m_recordBuffer = new RecordBuffer(address);
 
 		NameHierarchy javaLangPackageNameHierarchy = new NameHierarchy();
 		javaLangPackageNameHierarchy.push(new NameElement("java"));
@@ -20,6 +22,12 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		m_javaLangPackageRecorded = false;
 	}
 
+	// sends all buffered records to the native side
+	public void flush()
+	{
+		m_recordBuffer.flush();
+	}
+
 	@Override public boolean getInterrupted()
 	{
 		return JavaIndexer.getInterrupted(m_address);
@@ -44,12 +52,7 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 	public void recordSymbol(
 		NameHierarchy symbolName, SymbolKind symbolKind, AccessKind access, DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbol(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			access.getValue(),
-			definitionKind.getValue());
+		recordSymbol(symbolName.serialize(), symbolKind, access, definitionKind);
 	}
 
 	@Override
@@ -60,16 +63,13 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		AccessKind access,
 		DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbolWithLocation(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column,
-			access.getValue(),
-			definitionKind.getValue());
+		int nameIndex = m_recordBuffer.getStringIndex(symbolName.serialize());
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_SYMBOL_WITH_LOCATION, 8);
+		m_recordBuffer.putInt(nameIndex);
+		m_recordBuffer.putInt(symbolKind.getValue());
+		m_recordBuffer.putRange(range);
+		m_recordBuffer.putInt(access.getValue());
+		m_recordBuffer.putInt(definitionKind.getValue());
 	}
 
 	@Override
@@ -81,20 +81,14 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		AccessKind access,
 		DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbolWithLocationAndScope(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column,
-			scopeRange.begin.line,
-			scopeRange.begin.column,
-			scopeRange.end.line,
-			scopeRange.end.column,
-			access.getValue(),
-			definitionKind.getValue());
+		int nameIndex = m_recordBuffer.getStringIndex(symbolName.serialize());
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE, 12);
+		m_recordBuffer.putInt(nameIndex);
+		m_recordBuffer.putInt(symbolKind.getValue());
+		m_recordBuffer.putRange(range);
+		m_recordBuffer.putRange(scopeRange);
+		m_recordBuffer.putInt(access.getValue());
+		m_recordBuffer.putInt(definitionKind.getValue());
 	}
 
 	@Override
@@ -107,24 +101,16 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		AccessKind access,
 		DefinitionKind definitionKind)
 	{
-		JavaIndexer.recordSymbolWithLocationAndScopeAndSignature(
-			m_address,
-			symbolName.serialize(),
-			symbolKind.getValue(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column,
-			scopeRange.begin.line,
-			scopeRange.begin.column,
-			scopeRange.end.line,
-			scopeRange.end.column,
-			signatureRange.begin.line,
-			signatureRange.begin.column,
-			signatureRange.end.line,
-			signatureRange.end.column,
-			access.getValue(),
-			definitionKind.getValue());
+		int nameIndex = m_recordBuffer.getStringIndex(symbolName.serialize());
+		m_recordBuffer.beginRecord(
+			RecordBuffer.RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE, 16);
+		m_recordBuffer.putInt(nameIndex);
+		m_recordBuffer.putInt(symbolKind.getValue());
+		m_recordBuffer.putRange(range);
+		m_recordBuffer.putRange(scopeRange);
+		m_recordBuffer.putRange(signatureRange);
+		m_recordBuffer.putInt(access.getValue());
+		m_recordBuffer.putInt(definitionKind.getValue());
 	}
 
 	@Override
@@ -134,65 +120,64 @@ public class JavaIndexerAstVisitorClient extends AstVisitorClient
 		String serializedReferencedName = referencedName.serialize();
 		if (!m_javaLangPackageRecorded && serializedReferencedName.startsWith(m_javaLangPackageName))
 		{
-			JavaIndexer.recordSymbol(
-				m_address,
-				m_javaLangPackageName,
-				SymbolKind.PACKAGE.getValue(),
-				AccessKind.NONE.getValue(),
-				DefinitionKind.NONE.getValue());
+			recordSymbol(
+				m_javaLangPackageName, SymbolKind.PACKAGE, AccessKind.NONE, DefinitionKind.NONE);
 
 			m_javaLangPackageRecorded = true;
 		}
 
-		JavaIndexer.recordReference(
-			m_address,
-			referenceKind.getValue(),
-			serializedReferencedName,
-			contextName.serialize(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int referencedNameIndex = m_recordBuffer.getStringIndex(serializedReferencedName);
+		int contextNameIndex = m_recordBuffer.getStringIndex(contextName.serialize());
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_REFERENCE, 7);
+		m_recordBuffer.putInt(referenceKind.getValue());
+		m_recordBuffer.putInt(referencedNameIndex);
+		m_recordBuffer.putInt(contextNameIndex);
+		m_recordBuffer.putRange(range);
 	}
 
 	@Override public void recordQualifierLocation(NameHierarchy qualifierName, Range range)
 	{
-		JavaIndexer.recordQualifierLocation(
-			m_address,
-			qualifierName.serialize(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int nameIndex = m_recordBuffer.getStringIndex(qualifierName.serialize());
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_QUALIFIER_LOCATION, 5);
+		m_recordBuffer.putInt(nameIndex);
+		m_recordBuffer.putRange(range);
 	}
 
 	@Override public void recordLocalSymbol(NameHierarchy symbolName, Range range)
 	{
-		JavaIndexer.recordLocalSymbol(
-			m_address,
-			symbolName.serialize(),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int nameIndex = m_recordBuffer.getStringIndex(symbolName.serialize());
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_LOCAL_SYMBOL, 5);
+		m_recordBuffer.putInt(nameIndex);
+		m_recordBuffer.putRange(range);
 	}
 
 	@Override public void recordComment(Range range)
 	{
-		JavaIndexer.recordComment(
-			m_address, range.begin.line, range.begin.column, range.end.line, range.end.column);
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_COMMENT, 4);
+		m_recordBuffer.putRange(range);
 	}
 
 	@Override public void recordError(String message, boolean fatal, boolean indexed, Range range)
 	{
-		JavaIndexer.recordError(
-			m_address,
-			message,
-			(fatal ? 1 : 0),
-			(indexed ? 1 : 0),
-			range.begin.line,
-			range.begin.column,
-			range.end.line,
-			range.end.column);
+		int messageIndex = m_recordBuffer.getStringIndex(message);
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_ERROR, 7);
+		m_recordBuffer.putInt(messageIndex);
+		m_recordBuffer.putInt(fatal ? 1 : 0);
+		m_recordBuffer.putInt(indexed ? 1 : 0);
+		m_recordBuffer.putRange(range);
+	}
+
+	private void recordSymbol(
+		String serializedSymbolName,
+		SymbolKind symbolKind,
+		AccessKind access,
+		DefinitionKind definitionKind)
+	{
+		int nameIndex = m_recordBuffer.getStringIndex(serializedSymbolName);
+		m_recordBuffer.beginRecord(RecordBuffer.RECORD_SYMBOL, 4);
+		m_recordBuffer.putInt(nameIndex);
+		m_recordBuffer.putInt(symbolKind.getValue());
+		m_recordBuffer.putInt(access.getValue());
+		m_recordBuffer.putInt(definitionKind.getValue());
 	}
 }
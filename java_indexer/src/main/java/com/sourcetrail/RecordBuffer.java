@@ -0,0 +1,107 @@
+package com.sourcetrail;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.HashMap;
+import java.util.Map;
+
+// Collects the records of one source file in a direct buffer that is handed over to the native
+// side with a single JNI call instead of one call per record. Strings are sent only once per file
+// and are referenced by their index afterwards. The direct buffer is kept per indexer thread and
+// reused for all files indexed on that thread.
+public class RecordBuffer
+{
+	// Must be in sync with 'JavaParser::RecordKind'.
+	public static final int RECORD_STRING = 0;
+	public static final int RECORD_SYMBOL = 1;
+	public static final int RECORD_SYMBOL_WITH_LOCATION = 2;
+	public static final int RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE = 3;
+	public static final int RECORD_SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE = 4;
+	public static final int RECORD_REFERENCE = 5;
+	public static final int RECORD_QUALIFIER_LOCATION = 6;
+	public static final int RECORD_LOCAL_SYMBOL = 7;
+	public static final int RECORD_COMMENT = 8;
+	public static final int RECORD_ERROR = 9;
+
+	private static final int INITIAL_CAPACITY = 1024 * 1024;
+	private static final int INT_SIZE = 4;
+
+	private static final ThreadLocal<ByteBuffer> s_threadBuffer = ThreadLocal.withInitial(
+		() -> ByteBuffer.allocateDirect(INITIAL_CAPACITY).order(ByteOrder.nativeOrder()));
+
+	private final int m_address;
+	private ByteBuffer m_buffer;
+	private final Map<String, Integer> m_stringIndices = new HashMap<>();
+
+	public RecordBuffer(int address)
+	{
+		m_address = address;
+		m_buffer = s_threadBuffer.get();
+		// drops records left over by a file whose indexing failed
+		m_buffer.clear();
+	}
+
+	// Returns the index of the string and writes it to the buffer if it has not been sent before.
+	// Call this before 'beginRecord' because the string entry must not end up inside a record.
+	public int getStringIndex(String s)
+	{
+		Integer index = m_stringIndices.get(s);
+		if (index != null)
+		{
+			return index;
+		}
+
+		byte[] bytes = s.getBytes(StandardCharsets.UTF_8);
+		reserve(2 * INT_SIZE + bytes.length);
+		m_buffer.putInt(RECORD_STRING);
+		m_buffer.putInt(bytes.length);
+		m_buffer.put(bytes);
+
+		int newIndex = m_stringIndices.size();
+		m_stringIndices.put(s, newIndex);
+		return newIndex;
+	}
+
+	public void beginRecord(int recordKind, int fieldCount)
+	{
+		reserve((1 + fieldCount) * INT_SIZE);
+		m_buffer.putInt(recordKind);
+	}
+
+	public void putInt(int value)
+	{
+		m_buffer.putInt(value);
+	}
+
+	public void putRange(Range range)
+	{
+		m_buffer.putInt(range.begin.line);
+		m_buffer.putInt(range.begin.column);
+		m_buffer.putInt(range.end.line);
+		m_buffer.putInt(range.end.column);
+	}
+
+	public void flush()
+	{
+		if (m_buffer.position() > 0)
+		{
+			JavaIndexer.recordBatch(m_address, m_buffer, m_buffer.position());
+			m_buffer.clear();
+		}
+	}
+
+	private void reserve(int size)
+	{
+		if (m_buffer.remaining() < size)
+		{
+			flush();
+
+			if (m_buffer.capacity() < size)
+			{
+				m_buffer = ByteBuffer.allocateDirect(size).order(ByteOrder.nativeOrder());
+				s_threadBuffer.set(m_buffer);
+			}
+		}
+	}
+}
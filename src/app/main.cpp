@@ -64,6 +64,8 @@ void setupLogging()
 
 	std::shared_ptr<FileLogger> fileLogger = std::make_shared<FileLogger>();
 	fileLogger->setLogLevel(Logger::LOG_ALL);
+	fileLogger->setMaxLogFileSize(10 * 1024 * 1024);
+	fileLogger->setMaxLogFileCount(10);
 	fileLogger->deleteLogFiles(FileLogger::generateDatedFileName(L"log", L"", -30));
 	logManager->addLogger(fileLogger);
 }
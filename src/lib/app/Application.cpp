@@ -120,6 +120,8 @@ void Application::loadSettings()
 		fileLogger->setFileName(FileLogger::generateDatedFileName(L"log"));
 	}
 
+	Tracer::getInstance()->setEnabled(settings->getTracingEnabled());
+
 	loadStyle(settings->getColorSchemePath());
 }
 
@@ -129,6 +131,19 @@ void Application::loadStyle(const FilePath& colorSchemePath)
 	GraphViewStyle::loadStyleSettings();
 }
 
+void Application::saveTraces()
+{
+	const FilePath logDirectoryPath = ApplicationSettings::getInstance()->getLogDirectoryPath();
+	FileSystem::createDirectories(logDirectoryPath);
+
+	Tracer* tracer = Tracer::getInstance();
+	if (tracer->exportChromeTrace(logDirectoryPath.getConcatenated(
+			FileLogger::generateDatedFileName(L"trace") + L".json")))
+	{
+		tracer->clear();
+	}
+}
+
 Application::Application(bool withGUI): m_hasGUI(withGUI) {}
 
 Application::~Application()
@@ -143,6 +158,11 @@ Application::~Application()
 	{
 		collector->stop();
 	}
+
+	if (Tracer::isEnabled())
+	{
+		saveTraces();
+	}
 }
 
 std::shared_ptr<const Project> Application::getCurrentProject() const
@@ -43,6 +43,9 @@ public:
 	static void loadSettings();
 	static void loadStyle(const FilePath& colorSchemePath);
 
+	// writes the recorded trace events to a dated file in the log directory
+	static void saveTraces();
+
 	~Application() override;
 
 	std::shared_ptr<const Project> getCurrentProject() const;
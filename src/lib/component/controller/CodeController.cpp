@@ -19,7 +19,10 @@
 #include "utility.h"
 #include "utilityString.h"
 
-CodeController::CodeController(StorageAccess* storageAccess): m_storageAccess(storageAccess) {}
+CodeController::CodeController(StorageAccess* storageAccess)
+	: m_storageAccess(storageAccess), m_snapshots(20)
+{
+}
 
 Id CodeController::getSchedulerId() const
 {
@@ -194,6 +197,12 @@ void CodeController::handleMessage(MessageActivateTokens* message)
 		return;
 	}
 
+	if (message->isReplayed() && !message->isEdge && restoreSnapshot(message))
+	{
+		sendActivationStatus(message);
+		return;
+	}
+
 	CodeView::CodeParams params;
 	params.activeTokenIds = message->tokenIds;
 	params.clearSnippets = true;
@@ -221,34 +230,13 @@ void CodeController::handleMessage(MessageActivateTokens* message)
 	m_files = getFilesForActiveSourceLocations(m_collection.get(), declarationId);
 	createReferences();
 	expandVisibleFiles(params.useSingleFileCache);
-	showFiles(params, definitionReferenceScrollParams(params.activeTokenIds), !message->isReplayed());
 
-	// send status message
-	{
-		size_t fileCount = m_collection->getSourceLocationFileCount();
-		size_t referenceCount = m_collection->getSourceLocationCount();
-
-		std::wstring status;
-		for (const SearchMatch& match: message->getSearchMatches())
-		{
-			status += L"Activate \"" + match.name + L"\": ";
-			// TODO (PMost): MSVC warns about unreachable code
-			break;
-		}
+	CodeScrollParams scrollParams = definitionReferenceScrollParams(params.activeTokenIds);
+	showFiles(params, scrollParams, !message->isReplayed());
 
-		status += std::to_wstring(message->tokenIds.size()) + L" ";
-		status += (message->tokenIds.size() == 1 ? L"result" : L"results");
+	saveSnapshot(message, params, scrollParams);
 
-		if (fileCount > 0)
-		{
-			status += L" with " + std::to_wstring(referenceCount) + L" ";
-			status += (referenceCount == 1 ? L"reference" : L"references");
-			status += L" in " + std::to_wstring(fileCount) + L" ";
-			status += (fileCount == 1 ? L"file" : L"files");
-		}
-
-		MessageStatus(status).dispatch();
-	}
+	sendActivationStatus(message);
 }
 
 void CodeController::handleMessage(MessageActivateTrail* message)
@@ -368,7 +356,7 @@ void CodeController::handleMessage(MessageCodeShowDefinition* message)
 		if (!addedLocation)
 		{
 			SourceLocation* location =
-				collection->getSourceLocationFiles().begin()->second->getSourceLocations().begin()->get();
+				collection->getSourceLocationFiles().begin()->second->getFirstSourceLocation();
 			filteredCollection->addSourceLocationCopy(location);
 			filteredCollection->addSourceLocationCopy(location->getOtherLocation());
 
@@ -455,6 +443,11 @@ void CodeController::handleMessage(MessageFocusOut*  /*message*/)
 	getView()->deCoFocusTokenIds();
 }
 
+void CodeController::handleMessage(MessageIndexingFinished*  /*message*/)
+{
+	m_snapshotsInvalid = true;
+}
+
 void CodeController::handleMessage(MessageScrollToLine* message)
 {
 	getView()->scrollTo(
@@ -736,9 +729,9 @@ CodeSnippetParams CodeController::getSnippetParamsForWholeFile(
 	{
 		std::shared_ptr<SourceLocationFile> file =
 			m_collection->getSourceLocationFiles().begin()->second;
-		if (file->getSourceLocations().size())
+		if (const SourceLocation* location = file->getFirstSourceLocation())
 		{
-			showsErrors = (*file->getSourceLocations().begin())->getType() == LOCATION_ERROR;
+			showsErrors = location->getType() == LOCATION_ERROR;
 		}
 	}
 
@@ -760,10 +753,9 @@ std::vector<CodeSnippetParams> CodeController::getSnippetsForFile(
 	TRACE();
 
 	bool showsErrors = false;
-	if (activeSourceLocations->getSourceLocations().size())
+	if (const SourceLocation* location = activeSourceLocations->getFirstSourceLocation())
 	{
-		showsErrors = (*activeSourceLocations->getSourceLocations().begin())->getType() ==
-			LOCATION_ERROR;
+		showsErrors = location->getType() == LOCATION_ERROR;
 	}
 
 	std::shared_ptr<TextAccess> textAccess = m_storageAccess->getFileContent(
@@ -1709,3 +1701,140 @@ void CodeController::showFiles(CodeView::CodeParams params, CodeScrollParams scr
 		getView()->updateSourceLocations(m_files);
 	}
 }
+
+void CodeController::sendActivationStatus(const MessageActivateTokens* message) const
+{
+	size_t fileCount = m_collection->getSourceLocationFileCount();
+	size_t referenceCount = m_collection->getSourceLocationCount();
+
+	std::wstring status;
+	for (const SearchMatch& match: message->getSearchMatches())
+	{
+		status += L"Activate \"" + match.name + L"\": ";
+		// TODO (PMost): MSVC warns about unreachable code
+		break;
+	}
+
+	status += std::to_wstring(message->tokenIds.size()) + L" ";
+	status += (message->tokenIds.size() == 1 ? L"result" : L"results");
+
+	if (fileCount > 0)
+	{
+		status += L" with " + std::to_wstring(referenceCount) + L" ";
+		status += (referenceCount == 1 ? L"reference" : L"references");
+		status += L" in " + std::to_wstring(fileCount) + L" ";
+		status += (fileCount == 1 ? L"file" : L"files");
+	}
+
+	MessageStatus(status).dispatch();
+}
+
+void CodeController::saveSnapshot(
+	const MessageActivateTokens* message,
+	const CodeView::CodeParams& params,
+	const CodeScrollParams& scrollParams)
+{
+	if (m_snapshotsInvalid.exchange(false))
+	{
+		m_snapshots.clear();
+	}
+
+	CodeSnapshot snapshot;
+	snapshot.tokenIds = message->tokenIds;
+	snapshot.inListMode = getView()->isInListMode();
+	snapshot.params = params;
+	snapshot.scrollParams = scrollParams;
+	snapshot.collection = m_collection;
+	snapshot.files = m_files;
+	snapshot.currentFilePath = m_currentFilePath;
+
+	// later messages add source locations and snippets to the shown files in place
+	m_snapshots.setValue(message->getId(), copySnapshot(snapshot));
+}
+
+bool CodeController::restoreSnapshot(const MessageActivateTokens* message)
+{
+	if (m_snapshotsInvalid.exchange(false))
+	{
+		m_snapshots.clear();
+		return false;
+	}
+
+	const CodeSnapshot* snapshot = m_snapshots.getValue(message->getId());
+	if (!snapshot || snapshot->tokenIds != message->tokenIds ||
+		snapshot->inListMode != getView()->isInListMode())
+	{
+		return false;
+	}
+
+	TRACE("code restore");
+
+	CodeSnapshot copy = copySnapshot(*snapshot);
+
+	m_collection = copy.collection;
+	m_files = copy.files;
+
+	// files shown from the single file cache of the view don't contain their code
+	for (CodeFileParams& file: m_files)
+	{
+		if (file.fileParams && file.fileParams->code.empty() &&
+			!getView()->hasSingleFileCached(file.locationFile->getFilePath()))
+		{
+			file.fileParams.reset();
+			setFileState(file, MessageChangeFileView::FILE_MAXIMIZED, copy.params.useSingleFileCache);
+		}
+	}
+
+	m_currentFilePath = copy.currentFilePath;
+
+	createReferences();
+	showFiles(copy.params, copy.scrollParams, false);
+
+	return true;
+}
+
+CodeController::CodeSnapshot CodeController::copySnapshot(const CodeSnapshot& snapshot)
+{
+	CodeSnapshot copy = snapshot;
+
+	copy.collection = std::make_shared<SourceLocationCollection>();
+	snapshot.collection->forEachSourceLocationFile(
+		[&copy](std::shared_ptr<SourceLocationFile> file) {
+			copy.collection->addSourceLocationFile(std::make_shared<SourceLocationFile>(*file));
+		});
+
+	auto copyLocationFile = [](std::shared_ptr<SourceLocationFile>& locationFile) {
+		if (locationFile)
+		{
+			locationFile = std::make_shared<SourceLocationFile>(*locationFile);
+		}
+	};
+
+	for (CodeFileParams& file: copy.files)
+	{
+		// the files refer to the location files of the collection
+		std::shared_ptr<SourceLocationFile> locationFile =
+			copy.collection->getSourceLocationFileByPath(file.locationFile->getFilePath());
+		if (locationFile)
+		{
+			file.locationFile = locationFile;
+		}
+		else
+		{
+			copyLocationFile(file.locationFile);
+		}
+
+		for (CodeSnippetParams& snippet: file.snippetParams)
+		{
+			copyLocationFile(snippet.locationFile);
+		}
+
+		if (file.fileParams)
+		{
+			file.fileParams = std::make_shared<CodeSnippetParams>(*file.fileParams);
+			copyLocationFile(file.fileParams->locationFile);
+		}
+	}
+
+	return copy;
+}
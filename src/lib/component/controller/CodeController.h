@@ -1,6 +1,7 @@
 #ifndef CODE_CONTROLLER_H
 #define CODE_CONTROLLER_H
 
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -23,6 +24,7 @@
 #include "MessageFocusChanged.h"
 #include "MessageFocusIn.h"
 #include "MessageFocusOut.h"
+#include "MessageIndexingFinished.h"
 #include "MessageListener.h"
 #include "MessageScrollCode.h"
 #include "MessageScrollToLine.h"
@@ -34,6 +36,7 @@
 
 #include "CodeView.h"
 #include "Controller.h"
+#include "LruCache.h"
 #include "SnippetMerger.h"
 
 class StorageAccess;
@@ -60,6 +63,7 @@ class CodeController
 	, public MessageListener<MessageFlushUpdates>
 	, public MessageListener<MessageFocusIn>
 	, public MessageListener<MessageFocusOut>
+	, public MessageListener<MessageIndexingFinished>
 	, public MessageListener<MessageScrollCode>
 	, public MessageListener<MessageScrollToLine>
 	, public MessageListener<MessageShowError>
@@ -85,6 +89,20 @@ private:
 		size_t columnNumber = 0;
 	};
 
+	// the files shown for an activation, keeps its own copies of the source locations
+	struct CodeSnapshot
+	{
+		std::vector<Id> tokenIds;
+		bool inListMode = false;
+
+		CodeView::CodeParams params;
+		CodeScrollParams scrollParams;
+
+		std::shared_ptr<SourceLocationCollection> collection;
+		std::vector<CodeFileParams> files;
+		FilePath currentFilePath;
+	};
+
 	void handleMessage(MessageActivateErrors* message) override;
 	void handleMessage(MessageActivateFullTextSearch* message) override;
 	void handleMessage(MessageActivateLegend* message) override;
@@ -102,6 +120,7 @@ private:
 	void handleMessage(MessageFlushUpdates* message) override;
 	void handleMessage(MessageFocusIn* message) override;
 	void handleMessage(MessageFocusOut* message) override;
+	void handleMessage(MessageIndexingFinished* message) override;
 	void handleMessage(MessageScrollCode* message) override;
 	void handleMessage(MessageScrollToLine* message) override;
 	void handleMessage(MessageShowError* message) override;
@@ -169,6 +188,17 @@ private:
 	void showFirstActiveReference(Id tokenId, bool updateView);
 	void showFiles(CodeView::CodeParams params, CodeScrollParams scrollParams, bool updateView);
 
+	void sendActivationStatus(const MessageActivateTokens* message) const;
+
+	// history navigation replays activations, which restore the files they showed before instead
+	// of querying the storage and creating the snippets again
+	void saveSnapshot(
+		const MessageActivateTokens* message,
+		const CodeView::CodeParams& params,
+		const CodeScrollParams& scrollParams);
+	bool restoreSnapshot(const MessageActivateTokens* message);
+	static CodeSnapshot copySnapshot(const CodeSnapshot& snapshot);
+
 	StorageAccess* m_storageAccess;
 
 	std::shared_ptr<SourceLocationCollection> m_collection;
@@ -186,6 +216,12 @@ private:
 
 	std::vector<Reference> m_localReferences;
 	int m_localReferenceIndex = -1;
+
+	// keyed by the id of the activation message, which is kept in the history
+	LruCache<Id, CodeSnapshot> m_snapshots;
+	// MessageIndexingFinished is handled on another thread, so the snapshots get cleared with the
+	// next activation
+	std::atomic<bool> m_snapshotsInvalid = false;
 };
 
 #endif	  // CODE_CONTROLLER_H
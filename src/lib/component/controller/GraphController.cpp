@@ -8,10 +8,10 @@
 #include "BucketLayouter.h"
 #include "Graph.h"
 #include "GraphView.h"
-#include "GraphViewStyle.h"
 #include "ListLayouter.h"
 #include "MessageActivateNodes.h"
 #include "MessageStatus.h"
+#include "NestingLayouter.h"
 #include "StorageAccess.h"
 #include "TokenComponentAccess.h"
 #include "TokenComponentFilePath.h"
@@ -23,7 +23,7 @@
 #include "utilityString.h"
 
 GraphController::GraphController(StorageAccess* storageAccess)
-	: m_storageAccess(storageAccess) 
+	: m_storageAccess(storageAccess), m_snapshots(20)
 {
 }
 
@@ -63,6 +63,11 @@ void GraphController::handleMessage(MessageActivateOverview* message)
 
 	clear();
 
+	if (message->isReplayed() && restoreSnapshot(message))
+	{
+		return;
+	}
+
 	if (message->acceptedNodeTypes != NodeTypeSet::all())
 	{
 		createDummyGraphAndSetActiveAndVisibility(
@@ -89,6 +94,8 @@ void GraphController::handleMessage(MessageActivateOverview* message)
 	GraphView::GraphParams params;
 	params.scrollToTop = message->acceptedNodeTypes != NodeTypeSet::all();
 	buildGraph(message, params);
+
+	saveSnapshot(message);
 }
 
 void GraphController::handleMessage(MessageActivateTokens* message)
@@ -136,6 +143,11 @@ void GraphController::handleMessage(MessageActivateTokens* message)
 		return;
 	}
 
+	if (message->isReplayed() && restoreSnapshot(message))
+	{
+		return;
+	}
+
 	std::vector<Id> tokenIds = utility::concat(m_activeNodeIds, m_activeEdgeIds);
 
 	bool isNamespace = false;
@@ -205,6 +217,8 @@ void GraphController::handleMessage(MessageActivateTokens* message)
 	params.centerActiveNode = !isNamespace;
 	params.scrollToTop = isNamespace;
 	buildGraph(message, params);
+
+	saveSnapshot(message);
 }
 
 void GraphController::handleMessage(MessageActivateTrail* message)
@@ -342,6 +356,11 @@ void GraphController::handleMessage(MessageFlushUpdates* message)
 	buildGraph(message, params);
 }
 
+void GraphController::handleMessage(MessageIndexingFinished*  /*message*/)
+{
+	m_snapshotsInvalid = true;
+}
+
 void GraphController::handleMessage(MessageScrollGraph* message)
 {
 	if (message->isReplayed())
@@ -1858,15 +1877,8 @@ void GraphController::layoutNesting()
 
 	extendEqualFunctionNames(m_dummyNodes);
 
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		layoutNestingRecursive(node.get());
-	}
-
-	for (const std::shared_ptr<DummyNode>& node: m_dummyNodes)
-	{
-		layoutToGrid(node.get());
-	}
+	NestingLayouter layouter(getView()->getViewSize(), m_dummyEdges, m_activeNodeIds.size());
+	layouter.layout(m_dummyNodes);
 }
 
 void GraphController::extendEqualFunctionNames(const std::vector<std::shared_ptr<DummyNode>>& nodes) const
@@ -1904,296 +1916,6 @@ void GraphController::extendEqualFunctionNames(const std::vector<std::shared_ptr
 	}
 }
 
-Vec4i GraphController::layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth) const
-{
-	if (!node->visible)
-	{
-		return Vec4i(0, 0, 0, 0);
-	}
-
-	GraphViewStyle::NodeMargins margins;
-
-	if (node->isGraphNode())
-	{
-		margins = GraphViewStyle::getMarginsForDataNode(
-			node->data->getType().getNodeStyle(), node->data->getType().hasIcon(), node->childVisible);
-	}
-	else if (node->isAccessNode())
-	{
-		margins = GraphViewStyle::getMarginsOfAccessNode(node->accessKind);
-	}
-	else if (node->isExpandToggleNode())
-	{
-		margins = GraphViewStyle::getMarginsOfExpandToggleNode();
-	}
-	else if (node->isBundleNode())
-	{
-		if (node->bundledNodeType.getKind() != NODE_SYMBOL)
-		{
-			margins = GraphViewStyle::getMarginsForDataNode(
-				node->bundledNodeType.getNodeStyle(), node->bundledNodeType.hasIcon(), false);
-		}
-		else
-		{
-			margins = GraphViewStyle::getMarginsOfBundleNode();
-		}
-	}
-	else if (node->isQualifierNode())
-	{
-		return Vec4i(0, 0, 0, 0);
-	}
-	else if (node->isTextNode())
-	{
-		margins = GraphViewStyle::getMarginsOfTextNode(node->fontSizeDiff);
-	}
-	else if (node->isGroupNode())
-	{
-		margins = GraphViewStyle::getMarginsOfGroupNode(node->groupType, node->name.size());
-	}
-
-	int width = 0;
-	int height = 0;
-
-	if (node->isGraphNode())
-	{
-		node->name = utility::elide(node->name, utility::ELIDE_RIGHT, node->active ? 100 : 50);
-		width = static_cast<int>(margins.charWidth * node->name.size());
-
-		if (node->data->getType().isCollapsible() && node->data->getChildCount() > 0)
-		{
-			addExpandToggleNode(node);
-		}
-	}
-	else if (node->isBundleNode() || node->isTextNode())
-	{
-		width = static_cast<int>(margins.charWidth * node->name.size());
-	}
-	else if (node->isGroupNode())
-	{
-		width = static_cast<int>(margins.charWidth * node->name.size() + 5);
-	}
-
-	width += margins.iconWidth;
-	width = std::max(width, margins.minWidth);
-
-	if (relayoutAccessMaxWidth == -1)
-	{
-		int maxAccessWidth = 0;
-		std::shared_ptr<const DummyNode> maxWidthAccessNode;
-
-		for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-		{
-			if (!subNode->visible)
-			{
-				continue;
-			}
-			else if (subNode->isQualifierNode())
-			{
-				subNode->position.y = static_cast<int>(margins.top + margins.charHeight / 2);
-				width += 5;
-				continue;
-			}
-
-			Vec4i rect = layoutNestingRecursive(subNode.get());
-
-			if (subNode->isExpandToggleNode())
-			{
-				width += margins.spacingX + subNode->size.x;
-			}
-			else if (subNode->isAccessNode() && rect.z() > maxAccessWidth)
-			{
-				maxAccessWidth = rect.z();
-				maxWidthAccessNode = subNode;
-			}
-		}
-
-		if (maxAccessWidth > 0)
-		{
-			for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-			{
-				if (subNode->visible && subNode->isAccessNode() && subNode != maxWidthAccessNode)
-				{
-					layoutNestingRecursive(subNode.get(), maxAccessWidth);
-				}
-			}
-		}
-	}
-
-	if (node->subNodes.size())
-	{
-		if (node->isGroupNode())
-		{
-			Vec2i viewSize = getView()->getViewSize();
-
-			switch (node->groupLayout)
-			{
-			case GroupLayout::LIST:
-				viewSize.x = viewSize.x - 150;	  // prevent horizontal scroll
-				ListLayouter::layoutMultiColumn(viewSize, &node->subNodes);
-				break;
-
-			case GroupLayout::SKEWED:
-				ListLayouter::layoutSkewed(
-					&node->subNodes,
-					margins.spacingX,
-					margins.spacingY,
-					static_cast<int>(viewSize.x() * 1.5));
-				break;
-
-			case GroupLayout::BUCKET:
-				if (node->hasActiveSubNode() || !m_activeNodeIds.size() /* bundled edges */)
-				{
-					BucketLayouter grid(viewSize);
-					grid.createBuckets(node->subNodes, m_dummyEdges);
-					grid.layoutBuckets(m_activeNodeIds.size());
-					node->subNodes = grid.getSortedNodes();
-				}
-				else
-				{
-					ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
-				}
-				break;
-
-			case GroupLayout::SQUARE:
-				ListLayouter::layoutSquare(&node->subNodes, -1);
-				break;
-			}
-		}
-		else if (node->isAccessNode() && !node->hasConnectedSubNode())
-		{
-			ListLayouter::layoutSquare(&node->subNodes, relayoutAccessMaxWidth);
-		}
-		else
-		{
-			ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
-		}
-	}
-
-	Vec2i size = ListLayouter::offsetNodes(
-		node->subNodes,
-		static_cast<int>(margins.top + margins.charHeight + margins.spacingA),
-		margins.left);
-
-	width = std::max(size.x(), width);
-	height = size.y();
-
-	node->size.x = margins.left + width + margins.right;
-	node->size.y = static_cast<int>(
-		margins.top + margins.charHeight + margins.spacingA + height + margins.bottom);
-
-	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-	{
-		if (!subNode->visible)
-		{
-			continue;
-		}
-
-		if (subNode->isAccessNode())
-		{
-			subNode->size.x = width;
-		}
-		else if (subNode->isExpandToggleNode())
-		{
-			subNode->position.x = margins.left + width - subNode->size.x;
-			subNode->position.y = 6;
-		}
-	}
-
-	return ListLayouter::boundingRect(node->subNodes);
-}
-
-void GraphController::addExpandToggleNode(DummyNode* node) 
-{
-	std::shared_ptr<DummyNode> expandNode = std::make_shared<DummyNode>(
-		DummyNode::DUMMY_EXPAND_TOGGLE);
-	expandNode->expanded = node->expanded;
-	expandNode->visible = true;
-
-	size_t visibleSubNodeCount = 0;
-	for (size_t i = 0; i < node->subNodes.size(); i++)
-	{
-		DummyNode* subNode = node->subNodes[i].get();
-
-		if (subNode->isExpandToggleNode())
-		{
-			node->subNodes.erase(node->subNodes.begin() + i);
-			i--;
-			continue;
-		}
-
-		if (subNode->isQualifierNode())
-		{
-			continue;
-		}
-
-		for (const std::shared_ptr<DummyNode>& subSubNode: subNode->subNodes)
-		{
-			if ((subSubNode->visible || subSubNode->hidden) &&
-				(!subSubNode->isGraphNode() || !subSubNode->data->isImplicit() ||
-				 node->data->isImplicit()))
-			{
-				visibleSubNodeCount++;
-			}
-		}
-	}
-
-	expandNode->invisibleSubNodeCount = node->data->getChildCount() - visibleSubNodeCount;
-	if ((expandNode->isExpanded() && visibleSubNodeCount > 0) || expandNode->invisibleSubNodeCount)
-	{
-		node->subNodes.push_back(expandNode);
-	}
-}
-
-void GraphController::layoutToGrid(DummyNode* node) 
-{
-	if (!node->visible || !node->isGraphNode() || !node->hasVisibleSubNode())
-	{
-		return;
-	}
-
-	// Increase size of nodes with visible children to cover full grid cells
-
-	size_t width = GraphViewStyle::toGridSize(node->size.x);
-	size_t height = GraphViewStyle::toGridSize(node->size.y);
-
-	size_t incX = width - node->size.x;
-	size_t incY = height - node->size.y;
-
-	DummyNode* lastAccessNode = nullptr;
-	DummyNode* expandToggleNode = nullptr;
-
-	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
-	{
-		if (!subNode->visible)
-		{
-			continue;
-		}
-
-		if (subNode->isAccessNode())
-		{
-			subNode->size.x = static_cast<int>(subNode->size.x + incX);
-			lastAccessNode = subNode.get();
-		}
-		else if (subNode->isExpandToggleNode())
-		{
-			expandToggleNode = subNode.get();
-		}
-	}
-
-	if (lastAccessNode)
-	{
-		lastAccessNode->size.y = static_cast<int>(lastAccessNode->size.y + incY);
-
-		if (expandToggleNode)
-		{
-			expandToggleNode->position.x = static_cast<int>(expandToggleNode->position.x + incX);
-		}
-
-		node->size.x = static_cast<int>(width);
-		node->size.y = static_cast<int>(height);
-	}
-}
-
 void GraphController::layoutGraph(bool getSortedNodes)
 {
 	TRACE();
@@ -2749,3 +2471,127 @@ void GraphController::createLegendGraph()
 		}
 	}
 }
+
+void GraphController::saveSnapshot(const MessageBase* message)
+{
+	if (m_snapshotsInvalid.exchange(false))
+	{
+		m_snapshots.clear();
+	}
+
+	if (!m_graph)
+	{
+		return;
+	}
+
+	GraphSnapshot snapshot;
+	snapshot.dummyNodes = m_dummyNodes;
+	snapshot.dummyEdges = m_dummyEdges;
+	snapshot.dummyGraphNodes = m_dummyGraphNodes;
+	snapshot.topLevelAncestorIds = m_topLevelAncestorIds;
+	snapshot.activeNodeIds = m_activeNodeIds;
+	snapshot.activeEdgeIds = m_activeEdgeIds;
+	snapshot.graph = m_graph;
+	snapshot.grouping = getView()->getGrouping();
+	snapshot.useBezierEdges = m_useBezierEdges;
+
+	// later messages change the dummy graph and expand the graph in place
+	m_snapshots.setValue(message->getId(), copySnapshot(snapshot));
+}
+
+bool GraphController::restoreSnapshot(const MessageBase* message)
+{
+	if (m_snapshotsInvalid.exchange(false))
+	{
+		m_snapshots.clear();
+		return false;
+	}
+
+	const GraphSnapshot* snapshot = m_snapshots.getValue(message->getId());
+	if (!snapshot || snapshot->activeNodeIds != m_activeNodeIds ||
+		snapshot->activeEdgeIds != m_activeEdgeIds ||
+		snapshot->grouping != getView()->getGrouping())
+	{
+		return false;
+	}
+
+	TRACE("graph restore");
+
+	GraphSnapshot copy = copySnapshot(*snapshot);
+
+	m_dummyNodes = copy.dummyNodes;
+	m_dummyEdges = copy.dummyEdges;
+	m_dummyGraphNodes = copy.dummyGraphNodes;
+	m_topLevelAncestorIds = copy.topLevelAncestorIds;
+	m_graph = copy.graph;
+
+	m_useBezierEdges = copy.useBezierEdges;
+	m_showsLegend = false;
+
+	return true;
+}
+
+GraphController::GraphSnapshot GraphController::copySnapshot(const GraphSnapshot& snapshot)
+{
+	GraphSnapshot copy = snapshot;
+
+	copy.graph = std::make_shared<Graph>();
+	snapshot.graph->forEachNode([&copy](Node* node) { copy.graph->addNodeAsPlainCopy(node); });
+	snapshot.graph->forEachEdge([&copy](Edge* edge) { copy.graph->addEdgeAsPlainCopy(edge); });
+	copy.graph->setTrailMode(snapshot.graph->getTrailMode());
+	copy.graph->setHasTrailOrigin(snapshot.graph->hasTrailOrigin());
+
+	// bundle nodes and the node map share their nodes with the node tree, so each gets copied once
+	std::map<const DummyNode*, std::shared_ptr<DummyNode>> nodeCopies;
+	std::function<std::shared_ptr<DummyNode>(const std::shared_ptr<DummyNode>&)> copyNode =
+		[&](const std::shared_ptr<DummyNode>& node) {
+			auto it = nodeCopies.find(node.get());
+			if (it != nodeCopies.end())
+			{
+				return it->second;
+			}
+
+			std::shared_ptr<DummyNode> nodeCopy = std::make_shared<DummyNode>(*node);
+			nodeCopies.emplace(node.get(), nodeCopy);
+
+			if (node->data)
+			{
+				nodeCopy->data = copy.graph->getNodeById(node->data->getId());
+			}
+
+			for (std::shared_ptr<DummyNode>& subNode: nodeCopy->subNodes)
+			{
+				subNode = copyNode(subNode);
+			}
+
+			DummyNode::BundledNodesSet bundledNodes;
+			for (const std::shared_ptr<DummyNode>& bundledNode: node->bundledNodes)
+			{
+				bundledNodes.insert(copyNode(bundledNode));
+			}
+			nodeCopy->bundledNodes = bundledNodes;
+
+			return nodeCopy;
+		};
+
+	for (std::shared_ptr<DummyNode>& node: copy.dummyNodes)
+	{
+		node = copyNode(node);
+	}
+
+	for (auto& p: copy.dummyGraphNodes)
+	{
+		p.second = copyNode(p.second);
+	}
+
+	for (std::shared_ptr<DummyEdge>& edge: copy.dummyEdges)
+	{
+		edge = std::make_shared<DummyEdge>(*edge);
+		if (edge->data)
+		{
+			edge->data = copy.graph->getEdgeById(edge->data->getId());
+		}
+	}
+
+	return copy;
+}
@@ -1,6 +1,7 @@
 #ifndef GRAPH_CONTROLLER_H
 #define GRAPH_CONTROLLER_H
 
+#include <atomic>
 #include <list>
 #include <vector>
 
@@ -20,6 +21,7 @@
 #include "MessageGraphNodeExpand.h"
 #include "MessageGraphNodeHide.h"
 #include "MessageGraphNodeMove.h"
+#include "MessageIndexingFinished.h"
 #include "MessageListener.h"
 #include "MessageScrollGraph.h"
 #include "MessageShowReference.h"
@@ -28,6 +30,7 @@
 #include "DummyEdge.h"
 #include "DummyNode.h"
 #include "GraphView.h"
+#include "LruCache.h"
 #include "Node.h"
 
 class Graph;
@@ -51,6 +54,7 @@ class GraphController
 	, public MessageListener<MessageGraphNodeExpand>
 	, public MessageListener<MessageGraphNodeHide>
 	, public MessageListener<MessageGraphNodeMove>
+	, public MessageListener<MessageIndexingFinished>
 	, public MessageListener<MessageScrollGraph>
 	, public MessageListener<MessageShowReference>
 {
@@ -61,6 +65,23 @@ public:
 	Id getSchedulerId() const override;
 
 private:
+	// the laid out dummy graph shown for an activation, keeps its own copy of the graph
+	struct GraphSnapshot
+	{
+		std::vector<std::shared_ptr<DummyNode>> dummyNodes;
+		std::vector<std::shared_ptr<DummyEdge>> dummyEdges;
+		std::map<Id, std::shared_ptr<DummyNode>> dummyGraphNodes;
+		std::map<Id, Id> topLevelAncestorIds;
+
+		std::vector<Id> activeNodeIds;
+		std::vector<Id> activeEdgeIds;
+
+		std::shared_ptr<Graph> graph;
+
+		GroupType grouping = GroupType::DEFAULT;
+		bool useBezierEdges = false;
+	};
+
 	void handleMessage(MessageActivateErrors* message) override;
 	void handleMessage(MessageActivateFullTextSearch* message) override;
 	void handleMessage(MessageActivateLegend* message) override;
@@ -77,6 +98,7 @@ private:
 	void handleMessage(MessageGraphNodeExpand* message) override;
 	void handleMessage(MessageGraphNodeHide* message) override;
 	void handleMessage(MessageGraphNodeMove* message) override;
+	void handleMessage(MessageIndexingFinished* message) override;
 	void handleMessage(MessageScrollGraph* message) override;
 	void handleMessage(MessageShowReference* message) override;
 
@@ -132,9 +154,6 @@ private:
 
 	void layoutNesting();
 	void extendEqualFunctionNames(const std::vector<std::shared_ptr<DummyNode>>& nodes) const;
-	Vec4i layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth = -1) const;
-	static void addExpandToggleNode(DummyNode* node);
-	static void layoutToGrid(DummyNode* node);
 
 	void layoutGraph(bool getSortedNodes = false);
 	void layoutList();
@@ -157,6 +176,12 @@ private:
 
 	void createLegendGraph();
 
+	// history navigation replays activations, which restore the graph they showed before instead
+	// of querying the storage and layouting again
+	void saveSnapshot(const MessageBase* message);
+	bool restoreSnapshot(const MessageBase* message);
+	static GraphSnapshot copySnapshot(const GraphSnapshot& snapshot);
+
 	StorageAccess* m_storageAccess;
 
 	std::vector<std::shared_ptr<DummyNode>> m_dummyNodes;
@@ -174,6 +199,12 @@ private:
 	bool m_useBezierEdges = false;
 	bool m_showsLegend = false;
 	Id m_tokenIdToFocus = 0;
+
+	// keyed by the id of the activation message, which is kept in the history
+	LruCache<Id, GraphSnapshot> m_snapshots;
+	// MessageIndexingFinished is handled on another thread, so the snapshots get cleared with the
+	// next activation
+	std::atomic<bool> m_snapshotsInvalid = false;
 };
 
 #endif	  // GRAPH_CONTROLLER_H
@@ -357,6 +357,7 @@ void UndoRedoController::handleMessage(MessageIndexingFinished*  /*message*/)
 			}
 
 			newList.insert(newList.end(), command);
+			newList.back().resolveTokenIds = true;
 		}
 	}
 
@@ -498,8 +499,10 @@ void UndoRedoController::replayCommand(std::list<Command>::iterator it)
 	{
 		MessageActivateTokens* msg = dynamic_cast<MessageActivateTokens*>(m.get());
 
-		if (!msg->isEdge && !msg->isBundledEdges)
+		if (it->resolveTokenIds && !msg->isEdge && !msg->isBundledEdges)
 		{
+			it->resolveTokenIds = false;
+
 			std::vector<SearchMatch> matches = msg->getSearchMatches();
 			msg->searchMatches.clear();
 			msg->tokenIds.clear();
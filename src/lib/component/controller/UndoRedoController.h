@@ -91,6 +91,9 @@ private:
 		std::shared_ptr<MessageBase> message;
 		Order order;
 		bool replayLastOnly;
+
+		// token ids change with indexing, so they get looked up by name before the next replay
+		bool resolveTokenIds = false;
 	};
 
 	void handleMessage(MessageActivateErrors* message) override;
@@ -465,6 +465,7 @@ public:
 
 	// Layout
 	Vec2i columnSize;
+	size_t layoutSignature = 0;	   // inputs of the last nesting layout, see NestingLayouter
 
 	// BundleNode
 	BundledNodesSet bundledNodes;
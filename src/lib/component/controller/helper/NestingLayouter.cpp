@@ -0,0 +1,381 @@
+#include "NestingLayouter.h"
+
+#include <functional>
+
+#include "BucketLayouter.h"
+#include "DummyEdge.h"
+#include "DummyNode.h"
+#include "GraphViewStyle.h"
+#include "ListLayouter.h"
+#include "utilityString.h"
+
+NestingLayouter::NestingLayouter(
+	Vec2i viewSize, const std::vector<std::shared_ptr<DummyEdge>>& edges, size_t activeNodeCount)
+	: m_viewSize(viewSize), m_edges(edges), m_activeNodeCount(activeNodeCount)
+{
+}
+
+void NestingLayouter::layout(const std::vector<std::shared_ptr<DummyNode>>& nodes)
+{
+	m_layoutedNodeCount = 0;
+
+	for (const std::shared_ptr<DummyNode>& node: nodes)
+	{
+		if (node->visible && node->isGraphNode() &&
+			node->layoutSignature == getLayoutSignature(node.get(), true))
+		{
+			continue;
+		}
+
+		layoutNestingRecursive(node.get());
+		layoutToGrid(node.get());
+
+		if (node->isGraphNode())
+		{
+			node->layoutSignature = getLayoutSignature(node.get(), true);
+		}
+	}
+}
+
+size_t NestingLayouter::getLayoutedNodeCount() const
+{
+	return m_layoutedNodeCount;
+}
+
+size_t NestingLayouter::getLayoutSignature(const DummyNode* node, bool alignedToGrid)
+{
+	// top level nodes get aligned to the grid, which changes their size after the nesting layout
+	size_t signature = alignedToGrid ? 2 : 1;
+	addToLayoutSignature(node, &signature);
+
+	// 0 is reserved for nodes that were never layouted
+	return signature ? signature : 1;
+}
+
+void NestingLayouter::addToLayoutSignature(const DummyNode* node, size_t* signature)
+{
+	auto add = [signature](size_t value) {
+		*signature ^= value + 0x9e3779b97f4a7c15 + (*signature << 6) + (*signature >> 2);
+	};
+
+	// positions and sizes are results of the layout, everything else it depends on is added
+	add(reinterpret_cast<size_t>(node));
+	add(node->type);
+	add(node->visible | node->hidden << 1 | node->childVisible << 2 | node->active << 3 |
+		node->connected << 4 | node->expanded << 5);
+	add(reinterpret_cast<size_t>(node->data));
+	add(std::hash<std::wstring>()(node->name));
+	add(node->accessKind);
+	add(node->getBundledNodeCount());
+	add(node->bundledNodeType.getKind());
+	add(static_cast<size_t>(node->groupType));
+	add(static_cast<size_t>(node->groupLayout));
+	add(node->fontSizeDiff);
+	add(node->subNodes.size());
+
+	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+	{
+		addToLayoutSignature(subNode.get(), signature);
+	}
+}
+
+Vec4i NestingLayouter::layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth)
+{
+	if (!node->visible)
+	{
+		return Vec4i(0, 0, 0, 0);
+	}
+
+	if (node->isGraphNode() && node->layoutSignature == getLayoutSignature(node, false))
+	{
+		return ListLayouter::boundingRect(node->subNodes);
+	}
+
+	GraphViewStyle::NodeMargins margins;
+
+	if (node->isGraphNode())
+	{
+		margins = GraphViewStyle::getMarginsForDataNode(
+			node->data->getType().getNodeStyle(), node->data->getType().hasIcon(), node->childVisible);
+	}
+	else if (node->isAccessNode())
+	{
+		margins = GraphViewStyle::getMarginsOfAccessNode(node->accessKind);
+	}
+	else if (node->isExpandToggleNode())
+	{
+		margins = GraphViewStyle::getMarginsOfExpandToggleNode();
+	}
+	else if (node->isBundleNode())
+	{
+		if (node->bundledNodeType.getKind() != NODE_SYMBOL)
+		{
+			margins = GraphViewStyle::getMarginsForDataNode(
+				node->bundledNodeType.getNodeStyle(), node->bundledNodeType.hasIcon(), false);
+		}
+		else
+		{
+			margins = GraphViewStyle::getMarginsOfBundleNode();
+		}
+	}
+	else if (node->isQualifierNode())
+	{
+		return Vec4i(0, 0, 0, 0);
+	}
+	else if (node->isTextNode())
+	{
+		margins = GraphViewStyle::getMarginsOfTextNode(node->fontSizeDiff);
+	}
+	else if (node->isGroupNode())
+	{
+		margins = GraphViewStyle::getMarginsOfGroupNode(node->groupType, node->name.size());
+	}
+
+	int width = 0;
+	int height = 0;
+
+	if (node->isGraphNode())
+	{
+		node->name = utility::elide(node->name, utility::ELIDE_RIGHT, node->active ? 100 : 50);
+		width = static_cast<int>(margins.charWidth * node->name.size());
+
+		if (node->data->getType().isCollapsible() && node->data->getChildCount() > 0)
+		{
+			addExpandToggleNode(node);
+		}
+	}
+	else if (node->isBundleNode() || node->isTextNode())
+	{
+		width = static_cast<int>(margins.charWidth * node->name.size());
+	}
+	else if (node->isGroupNode())
+	{
+		width = static_cast<int>(margins.charWidth * node->name.size() + 5);
+	}
+
+	width += margins.iconWidth;
+	width = std::max(width, margins.minWidth);
+
+	if (relayoutAccessMaxWidth == -1)
+	{
+		int maxAccessWidth = 0;
+		std::shared_ptr<const DummyNode> maxWidthAccessNode;
+
+		for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+		{
+			if (!subNode->visible)
+			{
+				continue;
+			}
+			else if (subNode->isQualifierNode())
+			{
+				subNode->position.y = static_cast<int>(margins.top + margins.charHeight / 2);
+				width += 5;
+				continue;
+			}
+
+			Vec4i rect = layoutNestingRecursive(subNode.get());
+
+			if (subNode->isExpandToggleNode())
+			{
+				width += margins.spacingX + subNode->size.x;
+			}
+			else if (subNode->isAccessNode() && rect.z() > maxAccessWidth)
+			{
+				maxAccessWidth = rect.z();
+				maxWidthAccessNode = subNode;
+			}
+		}
+
+		if (maxAccessWidth > 0)
+		{
+			for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+			{
+				if (subNode->visible && subNode->isAccessNode() && subNode != maxWidthAccessNode)
+				{
+					layoutNestingRecursive(subNode.get(), maxAccessWidth);
+				}
+			}
+		}
+	}
+
+	if (node->subNodes.size())
+	{
+		if (node->isGroupNode())
+		{
+			Vec2i viewSize = m_viewSize;
+
+			switch (node->groupLayout)
+			{
+			case GroupLayout::LIST:
+				viewSize.x = viewSize.x - 150;	  // prevent horizontal scroll
+				ListLayouter::layoutMultiColumn(viewSize, &node->subNodes);
+				break;
+
+			case GroupLayout::SKEWED:
+				ListLayouter::layoutSkewed(
+					&node->subNodes,
+					margins.spacingX,
+					margins.spacingY,
+					static_cast<int>(viewSize.x() * 1.5));
+				break;
+
+			case GroupLayout::BUCKET:
+				if (node->hasActiveSubNode() || !m_activeNodeCount /* bundled edges */)
+				{
+					BucketLayouter grid(viewSize);
+					grid.createBuckets(node->subNodes, m_edges);
+					grid.layoutBuckets(m_activeNodeCount);
+					node->subNodes = grid.getSortedNodes();
+				}
+				else
+				{
+					ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
+				}
+				break;
+
+			case GroupLayout::SQUARE:
+				ListLayouter::layoutSquare(&node->subNodes, -1);
+				break;
+			}
+		}
+		else if (node->isAccessNode() && !node->hasConnectedSubNode())
+		{
+			ListLayouter::layoutSquare(&node->subNodes, relayoutAccessMaxWidth);
+		}
+		else
+		{
+			ListLayouter::layoutColumn(&node->subNodes, margins.spacingY);
+		}
+	}
+
+	Vec2i size = ListLayouter::offsetNodes(
+		node->subNodes,
+		static_cast<int>(margins.top + margins.charHeight + margins.spacingA),
+		margins.left);
+
+	width = std::max(size.x(), width);
+	height = size.y();
+
+	node->size.x = margins.left + width + margins.right;
+	node->size.y = static_cast<int>(
+		margins.top + margins.charHeight + margins.spacingA + height + margins.bottom);
+
+	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+	{
+		if (!subNode->visible)
+		{
+			continue;
+		}
+
+		if (subNode->isAccessNode())
+		{
+			subNode->size.x = width;
+		}
+		else if (subNode->isExpandToggleNode())
+		{
+			subNode->position.x = margins.left + width - subNode->size.x;
+			subNode->position.y = 6;
+		}
+	}
+
+	if (node->isGraphNode())
+	{
+		node->layoutSignature = getLayoutSignature(node, false);
+		m_layoutedNodeCount++;
+	}
+
+	return ListLayouter::boundingRect(node->subNodes);
+}
+
+void NestingLayouter::addExpandToggleNode(DummyNode* node)
+{
+	std::shared_ptr<DummyNode> expandNode = std::make_shared<DummyNode>(
+		DummyNode::DUMMY_EXPAND_TOGGLE);
+	expandNode->expanded = node->expanded;
+	expandNode->visible = true;
+
+	size_t visibleSubNodeCount = 0;
+	for (size_t i = 0; i < node->subNodes.size(); i++)
+	{
+		DummyNode* subNode = node->subNodes[i].get();
+
+		if (subNode->isExpandToggleNode())
+		{
+			node->subNodes.erase(node->subNodes.begin() + i);
+			i--;
+			continue;
+		}
+
+		if (subNode->isQualifierNode())
+		{
+			continue;
+		}
+
+		for (const std::shared_ptr<DummyNode>& subSubNode: subNode->subNodes)
+		{
+			if ((subSubNode->visible || subSubNode->hidden) &&
+				(!subSubNode->isGraphNode() || !subSubNode->data->isImplicit() ||
+				 node->data->isImplicit()))
+			{
+				visibleSubNodeCount++;
+			}
+		}
+	}
+
+	expandNode->invisibleSubNodeCount = node->data->getChildCount() - visibleSubNodeCount;
+	if ((expandNode->isExpanded() && visibleSubNodeCount > 0) || expandNode->invisibleSubNodeCount)
+	{
+		node->subNodes.push_back(expandNode);
+	}
+}
+
+void NestingLayouter::layoutToGrid(DummyNode* node)
+{
+	if (!node->visible || !node->isGraphNode() || !node->hasVisibleSubNode())
+	{
+		return;
+	}
+
+	// Increase size of nodes with visible children to cover full grid cells
+
+	size_t width = GraphViewStyle::toGridSize(node->size.x);
+	size_t height = GraphViewStyle::toGridSize(node->size.y);
+
+	size_t incX = width - node->size.x;
+	size_t incY = height - node->size.y;
+
+	DummyNode* lastAccessNode = nullptr;
+	DummyNode* expandToggleNode = nullptr;
+
+	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+	{
+		if (!subNode->visible)
+		{
+			continue;
+		}
+
+		if (subNode->isAccessNode())
+		{
+			subNode->size.x = static_cast<int>(subNode->size.x + incX);
+			lastAccessNode = subNode.get();
+		}
+		else if (subNode->isExpandToggleNode())
+		{
+			expandToggleNode = subNode.get();
+		}
+	}
+
+	if (lastAccessNode)
+	{
+		lastAccessNode->size.y = static_cast<int>(lastAccessNode->size.y + incY);
+
+		if (expandToggleNode)
+		{
+			expandToggleNode->position.x = static_cast<int>(expandToggleNode->position.x + incX);
+		}
+
+		node->size.x = static_cast<int>(width);
+		node->size.y = static_cast<int>(height);
+	}
+}
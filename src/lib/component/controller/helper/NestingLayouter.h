@@ -0,0 +1,42 @@
+#ifndef NESTING_LAYOUTER_H
+#define NESTING_LAYOUTER_H
+
+#include <memory>
+#include <vector>
+
+#include "Vector2.h"
+#include "Vector4.h"
+
+struct DummyEdge;
+struct DummyNode;
+
+// Computes the sizes of dummy nodes and the positions of their sub nodes. Every graph node keeps a
+// signature of the inputs of its last layout, so sub trees that did not change since then keep
+// their sizes and are not layouted again.
+class NestingLayouter
+{
+public:
+	NestingLayouter(
+		Vec2i viewSize, const std::vector<std::shared_ptr<DummyEdge>>& edges, size_t activeNodeCount);
+
+	void layout(const std::vector<std::shared_ptr<DummyNode>>& nodes);
+
+	// number of graph nodes that were layouted by the last call to 'layout'
+	size_t getLayoutedNodeCount() const;
+
+private:
+	static size_t getLayoutSignature(const DummyNode* node, bool alignedToGrid);
+	static void addToLayoutSignature(const DummyNode* node, size_t* signature);
+
+	Vec4i layoutNestingRecursive(DummyNode* node, int relayoutAccessMaxWidth = -1);
+	static void addExpandToggleNode(DummyNode* node);
+	static void layoutToGrid(DummyNode* node);
+
+	const Vec2i m_viewSize;
+	const std::vector<std::shared_ptr<DummyEdge>>& m_edges;
+	const size_t m_activeNodeCount;
+
+	size_t m_layoutedNodeCount = 0;
+};
+
+#endif	  // NESTING_LAYOUTER_H
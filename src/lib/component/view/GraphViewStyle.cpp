@@ -12,6 +12,7 @@ int GraphViewStyle::s_gridCellPadding = 10;
 
 std::map<NodeType::StyleType, float> GraphViewStyle::s_charWidths;
 std::map<NodeType::StyleType, float> GraphViewStyle::s_charHeights;
+std::map<std::pair<std::string, size_t>, float> GraphViewStyle::s_fontCharWidths;
 
 std::shared_ptr<GraphViewStyleImpl> GraphViewStyle::s_impl;
 
@@ -109,6 +110,7 @@ void GraphViewStyle::loadStyleSettings()
 
 	s_charWidths.clear();
 	s_charHeights.clear();
+	s_fontCharWidths.clear();
 
 	s_focusColor.clear();
 	s_nodeColors.clear();
@@ -844,7 +846,16 @@ float GraphViewStyle::getCharHeight(NodeType::StyleType type)
 
 float GraphViewStyle::getCharWidth(const std::string& fontName, size_t fontSize)
 {
-	return getImpl()->getCharWidth(fontName, fontSize);
+	const std::pair<std::string, size_t> font(fontName, fontSize);
+	std::map<std::pair<std::string, size_t>, float>::const_iterator it = s_fontCharWidths.find(font);
+	if (it != s_fontCharWidths.end())
+	{
+		return it->second;
+	}
+
+	float charWidth = getImpl()->getCharWidth(fontName, fontSize);
+	s_fontCharWidths.emplace(font, charWidth);
+	return charWidth;
 }
 
 float GraphViewStyle::getCharHeight(const std::string& fontName, size_t fontSize)
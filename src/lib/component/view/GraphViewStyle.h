@@ -173,6 +173,7 @@ private:
 
 	static std::map<NodeType::StyleType, float> s_charWidths;
 	static std::map<NodeType::StyleType, float> s_charHeights;
+	static std::map<std::pair<std::string, size_t>, float> s_fontCharWidths;
 
 	static std::shared_ptr<GraphViewStyleImpl> s_impl;
 
@@ -95,6 +95,6 @@ bool CodeFileParams::sort(const CodeFileParams& a, const CodeFileParams& b)
 
 bool CodeFileParams::sortById(const CodeFileParams& a, const CodeFileParams& b)
 {
-	return a.locationFile->getSourceLocations().begin()->get()->getLocationId() <
-		b.locationFile->getSourceLocations().begin()->get()->getLocationId();
+	return a.locationFile->getFirstSourceLocation()->getLocationId() <
+		b.locationFile->getFirstSourceLocation()->getLocationId();
 }
@@ -0,0 +1,127 @@
+#include "EdgeAdjacencyCache.h"
+
+#include <algorithm>
+
+void EdgeAdjacencyCache::AdjacencyIndex::build(std::vector<std::pair<Id, AdjacentEdge>> entries)
+{
+	std::sort(
+		entries.begin(),
+		entries.end(),
+		[](const std::pair<Id, AdjacentEdge>& a, const std::pair<Id, AdjacentEdge>& b) {
+			return a.first != b.first ? a.first < b.first : a.second.edgeId < b.second.edgeId;
+		});
+
+	m_nodeIds.clear();
+	m_offsets.clear();
+	m_edges.clear();
+	m_edges.reserve(entries.size());
+
+	for (const std::pair<Id, AdjacentEdge>& entry: entries)
+	{
+		if (m_nodeIds.empty() || m_nodeIds.back() != entry.first)
+		{
+			m_nodeIds.push_back(entry.first);
+			m_offsets.push_back(m_edges.size());
+		}
+		m_edges.push_back(entry.second);
+	}
+	m_offsets.push_back(m_edges.size());
+
+	m_nodeIds.shrink_to_fit();
+	m_offsets.shrink_to_fit();
+}
+
+template <typename FuncType>
+void EdgeAdjacencyCache::AdjacencyIndex::forEachAdjacentEdge(Id nodeId, FuncType func) const
+{
+	auto it = std::lower_bound(m_nodeIds.begin(), m_nodeIds.end(), nodeId);
+	if (it == m_nodeIds.end() || *it != nodeId)
+	{
+		return;
+	}
+
+	const size_t index = it - m_nodeIds.begin();
+	for (size_t i = m_offsets[index]; i < m_offsets[index + 1]; i++)
+	{
+		func(m_edges[i]);
+	}
+}
+
+
+void EdgeAdjacencyCache::clear()
+{
+	m_tables.clear();
+	m_edgeCount = 0;
+}
+
+void EdgeAdjacencyCache::build(const std::vector<StorageEdge>& edges)
+{
+	clear();
+
+	std::map<Edge::EdgeType, std::vector<const StorageEdge*>> edgesByType;
+	for (const StorageEdge& edge: edges)
+	{
+		edgesByType[Edge::intToType(edge.type)].push_back(&edge);
+	}
+
+	for (const auto& p: edgesByType)
+	{
+		std::vector<std::pair<Id, AdjacentEdge>> outgoing;
+		std::vector<std::pair<Id, AdjacentEdge>> incoming;
+		outgoing.reserve(p.second.size());
+		incoming.reserve(p.second.size());
+
+		for (const StorageEdge* edge: p.second)
+		{
+			outgoing.push_back({edge->sourceNodeId, {edge->id, edge->targetNodeId}});
+			incoming.push_back({edge->targetNodeId, {edge->id, edge->sourceNodeId}});
+		}
+
+		EdgeTable& table = m_tables[p.first];
+		table.outgoing.build(std::move(outgoing));
+		table.incoming.build(std::move(incoming));
+	}
+
+	m_edgeCount = edges.size();
+}
+
+size_t EdgeAdjacencyCache::getEdgeCount() const
+{
+	return m_edgeCount;
+}
+
+void EdgeAdjacencyCache::addEdgesBySourceIds(
+	const std::vector<Id>& sourceIds, Edge::TypeMask edgeTypes, std::vector<StorageEdge>* edges) const
+{
+	for (const auto& p: m_tables)
+	{
+		if (p.first & edgeTypes)
+		{
+			const int type = Edge::typeToInt(p.first);
+			for (Id sourceId: sourceIds)
+			{
+				p.second.outgoing.forEachAdjacentEdge(sourceId, [&](const AdjacentEdge& edge) {
+					edges->emplace_back(edge.edgeId, type, sourceId, edge.nodeId);
+				});
+			}
+		}
+	}
+}
+
+void EdgeAdjacencyCache::addEdgesByTargetIds(
+	const std::vector<Id>& targetIds, Edge::TypeMask edgeTypes, std::vector<StorageEdge>* edges) const
+{
+	for (const auto& p: m_tables)
+	{
+		if (p.first & edgeTypes)
+		{
+			const int type = Edge::typeToInt(p.first);
+			for (Id targetId: targetIds)
+			{
+				p.second.incoming.forEachAdjacentEdge(targetId, [&](const AdjacentEdge& edge) {
+					edges->emplace_back(edge.edgeId, type, edge.nodeId, targetId);
+				});
+			}
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef EDGE_ADJACENCY_CACHE_H
+#define EDGE_ADJACENCY_CACHE_H
+
+#include <map>
+#include <vector>
+
+#include "Edge.h"
+#include "StorageEdge.h"
+#include "types.h"
+
+// Keeps the edges of each type in compressed sparse row layout, so graph traversals can step from
+// a set of nodes to their neighbours without querying the database.
+class EdgeAdjacencyCache
+{
+public:
+	void clear();
+	void build(const std::vector<StorageEdge>& edges);
+
+	size_t getEdgeCount() const;
+
+	void addEdgesBySourceIds(
+		const std::vector<Id>& sourceIds, Edge::TypeMask edgeTypes, std::vector<StorageEdge>* edges) const;
+	void addEdgesByTargetIds(
+		const std::vector<Id>& targetIds, Edge::TypeMask edgeTypes, std::vector<StorageEdge>* edges) const;
+
+private:
+	struct AdjacentEdge
+	{
+		Id edgeId;
+		Id nodeId;	  // node on the other end of the edge
+	};
+
+	class AdjacencyIndex
+	{
+	public:
+		void build(std::vector<std::pair<Id, AdjacentEdge>> entries);
+
+		template <typename FuncType>
+		void forEachAdjacentEdge(Id nodeId, FuncType func) const;
+
+	private:
+		std::vector<Id> m_nodeIds;	  // sorted
+		std::vector<size_t> m_offsets;	  // one more entry than m_nodeIds
+		std::vector<AdjacentEdge> m_edges;
+	};
+
+	struct EdgeTable
+	{
+		AdjacencyIndex outgoing;
+		AdjacencyIndex incoming;
+	};
+
+	std::map<Edge::EdgeType, EdgeTable> m_tables;
+	size_t m_edgeCount = 0;
+};
+
+#endif	  // EDGE_ADJACENCY_CACHE_H
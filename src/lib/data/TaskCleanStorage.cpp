@@ -5,6 +5,7 @@
 #include "DialogView.h"
 #include "FilePath.h"
 #include "PersistentStorage.h"
+#include "tracing.h"
 
 TaskCleanStorage::TaskCleanStorage(
 	std::weak_ptr<PersistentStorage> storage,
@@ -36,6 +37,8 @@ void TaskCleanStorage::doEnter(std::shared_ptr<Blackboard>  /*blackboard*/)
 
 Task::TaskState TaskCleanStorage::doUpdate(std::shared_ptr<Blackboard>  /*blackboard*/)
 {
+	TRACE("clean storage");
+
 	if (std::shared_ptr<PersistentStorage> storage = m_storage.lock())
 	{
 		if (m_clearAllErrors)
@@ -7,6 +7,7 @@
 #include "MessageStatus.h"
 #include "PersistentStorage.h"
 #include "TimeStamp.h"
+#include "tracing.h"
 #include "utilityString.h"
 
 TaskFinishParsing::TaskFinishParsing(
@@ -30,6 +31,8 @@ void TaskFinishParsing::doEnter(std::shared_ptr<Blackboard>  /*blackboard*/)
 
 Task::TaskState TaskFinishParsing::doUpdate(std::shared_ptr<Blackboard> blackboard)
 {
+	TRACE("finish parsing");
+
 	TimeStamp start = TimeStamp::now();
 
 	m_dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Optimizing database");
@@ -2,6 +2,7 @@
 
 #include "Storage.h"
 #include "StorageProvider.h"
+#include "tracing.h"
 
 TaskInjectStorage::TaskInjectStorage(
 	std::shared_ptr<StorageProvider> storageProvider, std::weak_ptr<Storage> target)
@@ -20,6 +21,8 @@ Task::TaskState TaskInjectStorage::doUpdate(std::shared_ptr<Blackboard>  /*black
 		{
 			if (std::shared_ptr<Storage> target = m_target.lock())
 			{
+				TRACE("inject storage");
+
 				target->inject(source.get());
 				return STATE_SUCCESS;
 			}
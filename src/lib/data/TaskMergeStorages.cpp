@@ -1,6 +1,7 @@
 #include "TaskMergeStorages.h"
 
 #include "StorageProvider.h"
+#include "tracing.h"
 
 TaskMergeStorages::TaskMergeStorages(std::shared_ptr<StorageProvider> storageProvider)
 	: m_storageProvider(storageProvider)
@@ -17,6 +18,8 @@ Task::TaskState TaskMergeStorages::doUpdate(std::shared_ptr<Blackboard>  /*black
 		std::shared_ptr<IntermediateStorage> source = m_storageProvider->consumeSecondLargestStorage();
 		if (target && source)
 		{
+			TRACE("merge storages");
+
 			target->inject(source.get());
 			m_storageProvider->insert(target);
 			return STATE_SUCCESS;
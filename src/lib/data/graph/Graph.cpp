@@ -18,18 +18,12 @@ void Graph::clear()
 
 void Graph::forEachNode(std::function<void(Node*)> func) const
 {
-	for (const auto &node: m_nodes)
-	{
-		func(node.second.get());
-	}
+	m_nodes.forEach(func);
 }
 
 void Graph::forEachEdge(std::function<void(Edge*)> func) const
 {
-	for (const auto &edge: m_edges)
-	{
-		func(edge.second.get());
-	}
+	m_edges.forEach(func);
 }
 
 void Graph::forEachToken(std::function<void(Token*)> func) const
@@ -46,10 +40,19 @@ Node* Graph::createNode(Id id, NodeType type, NameHierarchy nameHierarchy, Defin
 		return n;
 	}
 
-	std::shared_ptr<Node> node = std::make_shared<Node>(
-		id, type, std::move(nameHierarchy), definitionKind);
-	m_nodes.emplace(node->getId(), node);
-	return node.get();
+	return m_nodes.create(id, type, std::move(nameHierarchy), definitionKind);
+}
+
+Node* Graph::createNodeWithSerializedName(
+	Id id, NodeType type, const std::wstring& serializedName, DefinitionKind definitionKind)
+{
+	Node* n = getNodeById(id);
+	if (n)
+	{
+		return n;
+	}
+
+	return m_nodes.create(id, type, serializedName, definitionKind);
 }
 
 Edge* Graph::createEdge(Id id, Edge::EdgeType type, Node* from, Node* to)
@@ -66,9 +69,7 @@ Edge* Graph::createEdge(Id id, Edge::EdgeType type, Node* from, Node* to)
 		return nullptr;
 	}
 
-	std::shared_ptr<Edge> edge = std::make_shared<Edge>(id, type, from, to);
-	m_edges.emplace(edge->getId(), edge);
-	return edge.get();
+	return m_edges.create(id, type, from, to);
 }
 
 size_t Graph::getNodeCount() const
@@ -83,38 +84,17 @@ size_t Graph::getEdgeCount() const
 
 Node* Graph::getNodeById(Id id) const
 {
-	std::map<Id, std::shared_ptr<Node>>::const_iterator it = m_nodes.find(id);
-	if (it != m_nodes.end())
-	{
-		return it->second.get();
-	}
-	return nullptr;
+	return m_nodes.get(id);
 }
 
 Edge* Graph::getEdgeById(Id id) const
 {
-	std::map<Id, std::shared_ptr<Edge>>::const_iterator it = m_edges.find(id);
-	if (it != m_edges.end())
-	{
-		return it->second.get();
-	}
-	return nullptr;
-}
-
-const std::map<Id, std::shared_ptr<Node>>& Graph::getNodes() const
-{
-	return m_nodes;
-}
-
-const std::map<Id, std::shared_ptr<Edge>>& Graph::getEdges() const
-{
-	return m_edges;
+	return m_edges.get(id);
 }
 
 void Graph::removeNode(Node* node)
 {
-	std::map<Id, std::shared_ptr<Node>>::const_iterator it = m_nodes.find(node->getId());
-	if (it == m_nodes.end())
+	if (getNodeById(node->getId()) != node)
 	{
 		LOG_WARNING("Node was not found in the graph.");
 		return;
@@ -138,7 +118,7 @@ void Graph::removeNode(Node* node)
 
 	for (Edge* edge: edgesToRemove)
 	{
-		removeEdgeInternal(edge);
+		m_edges.remove(edge);
 	}
 
 	if (node->getEdgeCount())
@@ -146,15 +126,15 @@ void Graph::removeNode(Node* node)
 		LOG_ERROR("Node still has edges.");
 	}
 
-	m_nodes.erase(it);
+	m_nodes.remove(node);
 }
 
 void Graph::removeEdge(Edge* edge)
 {
-	std::map<Id, std::shared_ptr<Edge>>::const_iterator it = m_edges.find(edge->getId());
-	if (it == m_edges.end())
+	if (getEdgeById(edge->getId()) != edge)
 	{
 		LOG_WARNING("Edge was not found in the graph.");
+		return;
 	}
 
 	if (edge->getType() == Edge::EDGE_MEMBER)
@@ -163,37 +143,17 @@ void Graph::removeEdge(Edge* edge)
 		return;
 	}
 
-	m_edges.erase(it);
+	m_edges.remove(edge);
 }
 
 Node* Graph::findNode(std::function<bool(Node*)> func) const
 {
-	std::map<Id, std::shared_ptr<Node>>::const_iterator it = find_if(
-		m_nodes.begin(), m_nodes.end(), [&func](const std::pair<Id, std::shared_ptr<Node>>& n) {
-			return func(n.second.get());
-		});
-
-	if (it != m_nodes.end())
-	{
-		return it->second.get();
-	}
-
-	return nullptr;
+	return m_nodes.find(func);
 }
 
 Edge* Graph::findEdge(std::function<bool(Edge*)> func) const
 {
-	std::map<Id, std::shared_ptr<Edge>>::const_iterator it = find_if(
-		m_edges.begin(), m_edges.end(), [func](const std::pair<Id, std::shared_ptr<Edge>>& e) {
-			return func(e.second.get());
-		});
-
-	if (it != m_edges.end())
-	{
-		return it->second.get();
-	}
-
-	return nullptr;
+	return m_edges.find(func);
 }
 
 Token* Graph::findToken(std::function<bool(Token*)> func) const
@@ -221,9 +181,7 @@ Node* Graph::addNodeAsPlainCopy(Node* node)
 		return n;
 	}
 
-	std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
-	m_nodes.emplace(copy->getId(), copy);
-	return copy.get();
+	return m_nodes.create(*node);
 }
 
 Edge* Graph::addEdgeAsPlainCopy(Edge* edge)
@@ -237,9 +195,7 @@ Edge* Graph::addEdgeAsPlainCopy(Edge* edge)
 	Node* from = addNodeAsPlainCopy(edge->getFrom());
 	Node* to = addNodeAsPlainCopy(edge->getTo());
 
-	std::shared_ptr<Edge> copy = std::make_shared<Edge>(*edge, from, to);
-	m_edges.emplace(copy->getId(), copy);
-	return copy.get();
+	return m_edges.create(*edge, from, to);
 }
 
 Node* Graph::addNodeAndAllChildrenAsPlainCopy(Node* node)
@@ -323,15 +279,6 @@ void Graph::printBasic(std::wostream& ostream) const
 	ostream << L'\n';
 }
 
-void Graph::removeEdgeInternal(Edge* edge)
-{
-	std::map<Id, std::shared_ptr<Edge>>::const_iterator it = m_edges.find(edge->getId());
-	if (it != m_edges.end() && it->second.get() == edge)
-	{
-		m_edges.erase(it);
-	}
-}
-
 std::wostream& operator<<(std::wostream& ostream, const Graph& graph)
 {
 	graph.print(ostream);
@@ -1,9 +1,13 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <algorithm>
 #include <deque>
-#include <map>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include "Edge.h"
 #include "Node.h"
@@ -28,6 +32,8 @@ public:
 	void forEachToken(std::function<void(Token*)> func) const;
 
 	Node* createNode(Id id, NodeType type, NameHierarchy nameHierarchy, DefinitionKind definitionKind);
+	Node* createNodeWithSerializedName(
+		Id id, NodeType type, const std::wstring& serializedName, DefinitionKind definitionKind);
 	Edge* createEdge(Id id, Edge::EdgeType type, Node* from, Node* to);
 
 	size_t getNodeCount() const;
@@ -36,9 +42,6 @@ public:
 	Node* getNodeById(Id id) const;
 	Edge* getEdgeById(Id id) const;
 
-	const std::map<Id, std::shared_ptr<Node>>& getNodes() const;
-	const std::map<Id, std::shared_ptr<Edge>>& getEdges() const;
-
 	void removeNode(Node* node);
 	void removeEdge(Edge* edge);
 
@@ -66,13 +69,40 @@ public:
 	void printBasic(std::wostream& ostream) const;
 
 private:
+	// Stores the elements in a deque, so they don't need an allocation each and keep their address
+	// while the graph grows. Removed elements leave an empty slot behind.
+	template <typename T>
+	class ElementPool
+	{
+	public:
+		template <typename... Args>
+		T* create(Args&&... args);
+		void remove(T* element);
+		void clear();
+
+		T* get(Id id) const;
+		size_t size() const;
+
+		// visits the elements ordered by id, elements may be added while visiting
+		void forEach(const std::function<void(T*)>& func) const;
+		T* find(const std::function<bool(T*)>& func) const;
+
+	private:
+		std::deque<std::optional<T>> m_slots;
+		std::unordered_map<Id, size_t> m_slotIndices;
+		Id m_lastCreatedId = 0;
+		bool m_createdInIdOrder = true;
+
+		// elements sorted by id if they were not created in id order, sorted again only after the
+		// elements changed, shared with running visits so they can be replaced meanwhile
+		mutable std::shared_ptr<const std::vector<T*>> m_sortedElements;
+	};
+
 	Graph(const Graph&);
 	void operator=(const Graph&);
 
-	void removeEdgeInternal(Edge* edge);
-
-	std::map<Id, std::shared_ptr<Node>> m_nodes;
-	std::map<Id, std::shared_ptr<Edge>> m_edges;
+	ElementPool<Node> m_nodes;
+	ElementPool<Edge> m_edges;
 
 	TrailMode m_trailMode = TRAIL_NONE;
 	bool m_hasTrailOrigin;
@@ -80,4 +110,115 @@ private:
 
 std::wostream& operator<<(std::wostream& ostream, const Graph& graph);
 
+template <typename T>
+template <typename... Args>
+T* Graph::ElementPool<T>::create(Args&&... args)
+{
+	T& element = m_slots.emplace_back(std::in_place, std::forward<Args>(args)...).value();
+	const Id id = element.getId();
+
+	if (m_slots.size() > 1 && !(m_lastCreatedId < id))
+	{
+		m_createdInIdOrder = false;
+	}
+	m_lastCreatedId = id;
+
+	m_slotIndices.emplace(id, m_slots.size() - 1);
+	m_sortedElements.reset();
+	return &element;
+}
+
+template <typename T>
+void Graph::ElementPool<T>::remove(T* element)
+{
+	auto it = m_slotIndices.find(element->getId());
+	if (it != m_slotIndices.end() && &*m_slots[it->second] == element)
+	{
+		m_slots[it->second].reset();
+		m_slotIndices.erase(it);
+		m_sortedElements.reset();
+	}
+}
+
+template <typename T>
+void Graph::ElementPool<T>::clear()
+{
+	m_slotIndices.clear();
+	m_slots.clear();
+	m_createdInIdOrder = true;
+	m_sortedElements.reset();
+}
+
+template <typename T>
+T* Graph::ElementPool<T>::get(Id id) const
+{
+	auto it = m_slotIndices.find(id);
+	if (it != m_slotIndices.end())
+	{
+		return const_cast<T*>(&*m_slots[it->second]);
+	}
+	return nullptr;
+}
+
+template <typename T>
+size_t Graph::ElementPool<T>::size() const
+{
+	return m_slotIndices.size();
+}
+
+template <typename T>
+void Graph::ElementPool<T>::forEach(const std::function<void(T*)>& func) const
+{
+	if (m_createdInIdOrder)
+	{
+		// indices instead of iterators, because creating elements invalidates deque iterators
+		for (size_t i = 0; i < m_slots.size(); i++)
+		{
+			if (m_slots[i])
+			{
+				func(const_cast<T*>(&*m_slots[i]));
+			}
+		}
+		return;
+	}
+
+	if (!m_sortedElements)
+	{
+		std::vector<T*> elements;
+		elements.reserve(m_slotIndices.size());
+		for (const std::optional<T>& slot: m_slots)
+		{
+			if (slot)
+			{
+				elements.push_back(const_cast<T*>(&*slot));
+			}
+		}
+
+		std::sort(elements.begin(), elements.end(), [](const T* a, const T* b) {
+			return a->getId() < b->getId();
+		});
+
+		m_sortedElements = std::make_shared<const std::vector<T*>>(std::move(elements));
+	}
+
+	const std::shared_ptr<const std::vector<T*>> elements = m_sortedElements;
+	for (T* element: *elements)
+	{
+		func(element);
+	}
+}
+
+template <typename T>
+T* Graph::ElementPool<T>::find(const std::function<bool(T*)>& func) const
+{
+	T* result = nullptr;
+	forEach([&result, &func](T* element) {
+		if (!result && func(element))
+		{
+			result = element;
+		}
+	});
+	return result;
+}
+
 #endif	  // GRAPH_H
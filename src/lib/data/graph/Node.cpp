@@ -12,22 +12,38 @@
 Node::Node(Id id, NodeType type, NameHierarchy nameHierarchy, DefinitionKind definitionKind)
 	: Token(id)
 	, m_type(type)
-	, m_nameHierarchy(std::move(nameHierarchy))
+	, m_nameHierarchy(new NameHierarchy(std::move(nameHierarchy)))
+	, m_definitionKind(definitionKind)
+{
+}
+
+Node::Node(Id id, NodeType type, const std::wstring& serializedName, DefinitionKind definitionKind)
+	: Token(id)
+	, m_type(type)
+	, m_serializedName(utility::encodeToUtf8(serializedName))
+	, m_nameHierarchy(nullptr)
 	, m_definitionKind(definitionKind)
-	 
 {
 }
 
 Node::Node(const Node& other)
 	: Token(other)
 	, m_type(other.m_type)
-	, m_nameHierarchy(other.m_nameHierarchy)
+	, m_serializedName(other.m_serializedName)
+	, m_nameHierarchy(nullptr)
 	, m_definitionKind(other.m_definitionKind)
 	, m_childCount(other.m_childCount)
 {
+	if (const NameHierarchy* nameHierarchy = other.m_nameHierarchy.load(std::memory_order_acquire))
+	{
+		m_nameHierarchy = new NameHierarchy(*nameHierarchy);
+	}
 }
 
-Node::~Node() = default;
+Node::~Node()
+{
+	delete m_nameHierarchy.load();
+}
 
 NodeType Node::getType() const
 {
@@ -53,17 +69,32 @@ bool Node::isType(NodeKindMask mask) const
 
 std::wstring Node::getName() const
 {
-	return m_nameHierarchy.getRawName();
+	return getNameHierarchy().getRawName();
 }
 
 std::wstring Node::getFullName() const
 {
-	return m_nameHierarchy.getQualifiedName();
+	return getNameHierarchy().getQualifiedName();
 }
 
 const NameHierarchy& Node::getNameHierarchy() const
 {
-	return m_nameHierarchy;
+	NameHierarchy* nameHierarchy = m_nameHierarchy.load(std::memory_order_acquire);
+	if (!nameHierarchy)
+	{
+		// graphs may be read from several threads, the first one to finish keeps its result
+		NameHierarchy* deserialized = new NameHierarchy(deserializeNameHierarchy());
+		if (m_nameHierarchy.compare_exchange_strong(
+				nameHierarchy, deserialized, std::memory_order_acq_rel))
+		{
+			nameHierarchy = deserialized;
+		}
+		else
+		{
+			delete deserialized;
+		}
+	}
+	return *nameHierarchy;
 }
 
 bool Node::isDefined() const
@@ -278,6 +309,11 @@ std::wstring Node::getAsString() const
 	return str.str();
 }
 
+NameHierarchy Node::deserializeNameHierarchy() const
+{
+	return NameHierarchy::deserialize(utility::decodeFromUtf8(m_serializedName));
+}
+
 std::wostream& operator<<(std::wostream& ostream, const Node& node)
 {
 	ostream << node.getAsString();
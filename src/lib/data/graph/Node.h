@@ -2,6 +2,7 @@
 #define NODE_H
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <string>
@@ -16,6 +17,11 @@ class Node: public Token
 {
 public:
 	Node(Id id, NodeType type, NameHierarchy nameHierarchy, DefinitionKind definitionKind);
+
+	// The name hierarchy is only deserialized once it is requested. Most nodes of large graphs
+	// never need more than their name.
+	Node(Id id, NodeType type, const std::wstring& serializedName, DefinitionKind definitionKind);
+
 	Node(const Node& other);
 	~Node() override;
 
@@ -65,10 +71,13 @@ public:
 private:
 	void operator=(const Node&);
 
+	NameHierarchy deserializeNameHierarchy() const;
+
 	std::map<Id, Edge*> m_edges;
 
 	NodeType m_type;
-	const NameHierarchy m_nameHierarchy;
+	const std::string m_serializedName;	   // utf-8, empty if created with a name hierarchy
+	mutable std::atomic<NameHierarchy*> m_nameHierarchy;
 	DefinitionKind m_definitionKind;
 
 	size_t m_childCount = 0;
@@ -8,6 +8,7 @@
 #include "IndexerStateInfo.h"
 #include "ParserClientImpl.h"
 #include "logging.h"
+#include "tracing.h"
 
 template <typename T>
 class Indexer: public IndexerBase
@@ -49,6 +50,8 @@ void Indexer<T>::interrupt()
 template <typename T>
 std::shared_ptr<IntermediateStorage> Indexer<T>::index(std::shared_ptr<IndexerCommand> indexerCommand)
 {
+	TRACE("index file");
+
 	std::shared_ptr<T> castCommand = std::dynamic_pointer_cast<T>(indexerCommand);
 	if (!castCommand)
 	{
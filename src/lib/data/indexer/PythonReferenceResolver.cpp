@@ -0,0 +1,394 @@
+#include "PythonReferenceResolver.h"
+
+#include <algorithm>
+#include <set>
+
+#include "Edge.h"
+#include "ElementComponentKind.h"
+#include "FilePath.h"
+#include "NameHierarchy.h"
+#include "NodeKind.h"
+#include "PersistentStorage.h"
+#include "SourceLocation.h"
+#include "SourceLocationCollection.h"
+#include "SourceLocationFile.h"
+#include "StorageElementComponent.h"
+#include "StorageOccurrence.h"
+#include "TextAccess.h"
+#include "ThreadPool.h"
+#include "logging.h"
+#include "tracing.h"
+#include "utility.h"
+#include "utilityString.h"
+
+namespace
+{
+// same characters as '\s' in the regular expressions this scanner replaces
+bool isWhitespace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+}	 // namespace
+
+std::string PythonReferenceResolver::getAccessedName(const std::string& linePrefix)
+{
+	if (linePrefix.empty() || linePrefix.back() != '.')
+	{
+		return "";
+	}
+
+	const size_t end = linePrefix.size() - 1;
+
+	static const std::string superCall = "super()";
+	if (end > superCall.size() &&
+		linePrefix.compare(end - superCall.size(), superCall.size(), superCall) == 0 &&
+		isWhitespace(linePrefix[end - superCall.size() - 1]))
+	{
+		return superCall;
+	}
+
+	size_t start = end;
+	while (start > 0)
+	{
+		const char c = linePrefix[start - 1];
+		if (isWhitespace(c) || c == '.' || c == '(' || c == ')')
+		{
+			break;
+		}
+		start--;
+	}
+
+	if (start == end || start == 0 || !isWhitespace(linePrefix[start - 1]))
+	{
+		return "";
+	}
+	return linePrefix.substr(start, end - start);
+}
+
+PythonReferenceResolver::PythonReferenceResolver(PersistentStorage& storage): m_storage(storage)
+{
+}
+
+bool PythonReferenceResolver::resolve()
+{
+	TRACE();
+
+	// FIXME: this doesn't catch unsolved qualifiers -> convert Qualifier location type to qualifier
+	// edge
+	std::shared_ptr<SourceLocationCollection> locationCollection =
+		m_storage.getSourceLocationsOfType(LOCATION_UNSOLVED);
+
+	std::vector<std::shared_ptr<SourceLocationFile>> files;
+	locationCollection->forEachSourceLocationFile(
+		[&files](std::shared_ptr<SourceLocationFile> file) {
+			if (!file->getFilePath().empty())
+			{
+				files.push_back(file);
+			}
+		});
+
+	m_resolvedEdgeCount = 0;
+	if (files.empty())
+	{
+		return true;
+	}
+
+	m_storage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+
+	buildNodeIndex();
+	fetchUnsolvedEdges(files);
+
+	std::vector<std::shared_ptr<TextAccess>> texts(files.size());
+	{
+		TRACE("load file contents");
+
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			const FilePath& filePath = files[i]->getFilePath();
+			if (!filePath.exists())
+			{
+				LOG_WARNING(L"Skipping post processing for non-existing file: " + filePath.wstr());
+				continue;
+			}
+			texts[i] = m_storage.getFileContent(filePath, false);
+		}
+	}
+
+	std::vector<std::vector<ResolvedEdge>> resolvedEdgesPerFile(files.size());
+	{
+		TRACE("resolve files");
+
+		ThreadPool::getInstance()->parallelFor(
+			files.size(), [this, &files, &texts, &resolvedEdgesPerFile](size_t fileIndex) {
+				if (texts[fileIndex])
+				{
+					resolvedEdgesPerFile[fileIndex] = resolveFile(
+						*files[fileIndex], *texts[fileIndex]);
+				}
+			});
+	}
+
+	std::vector<ResolvedEdge> resolvedEdges;
+	for (std::vector<ResolvedEdge>& fileEdges: resolvedEdgesPerFile)
+	{
+		resolvedEdges.insert(resolvedEdges.end(), fileEdges.begin(), fileEdges.end());
+	}
+
+	m_resolvedEdgeCount = resolvedEdges.size();
+	return store(resolvedEdges);
+}
+
+size_t PythonReferenceResolver::getResolvedEdgeCount() const
+{
+	return m_resolvedEdgeCount;
+}
+
+void PythonReferenceResolver::buildNodeIndex()
+{
+	TRACE();
+
+	const std::vector<StorageNode>& storageNodes = m_storage.getStorageNodes();
+
+	m_nodes.clear();
+	m_nodes.resize(storageNodes.size());
+
+	const size_t chunkSize = 1024;
+	ThreadPool::getInstance()->parallelFor(
+		(storageNodes.size() + chunkSize - 1) / chunkSize, [this, &storageNodes](size_t chunkIndex) {
+			const size_t end = std::min(storageNodes.size(), (chunkIndex + 1) * chunkSize);
+			for (size_t i = chunkIndex * chunkSize; i < end; i++)
+			{
+				const StorageNode& storageNode = storageNodes[i];
+				const NameHierarchy nameHierarchy = NameHierarchy::deserialize(
+					storageNode.serializedName);
+
+				Node& node = m_nodes[i];
+				node.id = storageNode.id;
+				node.type = storageNode.type;
+				if (nameHierarchy.size() > 0)
+				{
+					node.name = nameHierarchy.back().getName();
+				}
+				if (nameHierarchy.size() > 1)
+				{
+					node.parentName = nameHierarchy[nameHierarchy.size() - 2].getName();
+					node.hasParent = true;
+				}
+			}
+		});
+
+	m_nodeIndicesByName.clear();
+	m_nodeIndicesById.clear();
+	m_nodeIndicesById.reserve(m_nodes.size());
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		m_nodeIndicesByName[m_nodes[i].name].push_back(i);
+		m_nodeIndicesById.emplace(m_nodes[i].id, i);
+	}
+}
+
+void PythonReferenceResolver::fetchUnsolvedEdges(
+	const std::vector<std::shared_ptr<SourceLocationFile>>& files)
+{
+	TRACE();
+
+	std::set<Id> tokenIds;
+	for (const std::shared_ptr<SourceLocationFile>& file: files)
+	{
+		file->forEachStartSourceLocation([&tokenIds](const SourceLocation* startLocation) {
+			const auto ids = startLocation->getTokenIds();
+			tokenIds.insert(ids.begin(), ids.end());
+		});
+	}
+
+	m_edges.clear();
+	for (const StorageEdge& edge: m_storage.getEdgesByIds(utility::toVector(tokenIds)))
+	{
+		m_edges.emplace(edge.id, edge);
+	}
+}
+
+std::vector<PythonReferenceResolver::ResolvedEdge> PythonReferenceResolver::resolveFile(
+	const SourceLocationFile& file, const TextAccess& text) const
+{
+	std::map<std::wstring, std::vector<std::wstring>> childToParentNames;
+	std::vector<ResolvedEdge> resolvedEdges;
+
+	file.forEachStartSourceLocation(
+		[this, &text, &childToParentNames, &resolvedEdges](const SourceLocation* startLocation) {
+			if (startLocation)
+			{
+				resolveLocation(startLocation, text, childToParentNames, resolvedEdges);
+			}
+		});
+
+	return resolvedEdges;
+}
+
+void PythonReferenceResolver::resolveLocation(
+	const SourceLocation* startLocation,
+	const TextAccess& text,
+	std::map<std::wstring, std::vector<std::wstring>>& childToParentNames,
+	std::vector<ResolvedEdge>& resolvedEdges) const
+{
+	const SourceLocation* endLocation = startLocation->getOtherLocation();
+	if (!endLocation)
+	{
+		return;
+	}
+
+	const std::string line = text.getLine(static_cast<unsigned int>(startLocation->getLineNumber()));
+	const size_t startColumn = startLocation->getColumnNumber();
+	const size_t endColumn = endLocation->getColumnNumber();
+	if (startColumn == 0 || endColumn < startColumn || line.size() < startColumn - 1)
+	{
+		return;
+	}
+
+	const std::wstring token = utility::decodeFromUtf8(
+		line.substr(startColumn - 1, endColumn - startColumn + 1));
+
+	auto candidatesIt = m_nodeIndicesByName.find(token);
+	if (candidatesIt == m_nodeIndicesByName.end())
+	{
+		return;
+	}
+
+	std::wstring contextName;
+	const std::string accessedName = getAccessedName(line.substr(0, startColumn - 1));
+	if (accessedName == "super()")
+	{
+		for (const Id tokenId: startLocation->getTokenIds())
+		{
+			const StorageEdge* edge = getEdge(tokenId);
+			const Node* sourceNode = edge ? getNode(edge->sourceNodeId) : nullptr;
+			if (sourceNode && sourceNode->hasParent)
+			{
+				auto it = childToParentNames.find(sourceNode->parentName);
+				if (it != childToParentNames.end() && !it->second.empty())
+				{
+					contextName = it->second.front();
+				}
+			}
+		}
+	}
+	else if (!accessedName.empty())
+	{
+		contextName = utility::decodeFromUtf8(accessedName);
+	}
+
+	std::vector<size_t> contextCandidates;
+	if (!contextName.empty())
+	{
+		for (const size_t candidateIndex: candidatesIt->second)
+		{
+			const Node& candidate = m_nodes[candidateIndex];
+			if (candidate.hasParent && candidate.parentName == contextName)
+			{
+				contextCandidates.push_back(candidateIndex);
+			}
+		}
+	}
+
+	const std::vector<size_t>& targetIndices = contextCandidates.empty() ? candidatesIt->second
+																		  : contextCandidates;
+	for (const size_t targetIndex: targetIndices)
+	{
+		const Node& target = m_nodes[targetIndex];
+		for (const Id tokenId: startLocation->getTokenIds())
+		{
+			const StorageEdge* edge = getEdge(tokenId);
+			if (!edge)	  // for node elements there is no edge
+			{
+				continue;
+			}
+
+			if (Edge::intToType(edge->type) == Edge::EDGE_INHERITANCE)
+			{
+				if (intToNodeKind(target.type) != NODE_CLASS)
+				{
+					continue;
+				}
+
+				if (const Node* child = getNode(edge->sourceNodeId))
+				{
+					childToParentNames[child->name].push_back(target.name);
+				}
+			}
+
+			resolvedEdges.push_back(
+				{StorageEdgeData(edge->type, edge->sourceNodeId, target.id),
+				 startLocation->getLocationId(),
+				 edge->id});
+		}
+	}
+}
+
+const PythonReferenceResolver::Node* PythonReferenceResolver::getNode(Id nodeId) const
+{
+	auto it = m_nodeIndicesById.find(nodeId);
+	if (it != m_nodeIndicesById.end())
+	{
+		return &m_nodes[it->second];
+	}
+	return nullptr;
+}
+
+const StorageEdge* PythonReferenceResolver::getEdge(Id edgeId) const
+{
+	auto it = m_edges.find(edgeId);
+	if (it != m_edges.end())
+	{
+		return &it->second;
+	}
+	return nullptr;
+}
+
+bool PythonReferenceResolver::store(const std::vector<ResolvedEdge>& resolvedEdges)
+{
+	TRACE();
+
+	m_storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+	m_storage.startInjection();
+
+	std::vector<StorageEdge> edges;
+	edges.reserve(resolvedEdges.size());
+	for (const ResolvedEdge& resolvedEdge: resolvedEdges)
+	{
+		edges.emplace_back(0, resolvedEdge.edgeData);
+	}
+	const std::vector<Id> ambiguousEdgeIds = m_storage.addEdges(edges);
+
+	if (ambiguousEdgeIds.size() != resolvedEdges.size())
+	{
+		m_storage.rollbackInjection();
+		return false;
+	}
+
+	std::set<Id> componentEdgeIds;
+	std::vector<StorageElementComponent> components;
+	std::vector<StorageOccurrence> occurrences;
+	std::vector<StorageOccurrence> unsolvedOccurrences;
+	std::set<Id> unsolvedEdgeIds;
+	for (size_t i = 0; i < ambiguousEdgeIds.size(); i++)
+	{
+		if (componentEdgeIds.insert(ambiguousEdgeIds[i]).second)
+		{
+			components.emplace_back(
+				ambiguousEdgeIds[i], elementComponentKindToInt(ElementComponentKind::IS_AMBIGUOUS), L"");
+		}
+		occurrences.emplace_back(ambiguousEdgeIds[i], resolvedEdges[i].sourceLocationId);
+		unsolvedOccurrences.emplace_back(
+			resolvedEdges[i].unsolvedEdgeId, resolvedEdges[i].sourceLocationId);
+		unsolvedEdgeIds.insert(resolvedEdges[i].unsolvedEdgeId);
+	}
+	m_storage.addElementComponents(components);
+	m_storage.addOccurrences(occurrences);
+
+	m_storage.setMode(SqliteIndexStorage::STORAGE_MODE_CLEAR);
+	m_storage.removeOccurrences(unsolvedOccurrences);
+	m_storage.removeElementsWithoutOccurrences(utility::toVector(unsolvedEdgeIds));
+
+	m_storage.finishInjection();
+	return true;
+}
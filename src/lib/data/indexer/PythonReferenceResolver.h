@@ -0,0 +1,80 @@
+#ifndef PYTHON_REFERENCE_RESOLVER_H
+#define PYTHON_REFERENCE_RESOLVER_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "StorageEdge.h"
+#include "types.h"
+
+class PersistentStorage;
+class SourceLocation;
+class SourceLocationFile;
+class TextAccess;
+
+// Resolves the references the Python indexer left unsolved to all nodes with the referenced name
+// and stores them as ambiguous edges in place of the unsolved ones. An access like 'A.' or
+// 'super().' in front of a reference narrows the candidates down to the members of that class.
+// Files are resolved in parallel, the storage is only read before and written after that.
+class PythonReferenceResolver
+{
+public:
+	// Returns the expression accessed by the member access at the end of 'linePrefix', e.g. 'A' for
+	// '	x = A.' or 'super()' for '	super().'. Returns an empty string if the prefix does not end
+	// with the access of a plain name.
+	static std::string getAccessedName(const std::string& linePrefix);
+
+	PythonReferenceResolver(PersistentStorage& storage);
+
+	// returns false if storing the resolved references failed and all changes were rolled back
+	bool resolve();
+
+	size_t getResolvedEdgeCount() const;
+
+private:
+	struct Node
+	{
+		Id id;
+		int type = 0;
+		std::wstring name;
+		std::wstring parentName;
+		bool hasParent = false;
+	};
+
+	struct ResolvedEdge
+	{
+		StorageEdgeData edgeData;
+		Id sourceLocationId;
+		Id unsolvedEdgeId;
+	};
+
+	void buildNodeIndex();
+	void fetchUnsolvedEdges(const std::vector<std::shared_ptr<SourceLocationFile>>& files);
+
+	std::vector<ResolvedEdge> resolveFile(
+		const SourceLocationFile& file, const TextAccess& text) const;
+	void resolveLocation(
+		const SourceLocation* startLocation,
+		const TextAccess& text,
+		std::map<std::wstring, std::vector<std::wstring>>& childToParentNames,
+		std::vector<ResolvedEdge>& resolvedEdges) const;
+
+	const Node* getNode(Id nodeId) const;
+	const StorageEdge* getEdge(Id edgeId) const;
+
+	bool store(const std::vector<ResolvedEdge>& resolvedEdges);
+
+	PersistentStorage& m_storage;
+
+	std::vector<Node> m_nodes;
+	std::unordered_map<std::wstring, std::vector<size_t>> m_nodeIndicesByName;
+	std::unordered_map<Id, size_t> m_nodeIndicesById;
+	std::unordered_map<Id, StorageEdge> m_edges;
+
+	size_t m_resolvedEdgeCount = 0;
+};
+
+#endif	  // PYTHON_REFERENCE_RESOLVER_H
@@ -9,12 +9,15 @@
 #include "MessageStatus.h"
 #include "ParserClientImpl.h"
 #include "StorageProvider.h"
+#include "ThreadPool.h"
 #include "TimeStamp.h"
 #include "UserPaths.h"
 #include "utilityApp.h"
 
 using namespace utility;
 
+const int TaskBuildIndex::s_maxQueuedStorageCount = 10;
+
 TaskBuildIndex::TaskBuildIndex(
 	size_t processCount,
 	std::shared_ptr<StorageProvider> storageProvider,
@@ -46,6 +49,10 @@ void TaskBuildIndex::doEnter(std::shared_ptr<Blackboard> blackboard)
 		logFilePath = dynamic_cast<FileLogger*>(logger)->getLogFilePath().wstr();
 	}
 
+	// indexer loops run until the command queue is drained, so they get a pool of their own instead
+	// of blocking the workers of the shared one
+	m_indexerThreadPool = new ThreadPool(m_processCount);
+
 	// start indexer processes
 	for (unsigned int i = 0; i < m_processCount; i++)
 	{
@@ -61,13 +68,13 @@ void TaskBuildIndex::doEnter(std::shared_ptr<Blackboard> blackboard)
 
 		if (m_multiProcessIndexing)
 		{
-			m_processThreads.push_back(
-				new std::thread(&TaskBuildIndex::runIndexerProcess, this, processId, logFilePath));
+			m_indexerFutures.push_back(m_indexerThreadPool->submit(
+				[this, processId, logFilePath]() { runIndexerProcess(processId, logFilePath); }));
 		}
 		else
 		{
-			m_processThreads.push_back(
-				new std::thread(&TaskBuildIndex::runIndexerThread, this, processId));
+			m_indexerFutures.push_back(
+				m_indexerThreadPool->submit([this, processId]() { runIndexerThread(processId); }));
 		}
 	}
 
@@ -115,12 +122,14 @@ Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
 
 void TaskBuildIndex::doExit(std::shared_ptr<Blackboard> blackboard)
 {
-	for (auto *processThread: m_processThreads)
+	for (std::future<void>& indexerFuture: m_indexerFutures)
 	{
-		processThread->join();
-		delete processThread;
+		indexerFuture.wait();
 	}
-	m_processThreads.clear();
+	m_indexerFutures.clear();
+
+	delete m_indexerThreadPool;
+	m_indexerThreadPool = nullptr;
 
 	if (!m_interrupted)
 	{
@@ -220,6 +229,14 @@ void TaskBuildIndex::runIndexerThread(int processId)
 	do
 	{
 		InterprocessIndexer indexer(m_appUUID, processId);
+		indexer.setIntermediateStorageConsumer([this](std::shared_ptr<IntermediateStorage> storage) {
+			while (m_storageProvider->getStorageCount() > s_maxQueuedStorageCount && !m_interrupted)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			}
+			m_storageProvider->insert(storage);
+			m_insertedStorageCount++;
+		});
 		indexer.work();	   // this will only return if there are no indexer commands left in the queue
 		if (!m_interrupted)
 		{
@@ -240,7 +257,7 @@ bool TaskBuildIndex::fetchIntermediateStorages(std::shared_ptr<Blackboard> black
 	int poppedStorageCount = 0;
 
 	int providerStorageCount = m_storageProvider->getStorageCount();
-	if (providerStorageCount > 10)
+	if (providerStorageCount > s_maxQueuedStorageCount)
 	{
 		LOG_INFO_STREAM(<< "waiting, too many storages queued: " << providerStorageCount);
 
@@ -249,6 +266,9 @@ bool TaskBuildIndex::fetchIntermediateStorages(std::shared_ptr<Blackboard> black
 		return true;
 	}
 
+	// indexer threads of this process insert their storages directly
+	poppedStorageCount += m_insertedStorageCount.exchange(0);
+
 	TimeStamp t = TimeStamp::now();
 	do
 	{
@@ -1,7 +1,8 @@
 #ifndef TASK_BUILD_INDEX_H
 #define TASK_BUILD_INDEX_H
 
-#include <thread>
+#include <atomic>
+#include <future>
 
 #include "MessageIndexingInterrupted.h"
 #include "MessageListener.h"
@@ -13,6 +14,7 @@
 
 class DialogView;
 class StorageProvider;
+class ThreadPool;
 class IndexerCommandList;
 
 class TaskBuildIndex
@@ -43,6 +45,7 @@ protected:
 		std::shared_ptr<Blackboard> blackboard, const std::vector<FilePath>& sourcePaths);
 
 	static const std::wstring s_processName;
+	static const int s_maxQueuedStorageCount;
 
 	std::shared_ptr<IndexerCommandList> m_indexerCommandList;
 	std::shared_ptr<StorageProvider> m_storageProvider;
@@ -56,13 +59,17 @@ protected:
 	bool m_interrupted = false;
 	size_t m_indexingFileCount = 0;
 
-	// store as plain pointers to avoid deallocation issues when closing app during indexing
-	std::vector<std::thread*> m_processThreads;
+	// store as plain pointer to avoid deallocation issues when closing app during indexing
+	ThreadPool* m_indexerThreadPool = nullptr;
+	std::vector<std::future<void>> m_indexerFutures;
 	std::vector<std::shared_ptr<InterprocessIntermediateStorageManager>>
 		m_interprocessIntermediateStorageManagers;
 
 	size_t m_runningThreadCount = 0;
 	std::mutex m_runningThreadCountMutex;
+
+	// storages that indexer threads inserted into the storage provider since the last fetch
+	std::atomic<int> m_insertedStorageCount = 0;
 };
 
 #endif	  // TASK_PARSE_H
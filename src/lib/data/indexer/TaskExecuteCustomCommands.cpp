@@ -3,7 +3,6 @@
 #include "ApplicationSettings.h"
 #include "Blackboard.h"
 #include "DialogView.h"
-#include "ElementComponentKind.h"
 #include "FileSystem.h"
 #include "IndexerCommandCustom.h"
 #include "IndexerCommandProvider.h"
@@ -13,9 +12,7 @@
 #include "MessageShowStatus.h"
 #include "MessageStatus.h"
 #include "PersistentStorage.h"
-#include "SourceLocationCollection.h"
-#include "SourceLocationFile.h"
-#include "TextAccess.h"
+#include "PythonReferenceResolver.h"
 #include "utility.h"
 #include "utilityApp.h"
 #include "utilityFile.h"
@@ -25,222 +22,13 @@ using namespace utility;
 
 void TaskExecuteCustomCommands::runPythonPostProcessing(PersistentStorage& storage)
 {
-	std::vector<Id> unsolvedLocationIds;
-	for (const StorageSourceLocation location: storage.getStorageSourceLocations())
+	if (PythonReferenceResolver(storage).resolve())
 	{
-		if (intToLocationType(location.type) ==
-			LOCATION_UNSOLVED)	  // FIXME: this doesn't catch unsolved qualifiers -> convert
-								  // Qualifier location type to qualifier edge
-		{
-			unsolvedLocationIds.push_back(location.id);
-		}
-	}
-
-	std::shared_ptr<SourceLocationCollection> locationCollection =
-		storage.getSourceLocationsForLocationIds(unsolvedLocationIds);
-
-	std::map<std::wstring, std::vector<StorageNode>> nodeNameToStorageNodes;
-	if (locationCollection->getSourceLocationCount() > 0)
-	{
-		for (const StorageNode& node: storage.getStorageNodes())
-		{
-			nodeNameToStorageNodes[NameHierarchy::deserialize(node.serializedName).back().getName()]
-				.push_back(node);
-		}
-	}
-
-	struct DataToInsert
-	{
-		StorageEdgeData edgeData;
-		Id sourceLocationId;
-	};
-
-	storage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
-
-	std::vector<DataToInsert> dataToInsert;
-	std::vector<StorageOccurrence> occurrencesToDelete;
-	locationCollection->forEachSourceLocationFile([&nodeNameToStorageNodes,
-												   &storage,
-												   &dataToInsert,
-												   &occurrencesToDelete](
-													  std::shared_ptr<SourceLocationFile> locationFile) {
-		const FilePath filePath = locationFile->getFilePath();
-		if (filePath.empty())
-		{
-			return;
-		}
-		if (!filePath.exists())
-		{
-			LOG_WARNING(L"Skipping post processing for non-existing file: " + filePath.wstr());
-			return;
-		}
-
-		std::shared_ptr<TextAccess> textAccess = storage.getFileContent(filePath, false);
-		if (textAccess)
-		{
-			std::map<std::wstring, std::vector<std::wstring>> childToParentNodesMap;
-
-			locationFile->forEachStartSourceLocation([textAccess,
-													  &childToParentNodesMap,
-													  &nodeNameToStorageNodes,
-													  &storage,
-													  &dataToInsert,
-													  &occurrencesToDelete](
-														 const SourceLocation* startLoc) {
-				if (!startLoc)
-				{
-					return;
-				}
-				const SourceLocation* endLoc = startLoc->getOtherLocation();
-				if (!endLoc)
-				{
-					return;
-				}
-
-				const std::string tokenLine = textAccess->getLine(
-					static_cast<unsigned int>(startLoc->getLineNumber()));
-				const std::wstring token = utility::decodeFromUtf8(tokenLine.substr(
-					startLoc->getColumnNumber() - 1,
-					endLoc->getColumnNumber() - startLoc->getColumnNumber() + 1));
-
-				std::string prefixString = tokenLine.substr(0, startLoc->getColumnNumber() - 1);
-
-				std::wstring definitionContextName;
-				{
-					std::regex regex("\\s([^\\.()\\s]+)\\.$");
-					std::smatch matches;
-					std::regex_search(prefixString, matches, regex);
-					if (!matches.empty())
-					{
-						definitionContextName = utility::decodeFromUtf8(matches.str(1));
-					}
-				}
-				{
-					std::regex regex("\\s(super\\(\\))\\.$");
-					std::smatch matches;
-					std::regex_search(prefixString, matches, regex);
-					if (!matches.empty())
-					{
-						for (const Id elementId: startLoc->getTokenIds())
-						{
-							const StorageEdge edge = storage.getEdgeById(elementId);
-							if (edge.id != 0)
-							{
-								NameHierarchy nameHierarchy = storage.getNameHierarchyForNodeId(
-									edge.sourceNodeId);
-								if (nameHierarchy.size() > 1)
-								{
-									std::wstring name = nameHierarchy
-															.getRange(0, nameHierarchy.size() - 1)
-															.back()
-															.getName();
-
-									if (!childToParentNodesMap[name].empty())
-									{
-										definitionContextName = childToParentNodesMap[name].front();
-									}
-								}
-							}
-						}
-					}
-				}
-				{
-					std::vector<StorageNode> targetNodes;
-					if (!definitionContextName.empty())
-					{
-						for (const StorageNode& node: nodeNameToStorageNodes[token])
-						{
-							NameHierarchy nameHierarchy = NameHierarchy::deserialize(
-								node.serializedName);
-							if (nameHierarchy.size() > 1 &&
-								nameHierarchy.getRange(0, nameHierarchy.size() - 1).back().getName() ==
-									definitionContextName)
-							{
-								targetNodes.push_back(node);
-							}
-						}
-					}
-					if (targetNodes.empty())
-					{
-						targetNodes = nodeNameToStorageNodes[token];
-					}
-
-					for (const StorageNode& targetNode: targetNodes)
-					{
-						for (const Id elementId: startLoc->getTokenIds())
-						{
-							const StorageEdge edge = storage.getEdgeById(elementId);
-							if (edge.id != 0)	 // for node elements this condition will fail
-							{
-								if (Edge::intToType(edge.type) == Edge::EDGE_INHERITANCE)
-								{
-									if (intToNodeKind(targetNode.type) == NODE_CLASS)
-									{
-										const NameHierarchy chileName =
-											storage.getNameHierarchyForNodeId(edge.sourceNodeId);
-										const NameHierarchy parentName = NameHierarchy::deserialize(
-											targetNode.serializedName);
-										childToParentNodesMap[chileName.back().getName()].push_back(
-											parentName.back().getName());
-									}
-									else
-									{
-										continue;
-									}
-								}
-
-								dataToInsert.push_back(
-									{StorageEdgeData(edge.type, edge.sourceNodeId, targetNode.id),
-									 startLoc->getLocationId()});
-								occurrencesToDelete.push_back(
-									StorageOccurrence(edge.id, startLoc->getLocationId()));
-							}
-						}
-					}
-				}
-			});
-		}
-	});
-
-	storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
-
-	storage.startInjection();
-
-	std::vector<StorageEdge> edgesToInsert;
-	for (const DataToInsert& data: dataToInsert)
-	{
-		edgesToInsert.push_back(StorageEdge(0, data.edgeData));
-	}
-	const std::vector<Id> ambiguousEdgeIds = storage.addEdges(edgesToInsert);
-
-	if (ambiguousEdgeIds.size() == dataToInsert.size())
-	{
-		for (size_t i = 0; i < ambiguousEdgeIds.size(); i++)
-		{
-			storage.addElementComponent(StorageElementComponent(
-				ambiguousEdgeIds[i],
-				elementComponentKindToInt(ElementComponentKind::IS_AMBIGUOUS),
-				L""));
-			storage.addOccurrence(
-				StorageOccurrence(ambiguousEdgeIds[i], dataToInsert[i].sourceLocationId));
-		}
-		storage.setMode(SqliteIndexStorage::STORAGE_MODE_CLEAR);
-
-		storage.removeOccurrences(occurrencesToDelete);
-		std::set<Id> edgeIds;
-		for (const StorageOccurrence& occurrence: occurrencesToDelete)
-		{
-			edgeIds.insert(occurrence.elementId);
-		}
-		storage.removeElementsWithoutOccurrences(utility::toVector(edgeIds));
-
-		storage.finishInjection();
 		LOG_INFO("Finished Python post processing.");
 	}
 	else
 	{
 		LOG_ERROR("Error occurred while running Python post processing. Rolling back all changes.");
-		storage.rollbackInjection();
 	}
 }
 
@@ -342,16 +130,17 @@ Task::TaskState TaskExecuteCustomCommands::doUpdate(std::shared_ptr<Blackboard>
 		PersistentStorage targetStorage(m_targetDatabaseFilePath, FilePath());
 		targetStorage.setup();
 		targetStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
-		targetStorage.buildCaches();
 		for (const FilePath& sourceDatabaseFilePath: m_sourceDatabaseFilePaths)
 		{
+			if (targetStorage.injectDatabase(sourceDatabaseFilePath))
+			{
+				FileSystem::remove(sourceDatabaseFilePath);
+			}
+			else
 			{
-				PersistentStorage sourceStorage(sourceDatabaseFilePath, FilePath());
-				sourceStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
-				sourceStorage.buildCaches();
-				targetStorage.inject(&sourceStorage);
+				LOG_ERROR(
+					L"Failed to inject database, keeping it at: " + sourceDatabaseFilePath.wstr());
 			}
-			FileSystem::remove(sourceDatabaseFilePath);
 		}
 
 		if (m_hasPythonCommands &&
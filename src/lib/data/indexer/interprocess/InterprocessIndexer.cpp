@@ -16,6 +16,12 @@ InterprocessIndexer::InterprocessIndexer(const std::string& uuid, Id processId)
 {
 }
 
+void InterprocessIndexer::setIntermediateStorageConsumer(
+	std::function<void(std::shared_ptr<IntermediateStorage>)> intermediateStorageConsumer)
+{
+	m_intermediateStorageConsumer = intermediateStorageConsumer;
+}
+
 void InterprocessIndexer::work()
 {
 	bool updaterThreadRunning = true;
@@ -63,7 +69,8 @@ void InterprocessIndexer::work()
 				<< m_processId << " indexer commands left: "
 				<< m_interprocessIndexerCommandManager.indexerCommandCount());
 
-			while (updaterThreadRunning)
+			// indexers with a consumer don't use the shared memory
+			while (updaterThreadRunning && !m_intermediateStorageConsumer)
 			{
 				const size_t storageCount =
 					m_interprocessIntermediateStorageManager.getIntermediateStorageCount();
@@ -89,7 +96,12 @@ void InterprocessIndexer::work()
 			LOG_INFO_STREAM(<< m_processId << " starting to index current file");
 			std::shared_ptr<IntermediateStorage> result = indexer->index(indexerCommand);
 
-			if (result)
+			if (result && m_intermediateStorageConsumer)
+			{
+				LOG_INFO_STREAM(<< m_processId << " passing index to storage consumer");
+				m_intermediateStorageConsumer(result);
+			}
+			else if (result)
 			{
 				LOG_INFO_STREAM(<< m_processId << " pushing index to shared memory");
 				m_interprocessIntermediateStorageManager.pushIntermediateStorage(result);
@@ -1,6 +1,8 @@
 #ifndef INTERPROCESS_INDEXER_H
 #define INTERPROCESS_INDEXER_H
 
+#include <functional>
+
 #include "InterprocessIndexerCommandManager.h"
 #include "InterprocessIndexingStatusManager.h"
 #include "InterprocessIntermediateStorageManager.h"
@@ -10,6 +12,11 @@ class InterprocessIndexer
 public:
 	InterprocessIndexer(const std::string& uuid, Id processId);
 
+	// Indexers running as threads of the app process can hand their results over directly instead
+	// of copying them through shared memory. The consumer is responsible for throttling.
+	void setIntermediateStorageConsumer(
+		std::function<void(std::shared_ptr<IntermediateStorage>)> intermediateStorageConsumer);
+
 	void work();
 
 private:
@@ -17,6 +24,8 @@ private:
 	InterprocessIndexingStatusManager m_interprocessIndexingStatusManager;
 	InterprocessIntermediateStorageManager m_interprocessIntermediateStorageManager;
 
+	std::function<void(std::shared_ptr<IntermediateStorage>)> m_intermediateStorageConsumer;
+
 	const std::string m_uuid;
 	const Id m_processId;
 };
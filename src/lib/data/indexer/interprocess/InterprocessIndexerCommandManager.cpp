@@ -1,12 +1,43 @@
 #include "InterprocessIndexerCommandManager.h"
 
+#include "language_packages.h"
+
+#if BUILD_CXX_LANGUAGE_PACKAGE
+#	include "IndexerCommandCxx.h"
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+#	include "IndexerCommandJava.h"
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
 #include "IndexerCommand.h"
+#include "SharedIndexerCommandTable.h"
 #include "logging.h"
+#include "utilityString.h"
+
+namespace
+{
+const std::wstring& toWString(const std::wstring& str)
+{
+	return str;
+}
+
+std::wstring toWString(const FilePath& path)
+{
+	return path.wstr();
+}
+
+std::wstring toWString(const FilePathFilter& filter)
+{
+	return filter.wstr();
+}
+}	 // namespace
 
 const char* InterprocessIndexerCommandManager::s_sharedMemoryNamePrefix = "icmd_";
 
 const char* InterprocessIndexerCommandManager::s_indexerCommandsKeyName = "indexer_commands";
 
+const char* InterprocessIndexerCommandManager::s_indexerCommandTableKeyName =
+	"indexer_command_table";
+
 InterprocessIndexerCommandManager::InterprocessIndexerCommandManager(
 	const std::string& instanceUuid, Id processId, bool isOwner)
 	: BaseInterprocessDataManager(
@@ -19,17 +50,61 @@ InterprocessIndexerCommandManager::~InterprocessIndexerCommandManager() = defaul
 void InterprocessIndexerCommandManager::pushIndexerCommands(
 	const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands)
 {
+	SharedMemory::ScopedAccess access(&m_sharedMemory);
+
+	std::vector<SharedIndexerCommand> sharedCommands;
+	size_t newListElementCount = 0;
 	size_t size = 0;
 	{
-		const size_t overestimationMultiplier = 2;
+		SharedMemory::Queue<SharedIndexerCommand>* queue =
+			access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
+				s_indexerCommandsKeyName);
+		SharedIndexerCommandTable* table = access.accessValueWithAllocator<SharedIndexerCommandTable>(
+			s_indexerCommandTableKeyName);
+		if (!queue || !table)
+		{
+			return;
+		}
+
+		if (queue->empty())
+		{
+			// no command refers to the table anymore
+			table->clear();
+		}
+		updateTableGeneration(*table);
+
+		m_tableStringCount = table->getStringCount();
+		m_tableListCount = table->getListCount();
+
+		sharedCommands.reserve(indexerCommands.size());
 		for (const auto& command: indexerCommands)
 		{
-			size += command->getByteSize(sizeof(SharedMemory::String)) + sizeof(SharedIndexerCommand);
+			const SharedIndexerCommand sharedCommand = toShared(command.get());
+			if (sharedCommand.type != SharedIndexerCommand::UNKNOWN)
+			{
+				sharedCommands.push_back(sharedCommand);
+			}
+		}
+
+		for (const std::vector<uint32_t>& list: m_newLists)
+		{
+			newListElementCount += list.size();
 		}
+
+		// growing the tables reallocates them, so their whole size is needed
+		for (const std::string& str: m_newStrings)
+		{
+			size += str.size() + sizeof(SharedMemory::String);
+		}
+		size += (m_tableStringCount + m_newStrings.size()) * sizeof(SharedMemory::String);
+		size += (table->getListElementCount() + newListElementCount) * sizeof(uint32_t);
+		size += (m_tableListCount + m_newLists.size()) * sizeof(uint32_t);
+		size += sharedCommands.size() * sizeof(SharedIndexerCommand);
+
+		const size_t overestimationMultiplier = 2;
 		size *= overestimationMultiplier;
 	}
 
-	SharedMemory::ScopedAccess access(&m_sharedMemory);
 	while (access.getFreeMemorySize() < size)
 	{
 		size_t currentSize = access.getMemorySize();
@@ -45,16 +120,32 @@ void InterprocessIndexerCommandManager::pushIndexerCommands(
 	SharedMemory::Queue<SharedIndexerCommand>* queue =
 		access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(
 			s_indexerCommandsKeyName);
-	if (!queue)
+	SharedIndexerCommandTable* table = access.accessValueWithAllocator<SharedIndexerCommandTable>(
+		s_indexerCommandTableKeyName);
+	if (!queue || !table)
 	{
+		// the new entries never reach the table, so their indices must not be used later on
+		discardNewEntries();
 		return;
 	}
 
-	for (const auto& command: indexerCommands)
+	table->reserve(m_newStrings.size(), m_newLists.size(), newListElementCount);
+
+	for (const std::string& str: m_newStrings)
+	{
+		table->addString(str);
+	}
+	m_newStrings.clear();
+
+	for (const std::vector<uint32_t>& list: m_newLists)
 	{
-		queue->push_back(SharedIndexerCommand(access.getAllocator()));
-		SharedIndexerCommand& sharedCommand = queue->back();
-		sharedCommand.fromLocal(command.get());
+		table->addList(list);
+	}
+	m_newLists.clear();
+
+	for (const SharedIndexerCommand& sharedCommand: sharedCommands)
+	{
+		queue->push_back(sharedCommand);
 	}
 
 	LOG_INFO(access.logString());
@@ -72,7 +163,16 @@ std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::popIndexerCom
 		return nullptr;
 	}
 
-	std::shared_ptr<IndexerCommand> command = SharedIndexerCommand::fromShared(queue->front());
+	SharedIndexerCommandTable* table = access.accessValueWithAllocator<SharedIndexerCommandTable>(
+		s_indexerCommandTableKeyName);
+	if (!table)
+	{
+		return nullptr;
+	}
+
+	updateTableGeneration(*table);
+
+	std::shared_ptr<IndexerCommand> command = fromShared(queue->front(), *table);
 
 	queue->pop_front();
 
@@ -92,6 +192,13 @@ void InterprocessIndexerCommandManager::clearIndexerCommands()
 	}
 
 	queue->clear();
+
+	SharedIndexerCommandTable* table = access.accessValueWithAllocator<SharedIndexerCommandTable>(
+		s_indexerCommandTableKeyName);
+	if (table)
+	{
+		table->clear();
+	}
 }
 
 size_t InterprocessIndexerCommandManager::indexerCommandCount()
@@ -108,3 +215,163 @@ size_t InterprocessIndexerCommandManager::indexerCommandCount()
 
 	return queue->size();
 }
+
+void InterprocessIndexerCommandManager::updateTableGeneration(
+	const SharedIndexerCommandTable& table)
+{
+	if (m_tableGeneration != table.getGeneration())
+	{
+		m_tableGeneration = table.getGeneration();
+		m_stringIndices.clear();
+		m_listIndices.clear();
+		m_stringLists.clear();
+		m_pathLists.clear();
+		m_pathSets.clear();
+		m_filterSets.clear();
+	}
+}
+
+void InterprocessIndexerCommandManager::discardNewEntries()
+{
+	for (auto it = m_stringIndices.begin(); it != m_stringIndices.end();)
+	{
+		it = it->second >= m_tableStringCount ? m_stringIndices.erase(it) : std::next(it);
+	}
+	for (auto it = m_listIndices.begin(); it != m_listIndices.end();)
+	{
+		it = it->second >= m_tableListCount ? m_listIndices.erase(it) : std::next(it);
+	}
+	m_newStrings.clear();
+	m_newLists.clear();
+}
+
+SharedIndexerCommand InterprocessIndexerCommandManager::toShared(IndexerCommand* indexerCommand)
+{
+	SharedIndexerCommand sharedCommand;
+	sharedCommand.sourceFilePath = addString(indexerCommand->getSourceFilePath().wstr());
+
+#if BUILD_CXX_LANGUAGE_PACKAGE
+	if (IndexerCommandCxx* cmd = dynamic_cast<IndexerCommandCxx*>(indexerCommand))
+	{
+		sharedCommand.type = SharedIndexerCommand::CXX;
+		sharedCommand.indexedPaths = addList(cmd->getIndexedPaths());
+		sharedCommand.excludeFilters = addList(cmd->getExcludeFilters());
+		sharedCommand.includeFilters = addList(cmd->getIncludeFilters());
+		sharedCommand.workingDirectory = addString(cmd->getWorkingDirectory().wstr());
+		sharedCommand.compilerFlags = addList(cmd->getCompilerFlags());
+		return sharedCommand;
+	}
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+	if (IndexerCommandJava* cmd = dynamic_cast<IndexerCommandJava*>(indexerCommand))
+	{
+		sharedCommand.type = SharedIndexerCommand::JAVA;
+		sharedCommand.languageStandard = addString(cmd->getLanguageStandard());
+		sharedCommand.classPaths = addList(cmd->getClassPath());
+		return sharedCommand;
+	}
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
+
+	LOG_ERROR(
+		L"Trying to push unhandled type of IndexerCommand for file: " +
+		indexerCommand->getSourceFilePath().wstr() + L". Type string is: " +
+		utility::decodeFromUtf8(indexerCommandTypeToString(indexerCommand->getIndexerCommandType())) +
+		L". It will be ignored.");
+
+	sharedCommand.type = SharedIndexerCommand::UNKNOWN;
+	return sharedCommand;
+}
+
+std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::fromShared(
+	const SharedIndexerCommand& indexerCommand, const SharedIndexerCommandTable& table)
+{
+	const FilePath sourceFilePath(
+		utility::decodeFromUtf8(table.getString(indexerCommand.sourceFilePath)));
+
+	switch (indexerCommand.type)
+	{
+#if BUILD_CXX_LANGUAGE_PACKAGE
+	case SharedIndexerCommand::CXX:
+		return std::make_shared<IndexerCommandCxx>(
+			sourceFilePath,
+			getList(table, indexerCommand.indexedPaths, m_pathSets),
+			getList(table, indexerCommand.excludeFilters, m_filterSets),
+			getList(table, indexerCommand.includeFilters, m_filterSets),
+			FilePath(utility::decodeFromUtf8(table.getString(indexerCommand.workingDirectory))),
+			getList(table, indexerCommand.compilerFlags, m_stringLists));
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
+#if BUILD_JAVA_LANGUAGE_PACKAGE
+	case SharedIndexerCommand::JAVA:
+		return std::make_shared<IndexerCommandJava>(
+			sourceFilePath,
+			utility::decodeFromUtf8(table.getString(indexerCommand.languageStandard)),
+			getList(table, indexerCommand.classPaths, m_pathLists));
+#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
+	case SharedIndexerCommand::UNKNOWN:
+	default:
+		LOG_ERROR(
+			L"Cannot convert shared IndexerCommand for file: " + sourceFilePath.wstr() +
+			L". The type is unknown.");
+	}
+
+	return nullptr;
+}
+
+uint32_t InterprocessIndexerCommandManager::addString(const std::wstring& str)
+{
+	auto it = m_stringIndices.find(str);
+	if (it != m_stringIndices.end())
+	{
+		return it->second;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(m_tableStringCount + m_newStrings.size());
+	m_newStrings.push_back(utility::encodeToUtf8(str));
+	m_stringIndices.emplace(str, index);
+	return index;
+}
+
+template <typename ContainerType>
+uint32_t InterprocessIndexerCommandManager::addList(const ContainerType& container)
+{
+	std::vector<uint32_t> stringIndices;
+	stringIndices.reserve(container.size());
+
+	for (const auto& element: container)
+	{
+		stringIndices.push_back(addString(toWString(element)));
+	}
+
+	auto it = m_listIndices.find(stringIndices);
+	if (it != m_listIndices.end())
+	{
+		return it->second;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(m_tableListCount + m_newLists.size());
+	m_newLists.push_back(stringIndices);
+	m_listIndices.emplace(std::move(stringIndices), index);
+	return index;
+}
+
+template <typename ContainerType>
+const ContainerType& InterprocessIndexerCommandManager::getList(
+	const SharedIndexerCommandTable& table,
+	uint32_t listIndex,
+	std::unordered_map<uint32_t, ContainerType>& lists)
+{
+	auto it = lists.find(listIndex);
+	if (it == lists.end())
+	{
+		ContainerType list;
+		for (uint32_t stringIndex: table.getList(listIndex))
+		{
+			list.insert(
+				list.end(),
+				typename ContainerType::value_type(
+					utility::decodeFromUtf8(table.getString(stringIndex))));
+		}
+		it = lists.emplace(listIndex, std::move(list)).first;
+	}
+	return it->second;
+}
@@ -1,11 +1,22 @@
 #ifndef INTERPROCESS_INDEXER_COMMAND_MANAGER_H
 #define INTERPROCESS_INDEXER_COMMAND_MANAGER_H
 
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 #include "BaseInterprocessDataManager.h"
+#include "FilePath.h"
+#include "FilePathFilter.h"
 #include "SharedIndexerCommand.h"
 
 class IndexerCommand;
+class SharedIndexerCommandTable;
 
+// Commands are queued as SharedIndexerCommands that refer to the strings and string lists of a
+// shared table. Each manager remembers the entries of that table it already stored or read, so
+// compiler flags and paths shared by many commands are only stored and decoded once.
 class InterprocessIndexerCommandManager: public BaseInterprocessDataManager
 {
 public:
@@ -21,6 +32,42 @@ public:
 private:
 	static const char* s_sharedMemoryNamePrefix;
 	static const char* s_indexerCommandsKeyName;
+	static const char* s_indexerCommandTableKeyName;
+
+	void updateTableGeneration(const SharedIndexerCommandTable& table);
+	// forgets the entries added while pushing, if they could not be stored in the table
+	void discardNewEntries();
+
+	SharedIndexerCommand toShared(IndexerCommand* indexerCommand);
+	std::shared_ptr<IndexerCommand> fromShared(
+		const SharedIndexerCommand& indexerCommand, const SharedIndexerCommandTable& table);
+
+	uint32_t addString(const std::wstring& str);
+	template <typename ContainerType>
+	uint32_t addList(const ContainerType& container);
+
+	template <typename ContainerType>
+	const ContainerType& getList(
+		const SharedIndexerCommandTable& table,
+		uint32_t listIndex,
+		std::unordered_map<uint32_t, ContainerType>& lists);
+
+	// entries of the table with this generation known to this process
+	size_t m_tableGeneration = 0;
+	std::unordered_map<std::wstring, uint32_t> m_stringIndices;
+	std::map<std::vector<uint32_t>, uint32_t> m_listIndices;
+
+	// lists read from the table, kept converted because building filters is expensive
+	std::unordered_map<uint32_t, std::vector<std::wstring>> m_stringLists;
+	std::unordered_map<uint32_t, std::vector<FilePath>> m_pathLists;
+	std::unordered_map<uint32_t, std::set<FilePath>> m_pathSets;
+	std::unordered_map<uint32_t, std::set<FilePathFilter>> m_filterSets;
+
+	// entries added while pushing, which get stored in the table afterwards
+	size_t m_tableStringCount = 0;
+	size_t m_tableListCount = 0;
+	std::vector<std::string> m_newStrings;
+	std::vector<std::vector<uint32_t>> m_newLists;
 };
 
 #endif	  // INTERPROCESS_INDEXER_COMMAND_MANAGER_H
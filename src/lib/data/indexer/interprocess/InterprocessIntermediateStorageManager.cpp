@@ -1,5 +1,8 @@
 #include "InterprocessIntermediateStorageManager.h"
 
+#include <chrono>
+#include <thread>
+
 #include "IntermediateStorage.h"
 #include "SharedIntermediateStorage.h"
 #include "logging.h"
@@ -24,14 +27,35 @@ InterprocessIntermediateStorageManager::InterprocessIntermediateStorageManager(
 void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 	const std::shared_ptr<IntermediateStorage>& intermediateStorage)
 {
-	const size_t requiredInsertsToShrink = 10;
-
 	const size_t overestimationMultiplier = 2;
 	const size_t requiredSize = (intermediateStorage->getByteSize(sizeof(SharedMemory::String)) +
 								 sizeof(SharedIntermediateStorage)) *
 			overestimationMultiplier +
 		1048576 /* 1 MB */;
 
+	while (true)
+	{
+		// the indexer waits for the app to catch up after pushing, so this only blocks if the app
+		// stopped popping for a while
+		while (getIntermediateStorageCount() >= s_maxIntermediateStorageCount)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+
+		if (tryPushIntermediateStorage(intermediateStorage, requiredSize))
+		{
+			return;
+		}
+
+		LOG_WARNING("Intermediate storage ring is full, waiting for the app to pop storages.");
+	}
+}
+
+bool InterprocessIntermediateStorageManager::tryPushIntermediateStorage(
+	const std::shared_ptr<IntermediateStorage>& intermediateStorage, size_t requiredSize)
+{
+	const size_t requiredInsertsToShrink = 10;
+
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
 
 	const size_t freeMemory = access.getFreeMemorySize();
@@ -54,16 +78,21 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 		m_insertsWithoutGrowth++;
 	}
 
-	SharedMemory::Queue<SharedIntermediateStorage>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(
-			s_intermediateStoragesKeyName);
-	if (!queue)
+	IntermediateStorageRing* ring = accessRing(access);
+	if (!ring)
 	{
-		return;
+		LOG_ERROR("Unable to access the intermediate storage ring, the storage is dropped.");
+		return true;
 	}
 
-	queue->push_back(SharedIntermediateStorage(access.getAllocator()));
-	SharedIntermediateStorage& storage = queue->back();
+	// the ring is checked before pushing, so it is only full if this process pushed meanwhile
+	if (ring->isFull())
+	{
+		return false;
+	}
+
+	SharedIntermediateStorage& storage = *access.getAllocator()->construct<SharedIntermediateStorage>(
+		boost::interprocess::anonymous_instance)(access.getAllocator());
 
 	storage.setStorageNodes(intermediateStorage->getStorageNodes());
 	storage.setStorageFiles(intermediateStorage->getStorageFiles());
@@ -77,6 +106,12 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 
 	storage.setNextId(intermediateStorage->getNextId());
 
+	if (!ring->push(&storage))
+	{
+		access.getAllocator()->destroy_ptr(&storage);
+		return false;
+	}
+
 	if (m_insertsWithoutGrowth >= requiredInsertsToShrink)
 	{
 		m_insertsWithoutGrowth = 0;
@@ -86,24 +121,27 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(
 		LOG_INFO_STREAM(
 			<< "shrunk memory - size: " << access.getMemorySize()
 			<< " free: " << access.getFreeMemorySize());
+
+		// shrinking maps the segment again
+		accessRing(access);
 	}
 
 	LOG_INFO(access.logString());
+	return true;
 }
 
 std::shared_ptr<IntermediateStorage> InterprocessIntermediateStorageManager::popIntermediateStorage()
 {
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
 
-	SharedMemory::Queue<SharedIntermediateStorage>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(
-			s_intermediateStoragesKeyName);
-	if (!queue || !queue->size())
+	IntermediateStorageRing* ring = accessRing(access);
+	boost::interprocess::offset_ptr<SharedIntermediateStorage> sharedStorage;
+	if (!ring || !ring->pop(sharedStorage))
 	{
 		return nullptr;
 	}
 
-	SharedIntermediateStorage& sharedIntermediateStorage = queue->front();
+	SharedIntermediateStorage& sharedIntermediateStorage = *sharedStorage;
 
 	std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
 
@@ -119,7 +157,7 @@ std::shared_ptr<IntermediateStorage> InterprocessIntermediateStorageManager::pop
 
 	storage->setNextId(sharedIntermediateStorage.getNextId());
 
-	queue->pop_front();
+	access.getAllocator()->destroy_ptr(sharedStorage.get());
 	LOG_INFO(access.logString());
 
 	return storage;
@@ -127,15 +165,27 @@ std::shared_ptr<IntermediateStorage> InterprocessIntermediateStorageManager::pop
 
 size_t InterprocessIntermediateStorageManager::getIntermediateStorageCount()
 {
+	if (m_ring)
+	{
+		return m_ring->size();
+	}
+
 	SharedMemory::ScopedAccess access(&m_sharedMemory);
 
-	SharedMemory::Queue<SharedIntermediateStorage>* queue =
-		access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(
-			s_intermediateStoragesKeyName);
-	if (!queue)
+	IntermediateStorageRing* ring = accessRing(access);
+	if (!ring)
 	{
 		return 0;
 	}
 
-	return queue->size();
+	return ring->size();
+}
+
+InterprocessIntermediateStorageManager::IntermediateStorageRing* InterprocessIntermediateStorageManager::
+	accessRing(SharedMemory::ScopedAccess& access)
+{
+	IntermediateStorageRing* ring = access.accessValue<IntermediateStorageRing>(
+		s_intermediateStoragesKeyName);
+	m_ring = SharedMemory::s_keepsMemoryMapped ? ring : nullptr;
+	return ring;
 }
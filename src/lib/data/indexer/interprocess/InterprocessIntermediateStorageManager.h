@@ -2,8 +2,10 @@
 #define INTERPROCESS_INTERMEDIATE_STORAGE_MANAGER_H
 
 #include "BaseInterprocessDataManager.h"
+#include "SpscRing.h"
 
 class IntermediateStorage;
+class SharedIntermediateStorage;
 
 class InterprocessIntermediateStorageManager: public BaseInterprocessDataManager
 {
@@ -17,10 +19,26 @@ public:
 	size_t getIntermediateStorageCount();
 
 private:
+	static constexpr size_t s_maxIntermediateStorageCount = 64;
+
+	// the indexer process pushes and the app pops
+	using IntermediateStorageRing = SpscRing<
+		boost::interprocess::offset_ptr<SharedIntermediateStorage>,
+		s_maxIntermediateStorageCount>;
+
 	static const char* s_sharedMemoryNamePrefix;
 	static const char* s_intermediateStoragesKeyName;
 
+	// returns false if the ring is full and nothing was pushed
+	bool tryPushIntermediateStorage(
+		const std::shared_ptr<IntermediateStorage>& intermediateStorage, size_t requiredSize);
+	IntermediateStorageRing* accessRing(SharedMemory::ScopedAccess& access);
+
 	size_t m_insertsWithoutGrowth = 0;
+
+	// Points into this process' mapping of the segment, which only changes during a ScopedAccess,
+	// so the ring can be polled without locking. Stays null if the segment does not stay mapped.
+	IntermediateStorageRing* m_ring = nullptr;
 };
 
 #endif	  // INTERPROCESS_INTERMEDIATE_STORAGE_MANAGER_H
@@ -1,58 +1,16 @@
 #ifndef SHARED_INDEXER_COMMAND_H
 #define SHARED_INDEXER_COMMAND_H
 
-#include <set>
+#include <cstdint>
 
 #include "language_packages.h"
 
-#include "FilePath.h"
-#include "FilePathFilter.h"
-#include "SharedMemory.h"
-
-class IndexerCommand;
-
-class SharedIndexerCommand
+// An indexer command in shared memory. Instead of holding its own strings it refers to the strings
+// and string lists of a SharedIndexerCommandTable by their index, so commands sharing compiler
+// flags or paths don't copy them and every command has the same small size.
+struct SharedIndexerCommand
 {
-public:
-	void fromLocal(IndexerCommand* indexerCommand);
-	static std::shared_ptr<IndexerCommand> fromShared(const SharedIndexerCommand& indexerCommand);
-
-	SharedIndexerCommand(SharedMemory::Allocator* allocator);
-	~SharedIndexerCommand();
-
-	FilePath getSourceFilePath() const;
-	void setSourceFilePath(const FilePath& filePath);
-
-#if BUILD_CXX_LANGUAGE_PACKAGE
-
-	std::set<FilePath> getIndexedPaths() const;
-	void setIndexedPaths(const std::set<FilePath>& indexedPaths);
-
-	std::set<FilePathFilter> getExcludeFilters() const;
-	void setExcludeFilters(const std::set<FilePathFilter>& excludeFilters);
-
-	std::set<FilePathFilter> getIncludeFilters() const;
-	void setIncludeFilters(const std::set<FilePathFilter>& includeFilters);
-
-	FilePath getWorkingDirectory() const;
-	void setWorkingDirectory(const FilePath& workingDirectory);
-
-	std::vector<std::wstring> getCompilerFlags() const;
-	void setCompilerFlags(const std::vector<std::wstring>& compilerFlags);
-
-#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
-#if BUILD_JAVA_LANGUAGE_PACKAGE
-
-	std::wstring getLanguageStandard() const;
-	void setLanguageStandard(const std::wstring& languageStandard);
-
-	std::vector<FilePath> getClassPaths() const;
-	void setClassPaths(const std::vector<FilePath>& classPaths);
-
-#endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
-
-private:
-	enum Type
+	enum Type : uint32_t
 	{
 		UNKNOWN = 0,
 #if BUILD_CXX_LANGUAGE_PACKAGE
@@ -66,25 +24,26 @@ private:
 #endif	  // BUILD_PYTHON_LANGUAGE_PACKAGE
 	};
 
-	Type getType() const;
-	void setType(const Type type);
-
-	Type m_type = Type::UNKNOWN;
+	Type type = UNKNOWN;
 
-	// indexer command
-	SharedMemory::String m_sourceFilePath;
+	// string index
+	uint32_t sourceFilePath = 0;
 
 #if BUILD_CXX_LANGUAGE_PACKAGE
-	SharedMemory::Vector<SharedMemory::String> m_indexedPaths;
-	SharedMemory::Vector<SharedMemory::String> m_excludeFilters;
-	SharedMemory::Vector<SharedMemory::String> m_includeFilters;
-	SharedMemory::String m_workingDirectory;
-	SharedMemory::Vector<SharedMemory::String> m_compilerFlags;
+	// list indices
+	uint32_t indexedPaths = 0;
+	uint32_t excludeFilters = 0;
+	uint32_t includeFilters = 0;
+	uint32_t compilerFlags = 0;
+	// string index
+	uint32_t workingDirectory = 0;
 #endif	  // BUILD_CXX_LANGUAGE_PACKAGE
 
 #if BUILD_JAVA_LANGUAGE_PACKAGE
-	SharedMemory::String m_languageStandard;
-	SharedMemory::Vector<SharedMemory::String> m_classPaths;
+	// string index
+	uint32_t languageStandard = 0;
+	// list index
+	uint32_t classPaths = 0;
 #endif	  // BUILD_JAVA_LANGUAGE_PACKAGE
 };
 
@@ -0,0 +1,67 @@
+#include "SharedIndexerCommandTable.h"
+
+SharedIndexerCommandTable::SharedIndexerCommandTable(SharedMemory::Allocator* allocator)
+	: m_strings(allocator), m_listElements(allocator), m_listEnds(allocator)
+{
+}
+
+size_t SharedIndexerCommandTable::getGeneration() const
+{
+	return m_generation;
+}
+
+void SharedIndexerCommandTable::clear()
+{
+	m_strings.clear();
+	m_listElements.clear();
+	m_listEnds.clear();
+	m_generation++;
+}
+
+size_t SharedIndexerCommandTable::getStringCount() const
+{
+	return m_strings.size();
+}
+
+size_t SharedIndexerCommandTable::getListCount() const
+{
+	return m_listEnds.size();
+}
+
+size_t SharedIndexerCommandTable::getListElementCount() const
+{
+	return m_listElements.size();
+}
+
+void SharedIndexerCommandTable::reserve(
+	size_t stringCount, size_t listCount, size_t listElementCount)
+{
+	m_strings.reserve(m_strings.size() + stringCount);
+	m_listEnds.reserve(m_listEnds.size() + listCount);
+	m_listElements.reserve(m_listElements.size() + listElementCount);
+}
+
+uint32_t SharedIndexerCommandTable::addString(const std::string& str)
+{
+	m_strings.push_back(SharedMemory::String(str.c_str(), m_strings.get_allocator()));
+	return static_cast<uint32_t>(m_strings.size() - 1);
+}
+
+const char* SharedIndexerCommandTable::getString(uint32_t index) const
+{
+	return m_strings[index].c_str();
+}
+
+uint32_t SharedIndexerCommandTable::addList(const std::vector<uint32_t>& stringIndices)
+{
+	m_listElements.insert(m_listElements.end(), stringIndices.begin(), stringIndices.end());
+	m_listEnds.push_back(static_cast<uint32_t>(m_listElements.size()));
+	return static_cast<uint32_t>(m_listEnds.size() - 1);
+}
+
+std::vector<uint32_t> SharedIndexerCommandTable::getList(uint32_t index) const
+{
+	const uint32_t begin = index ? m_listEnds[index - 1] : 0;
+	return std::vector<uint32_t>(
+		m_listElements.begin() + begin, m_listElements.begin() + m_listEnds[index]);
+}
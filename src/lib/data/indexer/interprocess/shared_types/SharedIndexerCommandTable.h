@@ -0,0 +1,43 @@
+#ifndef SHARED_INDEXER_COMMAND_TABLE_H
+#define SHARED_INDEXER_COMMAND_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SharedMemory.h"
+
+// Stores the strings and string lists the SharedIndexerCommands in shared memory refer to. Entries
+// are only appended and keep their index until the table gets cleared. Every clear increments the
+// generation of the table, so processes know when indices they remember became invalid.
+class SharedIndexerCommandTable
+{
+public:
+	SharedIndexerCommandTable(SharedMemory::Allocator* allocator);
+
+	size_t getGeneration() const;
+	void clear();
+
+	size_t getStringCount() const;
+	size_t getListCount() const;
+	size_t getListElementCount() const;
+
+	void reserve(size_t stringCount, size_t listCount, size_t listElementCount);
+
+	uint32_t addString(const std::string& str);
+	const char* getString(uint32_t index) const;
+
+	uint32_t addList(const std::vector<uint32_t>& stringIndices);
+	std::vector<uint32_t> getList(uint32_t index) const;
+
+private:
+	size_t m_generation = 1;
+
+	SharedMemory::Vector<SharedMemory::String> m_strings;
+
+	// the string indices of all lists one after another, each list ends at its entry in m_listEnds
+	SharedMemory::Vector<uint32_t> m_listElements;
+	SharedMemory::Vector<uint32_t> m_listEnds;
+};
+
+#endif	  // SHARED_INDEXER_COMMAND_TABLE_H
@@ -2,51 +2,10 @@
 
 #include "SourceLocationFile.h"
 
-SourceLocation::SourceLocation(
-	SourceLocationFile* file,
-	LocationType type,
-	Id locationId,
-	std::vector<Id> tokenIds,
-	size_t lineNumber,
-	size_t columnNumber,
-	bool isStart)
-	: m_file(file)
-	, m_type(type)
-	, m_locationId(locationId)
-	, m_tokenIds(tokenIds)
-	, m_lineNumber(lineNumber)
-	, m_columnNumber(columnNumber)
-	, m_other(nullptr)
-	, m_isStart(isStart)
-{
-}
-
-SourceLocation::SourceLocation(SourceLocation* other, size_t lineNumber, size_t columnNumber)
-	: m_file(other->m_file)
-	, m_type(other->m_type)
-	, m_locationId(other->m_locationId)
-	, m_tokenIds(other->m_tokenIds)
-	, m_lineNumber(lineNumber)
-	, m_columnNumber(columnNumber)
-	, m_other(other)
-	, m_isStart(!other->m_isStart)
-{
-	other->setOtherLocation(this);
-}
-
-SourceLocation::SourceLocation(const SourceLocation* other, SourceLocationFile* file)
-	: m_file(file)
-	, m_type(other->m_type)
-	, m_locationId(other->m_locationId)
-	, m_tokenIds(other->m_tokenIds)
-	, m_lineNumber(other->m_lineNumber)
-	, m_columnNumber(other->m_columnNumber)
-	, m_other(nullptr)
-	, m_isStart(other->m_isStart)
-{
-}
-
-SourceLocation::~SourceLocation() = default;
+SourceLocation::SourceLocation(SourceLocationFile* file, uint32_t endpointIndex)
+	: m_file(file), m_endpointIndex(endpointIndex)
+{
+}
 
 bool SourceLocation::operator==(const SourceLocation& rhs) const
 {
@@ -125,27 +84,30 @@ SourceLocationFile* SourceLocation::getSourceLocationFile() const
 
 Id SourceLocation::getLocationId() const
 {
-	return m_locationId;
+	return m_file->m_locationIds[m_file->m_endpointLocations[m_endpointIndex]];
 }
 
-const std::vector<Id>& SourceLocation::getTokenIds() const
+std::span<const Id> SourceLocation::getTokenIds() const
 {
-	return m_tokenIds;
+	const uint32_t locationIndex = m_file->m_endpointLocations[m_endpointIndex];
+	const uint32_t first = m_file->m_tokenIdOffsets[locationIndex];
+	return std::span<const Id>(m_file->m_tokenIds)
+		.subspan(first, m_file->m_tokenIdOffsets[locationIndex + 1] - first);
 }
 
 LocationType SourceLocation::getType() const
 {
-	return m_type;
+	return m_file->m_types[m_file->m_endpointLocations[m_endpointIndex]];
 }
 
 size_t SourceLocation::getColumnNumber() const
 {
-	return m_columnNumber;
+	return m_file->m_columnNumbers[m_endpointIndex];
 }
 
 size_t SourceLocation::getLineNumber() const
 {
-	return m_lineNumber;
+	return m_file->m_lineNumbers[m_endpointIndex];
 }
 
 const FilePath& SourceLocation::getFilePath() const
@@ -155,56 +117,55 @@ const FilePath& SourceLocation::getFilePath() const
 
 const SourceLocation* SourceLocation::getOtherLocation() const
 {
-	return m_other;
-}
-
-void SourceLocation::setOtherLocation(SourceLocation* other)
-{
-	m_other = other;
+	const uint32_t locationIndex = m_file->m_endpointLocations[m_endpointIndex];
+	return m_file->getEndpoint(
+		isStartLocation() ? m_file->m_endEndpoints[locationIndex]
+						  : m_file->m_startEndpoints[locationIndex]);
 }
 
 const SourceLocation* SourceLocation::getStartLocation() const
 {
-	if (m_isStart)
+	if (isStartLocation())
 	{
 		return this;
 	}
 	else
 	{
-		return m_other;
+		return getOtherLocation();
 	}
 }
 
 const SourceLocation* SourceLocation::getEndLocation() const
 {
-	if (!m_isStart)
+	if (isEndLocation())
 	{
 		return this;
 	}
 	else
 	{
-		return m_other;
+		return getOtherLocation();
 	}
 }
 
 bool SourceLocation::isStartLocation() const
 {
-	return m_isStart;
+	return m_file->m_startEndpoints[m_file->m_endpointLocations[m_endpointIndex]] ==
+		m_endpointIndex;
 }
 
 bool SourceLocation::isEndLocation() const
 {
-	return !m_isStart;
+	return !isStartLocation();
 }
 
 bool SourceLocation::isScopeLocation() const
 {
-	return m_type == LOCATION_SCOPE;
+	return getType() == LOCATION_SCOPE;
 }
 
 bool SourceLocation::isFullTextSearchMatch() const
 {
-	return m_type == LOCATION_FULLTEXT_SEARCH;
+	return getType() == LOCATION_FULLTEXT_SEARCH;
 }
 
 std::wostream& operator<<(std::wostream& ostream, const SourceLocation& location)
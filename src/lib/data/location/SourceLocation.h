@@ -1,9 +1,10 @@
 #ifndef SOURCE_LOCATION_H
 #define SOURCE_LOCATION_H
 
+#include <cstdint>
 #include <ostream>
+#include <span>
 #include <string>
-#include <vector>
 
 #include "LocationType.h"
 #include "types.h"
@@ -11,21 +12,11 @@
 class FilePath;
 class SourceLocationFile;
 
+// Lightweight handle of one end of a location. All data is stored in the struct-of-arrays of the
+// owning SourceLocationFile, which also keeps the handles at stable addresses.
 class SourceLocation
 {
 public:
-	SourceLocation(
-		SourceLocationFile* file,
-		LocationType type,
-		Id locationId,
-		std::vector<Id> tokenIds,
-		size_t lineNumber,
-		size_t columnNumber,
-		bool isStart);
-	SourceLocation(SourceLocation* other, size_t lineNumber, size_t columnNumber);
-	SourceLocation(const SourceLocation* other, SourceLocationFile* file);
-	virtual ~SourceLocation();
-
 	bool operator==(const SourceLocation& rhs) const;
 	bool operator<(const SourceLocation& rhs) const;
 	bool operator>(const SourceLocation& rhs) const;
@@ -35,7 +26,7 @@ public:
 	SourceLocationFile* getSourceLocationFile() const;
 
 	Id getLocationId() const;
-	const std::vector<Id>& getTokenIds() const;
+	std::span<const Id> getTokenIds() const;
 	LocationType getType() const;
 
 	size_t getColumnNumber() const;
@@ -43,7 +34,6 @@ public:
 	const FilePath& getFilePath() const;
 
 	const SourceLocation* getOtherLocation() const;
-	void setOtherLocation(SourceLocation* other);
 
 	const SourceLocation* getStartLocation() const;
 	const SourceLocation* getEndLocation() const;
@@ -55,18 +45,12 @@ public:
 	bool isFullTextSearchMatch() const;
 
 private:
-	SourceLocationFile* m_file;
-
-	LocationType m_type;
+	friend class SourceLocationFile;
 
-	const Id m_locationId;
-	const std::vector<Id> m_tokenIds;
+	SourceLocation(SourceLocationFile* file, uint32_t endpointIndex);
 
-	const size_t m_lineNumber;
-	const size_t m_columnNumber;
-
-	SourceLocation* m_other;
-	const bool m_isStart;
+	SourceLocationFile* m_file;
+	uint32_t m_endpointIndex;
 };
 
 std::wostream& operator<<(std::wostream& ostream, const SourceLocation& location);
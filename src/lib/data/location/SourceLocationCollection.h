@@ -14,6 +14,8 @@ class FilePath;
 class SourceLocation;
 class SourceLocationFile;
 
+// Groups the SourceLocationFiles by path. The locations themselves are stored in the flat arrays of
+// their files, the collection holds no per location data.
 class SourceLocationCollection
 {
 public:
@@ -1,5 +1,10 @@
 #include "SourceLocationFile.h"
 
+#include <algorithm>
+#include <limits>
+
+const uint32_t SourceLocationFile::s_noEndpoint = std::numeric_limits<uint32_t>::max();
+
 SourceLocationFile::SourceLocationFile(
 	const FilePath& filePath, const std::wstring& language, bool isWhole, bool isComplete, bool isIndexed)
 	: m_filePath(filePath)
@@ -7,9 +12,36 @@ SourceLocationFile::SourceLocationFile(
 	, m_isWhole(isWhole)
 	, m_isComplete(isComplete)
 	, m_isIndexed(isIndexed)
+	, m_tokenIdOffsets({0})
 {
 }
 
+SourceLocationFile::SourceLocationFile(const SourceLocationFile& other)
+	: m_filePath(other.m_filePath)
+	, m_language(other.m_language)
+	, m_isWhole(other.m_isWhole)
+	, m_isComplete(other.m_isComplete)
+	, m_isIndexed(other.m_isIndexed)
+	, m_locationIds(other.m_locationIds)
+	, m_types(other.m_types)
+	, m_tokenIdOffsets(other.m_tokenIdOffsets)
+	, m_startEndpoints(other.m_startEndpoints)
+	, m_endEndpoints(other.m_endEndpoints)
+	, m_tokenIds(other.m_tokenIds)
+	, m_lineNumbers(other.m_lineNumbers)
+	, m_columnNumbers(other.m_columnNumbers)
+	, m_endpointLocations(other.m_endpointLocations)
+	, m_sortedEndpoints(other.getSortedEndpoints())
+	, m_sortedEndpointCount(m_sortedEndpoints.size())
+	, m_locationIndex(other.m_locationIndex)
+{
+	// the handles of the other file refer to it, so this file needs its own
+	for (size_t i = 0; i < other.m_endpoints.size(); i++)
+	{
+		m_endpoints.push_back(SourceLocation(this, static_cast<uint32_t>(i)));
+	}
+}
+
 SourceLocationFile::~SourceLocationFile() = default;
 
 const FilePath& SourceLocationFile::getFilePath() const
@@ -57,10 +89,10 @@ bool SourceLocationFile::isIndexed() const
 	return m_isIndexed;
 }
 
-const std::multiset<std::shared_ptr<SourceLocation>, SourceLocationFile::LocationComp>& SourceLocationFile::
-	getSourceLocations() const
+SourceLocation* SourceLocationFile::getFirstSourceLocation() const
 {
-	return m_locations;
+	const std::vector<uint32_t>& sortedEndpoints = getSortedEndpoints();
+	return sortedEndpoints.empty() ? nullptr : getEndpoint(sortedEndpoints.front());
 }
 
 size_t SourceLocationFile::getSourceLocationCount() const
@@ -71,9 +103,9 @@ size_t SourceLocationFile::getSourceLocationCount() const
 size_t SourceLocationFile::getUnscopedStartLocationCount() const
 {
 	size_t count = 0;
-	for (const std::shared_ptr<SourceLocation>& location: m_locations)
+	for (size_t i = 0; i < m_types.size(); i++)
 	{
-		if (location->isStartLocation() && !location->isScopeLocation())
+		if (m_startEndpoints[i] != s_noEndpoint && m_types[i] != LOCATION_SCOPE)
 		{
 			count++;
 		}
@@ -90,56 +122,52 @@ SourceLocation* SourceLocationFile::addSourceLocation(
 	size_t endLineNumber,
 	size_t endColumnNumber)
 {
-	std::shared_ptr<SourceLocation> start = std::make_shared<SourceLocation>(
-		this, type, locationId, tokenIds, startLineNumber, startColumnNumber, true);
-	std::shared_ptr<SourceLocation> end = std::make_shared<SourceLocation>(
-		start.get(), endLineNumber, endColumnNumber);
+	const uint32_t locationIndex = addLocation(type, locationId, tokenIds);
 
-	m_locations.insert(start);
-	m_locations.insert(end);
+	SourceLocation* start = addEndpoint(locationIndex, startLineNumber, startColumnNumber, true);
+	addEndpoint(locationIndex, endLineNumber, endColumnNumber, false);
 
-	if (start->getLocationId())
+	if (locationId)
 	{
-		m_locationIndex.emplace(start->getLocationId(), start.get());
+		m_locationIndex.emplace(locationId, locationIndex);
 	}
 
-	return start.get();
+	return start;
 }
 
 SourceLocation* SourceLocationFile::addSourceLocationCopy(const SourceLocation* location)
 {
+	const Id locationId = location->getLocationId();
+	const bool isStart = location->isStartLocation();
+
 	// Check whether this location was already added or if the other SourceLocation was added.
-	SourceLocation* oldLocation = getSourceLocationById(location->getLocationId());
-	if (oldLocation)
+	if (locationId)
 	{
-		if (oldLocation->isStartLocation() == location->isStartLocation())
+		std::unordered_map<Id, uint32_t>::const_iterator it = m_locationIndex.find(locationId);
+		if (it != m_locationIndex.end())
 		{
-			return oldLocation;
-		}
+			const uint32_t endpointIndex = isStart ? m_startEndpoints[it->second]
+												   : m_endEndpoints[it->second];
+			if (endpointIndex != s_noEndpoint)
+			{
+				return getEndpoint(endpointIndex);
+			}
 
-		const SourceLocation* otherOldLocation = oldLocation->getOtherLocation();
-		if (otherOldLocation && otherOldLocation->isStartLocation() == location->isStartLocation())
-		{
-			return const_cast<SourceLocation*>(otherOldLocation);
+			// The other end was added before, so both ends share one location entry.
+			return addEndpoint(
+				it->second, location->getLineNumber(), location->getColumnNumber(), isStart);
 		}
 	}
 
-	std::shared_ptr<SourceLocation> copy = std::make_shared<SourceLocation>(location, this);
-	m_locations.insert(copy);
+	const uint32_t locationIndex = addLocation(
+		location->getType(), locationId, location->getTokenIds());
 
-	if (copy->getLocationId())
+	if (locationId)
 	{
-		m_locationIndex.emplace(copy->getLocationId(), copy.get());
+		m_locationIndex.emplace(locationId, locationIndex);
 	}
 
-	// If the old location was added before, then link them with each other.
-	if (oldLocation)
-	{
-		oldLocation->setOtherLocation(copy.get());
-		copy->setOtherLocation(oldLocation);
-	}
-
-	return copy.get();
+	return addEndpoint(locationIndex, location->getLineNumber(), location->getColumnNumber(), isStart);
 }
 
 void SourceLocationFile::copySourceLocations(std::shared_ptr<SourceLocationFile> file)
@@ -149,11 +177,12 @@ void SourceLocationFile::copySourceLocations(std::shared_ptr<SourceLocationFile>
 
 SourceLocation* SourceLocationFile::getSourceLocationById(Id locationId) const
 {
-	std::map<Id, SourceLocation*>::const_iterator it = m_locationIndex.find(locationId);
+	std::unordered_map<Id, uint32_t>::const_iterator it = m_locationIndex.find(locationId);
 
 	if (it != m_locationIndex.end())
 	{
-		return it->second;
+		// the end that was added first
+		return getEndpoint(std::min(m_startEndpoints[it->second], m_endEndpoints[it->second]));
 	}
 
 	return nullptr;
@@ -161,30 +190,30 @@ SourceLocation* SourceLocationFile::getSourceLocationById(Id locationId) const
 
 void SourceLocationFile::forEachSourceLocation(std::function<void(SourceLocation*)> func) const
 {
-	for (const std::shared_ptr<SourceLocation>& location: m_locations)
+	for (uint32_t endpointIndex: getSortedEndpoints())
 	{
-		func(location.get());
+		func(getEndpoint(endpointIndex));
 	}
 }
 
 void SourceLocationFile::forEachStartSourceLocation(std::function<void(SourceLocation*)> func) const
 {
-	for (const std::shared_ptr<SourceLocation>& location: m_locations)
+	for (uint32_t endpointIndex: getSortedEndpoints())
 	{
-		if (location->isStartLocation())
+		if (m_startEndpoints[m_endpointLocations[endpointIndex]] == endpointIndex)
 		{
-			func(location.get());
+			func(getEndpoint(endpointIndex));
 		}
 	}
 }
 
 void SourceLocationFile::forEachEndSourceLocation(std::function<void(SourceLocation*)> func) const
 {
-	for (const std::shared_ptr<SourceLocation>& location: m_locations)
+	for (uint32_t endpointIndex: getSortedEndpoints())
 	{
-		if (location->isEndLocation())
+		if (m_endEndpoints[m_endpointLocations[endpointIndex]] == endpointIndex)
 		{
-			func(location.get());
+			func(getEndpoint(endpointIndex));
 		}
 	}
 }
@@ -195,12 +224,12 @@ std::shared_ptr<SourceLocationFile> SourceLocationFile::getFilteredByLines(
 	std::shared_ptr<SourceLocationFile> ret = std::make_shared<SourceLocationFile>(
 		getFilePath(), getLanguage(), false, isComplete(), isIndexed());
 
-	for (const std::shared_ptr<SourceLocation>& location: m_locations)
+	for (uint32_t endpointIndex: getSortedEndpoints())
 	{
-		if (location->getLineNumber() >= firstLineNumber &&
-			location->getLineNumber() <= lastLineNumber)
+		if (m_lineNumbers[endpointIndex] >= firstLineNumber &&
+			m_lineNumbers[endpointIndex] <= lastLineNumber)
 		{
-			ret->addSourceLocationCopy(location.get());
+			ret->addSourceLocationCopy(getEndpoint(endpointIndex));
 		}
 	}
 
@@ -212,11 +241,11 @@ std::shared_ptr<SourceLocationFile> SourceLocationFile::getFilteredByType(Locati
 	std::shared_ptr<SourceLocationFile> ret = std::make_shared<SourceLocationFile>(
 		getFilePath(), getLanguage(), false, isComplete(), isIndexed());
 
-	for (const std::shared_ptr<SourceLocation>& location: m_locations)
+	for (uint32_t endpointIndex: getSortedEndpoints())
 	{
-		if (location->getType() == type)
+		if (m_types[m_endpointLocations[endpointIndex]] == type)
 		{
-			ret->addSourceLocationCopy(location.get());
+			ret->addSourceLocationCopy(getEndpoint(endpointIndex));
 		}
 	}
 
@@ -235,17 +264,105 @@ std::shared_ptr<SourceLocationFile> SourceLocationFile::getFilteredByTypes(
 	std::shared_ptr<SourceLocationFile> ret = std::make_shared<SourceLocationFile>(
 		getFilePath(), getLanguage(), isWhole(), isComplete(), isIndexed());
 
-	for (const std::shared_ptr<SourceLocation>& location: m_locations)
+	for (uint32_t endpointIndex: getSortedEndpoints())
 	{
-		if ((static_cast<size_t>(1) << location->getType()) & typeMask)
+		if ((static_cast<size_t>(1) << m_types[m_endpointLocations[endpointIndex]]) & typeMask)
 		{
-			ret->addSourceLocationCopy(location.get());
+			ret->addSourceLocationCopy(getEndpoint(endpointIndex));
 		}
 	}
 
 	return ret;
 }
 
+uint32_t SourceLocationFile::addLocation(LocationType type, Id locationId, std::span<const Id> tokenIds)
+{
+	const uint32_t locationIndex = static_cast<uint32_t>(m_locationIds.size());
+
+	m_locationIds.push_back(locationId);
+	m_types.push_back(type);
+	m_tokenIds.insert(m_tokenIds.end(), tokenIds.begin(), tokenIds.end());
+	m_tokenIdOffsets.push_back(static_cast<uint32_t>(m_tokenIds.size()));
+	m_startEndpoints.push_back(s_noEndpoint);
+	m_endEndpoints.push_back(s_noEndpoint);
+
+	return locationIndex;
+}
+
+SourceLocation* SourceLocationFile::addEndpoint(
+	uint32_t locationIndex, size_t lineNumber, size_t columnNumber, bool isStart)
+{
+	const uint32_t endpointIndex = static_cast<uint32_t>(m_endpoints.size());
+
+	m_lineNumbers.push_back(static_cast<uint32_t>(lineNumber));
+	m_columnNumbers.push_back(static_cast<uint32_t>(columnNumber));
+	m_endpointLocations.push_back(locationIndex);
+	(isStart ? m_startEndpoints : m_endEndpoints)[locationIndex] = endpointIndex;
+
+	m_endpoints.push_back(SourceLocation(this, endpointIndex));
+	return &m_endpoints.back();
+}
+
+SourceLocation* SourceLocationFile::getEndpoint(uint32_t endpointIndex) const
+{
+	if (endpointIndex == s_noEndpoint)
+	{
+		return nullptr;
+	}
+
+	// the handles only refer to this file, so they may be handed out as mutable
+	return const_cast<SourceLocation*>(&m_endpoints[endpointIndex]);
+}
+
+bool SourceLocationFile::isEndpointBefore(uint32_t a, uint32_t b) const
+{
+	if (m_lineNumbers[a] != m_lineNumbers[b])
+	{
+		return m_lineNumbers[a] < m_lineNumbers[b];
+	}
+
+	if (m_columnNumbers[a] != m_columnNumbers[b])
+	{
+		return m_columnNumbers[a] < m_columnNumbers[b];
+	}
+
+	return m_locationIds[m_endpointLocations[a]] < m_locationIds[m_endpointLocations[b]];
+}
+
+const std::vector<uint32_t>& SourceLocationFile::getSortedEndpoints() const
+{
+	if (m_sortedEndpointCount.load(std::memory_order_acquire) == m_endpoints.size())
+	{
+		return m_sortedEndpoints;
+	}
+
+	std::lock_guard<std::mutex> lock(m_sortMutex);
+
+	const size_t sortedCount = m_sortedEndpointCount.load(std::memory_order_relaxed);
+	if (sortedCount == m_endpoints.size())
+	{
+		return m_sortedEndpoints;
+	}
+
+	// Sort only the new endpoints and merge them behind equal ones, which keeps the insertion
+	// order of equal endpoints.
+	for (size_t i = sortedCount; i < m_endpoints.size(); i++)
+	{
+		m_sortedEndpoints.push_back(static_cast<uint32_t>(i));
+	}
+
+	auto isBefore = [this](uint32_t a, uint32_t b) { return isEndpointBefore(a, b); };
+	std::stable_sort(m_sortedEndpoints.begin() + sortedCount, m_sortedEndpoints.end(), isBefore);
+	std::inplace_merge(
+		m_sortedEndpoints.begin(),
+		m_sortedEndpoints.begin() + sortedCount,
+		m_sortedEndpoints.end(),
+		isBefore);
+
+	m_sortedEndpointCount.store(m_sortedEndpoints.size(), std::memory_order_release);
+	return m_sortedEndpoints;
+}
+
 std::wostream& operator<<(std::wostream& ostream, const SourceLocationFile& file)
 {
 	ostream << L"file \"" << file.getFilePath().wstr() << L"\"";
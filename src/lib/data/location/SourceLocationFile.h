@@ -1,11 +1,16 @@
 #ifndef SOURCE_LOCATION_FILE_H
 #define SOURCE_LOCATION_FILE_H
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <functional>
-#include <map>
 #include <memory>
+#include <mutex>
 #include <ostream>
-#include <set>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 #include "FilePath.h"
 #include "LocationType.h"
@@ -15,23 +20,17 @@
 class SourceLocationFile
 {
 public:
-	struct LocationComp
-	{
-		bool operator()(
-			const std::shared_ptr<SourceLocation>& lhs, const std::shared_ptr<SourceLocation>& rhs) const
-		{
-			return *lhs < *rhs;
-		}
-	};
-
 	SourceLocationFile(
 		const FilePath& filePath,
 		const std::wstring& language,
 		bool isWhole,
 		bool isComplete,
 		bool isIndexed);
+	SourceLocationFile(const SourceLocationFile& other);
 	virtual ~SourceLocationFile();
 
+	SourceLocationFile& operator=(const SourceLocationFile&) = delete;
+
 	const FilePath& getFilePath() const;
 
 	void setLanguage(const std::wstring& language);
@@ -46,7 +45,8 @@ public:
 	void setIsIndexed(bool isIndexed);
 	bool isIndexed() const;
 
-	const std::multiset<std::shared_ptr<SourceLocation>, LocationComp>& getSourceLocations() const;
+	// returns the first location in source order or nullptr if there are none
+	SourceLocation* getFirstSourceLocation() const;
 
 	size_t getSourceLocationCount() const;
 	size_t getUnscopedStartLocationCount() const;
@@ -75,14 +75,46 @@ public:
 	std::shared_ptr<SourceLocationFile> getFilteredByTypes(const std::vector<LocationType>& types) const;
 
 private:
+	friend class SourceLocation;
+
+	static const uint32_t s_noEndpoint;
+
+	uint32_t addLocation(LocationType type, Id locationId, std::span<const Id> tokenIds);
+	SourceLocation* addEndpoint(
+		uint32_t locationIndex, size_t lineNumber, size_t columnNumber, bool isStart);
+	SourceLocation* getEndpoint(uint32_t endpointIndex) const;
+
+	bool isEndpointBefore(uint32_t a, uint32_t b) const;
+	const std::vector<uint32_t>& getSortedEndpoints() const;
+
 	const FilePath m_filePath;
 	std::wstring m_language;
 	bool m_isWhole;
 	bool m_isComplete;
 	bool m_isIndexed;
 
-	std::multiset<std::shared_ptr<SourceLocation>, LocationComp> m_locations;
-	std::map<Id, SourceLocation*> m_locationIndex;
+	// per location, indexed by location index
+	std::vector<Id> m_locationIds;
+	std::vector<LocationType> m_types;
+	std::vector<uint32_t> m_tokenIdOffsets;
+	std::vector<uint32_t> m_startEndpoints;
+	std::vector<uint32_t> m_endEndpoints;
+
+	// token ids of all locations, m_tokenIdOffsets points to the first one of each location
+	std::vector<Id> m_tokenIds;
+
+	// per endpoint, indexed by endpoint index in insertion order
+	std::vector<uint32_t> m_lineNumbers;
+	std::vector<uint32_t> m_columnNumbers;
+	std::vector<uint32_t> m_endpointLocations;
+	std::deque<SourceLocation> m_endpoints;
+
+	// endpoint indices in source order, endpoints added after the last sort get merged on access
+	mutable std::vector<uint32_t> m_sortedEndpoints;
+	mutable std::atomic<size_t> m_sortedEndpointCount = 0;
+	mutable std::mutex m_sortMutex;
+
+	std::unordered_map<Id, uint32_t> m_locationIndex;
 };
 
 std::wostream& operator<<(std::wostream& ostream, const SourceLocationFile& base);
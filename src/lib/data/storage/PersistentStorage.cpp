@@ -1,7 +1,10 @@
 #include "PersistentStorage.h"
 
+#include <algorithm>
 #include <queue>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "AccessKind.h"
 #include "ApplicationSettings.h"
@@ -17,6 +20,7 @@
 #include "SourceLocationFile.h"
 #include "TextAccess.h"
 #include "TextCodec.h"
+#include "ThreadPool.h"
 #include "TimeStamp.h"
 #include "TokenComponentAccess.h"
 #include "TokenComponentBundledEdges.h"
@@ -27,7 +31,6 @@
 #include "logging.h"
 #include "tracing.h"
 #include "utility.h"
-#include "utilityApp.h"
 
 PersistentStorage::PersistentStorage(const FilePath& dbPath, const FilePath& bookmarkPath)
 	: m_sqliteIndexStorage(dbPath), m_sqliteBookmarkStorage(bookmarkPath)
@@ -260,6 +263,19 @@ void PersistentStorage::rollbackInjection()
 	afterErrorRecording();
 }
 
+bool PersistentStorage::injectDatabase(const FilePath& dbFilePath)
+{
+	TRACE();
+
+	beforeErrorRecording();
+
+	const bool success = m_sqliteIndexStorage.injectDatabase(dbFilePath);
+
+	afterErrorRecording();
+
+	return success;
+}
+
 const std::vector<ErrorInfo> PersistentStorage::getErrorInfos() const
 {
 	return m_sqliteIndexStorage.getAllErrorInfos();
@@ -362,6 +378,11 @@ void PersistentStorage::clearCaches()
 	m_symbolDefinitionKinds.clear();
 
 	m_hierarchyCache.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_edgeAdjacencyCacheMutex);
+		m_edgeAdjacencyCache.clear();
+		m_edgeAdjacencyCacheBuilt = false;
+	}
 	m_fullTextSearchIndex.clear();
 	m_fullTextSearchCodec = "";
 }
@@ -479,11 +500,18 @@ void PersistentStorage::optimizeMemory()
 	TRACE();
 
 	m_sqliteIndexStorage.setTime();
+	m_sqliteIndexStorage.trainFileContentDictionary();
+	m_sqliteIndexStorage.packSourceLocations();
 	m_sqliteIndexStorage.optimizeMemory();
 
 	m_sqliteBookmarkStorage.optimizeMemory();
 }
 
+void PersistentStorage::checkpoint() const
+{
+	m_sqliteIndexStorage.checkpoint();
+}
+
 Id PersistentStorage::getNodeIdForFileNode(const FilePath& filePath) const
 {
 	return getFileNodeId(filePath);
@@ -586,6 +614,11 @@ StorageEdge PersistentStorage::getEdgeById(Id edgeId) const
 	return m_sqliteIndexStorage.getEdgeById(edgeId);
 }
 
+std::vector<StorageEdge> PersistentStorage::getEdgesByIds(const std::vector<Id>& edgeIds) const
+{
+	return m_sqliteIndexStorage.getAllByIds<StorageEdge>(edgeIds);
+}
+
 std::shared_ptr<SourceLocationCollection> PersistentStorage::getFullTextSearchLocations(
 	const std::wstring& searchTerm, bool caseSensitive) const
 {
@@ -617,81 +650,64 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getFullTextSearchLo
 		.dispatch();
 
 	{
-		std::vector<std::shared_ptr<std::thread>> threads;
+		const std::vector<FullTextSearchResult> fileResults = m_fullTextSearchIndex.searchForTerm(
+			searchTerm);
+		const int termLength = static_cast<int>(searchTerm.length());
 		std::mutex collectionMutex;
-		for (const std::vector<FullTextSearchResult> &fileResults: utility::splitToEquallySizedParts(
-				 m_fullTextSearchIndex.searchForTerm(searchTerm), utility::getIdealThreadCount()))
-		{
-			std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-				[this,
-				 &searchTerm,
-				 &caseSensitive,
-				 &codec,
-				 /*no ref here!*/ fileResults,
-				 &collection,
-				 &collectionMutex]() {
-					const int termLength = static_cast<int>(searchTerm.length());
-					for (const FullTextSearchResult& fileResult: fileResults)
-					{
-						const FilePath filePath = getFileNodePath(fileResult.fileId);
-						std::shared_ptr<TextAccess> fileContent = getFileContent(filePath, false);
 
-						int charsTotal = 0;
-						int lineNumber = 1;
-						std::wstring line = codec.decode(fileContent->getLine(lineNumber));
+		ThreadPool::getInstance()->parallelFor(fileResults.size(), [&](size_t fileResultIndex) {
+			const FullTextSearchResult& fileResult = fileResults[fileResultIndex];
+			const FilePath filePath = getFileNodePath(fileResult.fileId);
+			std::shared_ptr<TextAccess> fileContent = getFileContent(filePath, false);
 
-						for (int pos: fileResult.positions)
-						{
-							while (charsTotal + (int)line.length() <= pos)
-							{
-								charsTotal += static_cast<int>(line.length());
-								lineNumber++;
-								line = codec.decode(fileContent->getLine(lineNumber));
-							}
+			int charsTotal = 0;
+			int lineNumber = 1;
+			std::wstring line = codec.decode(fileContent->getLine(lineNumber));
 
-							ParseLocation location;
-							location.startLineNumber = lineNumber;
-							location.startColumnNumber = pos - charsTotal + 1;
+			for (int pos: fileResult.positions)
+			{
+				while (charsTotal + (int)line.length() <= pos)
+				{
+					charsTotal += static_cast<int>(line.length());
+					lineNumber++;
+					line = codec.decode(fileContent->getLine(lineNumber));
+				}
 
-							if (caseSensitive &&
-								line.substr(location.startColumnNumber - 1, termLength) != searchTerm)
-							{
-								continue;
-							}
-							while ((charsTotal + (int)line.length()) < pos + termLength)
-							{
-								charsTotal += static_cast<int>(line.length());
-								lineNumber++;
-								line = codec.decode(fileContent->getLine(lineNumber));
-							}
-							location.endLineNumber = lineNumber;
-							location.endColumnNumber = pos + termLength - charsTotal;
+				ParseLocation location;
+				location.startLineNumber = lineNumber;
+				location.startColumnNumber = pos - charsTotal + 1;
 
-							{
-								std::lock_guard<std::mutex> lock(collectionMutex);
-								// Set first bit to 1 to avoid collisions
-								const Id locationId = Id(collection->getSourceLocationCount() + 1) +
-									 ~(~Id::type(0) >> 1);
-								collection->addSourceLocation(
-									LOCATION_FULLTEXT_SEARCH,
-									locationId,
-									std::vector<Id>(),
-									filePath,
-									location.startLineNumber,
-									location.startColumnNumber,
-									location.endLineNumber,
-									location.endColumnNumber);
-							}
-						}
-					}
-				});
-			threads.push_back(thread);
-		}
+				if (caseSensitive &&
+					line.substr(location.startColumnNumber - 1, termLength) != searchTerm)
+				{
+					continue;
+				}
+				while ((charsTotal + (int)line.length()) < pos + termLength)
+				{
+					charsTotal += static_cast<int>(line.length());
+					lineNumber++;
+					line = codec.decode(fileContent->getLine(lineNumber));
+				}
+				location.endLineNumber = lineNumber;
+				location.endColumnNumber = pos + termLength - charsTotal;
 
-		for (std::shared_ptr<std::thread> thread: threads)
-		{
-			thread->join();
-		}
+				{
+					std::lock_guard<std::mutex> lock(collectionMutex);
+					// Set first bit to 1 to avoid collisions
+					const Id locationId = Id(collection->getSourceLocationCount() + 1) +
+						~(~Id::type(0) >> 1);
+					collection->addSourceLocation(
+						LOCATION_FULLTEXT_SEARCH,
+						locationId,
+						std::vector<Id>(),
+						filePath,
+						location.startLineNumber,
+						location.startColumnNumber,
+						location.endLineNumber,
+						location.endColumnNumber);
+				}
+			}
+		});
 	}
 
 	addCompleteFlagsToSourceLocationCollection(collection.get());
@@ -1136,15 +1152,23 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForActiveTokenIds(
 				nodeIds.push_back(elementId);
 				edgeIds.clear();
 
-				for (const StorageEdge& edge:
-					 m_sqliteIndexStorage.getEdgesBySourceOrTargetId(elementId))
+				const EdgeAdjacencyCache& edgeAdjacencyCache = getEdgeAdjacencyCache();
+				std::vector<StorageEdge> edges;
+				edgeAdjacencyCache.addEdgesBySourceIds({elementId}, ~Edge::EDGE_MEMBER, &edges);
+				const size_t outgoingEdgeCount = edges.size();
+				edgeAdjacencyCache.addEdgesByTargetIds({elementId}, ~Edge::EDGE_MEMBER, &edges);
+
+				for (size_t i = 0; i < edges.size(); i++)
 				{
-					Edge::EdgeType edgeType = Edge::intToType(edge.type);
-					if (edgeType == Edge::EDGE_MEMBER)
+					const StorageEdge& edge = edges[i];
+
+					// self references are outgoing edges as well
+					if (i >= outgoingEdgeCount && edge.sourceNodeId == elementId)
 					{
 						continue;
 					}
 
+					const Edge::EdgeType edgeType = Edge::intToType(edge.type);
 					if (nodeType.isUsable() && (edgeType & Edge::EDGE_TYPE_USAGE) &&
 						m_hierarchyCache.isChildOfVisibleNodeOrInvisible(edge.sourceNodeId) &&
 						(m_hierarchyCache.getLastVisibleParentNodeId(edge.targetNodeId) !=
@@ -1293,24 +1317,28 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 {
 	TRACE();
 
-	std::set<Id> nodeIds;
-	std::set<Id> edgeIds;
+	const EdgeAdjacencyCache& edgeAdjacencyCache = getEdgeAdjacencyCache();
+
+	std::unordered_set<Id> nodeIds;
+	std::unordered_set<Id> edgeIds;
 
-	nodeIds.insert(originId ? originId : targetId);
+	const Id startNodeId = originId ? originId : targetId;
+	nodeIds.insert(startNodeId);
 	bool forward = originId != 0;
 	size_t currentDepth = 0;
 
-	std::vector<Id> nodeIdsToProcess = {*nodeIds.begin()};
+	std::vector<Id> nodeIdsToProcess = {startNodeId};
 
+	// parents and edges may be added twice, the trail is collected into sets at the end
 	struct TrailNode
 	{
 		Id id = 0;
-		std::set<TrailNode*> parents;
-		std::set<Id> edgeIds;
+		std::vector<TrailNode*> parents;
+		std::vector<Id> edgeIds;
 	};
 
 	bool isTerminatedTrail = originId && targetId;
-	std::map<Id, TrailNode> trailNodes;
+	std::unordered_map<Id, TrailNode> trailNodes;
 
 	if (isTerminatedTrail)
 	{
@@ -1321,24 +1349,34 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 
 	while (nodeIdsToProcess.size() && (!depth || currentDepth < depth))
 	{
-		std::vector<StorageEdge> edges = forward
-			? m_sqliteIndexStorage.getEdgesBySourceIds(nodeIdsToProcess)
-			: m_sqliteIndexStorage.getEdgesByTargetIds(nodeIdsToProcess);
+		std::vector<StorageEdge> edges;
+		if (forward)
+		{
+			edgeAdjacencyCache.addEdgesBySourceIds(nodeIdsToProcess, edgeTypes, &edges);
+		}
+		else
+		{
+			edgeAdjacencyCache.addEdgesByTargetIds(nodeIdsToProcess, edgeTypes, &edges);
+		}
 
 		if (!directed || edgeTypes & Edge::LAYOUT_VERTICAL)
 		{
-			utility::append(
-				edges,
-				forward ? m_sqliteIndexStorage.getEdgesByTargetIds(nodeIdsToProcess)
-						: m_sqliteIndexStorage.getEdgesBySourceIds(nodeIdsToProcess));
+			if (forward)
+			{
+				edgeAdjacencyCache.addEdgesByTargetIds(nodeIdsToProcess, edgeTypes, &edges);
+			}
+			else
+			{
+				edgeAdjacencyCache.addEdgesBySourceIds(nodeIdsToProcess, edgeTypes, &edges);
+			}
 		}
 
 		std::vector<Id> nodeIdsToCheck;
-		std::map<Id, std::vector<StorageEdge>> edgesToInsert;
+		std::unordered_map<Id, std::vector<StorageEdge>> edgesToInsert;
 
 		for (const StorageEdge& edge: edges)
 		{
-			if (Edge::intToType(edge.type) & edgeTypes && edgeIds.find(edge.id) == edgeIds.end())
+			if (edgeIds.find(edge.id) == edgeIds.end())
 			{
 				bool isForward = forward == !(Edge::intToType(edge.type) & Edge::LAYOUT_VERTICAL);
 
@@ -1368,8 +1406,8 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 						TrailNode& origin = trailNodes[sourceNodeId];
 						target.id = targetNodeId;
 						origin.id = sourceNodeId;
-						target.parents.insert(&origin);
-						target.edgeIds.insert(edge.id);
+						target.parents.push_back(&origin);
+						target.edgeIds.push_back(edge.id);
 					}
 				}
 			}
@@ -1427,13 +1465,13 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(
 
 						for (const StorageEdge& edge: edgesToInsert[node.id])
 						{
-							targetNode.edgeIds.insert(edge.id);
+							targetNode.edgeIds.push_back(edge.id);
 
 							Id sourceNodeId =
 								(edge.targetNodeId == node.id ? edge.sourceNodeId
 															  : edge.targetNodeId);
 							TrailNode& oldNode = trailNodes[sourceNodeId];
-							targetNode.parents.insert(&oldNode);
+							targetNode.parents.push_back(&oldNode);
 						}
 					}
 				}
@@ -1742,6 +1780,19 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getSourceLocationsF
 	return collection;
 }
 
+std::shared_ptr<SourceLocationCollection> PersistentStorage::getSourceLocationsOfType(
+	LocationType type) const
+{
+	TRACE();
+
+	std::vector<Id> locationIds;
+	m_sqliteIndexStorage.forEachOfType<StorageSourceLocation>(
+		locationTypeToInt(type),
+		[&locationIds](StorageSourceLocation&& location) { locationIds.push_back(location.id); });
+
+	return getSourceLocationsForLocationIds(locationIds);
+}
+
 std::shared_ptr<SourceLocationFile> PersistentStorage::getSourceLocationsForFile(
 	const FilePath& filePath) const
 {
@@ -2348,8 +2399,9 @@ TooltipSnippet PersistentStorage::getTooltipSnippetForNode(const StorageNode& no
 				size_t delimiterPos = code.rfind(delimiter, annotation.startPos);
 
 				// if is function name itself, replace with qualified name
-				if (utility::containsElement(
-						file->getSourceLocationById(annotation.locationId)->getTokenIds(), node.id) &&
+				const std::span<const Id> tokenIds =
+					file->getSourceLocationById(annotation.locationId)->getTokenIds();
+				if (std::find(tokenIds.begin(), tokenIds.end(), node.id) != tokenIds.end() &&
 					(delimiterPos == std::wstring::npos ||
 					 delimiterPos < annotation.startPos - delimiter.size()) &&
 					text.size() <= nameHierarchy.getRawName().size())
@@ -2385,7 +2437,7 @@ TooltipSnippet PersistentStorage::getTooltipSnippetForNode(const StorageNode& no
 					snippet.locationFile->addSourceLocation(
 						loc->getType(),
 						loc->getLocationId(),
-						loc->getTokenIds(),
+						std::vector<Id>(loc->getTokenIds().begin(), loc->getTokenIds().end()),
 						1,
 						pos + 1,
 						1,
@@ -2552,15 +2604,16 @@ Id PersistentStorage::getFileNodeId(const FilePath& filePath) const
 	}
 
 	{
-		std::map<FilePath, Id>::const_iterator it = m_fileNodeIds.find(filePath);
+		std::unordered_map<FilePathHandle, Id>::const_iterator it = m_fileNodeIds.find(
+			FilePathHandle::find(filePath));
 		if (it != m_fileNodeIds.end())
 		{
 			return it->second;
 		}
 	}
 	{
-		std::map<FilePath, Id>::const_iterator it = m_lowerCasefileNodeIds.find(
-			filePath.getLowerCase());
+		std::unordered_map<FilePathHandle, Id>::const_iterator it = m_lowerCasefileNodeIds.find(
+			FilePathHandle::find(filePath.getLowerCase()));
 		if (it != m_lowerCasefileNodeIds.end())
 		{
 			return it->second;
@@ -2598,11 +2651,11 @@ FilePath PersistentStorage::getFileNodePath(Id fileId) const
 		return FilePath();
 	}
 
-	std::map<Id, FilePath>::const_iterator it = m_fileNodePaths.find(fileId);
+	std::map<Id, FilePathHandle>::const_iterator it = m_fileNodePaths.find(fileId);
 
 	if (it != m_fileNodePaths.end())
 	{
-		return it->second;
+		return it->second.getFilePath();
 	}
 
 	return FilePath();
@@ -2874,7 +2927,6 @@ void PersistentStorage::addFileNodeToGraph(const StorageNode& storageNode, Graph
 void PersistentStorage::addNodeToGraph(
 	const StorageNode& newNode, const NodeType& type, Graph* graph, bool addChildCount) const
 {
-	NameHierarchy nameHierarchy = NameHierarchy::deserialize(newNode.serializedName);
 	DefinitionKind defKind = DEFINITION_NONE;
 	auto it = m_symbolDefinitionKinds.find(newNode.id);
 	if (it != m_symbolDefinitionKinds.end())
@@ -2882,7 +2934,8 @@ void PersistentStorage::addNodeToGraph(
 		defKind = it->second;
 	}
 
-	Node* node = graph->createNode(newNode.id, type, std::move(nameHierarchy), defKind);
+	Node* node = graph->createNodeWithSerializedName(
+		newNode.id, type, newNode.serializedName, defKind);
 
 	if (addChildCount)
 	{
@@ -2996,8 +3049,10 @@ void PersistentStorage::addBundledEdgesToGraph(
 		connectedNodeIds[isSource ? edge.targetNodeId : edge.sourceNodeId].push_back(edgeInfo);
 	}
 
-	const std::vector<StorageEdge> outgoingEdges = m_sqliteIndexStorage.getEdgesBySourceIds(
-		childNodeIds);
+	const EdgeAdjacencyCache& edgeAdjacencyCache = getEdgeAdjacencyCache();
+
+	std::vector<StorageEdge> outgoingEdges;
+	edgeAdjacencyCache.addEdgesBySourceIds(childNodeIds, ~0, &outgoingEdges);
 	for (const StorageEdge& outEdge: outgoingEdges)
 	{
 		EdgeInfo edgeInfo;
@@ -3006,8 +3061,8 @@ void PersistentStorage::addBundledEdgesToGraph(
 		connectedNodeIds[outEdge.targetNodeId].push_back(edgeInfo);
 	}
 
-	const std::vector<StorageEdge> incomingEdges = m_sqliteIndexStorage.getEdgesByTargetIds(
-		childNodeIds);
+	std::vector<StorageEdge> incomingEdges;
+	edgeAdjacencyCache.addEdgesByTargetIds(childNodeIds, ~0, &incomingEdges);
 	for (const StorageEdge& inEdge: incomingEdges)
 	{
 		EdgeInfo edgeInfo;
@@ -3245,9 +3300,11 @@ void PersistentStorage::buildFilePathMaps()
 	m_sqliteIndexStorage.forEach<StorageFile>([&](StorageFile&& file) {
 		const FilePath path(file.filePath);
 
-		m_fileNodeIds.emplace(path, file.id);
-		m_lowerCasefileNodeIds.emplace(path.getLowerCase(), file.id);
-		m_fileNodePaths.emplace(file.id, path);
+		const FilePathHandle pathHandle = FilePathHandle::intern(path);
+
+		m_fileNodeIds.emplace(pathHandle, file.id);
+		m_lowerCasefileNodeIds.emplace(FilePathHandle::intern(path.getLowerCase()), file.id);
+		m_fileNodePaths.emplace(file.id, pathHandle);
 		m_fileNodeComplete.emplace(file.id, file.complete);
 		m_fileNodeIndexed.emplace(file.id, file.indexed);
 		m_fileNodeLanguage.emplace(file.id, file.languageIdentifier);
@@ -3282,7 +3339,7 @@ void PersistentStorage::buildSearchIndex()
 			auto it = m_fileNodePaths.find(node.id);
 			if (it != m_fileNodePaths.end())
 			{
-				FilePath filePath(it->second);
+				FilePath filePath(it->second.getFilePath());
 
 				if (filePath.exists())
 				{
@@ -3332,36 +3389,20 @@ void PersistentStorage::buildFullTextSearchIndex() const
 
 	m_fullTextSearchIndex.clear();
 
-	std::vector<std::shared_ptr<std::thread>> threads;
+	std::vector<StorageFile> indexedFiles;
+	for (const StorageFile& file: m_sqliteIndexStorage.getAll<StorageFile>())
 	{
-		std::vector<StorageFile> indexedFiles;
-		for (const StorageFile& file: m_sqliteIndexStorage.getAll<StorageFile>())
+		if (file.indexed)
 		{
-			if (file.indexed)
-			{
-				indexedFiles.push_back(file);
-			}
-		}
-		for (std::vector<StorageFile> part:
-			 utility::splitToEquallySizedParts(indexedFiles, utility::getIdealThreadCount()))
-		{
-			std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-				[&](const std::vector<StorageFile>& files) {
-					for (const StorageFile& file: files)
-					{
-						m_fullTextSearchIndex.addFile(
-							file.id,
-							codec.decode(m_sqliteIndexStorage.getFileContentById(file.id)->getText()));
-					}
-				},
-				part);
-			threads.push_back(thread);
+			indexedFiles.push_back(file);
 		}
 	}
-	for (std::shared_ptr<std::thread> thread: threads)
-	{
-		thread->join();
-	}
+
+	ThreadPool::getInstance()->parallelFor(indexedFiles.size(), [&](size_t fileIndex) {
+		const StorageFile& file = indexedFiles[fileIndex];
+		m_fullTextSearchIndex.addFile(
+			file.id, codec.decode(m_sqliteIndexStorage.getFileContentById(file.id)->getText()));
+	});
 }
 
 void PersistentStorage::buildMemberEdgeIdOrderMap()
@@ -3402,7 +3443,7 @@ void PersistentStorage::buildMemberEdgeIdOrderMap()
 			continue;
 		}
 
-		const FilePath path(m_fileNodePaths[location.fileNodeId]);
+		const FilePath path(m_fileNodePaths[location.fileNodeId].getFilePath());
 		if (path.extension() == L".java")
 		{
 			collection.addSourceLocation(
@@ -3495,3 +3536,20 @@ void PersistentStorage::buildHierarchyCache()
 			m_hierarchyCache.createInheritance(edge.id, edge.sourceNodeId, edge.targetNodeId);
 		});
 }
+
+const EdgeAdjacencyCache& PersistentStorage::getEdgeAdjacencyCache() const
+{
+	std::lock_guard<std::mutex> lock(m_edgeAdjacencyCacheMutex);
+	if (!m_edgeAdjacencyCacheBuilt)
+	{
+		TRACE("build edge adjacency cache");
+
+		std::vector<StorageEdge> edges;
+		m_sqliteIndexStorage.forEach<StorageEdge>(
+			[&edges](StorageEdge&& edge) { edges.emplace_back(std::move(edge)); });
+
+		m_edgeAdjacencyCache.build(edges);
+		m_edgeAdjacencyCacheBuilt = true;
+	}
+	return m_edgeAdjacencyCache;
+}
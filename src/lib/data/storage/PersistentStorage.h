@@ -2,8 +2,11 @@
 #define PERSISTENT_STORAGE_H
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
+#include "EdgeAdjacencyCache.h"
+#include "FilePathHandle.h"
 #include "FullTextSearchIndex.h"
 #include "HierarchyCache.h"
 #include "SearchIndex.h"
@@ -59,6 +62,9 @@ public:
 	void finishInjection() override;
 	void rollbackInjection();
 
+	// merges the index database of another storage into this one without opening it as storage
+	bool injectDatabase(const FilePath& dbFilePath);
+
 	const std::vector<ErrorInfo> getErrorInfos() const;
 
 	void beforeErrorRecording();
@@ -94,6 +100,9 @@ public:
 
 	void optimizeMemory();
 
+	// needs to be called before the index database file is copied
+	void checkpoint() const;
+
 	// StorageAccess implementation
 	Id getNodeIdForFileNode(const FilePath& filePath) const override;
 	Id getNodeIdForNameHierarchy(const NameHierarchy& nameHierarchy) const override;
@@ -108,6 +117,7 @@ public:
 	NodeType getNodeTypeForNodeWithId(Id nodeId) const override;
 
 	StorageEdge getEdgeById(Id edgeId) const override;
+	std::vector<StorageEdge> getEdgesByIds(const std::vector<Id>& edgeIds) const;
 
 	std::shared_ptr<SourceLocationCollection> getFullTextSearchLocations(
 		const std::wstring& searchTerm, bool caseSensitive) const override;
@@ -151,6 +161,7 @@ public:
 		const std::vector<Id>& tokenIds) const override;
 	std::shared_ptr<SourceLocationCollection> getSourceLocationsForLocationIds(
 		const std::vector<Id>& locationIds) const override;
+	std::shared_ptr<SourceLocationCollection> getSourceLocationsOfType(LocationType type) const;
 
 	std::shared_ptr<SourceLocationFile> getSourceLocationsForFile(const FilePath& filePath) const override;
 	std::shared_ptr<SourceLocationFile> getSourceLocationsForLinesInFile(
@@ -261,6 +272,9 @@ private:
 	void buildMemberEdgeIdOrderMap();
 	void buildHierarchyCache();
 
+	// built on first use, the caches are also rebuilt for temporary storages that never get queried
+	const EdgeAdjacencyCache& getEdgeAdjacencyCache() const;
+
 	bool m_preIndexingErrorCountSet = false;
 	size_t m_preIndexingErrorCount = 0;
 	size_t m_preInjectionErrorCount = 0;
@@ -276,9 +290,9 @@ private:
 	SqliteIndexStorage m_sqliteIndexStorage;
 	SqliteBookmarkStorage m_sqliteBookmarkStorage;
 
-	std::map<FilePath, Id> m_fileNodeIds;
-	std::map<FilePath, Id> m_lowerCasefileNodeIds;
-	std::map<Id, FilePath> m_fileNodePaths;
+	std::unordered_map<FilePathHandle, Id> m_fileNodeIds;
+	std::unordered_map<FilePathHandle, Id> m_lowerCasefileNodeIds;
+	std::map<Id, FilePathHandle> m_fileNodePaths;
 	std::map<Id, bool> m_fileNodeComplete;
 	std::unordered_map<Id, bool> m_fileNodeIndexed;
 	std::map<Id, std::wstring> m_fileNodeLanguage;
@@ -288,6 +302,10 @@ private:
 
 	HierarchyCache m_hierarchyCache;
 
+	mutable EdgeAdjacencyCache m_edgeAdjacencyCache;
+	mutable bool m_edgeAdjacencyCacheBuilt = false;
+	mutable std::mutex m_edgeAdjacencyCacheMutex;
+
 	bool m_hasJavaFiles = false;
 };
 
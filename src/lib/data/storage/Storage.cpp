@@ -16,7 +16,7 @@ void Storage::inject(Storage* injected)
 	startInjection();
 
 	{
-		// TRACE("inject errors");
+		TRACE("inject errors");
 
 		for (const StorageError& error: injected->getErrors())
 		{
@@ -26,7 +26,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject nodes");
+		TRACE("inject nodes");
 
 		const std::vector<StorageNode>& nodes = injected->getStorageNodes();
 
@@ -42,7 +42,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject files");
+		TRACE("inject files");
 
 		for (const StorageFile& file: injected->getStorageFiles())
 		{
@@ -61,7 +61,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject symbols");
+		TRACE("inject symbols");
 
 		std::vector<StorageSymbol> symbols = injected->getStorageSymbols();
 		for (size_t i = 0; i < symbols.size(); i++)
@@ -83,7 +83,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject edges");
+		TRACE("inject edges");
 
 		std::vector<StorageEdge> edges = injected->getStorageEdges();
 		for (size_t i = 0; i < edges.size(); i++)
@@ -132,7 +132,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject local symbols");
+		TRACE("inject local symbols");
 
 		const std::set<StorageLocalSymbol>& symbols = injected->getStorageLocalSymbols();
 		std::vector<Id> symbolIds = addLocalSymbols(symbols);
@@ -149,7 +149,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject locations");
+		TRACE("inject locations");
 
 		const std::set<StorageSourceLocation>& oldLocations = injected->getStorageSourceLocations();
 		std::vector<StorageSourceLocation> locations;
@@ -191,7 +191,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject occurrences");
+		TRACE("inject occurrences");
 
 		const std::set<StorageOccurrence>& oldOccurrences = injected->getStorageOccurrences();
 
@@ -233,7 +233,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject element components");
+		TRACE("inject element components");
 
 		const std::set<StorageElementComponent>& oldComponents = injected->getElementComponents();
 		std::vector<StorageElementComponent> components;
@@ -252,7 +252,7 @@ void Storage::inject(Storage* injected)
 	}
 
 	{
-		// TRACE("inject accesses");
+		TRACE("inject accesses");
 
 		const std::set<StorageComponentAccess>& oldAccesses = injected->getComponentAccesses();
 		std::vector<StorageComponentAccess> accesses;
@@ -11,6 +11,7 @@
 
 void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 {
+	std::lock_guard<std::shared_mutex> lock(m_subjectMutex);
 	m_subject = subject;
 }
 
@@ -19,6 +20,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 #define DEF_GETTER_0(_METHOD_NAME_, _RETURN_TYPE_, _DEFAULT_VALUE_)                                \
 	UNWRAP(_RETURN_TYPE_) StorageAccessProxy::_METHOD_NAME_() const                                \
 	{                                                                                              \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                  \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                             \
 		{                                                                                          \
 			return subject->_METHOD_NAME_();                                                       \
@@ -29,6 +31,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 #define DEF_GETTER_1(_METHOD_NAME_, _PARAM_1_TYPE_, _RETURN_TYPE_, _DEFAULT_VALUE_)                \
 	UNWRAP(_RETURN_TYPE_) StorageAccessProxy::_METHOD_NAME_(_PARAM_1_TYPE_ p1) const               \
 	{                                                                                              \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                  \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                             \
 		{                                                                                          \
 			return subject->_METHOD_NAME_(p1);                                                     \
@@ -40,6 +43,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 	UNWRAP(_RETURN_TYPE_)                                                                           \
 	StorageAccessProxy::_METHOD_NAME_(_PARAM_1_TYPE_ p1, _PARAM_2_TYPE_ p2) const                   \
 	{                                                                                               \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                   \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                              \
 		{                                                                                           \
 			return subject->_METHOD_NAME_(p1, p2);                                                  \
@@ -52,6 +56,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 	UNWRAP(_RETURN_TYPE_)                                                                            \
 	StorageAccessProxy::_METHOD_NAME_(_PARAM_1_TYPE_ p1, _PARAM_2_TYPE_ p2, _PARAM_3_TYPE_ p3) const \
 	{                                                                                                \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                    \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                               \
 		{                                                                                            \
 			return subject->_METHOD_NAME_(p1, p2, p3);                                               \
@@ -71,6 +76,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 	StorageAccessProxy::_METHOD_NAME_(                                                             \
 		_PARAM_1_TYPE_ p1, _PARAM_2_TYPE_ p2, _PARAM_3_TYPE_ p3, _PARAM_4_TYPE_ p4) const          \
 	{                                                                                              \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                  \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                             \
 		{                                                                                          \
 			return subject->_METHOD_NAME_(p1, p2, p3, p4);                                         \
@@ -92,6 +98,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 		_PARAM_1_TYPE_ p1, _PARAM_2_TYPE_ p2, _PARAM_3_TYPE_ p3, _PARAM_4_TYPE_ p4, _PARAM_5_TYPE_ p5) \
 		const                                                                                          \
 	{                                                                                                  \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                      \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                                 \
 		{                                                                                              \
 			return subject->_METHOD_NAME_(p1, p2, p3, p4, p5);                                         \
@@ -118,6 +125,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 		_PARAM_5_TYPE_ p5,                                                                         \
 		_PARAM_6_TYPE_ p6) const                                                                   \
 	{                                                                                              \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                  \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                             \
 		{                                                                                          \
 			return subject->_METHOD_NAME_(p1, p2, p3, p4, p5, p6);                                 \
@@ -146,6 +154,7 @@ void StorageAccessProxy::setSubject(std::weak_ptr<StorageAccess> subject)
 		_PARAM_6_TYPE_ p6,                                                                         \
 		_PARAM_7_TYPE_ p7) const                                                                   \
 	{                                                                                              \
+		std::shared_lock<std::shared_mutex> lock(m_subjectMutex);                                  \
 		if (std::shared_ptr<StorageAccess> subject = m_subject.lock())                             \
 		{                                                                                          \
 			return subject->_METHOD_NAME_(p1, p2, p3, p4, p5, p6, p7);                             \
@@ -251,6 +260,7 @@ DEF_GETTER_1(
 
 Id StorageAccessProxy::addNodeBookmark(const NodeBookmark& bookmark)
 {
+	std::lock_guard<std::shared_mutex> lock(m_subjectMutex);
 	if (std::shared_ptr<StorageAccess> subject = m_subject.lock())
 	{
 		return subject->addNodeBookmark(bookmark);
@@ -261,6 +271,7 @@ Id StorageAccessProxy::addNodeBookmark(const NodeBookmark& bookmark)
 
 Id StorageAccessProxy::addEdgeBookmark(const EdgeBookmark& bookmark)
 {
+	std::lock_guard<std::shared_mutex> lock(m_subjectMutex);
 	if (std::shared_ptr<StorageAccess> subject = m_subject.lock())
 	{
 		return subject->addEdgeBookmark(bookmark);
@@ -271,6 +282,7 @@ Id StorageAccessProxy::addEdgeBookmark(const EdgeBookmark& bookmark)
 
 Id StorageAccessProxy::addBookmarkCategory(const std::wstring& categoryName)
 {
+	std::lock_guard<std::shared_mutex> lock(m_subjectMutex);
 	if (std::shared_ptr<StorageAccess> subject = m_subject.lock())
 	{
 		return subject->addBookmarkCategory(categoryName);
@@ -285,6 +297,7 @@ void StorageAccessProxy::updateBookmark(
 	const std::wstring& comment,
 	const std::wstring& categoryName)
 {
+	std::lock_guard<std::shared_mutex> lock(m_subjectMutex);
 	if (std::shared_ptr<StorageAccess> subject = m_subject.lock())
 	{
 		subject->updateBookmark(bookmarkId, name, comment, categoryName);
@@ -293,6 +306,7 @@ void StorageAccessProxy::updateBookmark(
 
 void StorageAccessProxy::removeBookmark(const Id id)
 {
+	std::lock_guard<std::shared_mutex> lock(m_subjectMutex);
 	if (std::shared_ptr<StorageAccess> subject = m_subject.lock())
 	{
 		subject->removeBookmark(id);
@@ -301,6 +315,7 @@ void StorageAccessProxy::removeBookmark(const Id id)
 
 void StorageAccessProxy::removeBookmarkCategory(const Id id)
 {
+	std::lock_guard<std::shared_mutex> lock(m_subjectMutex);
 	if (std::shared_ptr<StorageAccess> subject = m_subject.lock())
 	{
 		subject->removeBookmarkCategory(id);
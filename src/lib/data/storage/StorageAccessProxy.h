@@ -2,6 +2,7 @@
 #define STORAGE_ACCESS_PROXY_H
 
 #include <memory>
+#include <shared_mutex>
 
 #include "StorageAccess.h"
 
@@ -10,7 +11,7 @@ class StorageAccessProxy: public StorageAccess
 public:
 	StorageAccessProxy() = default;
 
-	void setSubject(std::weak_ptr<StorageAccess> subject);
+	virtual void setSubject(std::weak_ptr<StorageAccess> subject);
 
 	// StorageAccess implementation
 	Id getNodeIdForFileNode(const FilePath& filePath) const override;
@@ -106,6 +107,9 @@ public:
 		const std::vector<Id>& locationIds, const std::vector<Id>& localSymbolIds) const override;
 
 private:
+	// Queries of several threads run on the subject at the same time, exchanging the subject and
+	// changing bookmarks waits until the running queries are done.
+	mutable std::shared_mutex m_subjectMutex;
 	std::weak_ptr<StorageAccess> m_subject;
 };
 
@@ -1,10 +1,65 @@
 #include "StorageCache.h"
 
+#include <set>
+
+#include "Graph.h"
+#include "Node.h"
+#include "SourceLocation.h"
 #include "SourceLocationCollection.h"
 #include "SourceLocationFile.h"
 #include "TextAccess.h"
+#include "logging.h"
 #include "utility.h"
 
+namespace
+{
+// the storage needs to be idle for this long before values get prefetched
+const std::chrono::milliseconds PREFETCH_IDLE_DELAY(300);
+
+// per graph or reference request, only the first tokens and files are prefetched
+const size_t MAX_PREFETCHED_TOKEN_COUNT = 64;
+const size_t MAX_PREFETCHED_FILE_COUNT = 16;
+const size_t MAX_PREFETCH_REQUEST_COUNT = 256;
+
+// files of a prefetched token that get their content and snippet locations prefetched as well
+const size_t MAX_PREFETCHED_FILE_COUNT_PER_TOKEN = 4;
+
+// the locations of tokens with more references take too long to load in the background
+const size_t MAX_PREFETCHED_REFERENCE_COUNT = 256;
+}	 // namespace
+
+float StorageCache::CacheStats::getHitRate() const
+{
+	if (!hitCount && !missCount)
+	{
+		return 0.0f;
+	}
+	return static_cast<float>(hitCount) / static_cast<float>(hitCount + missCount);
+}
+
+StorageCache::StorageCache()
+	: m_activeTokenIds(1024)
+	, m_sourceLocationsForTokenIds(128)
+	, m_sourceLocationsOfTypeInFile(256)
+	, m_fileContents(64)
+	, m_tooltipInfos(256)
+{
+}
+
+StorageCache::~StorageCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		m_stopped = true;
+	}
+	m_prefetchCondition.notify_one();
+
+	if (m_prefetchThread.joinable())
+	{
+		m_prefetchThread.join();
+	}
+}
+
 void StorageCache::clear()
 {
 	m_graphForAll.reset();
@@ -12,6 +67,46 @@ void StorageCache::clear()
 	m_storageStats = StorageStats();
 
 	setUseErrorCache(false);
+
+	const CacheStats stats = getCacheStats();
+	if (stats.hitCount || stats.missCount)
+	{
+		LOG_INFO(
+			"Storage cache: " + std::to_string(stats.hitCount) + " hits, " +
+			std::to_string(stats.missCount) + " misses (" +
+			std::to_string(static_cast<int>(stats.getHitRate() * 100)) + "% hit rate), " +
+			std::to_string(stats.prefetchCount) + " values prefetched");
+	}
+}
+
+void StorageCache::setSubject(std::weak_ptr<StorageAccess> subject)
+{
+	// values the prefetch thread loads from the old subject get dropped, because they are stored
+	// for an older generation
+	StorageAccessProxy::setSubject(subject);
+	clearCaches();
+}
+
+StorageCache::CacheStats StorageCache::getCacheStats() const
+{
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+	CacheStats stats;
+	stats.hitCount = m_activeTokenIds.getHitCount() + m_sourceLocationsForTokenIds.getHitCount() +
+		m_sourceLocationsOfTypeInFile.getHitCount() + m_fileContents.getHitCount() +
+		m_tooltipInfos.getHitCount();
+	stats.missCount = m_activeTokenIds.getMissCount() +
+		m_sourceLocationsForTokenIds.getMissCount() + m_sourceLocationsOfTypeInFile.getMissCount() +
+		m_fileContents.getMissCount() + m_tooltipInfos.getMissCount();
+	stats.prefetchCount = m_prefetchCount;
+	return stats;
+}
+
+bool StorageCache::waitForPrefetchCount(size_t prefetchCount, std::chrono::milliseconds timeout) const
+{
+	std::unique_lock<std::mutex> lock(m_cacheMutex);
+	return m_prefetchCountCondition.wait_for(
+		lock, timeout, [this, prefetchCount]() { return m_prefetchCount >= prefetchCount; });
 }
 
 std::shared_ptr<Graph> StorageCache::getGraphForAll() const
@@ -24,6 +119,31 @@ std::shared_ptr<Graph> StorageCache::getGraphForAll() const
 	return m_graphForAll;
 }
 
+std::shared_ptr<Graph> StorageCache::getGraphForActiveTokenIds(
+	const std::vector<Id>& tokenIds, const std::vector<Id>& expandedNodeIds, bool* isActiveNamespace) const
+{
+	notifyRequest();
+
+	std::shared_ptr<Graph> graph = StorageAccessProxy::getGraphForActiveTokenIds(
+		tokenIds, expandedNodeIds, isActiveNamespace);
+
+	if (graph)
+	{
+		std::vector<Id> nodeIds;
+		graph->forEachNode([&nodeIds](Node* node) {
+			// namespaces and files are referenced from almost everywhere
+			if (nodeIds.size() < MAX_PREFETCHED_TOKEN_COUNT && !node->getType().isPackage() &&
+				!node->getType().isFile())
+			{
+				nodeIds.push_back(node->getId());
+			}
+		});
+		prefetch(nodeIds, TOOLTIP_ORIGIN_GRAPH, {});
+	}
+
+	return graph;
+}
+
 StorageStats StorageCache::getStorageStats() const
 {
 	if (!m_storageStats.nodeCount)
@@ -34,14 +154,179 @@ StorageStats StorageCache::getStorageStats() const
 	return m_storageStats;
 }
 
+std::vector<Id> StorageCache::getActiveTokenIdsForId(Id tokenId, Id* declarationId) const
+{
+	notifyRequest();
+
+	if (m_useErrorCache)
+	{
+		return StorageAccessProxy::getActiveTokenIdsForId(tokenId, declarationId);
+	}
+
+	size_t generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (const ActiveTokenIds* cached = m_activeTokenIds.getValue(tokenId))
+		{
+			if (cached->declarationId)
+			{
+				*declarationId = cached->declarationId;
+			}
+			return cached->tokenIds;
+		}
+		generation = m_generation;
+	}
+
+	ActiveTokenIds activeTokenIds;
+	activeTokenIds.tokenIds = StorageAccessProxy::getActiveTokenIdsForId(
+		tokenId, &activeTokenIds.declarationId);
+
+	if (activeTokenIds.declarationId)
+	{
+		*declarationId = activeTokenIds.declarationId;
+	}
+
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	if (generation == m_generation)
+	{
+		m_activeTokenIds.setValue(tokenId, activeTokenIds);
+	}
+	return activeTokenIds.tokenIds;
+}
+
+std::shared_ptr<SourceLocationCollection> StorageCache::getSourceLocationsForTokenIds(
+	const std::vector<Id>& tokenIds) const
+{
+	notifyRequest();
+
+	if (m_useErrorCache)
+	{
+		return StorageAccessProxy::getSourceLocationsForTokenIds(tokenIds);
+	}
+
+	std::shared_ptr<const SourceLocationCollection> cached;
+	size_t generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (const std::shared_ptr<const SourceLocationCollection>* value =
+				m_sourceLocationsForTokenIds.getValue(tokenIds))
+		{
+			cached = *value;
+		}
+		generation = m_generation;
+	}
+
+	std::shared_ptr<SourceLocationCollection> collection;
+	if (cached)
+	{
+		collection = copyCollection(*cached);
+	}
+	else
+	{
+		collection = StorageAccessProxy::getSourceLocationsForTokenIds(tokenIds);
+
+		std::shared_ptr<const SourceLocationCollection> copy = copyCollection(*collection);
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (generation == m_generation)
+		{
+			m_sourceLocationsForTokenIds.setValue(tokenIds, copy);
+		}
+	}
+
+	std::vector<Id> referencedTokenIds;
+	std::vector<FilePath> filePaths;
+	{
+		std::set<Id> ids(tokenIds.begin(), tokenIds.end());
+		collection->forEachSourceLocationFile([&](std::shared_ptr<SourceLocationFile> file) {
+			if (filePaths.size() < MAX_PREFETCHED_FILE_COUNT)
+			{
+				filePaths.push_back(file->getFilePath());
+			}
+
+			file->forEachStartSourceLocation([&](SourceLocation* location) {
+				for (Id tokenId: location->getTokenIds())
+				{
+					if (referencedTokenIds.size() < MAX_PREFETCHED_TOKEN_COUNT &&
+						ids.insert(tokenId).second)
+					{
+						referencedTokenIds.push_back(tokenId);
+					}
+				}
+			});
+		});
+	}
+	prefetch(referencedTokenIds, TOOLTIP_ORIGIN_CODE, filePaths);
+
+	return collection;
+}
+
+std::shared_ptr<SourceLocationFile> StorageCache::getSourceLocationsOfTypeInFile(
+	const FilePath& filePath, LocationType type) const
+{
+	notifyRequest();
+
+	if (m_useErrorCache)
+	{
+		return StorageAccessProxy::getSourceLocationsOfTypeInFile(filePath, type);
+	}
+
+	size_t generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (const std::shared_ptr<const SourceLocationFile>* value =
+				m_sourceLocationsOfTypeInFile.getValue(std::make_pair(filePath, type)))
+		{
+			return std::make_shared<SourceLocationFile>(**value);
+		}
+		generation = m_generation;
+	}
+
+	std::shared_ptr<SourceLocationFile> file =
+		StorageAccessProxy::getSourceLocationsOfTypeInFile(filePath, type);
+
+	std::shared_ptr<const SourceLocationFile> copy = std::make_shared<SourceLocationFile>(*file);
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	if (generation == m_generation)
+	{
+		m_sourceLocationsOfTypeInFile.setValue(std::make_pair(filePath, type), copy);
+	}
+	return file;
+}
+
 std::shared_ptr<TextAccess> StorageCache::getFileContent(const FilePath& filePath, bool showsErrors) const
 {
-	if (m_useErrorCache && showsErrors)
+	notifyRequest();
+
+	if (m_useErrorCache)
+	{
+		if (showsErrors)
+		{
+			return TextAccess::createFromFile(filePath);
+		}
+
+		return StorageAccessProxy::getFileContent(filePath, showsErrors);
+	}
+
+	size_t generation = 0;
 	{
-		return TextAccess::createFromFile(filePath);
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (const std::shared_ptr<TextAccess>* value = m_fileContents.getValue(filePath))
+		{
+			return *value;
+		}
+		generation = m_generation;
 	}
 
-	return StorageAccessProxy::getFileContent(filePath, showsErrors);
+	std::shared_ptr<TextAccess> content = StorageAccessProxy::getFileContent(filePath, showsErrors);
+	if (content)
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (generation == m_generation)
+		{
+			m_fileContents.setValue(filePath, content);
+		}
+	}
+	return content;
 }
 
 ErrorCountInfo StorageCache::getErrorCount() const
@@ -113,6 +398,12 @@ void StorageCache::setUseErrorCache(bool enabled)
 	m_useErrorCache = enabled;
 	m_cachedErrors.clear();
 	m_errorCount = ErrorCountInfo();
+
+	// the storage changes while indexing, values cached before or during that are outdated
+	clearCaches();
+
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	m_prefetchPaused = enabled;
 }
 
 void StorageCache::addErrorsToCache(
@@ -121,3 +412,320 @@ void StorageCache::addErrorsToCache(
 	utility::append(m_cachedErrors, newErrors);
 	m_errorCount = errorCount;
 }
+
+TooltipInfo StorageCache::getTooltipInfoForTokenIds(
+	const std::vector<Id>& tokenIds, TooltipOrigin origin) const
+{
+	notifyRequest();
+
+	if (m_useErrorCache)
+	{
+		return StorageAccessProxy::getTooltipInfoForTokenIds(tokenIds, origin);
+	}
+
+	size_t generation = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (const TooltipInfo* value = m_tooltipInfos.getValue(std::make_pair(tokenIds, origin)))
+		{
+			return copyTooltipInfo(*value);
+		}
+		generation = m_generation;
+	}
+
+	TooltipInfo info = StorageAccessProxy::getTooltipInfoForTokenIds(tokenIds, origin);
+
+	TooltipInfo copy = copyTooltipInfo(info);
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	if (generation == m_generation)
+	{
+		m_tooltipInfos.setValue(std::make_pair(tokenIds, origin), std::move(copy));
+	}
+	return info;
+}
+
+std::shared_ptr<SourceLocationCollection> StorageCache::copyCollection(
+	const SourceLocationCollection& collection)
+{
+	std::shared_ptr<SourceLocationCollection> copy = std::make_shared<SourceLocationCollection>();
+	collection.forEachSourceLocationFile([&copy](std::shared_ptr<SourceLocationFile> file) {
+		copy->addSourceLocationFile(std::make_shared<SourceLocationFile>(*file));
+	});
+	return copy;
+}
+
+TooltipInfo StorageCache::copyTooltipInfo(const TooltipInfo& info)
+{
+	TooltipInfo copy = info;
+	for (TooltipSnippet& snippet: copy.snippets)
+	{
+		if (snippet.locationFile)
+		{
+			snippet.locationFile = std::make_shared<SourceLocationFile>(*snippet.locationFile);
+		}
+	}
+	return copy;
+}
+
+void StorageCache::clearCaches()
+{
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+	m_activeTokenIds.clear();
+	m_sourceLocationsForTokenIds.clear();
+	m_sourceLocationsOfTypeInFile.clear();
+	m_fileContents.clear();
+	m_tooltipInfos.clear();
+
+	m_prefetchRequests.clear();
+	m_generation++;
+}
+
+void StorageCache::notifyRequest() const
+{
+	m_lastRequestTime = std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void StorageCache::prefetch(
+	const std::vector<Id>& tokenIds, TooltipOrigin origin, const std::vector<FilePath>& filePaths) const
+{
+	if (tokenIds.empty() && filePaths.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (m_prefetchPaused || m_stopped)
+		{
+			return;
+		}
+
+		// the latest requests are prefetched first, tokens before files
+		std::vector<PrefetchRequest> requests;
+		for (Id tokenId: tokenIds)
+		{
+			requests.push_back({tokenId, origin, FilePath()});
+		}
+		for (const FilePath& filePath: filePaths)
+		{
+			requests.push_back({0, TOOLTIP_ORIGIN_NONE, filePath});
+		}
+		m_prefetchRequests.insert(m_prefetchRequests.begin(), requests.begin(), requests.end());
+
+		while (m_prefetchRequests.size() > MAX_PREFETCH_REQUEST_COUNT)
+		{
+			m_prefetchRequests.pop_back();
+		}
+
+		if (!m_prefetchThread.joinable())
+		{
+			m_prefetchThread = std::thread(&StorageCache::prefetchLoop, this);
+		}
+	}
+	m_prefetchCondition.notify_one();
+}
+
+void StorageCache::prefetchLoop() const
+{
+	std::unique_lock<std::mutex> lock(m_cacheMutex);
+	while (true)
+	{
+		m_prefetchCondition.wait(lock, [this]() {
+			return m_stopped || (!m_prefetchPaused && !m_prefetchRequests.empty());
+		});
+
+		if (m_stopped)
+		{
+			return;
+		}
+
+		const std::chrono::steady_clock::duration idleTime = std::chrono::steady_clock::now() -
+			std::chrono::steady_clock::time_point(
+				std::chrono::steady_clock::duration(m_lastRequestTime.load()));
+		if (idleTime < PREFETCH_IDLE_DELAY)
+		{
+			m_prefetchCondition.wait_for(lock, PREFETCH_IDLE_DELAY - idleTime);
+			continue;
+		}
+
+		const PrefetchRequest request = m_prefetchRequests.front();
+		m_prefetchRequests.pop_front();
+		const PrefetchState state = {m_generation, m_lastRequestTime.load()};
+		lock.unlock();
+
+		if (request.tokenId)
+		{
+			prefetchToken(request.tokenId, request.origin, state);
+		}
+		else
+		{
+			prefetchFile(request.filePath, state);
+		}
+
+		lock.lock();
+	}
+}
+
+bool StorageCache::isPrefetchInterrupted(const PrefetchState& state) const
+{
+	return m_lastRequestTime.load() != state.lastRequestTime;
+}
+
+void StorageCache::prefetchToken(Id tokenId, TooltipOrigin origin, const PrefetchState& state) const
+{
+	bool hasActiveTokenIds = false;
+	bool hasTooltipInfo = false;
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		hasActiveTokenIds = m_activeTokenIds.contains(tokenId);
+		hasTooltipInfo = m_tooltipInfos.contains(std::make_pair(std::vector<Id>{tokenId}, origin));
+	}
+
+	// the request is dropped as soon as the user queries the storage again
+	ActiveTokenIds activeTokenIds;
+	activeTokenIds.tokenIds = StorageAccessProxy::getActiveTokenIdsForId(
+		tokenId, &activeTokenIds.declarationId);
+	if (isPrefetchInterrupted(state))
+	{
+		return;
+	}
+
+	bool hasCollection = false;
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		hasCollection = m_sourceLocationsForTokenIds.contains(activeTokenIds.tokenIds);
+	}
+
+	// the active token ids are the token and the edges referencing it
+	std::shared_ptr<const SourceLocationCollection> collection;
+	if (!hasCollection && !activeTokenIds.tokenIds.empty() &&
+		activeTokenIds.tokenIds.size() <= MAX_PREFETCHED_REFERENCE_COUNT + 1)
+	{
+		collection = StorageAccessProxy::getSourceLocationsForTokenIds(activeTokenIds.tokenIds);
+		if (isPrefetchInterrupted(state))
+		{
+			return;
+		}
+	}
+
+	TooltipInfo tooltipInfo;
+	if (!hasTooltipInfo)
+	{
+		tooltipInfo = StorageAccessProxy::getTooltipInfoForTokenIds({tokenId}, origin);
+		if (isPrefetchInterrupted(state))
+		{
+			return;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		if (state.generation != m_generation)
+		{
+			return;
+		}
+
+		if (!hasActiveTokenIds)
+		{
+			m_activeTokenIds.setValue(tokenId, activeTokenIds);
+			m_prefetchCount++;
+		}
+		if (collection)
+		{
+			m_sourceLocationsForTokenIds.setValue(activeTokenIds.tokenIds, collection);
+			m_prefetchCount++;
+		}
+		if (!hasTooltipInfo)
+		{
+			m_tooltipInfos.setValue(
+				std::make_pair(std::vector<Id>{tokenId}, origin), std::move(tooltipInfo));
+			m_prefetchCount++;
+		}
+	}
+	m_prefetchCountCondition.notify_all();
+
+	if (collection)
+	{
+		size_t fileCount = 0;
+		for (const auto& p: collection->getSourceLocationFiles())
+		{
+			if (fileCount++ == MAX_PREFETCHED_FILE_COUNT_PER_TOKEN || isPrefetchInterrupted(state))
+			{
+				break;
+			}
+			prefetchFile(p.first, state);
+		}
+	}
+}
+
+void StorageCache::prefetchFile(const FilePath& filePath, const PrefetchState& state) const
+{
+	bool hasContent = false;
+	bool hasScopeLocations = false;
+	bool hasCommentLocations = false;
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		hasContent = m_fileContents.contains(filePath);
+		hasScopeLocations = m_sourceLocationsOfTypeInFile.contains(
+			std::make_pair(filePath, LOCATION_SCOPE));
+		hasCommentLocations = m_sourceLocationsOfTypeInFile.contains(
+			std::make_pair(filePath, LOCATION_COMMENT));
+	}
+
+	// the locations of these types are needed to build the snippets of the file
+	std::shared_ptr<TextAccess> content;
+	if (!hasContent)
+	{
+		content = StorageAccessProxy::getFileContent(filePath, false);
+		if (isPrefetchInterrupted(state))
+		{
+			return;
+		}
+	}
+
+	std::shared_ptr<const SourceLocationFile> scopeLocations;
+	if (!hasScopeLocations)
+	{
+		scopeLocations = StorageAccessProxy::getSourceLocationsOfTypeInFile(filePath, LOCATION_SCOPE);
+		if (isPrefetchInterrupted(state))
+		{
+			return;
+		}
+	}
+
+	std::shared_ptr<const SourceLocationFile> commentLocations;
+	if (!hasCommentLocations)
+	{
+		commentLocations = StorageAccessProxy::getSourceLocationsOfTypeInFile(
+			filePath, LOCATION_COMMENT);
+		if (isPrefetchInterrupted(state))
+		{
+			return;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	if (state.generation != m_generation)
+	{
+		return;
+	}
+
+	if (content)
+	{
+		m_fileContents.setValue(filePath, content);
+		m_prefetchCount++;
+	}
+	if (scopeLocations)
+	{
+		m_sourceLocationsOfTypeInFile.setValue(std::make_pair(filePath, LOCATION_SCOPE), scopeLocations);
+		m_prefetchCount++;
+	}
+	if (commentLocations)
+	{
+		m_sourceLocationsOfTypeInFile.setValue(
+			std::make_pair(filePath, LOCATION_COMMENT), commentLocations);
+		m_prefetchCount++;
+	}
+	m_prefetchCountCondition.notify_all();
+}
@@ -1,19 +1,62 @@
 #ifndef STORAGE_CACHE_H
 #define STORAGE_CACHE_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
 
+#include "FilePath.h"
+#include "LruCache.h"
 #include "StorageAccessProxy.h"
+#include "TooltipInfo.h"
 
+// Besides the values cached for the whole storage, the most recently used source locations, file
+// contents and tooltips are kept in bounded caches. After a graph or the references of a token were
+// requested, a background thread loads these values for the shown nodes and files once the storage
+// has not been queried for a while, so activating one of them next is served from the caches. The
+// background thread stops loading as soon as the storage gets queried again.
 class StorageCache: public StorageAccessProxy
 {
 public:
+	struct CacheStats
+	{
+		float getHitRate() const;
+
+		size_t hitCount = 0;
+		size_t missCount = 0;
+		size_t prefetchCount = 0;
+	};
+
+	StorageCache();
+	~StorageCache() override;
+
 	void clear();
 
+	void setSubject(std::weak_ptr<StorageAccess> subject) override;
+
+	CacheStats getCacheStats() const;
+	// returns false if fewer values were prefetched in total when the timeout expired
+	bool waitForPrefetchCount(size_t prefetchCount, std::chrono::milliseconds timeout) const;
+
 	std::shared_ptr<Graph> getGraphForAll() const override;
+	std::shared_ptr<Graph> getGraphForActiveTokenIds(
+		const std::vector<Id>& tokenIds,
+		const std::vector<Id>& expandedNodeIds,
+		bool* isActiveNamespace = nullptr) const override;
 
 	StorageStats getStorageStats() const override;
 
+	std::vector<Id> getActiveTokenIdsForId(Id tokenId, Id* declarationId) const override;
+
+	std::shared_ptr<SourceLocationCollection> getSourceLocationsForTokenIds(
+		const std::vector<Id>& tokenIds) const override;
+	std::shared_ptr<SourceLocationFile> getSourceLocationsOfTypeInFile(
+		const FilePath& filePath, LocationType type) const override;
+
 	std::shared_ptr<TextAccess> getFileContent(const FilePath& filePath, bool showsErrors) const override;
 
 	ErrorCountInfo getErrorCount() const override;
@@ -27,13 +70,82 @@ public:
 	void addErrorsToCache(
 		const std::vector<ErrorInfo>& newErrors, const ErrorCountInfo& errorCount) override;
 
+	TooltipInfo getTooltipInfoForTokenIds(
+		const std::vector<Id>& tokenIds, TooltipOrigin origin) const override;
+
 private:
+	struct PrefetchRequest
+	{
+		// requests the file if 0
+		Id tokenId = 0;
+		TooltipOrigin origin = TOOLTIP_ORIGIN_NONE;
+		FilePath filePath;
+	};
+
+	// what the storage looked like when a prefetch request was started
+	struct PrefetchState
+	{
+		size_t generation = 0;
+		std::chrono::steady_clock::rep lastRequestTime = 0;
+	};
+
+	struct ActiveTokenIds
+	{
+		std::vector<Id> tokenIds;
+		// 0 if the token is no node
+		Id declarationId = 0;
+	};
+
+	// the caches keep their own copies, so callers may change the values they get
+	static std::shared_ptr<SourceLocationCollection> copyCollection(
+		const SourceLocationCollection& collection);
+	static TooltipInfo copyTooltipInfo(const TooltipInfo& info);
+
+	void clearCaches();
+	void notifyRequest() const;
+
+	// queues loading the values needed to activate and hover the tokens and to show the files
+	void prefetch(
+		const std::vector<Id>& tokenIds,
+		TooltipOrigin origin,
+		const std::vector<FilePath>& filePaths) const;
+
+	void prefetchLoop() const;
+	// true if the storage was queried since the prefetch request was started
+	bool isPrefetchInterrupted(const PrefetchState& state) const;
+	void prefetchToken(Id tokenId, TooltipOrigin origin, const PrefetchState& state) const;
+	void prefetchFile(const FilePath& filePath, const PrefetchState& state) const;
+
 	mutable std::shared_ptr<Graph> m_graphForAll;
 	mutable StorageStats m_storageStats;
 
-	bool m_useErrorCache = false;
+	// also read by the prefetch thread
+	std::atomic<bool> m_useErrorCache = false;
 	ErrorCountInfo m_errorCount;
 	std::vector<ErrorInfo> m_cachedErrors;
+
+	// guards the caches and the prefetch queue, only held while accessing them
+	mutable std::mutex m_cacheMutex;
+	mutable LruCache<Id, ActiveTokenIds> m_activeTokenIds;
+	mutable LruCache<std::vector<Id>, std::shared_ptr<const SourceLocationCollection>>
+		m_sourceLocationsForTokenIds;
+	mutable LruCache<std::pair<FilePath, LocationType>, std::shared_ptr<const SourceLocationFile>>
+		m_sourceLocationsOfTypeInFile;
+	mutable LruCache<FilePath, std::shared_ptr<TextAccess>> m_fileContents;
+	mutable LruCache<std::pair<std::vector<Id>, TooltipOrigin>, TooltipInfo> m_tooltipInfos;
+	mutable size_t m_prefetchCount = 0;
+
+	mutable std::deque<PrefetchRequest> m_prefetchRequests;
+	bool m_prefetchPaused = false;
+	// increased whenever the cached values become invalid
+	size_t m_generation = 0;
+
+	mutable std::condition_variable m_prefetchCondition;
+	// notified whenever prefetched values were stored
+	mutable std::condition_variable m_prefetchCountCondition;
+	mutable std::atomic<std::chrono::steady_clock::rep> m_lastRequestTime = 0;
+	bool m_stopped = false;
+	mutable std::thread m_prefetchThread;
 };
 
 #endif	  // STORAGE_CACHE_H
@@ -1,17 +1,20 @@
 #include "SqliteIndexStorage.h"
 
+#include <set>
 #include <sstream>
 #include <unordered_map>
 
+#include "CompressedText.h"
 #include "FileSystem.h"
 #include "LocationType.h"
 #include "SourceLocationCollection.h"
 #include "SourceLocationFile.h"
 #include "TextAccess.h"
+#include "ThreadPool.h"
 #include "logging.h"
 #include "utilityString.h"
 
-const size_t SqliteIndexStorage::s_storageVersion = 25;
+const size_t SqliteIndexStorage::s_storageVersion = 27;
 
 namespace
 {
@@ -25,6 +28,41 @@ std::pair<std::wstring, std::wstring> splitLocalSymbolName(const std::wstring& n
 
 	return std::make_pair(name.substr(0, pos), name.substr(pos + 1, name.size() - pos - 2));
 }
+
+void appendVarInt(std::string& data, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	data.push_back(static_cast<char>(value));
+}
+
+bool readVarInt(const unsigned char*& it, const unsigned char* end, uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; it != end && shift < 64; shift += 7)
+	{
+		const unsigned char byte = *it++;
+		value |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+uint64_t zigZagEncode(int64_t value)
+{
+	return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+int64_t zigZagDecode(uint64_t value)
+{
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
 }	 // namespace
 
 size_t SqliteIndexStorage::getStorageVersion()
@@ -35,6 +73,8 @@ size_t SqliteIndexStorage::getStorageVersion()
 SqliteIndexStorage::SqliteIndexStorage(const FilePath& dbFilePath)
 	: SqliteStorage(dbFilePath.getCanonical())
 {
+	// lets the views query the index while the indexer writes to it
+	enableConcurrentReads();
 }
 
 size_t SqliteIndexStorage::getStaticVersion() const
@@ -44,12 +84,7 @@ size_t SqliteIndexStorage::getStaticVersion() const
 
 void SqliteIndexStorage::setMode(const StorageModeType mode)
 {
-	m_tempNodeNameIndex.clear();
-	m_tempWNodeNameIndex.clear();
-	m_tempNodeTypes.clear();
-	m_tempEdgeIndex.clear();
-	m_tempLocalSymbolIndex.clear();
-	m_tempSourceLocationIndices.clear();
+	clearTempIndices();
 
 	std::vector<std::pair<int, SqliteDatabaseIndex>> indices = getIndices();
 	for (size_t i = 0; i < indices.size(); i++)
@@ -204,8 +239,16 @@ bool SqliteIndexStorage::addFile(const StorageFile& data)
 
 	if (success && content)
 	{
+		const int dictionaryId = getCurrentFileContentDictionaryId();
+		const std::string compressedContent = CompressedText::compress(
+			content->getAllLines(), getFileContentDictionary(dictionaryId).get());
+
 		m_insertFileContentStmt.bind(1, reinterpret_id_cast<int>(data.id));
-		m_insertFileContentStmt.bind(2, content->getText().c_str());
+		m_insertFileContentStmt.bind(2, dictionaryId);
+		m_insertFileContentStmt.bind(
+			3,
+			reinterpret_cast<const unsigned char*>(compressedContent.data()),
+			static_cast<int>(compressedContent.size()));
 		success = executeStatement(m_insertFileContentStmt);
 	}
 
@@ -381,6 +424,14 @@ std::vector<Id> SqliteIndexStorage::addSourceLocations(const std::vector<Storage
 	if (locationsToInsert.size())
 	{
 		m_insertSourceLocationBatchStatement.execute(locationsToInsert, this);
+
+		std::set<Id> fileIds;
+		for (const StorageSourceLocationData& data: locationsToInsert)
+		{
+			fileIds.insert(data.fileNodeId);
+		}
+		removePackedSourceLocations(
+			utility::join(utility::toStrings(utility::toVector(fileIds)), ','));
 	}
 
 	return locationIds;
@@ -393,7 +444,9 @@ bool SqliteIndexStorage::addOccurrence(const StorageOccurrence& data)
 
 bool SqliteIndexStorage::addOccurrences(const std::vector<StorageOccurrence>& occurrences)
 {
-	return m_insertOccurrenceBatchStatement.execute(occurrences, this);
+	const bool success = m_insertOccurrenceBatchStatement.execute(occurrences, this);
+	removePackedSourceLocationsOfOccurrences(occurrences);
+	return success;
 }
 
 bool SqliteIndexStorage::addComponentAccess(const StorageComponentAccess& componentAccess)
@@ -408,19 +461,12 @@ bool SqliteIndexStorage::addComponentAccesses(const std::vector<StorageComponent
 
 void SqliteIndexStorage::addElementComponent(const StorageElementComponent& component)
 {
-	m_insertElementComponentStmt.bind(1, reinterpret_id_cast<int>(component.elementId));
-	m_insertElementComponentStmt.bind(2, component.type);
-	m_insertElementComponentStmt.bind(3, utility::encodeToUtf8(component.data).c_str());
-	executeStatement(m_insertElementComponentStmt);
-	m_insertElementComponentStmt.reset();
+	addElementComponents({component});
 }
 
 void SqliteIndexStorage::addElementComponents(const std::vector<StorageElementComponent>& components)
 {
-	for (const StorageElementComponent& component: components)
-	{
-		addElementComponent(component);
-	}
+	m_insertElementComponentBatchStatement.execute(components, this);
 }
 
 StorageError SqliteIndexStorage::addError(const StorageErrorData& data)
@@ -461,6 +507,53 @@ StorageError SqliteIndexStorage::addError(const StorageErrorData& data)
 	return StorageError(id, data);
 }
 
+bool SqliteIndexStorage::injectDatabase(const FilePath& dbFilePath)
+{
+	if (!dbFilePath.exists())
+	{
+		LOG_ERROR(L"Database to inject does not exist: " + dbFilePath.wstr());
+		return false;
+	}
+
+	try
+	{
+		CppSQLite3Statement attachStmt = m_database.compileStatement(
+			"ATTACH DATABASE ? AS injected;");
+		attachStmt.bind(1, utility::encodeToUtf8(dbFilePath.wstr()).c_str());
+		attachStmt.execDML();
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+		return false;
+	}
+
+	bool success = true;
+	beginTransaction();
+	try
+	{
+		injectAttachedDatabase();
+		commitTransaction();
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+		rollbackTransaction();
+		success = false;
+	}
+
+	executeStatement("DETACH DATABASE injected;");
+
+	// the injected rows are missing in the temporary indices of the add functions
+	clearTempIndices();
+	{
+		std::lock_guard<std::mutex> lock(m_fileContentDictionariesMutex);
+		m_currentFileContentDictionaryId = -1;
+	}
+
+	return success;
+}
+
 void SqliteIndexStorage::removeElement(Id id)
 {
 	std::vector<Id> ids;
@@ -470,23 +563,31 @@ void SqliteIndexStorage::removeElement(Id id)
 
 void SqliteIndexStorage::removeElements(const std::vector<Id>& ids)
 {
+	// the occurrences of the elements are deleted along with them
+	removePackedSourceLocations(
+		"SELECT source_location.file_node_id FROM occurrence "
+		"INNER JOIN source_location ON (occurrence.source_location_id = source_location.id) "
+		"WHERE occurrence.element_id IN (" +
+		utility::join(utility::toStrings(ids), ',') + ")");
+
 	executeStatement(
 		"DELETE FROM element WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ");");
 }
 
 void SqliteIndexStorage::removeOccurrence(const StorageOccurrence& occurrence)
 {
-	executeStatement(
-		"DELETE FROM occurrence WHERE element_id = " + to_string(occurrence.elementId) +
-		" AND source_location_id = " + to_string(occurrence.sourceLocationId) + ";");
+	removeOccurrences({occurrence});
 }
 
 void SqliteIndexStorage::removeOccurrences(const std::vector<StorageOccurrence>& occurrences)
 {
 	for (const StorageOccurrence& occurrence: occurrences)
 	{
-		removeOccurrence(occurrence);
+		executeStatement(
+			"DELETE FROM occurrence WHERE element_id = " + to_string(occurrence.elementId) +
+			" AND source_location_id = " + to_string(occurrence.sourceLocationId) + ";");
 	}
+	removePackedSourceLocationsOfOccurrences(occurrences);
 }
 
 void SqliteIndexStorage::removeElementsWithoutOccurrences(const std::vector<Id>& elementIds)
@@ -540,6 +641,16 @@ void SqliteIndexStorage::removeElementsWithLocationInFiles(
 		updateStatusCallback(4);
 	}
 
+	// the occurrences of the deleted edges may be located in other files
+	removePackedSourceLocations(
+		"SELECT source_location.file_node_id FROM occurrence "
+		"INNER JOIN source_location ON (occurrence.source_location_id = source_location.id) "
+		"WHERE occurrence.element_id IN ("
+		"	SELECT element_id_to_clear.id FROM element_id_to_clear INNER JOIN edge ON "
+		"(element_id_to_clear.id = edge.id)"
+		"	UNION SELECT id FROM edge WHERE source_node_id IN (SELECT id FROM element_id_to_clear)"
+		")");
+
 	// delete all edges in element_id_to_clear
 	executeStatement(
 		"DELETE FROM element WHERE element.id IN "
@@ -588,6 +699,7 @@ void SqliteIndexStorage::removeElementsWithLocationInFiles(
 	executeStatement(
 		"DELETE FROM source_location WHERE file_node_id IN (" +
 		utility::join(utility::toStrings(fileIds), ',') + ");");
+	removePackedSourceLocations(utility::join(utility::toStrings(fileIds), ','));
 
 	if (updateStatusCallback != nullptr)
 	{
@@ -644,29 +756,29 @@ void SqliteIndexStorage::removeAllErrors()
 
 bool SqliteIndexStorage::isEdge(Id elementId) const
 {
-	int count = executeStatementScalar(
-		"SELECT count(*) FROM edge WHERE id = " + to_string(elementId) + ";", 0);
+	int count = executeCachedStatementScalar(
+		"SELECT count(*) FROM edge WHERE id = ?;", {reinterpret_id_cast<int>(elementId)}, 0);
 	return (count > 0);
 }
 
 bool SqliteIndexStorage::isNode(Id elementId) const
 {
-	int count = executeStatementScalar(
-		"SELECT count(*) FROM node WHERE id = " + to_string(elementId) + ";", 0);
+	int count = executeCachedStatementScalar(
+		"SELECT count(*) FROM node WHERE id = ?;", {reinterpret_id_cast<int>(elementId)}, 0);
 	return (count > 0);
 }
 
 bool SqliteIndexStorage::isFile(Id elementId) const
 {
-	int count = executeStatementScalar(
-		"SELECT count(*) FROM file WHERE id = " + to_string(elementId) + ";", 0);
+	int count = executeCachedStatementScalar(
+		"SELECT count(*) FROM file WHERE id = ?;", {reinterpret_id_cast<int>(elementId)}, 0);
 	return (count > 0);
 }
 
 StorageEdge SqliteIndexStorage::getEdgeById(Id edgeId) const
 {
 	std::vector<StorageEdge> candidates = doGetAll<StorageEdge>(
-		"WHERE id = " + to_string(edgeId));
+		"WHERE id = ?", {reinterpret_id_cast<int>(edgeId)});
 
 	if (candidates.size() > 0)
 	{
@@ -679,88 +791,75 @@ StorageEdge SqliteIndexStorage::getEdgeById(Id edgeId) const
 StorageEdge SqliteIndexStorage::getEdgeBySourceTargetType(Id sourceId, Id targetId, int type) const
 {
 	return doGetFirst<StorageEdge>(
-		"WHERE "
-		"source_node_id == " +
-		to_string(sourceId) +
-		" AND "
-		"target_node_id == " +
-		to_string(targetId) +
-		" AND "
-		"type == " +
-		std::to_string(type));
+		"WHERE source_node_id == ? AND target_node_id == ? AND type == ?",
+		{reinterpret_id_cast<int>(sourceId), reinterpret_id_cast<int>(targetId), type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceId(Id sourceId) const
 {
-	return doGetAll<StorageEdge>("WHERE source_node_id == " + to_string(sourceId));
+	return doGetAll<StorageEdge>("WHERE source_node_id == ?", {reinterpret_id_cast<int>(sourceId)});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceIds(const std::vector<Id>& sourceIds) const
 {
 	return doGetAll<StorageEdge>(
-		"WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') + ")");
+		"WHERE " + getIdSetCondition("source_node_id"), {serializeIdSet(sourceIds)});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetId(Id targetId) const
 {
-	return doGetAll<StorageEdge>("WHERE target_node_id == " + to_string(targetId));
+	return doGetAll<StorageEdge>("WHERE target_node_id == ?", {reinterpret_id_cast<int>(targetId)});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetIds(const std::vector<Id>& targetIds) const
 {
 	return doGetAll<StorageEdge>(
-		"WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') + ")");
+		"WHERE " + getIdSetCondition("target_node_id"), {serializeIdSet(targetIds)});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceOrTargetId(Id id) const
 {
 	return doGetAll<StorageEdge>(
-		"WHERE source_node_id == " + to_string(id) +
-		" OR target_node_id == " + to_string(id));
+		"WHERE source_node_id == ?1 OR target_node_id == ?1", {reinterpret_id_cast<int>(id)});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByType(int type) const
 {
-	return doGetAll<StorageEdge>("WHERE type == " + std::to_string(type));
+	return doGetAll<StorageEdge>("WHERE type == ?", {type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceType(Id sourceId, int type) const
 {
 	return doGetAll<StorageEdge>(
-		"WHERE source_node_id == " + to_string(sourceId) +
-		" AND type == " + std::to_string(type));
+		"WHERE source_node_id == ? AND type == ?", {reinterpret_id_cast<int>(sourceId), type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourcesType(
 	const std::vector<Id>& sourceIds, int type) const
 {
 	return doGetAll<StorageEdge>(
-		"WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') +
-		")"
-		" AND type == " +
-		std::to_string(type));
+		"WHERE " + getIdSetCondition("source_node_id") + " AND type == ?",
+		{serializeIdSet(sourceIds), type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetType(Id targetId, int type) const
 {
 	return doGetAll<StorageEdge>(
-		"WHERE target_node_id == " + to_string(targetId) +
-		" AND type == " + std::to_string(type));
+		"WHERE target_node_id == ? AND type == ?", {reinterpret_id_cast<int>(targetId), type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetsType(
 	const std::vector<Id>& targetIds, int type) const
 {
 	return doGetAll<StorageEdge>(
-		"WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') +
-		")"
-		" AND type == " +
-		std::to_string(type));
+		"WHERE " + getIdSetCondition("target_node_id") + " AND type == ?",
+		{serializeIdSet(targetIds), type});
 }
 
 StorageNode SqliteIndexStorage::getNodeById(Id id) const
 {
-	std::vector<StorageNode> candidates = doGetAll<StorageNode>("WHERE id = " + to_string(id));
+	std::vector<StorageNode> candidates = doGetAll<StorageNode>(
+		"WHERE id = ?", {reinterpret_id_cast<int>(id)});
 
 	if (candidates.size() > 0)
 	{
@@ -772,11 +871,10 @@ StorageNode SqliteIndexStorage::getNodeById(Id id) const
 
 StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::wstring& serializedName) const
 {
-	CppSQLite3Statement stmt = m_database.compileStatement(
-		"SELECT id, type, serialized_name FROM node WHERE serialized_name == ? LIMIT 1;");
-
-	stmt.bind(1, utility::encodeToUtf8(serializedName).c_str());
-	CppSQLite3Query q = executeQuery(stmt);
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT id, type, serialized_name FROM node WHERE serialized_name == ? LIMIT 1;",
+		{utility::encodeToUtf8(serializedName)});
+	CppSQLite3Query& q = cachedQuery.query;
 
 	if (!q.eof())
 	{
@@ -790,8 +888,6 @@ StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::wstring& seri
 		}
 	}
 
-	stmt.reset();
-
 	return StorageNode();
 }
 
@@ -837,7 +933,7 @@ std::vector<int> SqliteIndexStorage::getAvailableEdgeTypes() const
 
 StorageFile SqliteIndexStorage::getFileByPath(const std::wstring& filePath) const
 {
-	return doGetFirst<StorageFile>("WHERE file.path == '" + utility::encodeToUtf8(filePath) + "'");
+	return doGetFirst<StorageFile>("WHERE file.path == ?", {utility::encodeToUtf8(filePath)});
 }
 
 std::vector<StorageFile> SqliteIndexStorage::getFilesByPaths(const std::vector<FilePath>& filePaths) const
@@ -848,11 +944,13 @@ std::vector<StorageFile> SqliteIndexStorage::getFilesByPaths(const std::vector<F
 
 std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentById(Id fileId) const
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT content FROM filecontent WHERE id = '" + to_string(fileId) + "';");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT dictionary_id, content FROM filecontent WHERE id = ?;",
+		{reinterpret_id_cast<int>(fileId)});
+	CppSQLite3Query& q = cachedQuery.query;
 	if (!q.eof())
 	{
-		return TextAccess::createFromString(q.getStringField(0, ""));
+		return createFileContent(q);
 	}
 
 	return TextAccess::createFromString("");
@@ -862,16 +960,17 @@ std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::
 {
 	try
 	{
-		CppSQLite3Query q = executeQuery(
-			"SELECT filecontent.content "
+		CachedQuery cachedQuery = executeCachedQuery(
+			"SELECT filecontent.dictionary_id, filecontent.content "
 			"FROM filecontent "
 			"INNER JOIN file ON filecontent.id = file.id "
-			"WHERE file.path = '" +
-			utility::encodeToUtf8(filePath) + "';");
+			"WHERE file.path = ?;",
+			{utility::encodeToUtf8(filePath)});
+		CppSQLite3Query& q = cachedQuery.query;
 
 		if (!q.eof())
 		{
-			return TextAccess::createFromString(q.getStringField(0, ""));
+			return createFileContent(q);
 		}
 	}
 	catch (CppSQLite3Exception& e)
@@ -882,6 +981,136 @@ std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::
 	return TextAccess::createFromString("");
 }
 
+void SqliteIndexStorage::trainFileContentDictionary()
+{
+	if (getCurrentFileContentDictionaryId() != 0)
+	{
+		return;
+	}
+
+	bool transactionActive = false;
+	try
+	{
+		std::vector<int> fileIds;
+		std::vector<std::string> samples;
+		size_t sampleSize = 0;
+		{
+			CachedQuery cachedQuery = executeCachedQuery(
+				"SELECT id, content FROM filecontent WHERE dictionary_id = 0;", {});
+			CppSQLite3Query& q = cachedQuery.query;
+			while (!q.eof())
+			{
+				fileIds.push_back(q.getIntField(0, 0));
+
+				// chunks are used as samples, because they are compressed independently
+				int size = 0;
+				const unsigned char* data = q.getBlobField(1, size);
+				std::shared_ptr<CompressedText> text = CompressedText::create(
+					std::string(reinterpret_cast<const char*>(data), size), nullptr);
+				for (size_t i = 0; text && i < text->getChunkCount() &&
+					 sampleSize < CompressedTextDictionary::s_maxSampleSize;
+					 i++)
+				{
+					samples.push_back(text->decompressChunkText(i));
+					sampleSize += samples.back().size();
+				}
+
+				q.nextRow();
+			}
+		}
+
+		std::shared_ptr<const CompressedTextDictionary> dictionary =
+			CompressedTextDictionary::train(samples);
+		if (!dictionary)
+		{
+			return;
+		}
+
+		beginTransaction();
+		transactionActive = true;
+
+		CppSQLite3Statement insertDictionaryStmt = m_database.compileStatement(
+			"INSERT INTO filecontent_dictionary(id, dictionary) VALUES(NULL, ?);");
+		insertDictionaryStmt.bind(
+			1,
+			reinterpret_cast<const unsigned char*>(dictionary->getData().data()),
+			static_cast<int>(dictionary->getData().size()));
+		insertDictionaryStmt.execDML();
+		const int dictionaryId = static_cast<int>(m_database.lastRowId());
+
+		CppSQLite3Statement updateContentStmt = m_database.compileStatement(
+			"UPDATE filecontent SET dictionary_id = ?, content = ? WHERE id = ?;");
+
+		// files are recompressed in parallel, in batches to keep the memory usage bounded
+		const size_t batchSize = 256;
+		for (size_t batchStart = 0; batchStart < fileIds.size(); batchStart += batchSize)
+		{
+			const size_t batchEnd = std::min(fileIds.size(), batchStart + batchSize);
+
+			std::vector<std::string> contents;
+			for (size_t i = batchStart; i < batchEnd; i++)
+			{
+				CachedQuery cachedQuery = executeCachedQuery(
+					"SELECT content FROM filecontent WHERE id = ?;", {fileIds[i]});
+				CppSQLite3Query& q = cachedQuery.query;
+
+				int size = 0;
+				const unsigned char* data = q.eof() ? nullptr : q.getBlobField(0, size);
+				contents.emplace_back(data ? reinterpret_cast<const char*>(data) : "", size);
+			}
+
+			ThreadPool::getInstance()->parallelFor(contents.size(), [&](size_t i) {
+				std::shared_ptr<CompressedText> text = CompressedText::create(
+					std::move(contents[i]), nullptr);
+				contents[i].clear();
+				if (!text)
+				{
+					return;
+				}
+
+				std::vector<std::string> lines;
+				for (size_t j = 0; j < text->getChunkCount(); j++)
+				{
+					std::vector<std::string> chunkLines = text->decompressChunk(j);
+					lines.insert(lines.end(), chunkLines.begin(), chunkLines.end());
+				}
+				contents[i] = CompressedText::compress(lines, dictionary.get());
+			});
+
+			for (size_t i = 0; i < contents.size(); i++)
+			{
+				if (contents[i].empty())
+				{
+					continue;
+				}
+
+				updateContentStmt.bind(1, dictionaryId);
+				updateContentStmt.bind(
+					2,
+					reinterpret_cast<const unsigned char*>(contents[i].data()),
+					static_cast<int>(contents[i].size()));
+				updateContentStmt.bind(3, fileIds[batchStart + i]);
+				updateContentStmt.execDML();
+				updateContentStmt.reset();
+			}
+		}
+
+		commitTransaction();
+
+		std::lock_guard<std::mutex> lock(m_fileContentDictionariesMutex);
+		m_fileContentDictionaries[dictionaryId] = dictionary;
+		m_currentFileContentDictionaryId = dictionaryId;
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+		if (transactionActive)
+		{
+			rollbackTransaction();
+		}
+	}
+}
+
 void SqliteIndexStorage::setFileIndexed(Id fileId, bool indexed)
 {
 	executeStatement(
@@ -892,8 +1121,8 @@ void SqliteIndexStorage::setFileIndexed(Id fileId, bool indexed)
 void SqliteIndexStorage::setFileCompleteIfNoError(Id fileId, const std::wstring&  /*filePath*/, bool complete)
 {
 	bool fileHasErrors = doGetFirst<StorageSourceLocation>(
-							 "WHERE file_node_id == " + to_string(fileId) +
-							 " AND type == " + std::to_string(locationTypeToInt(LOCATION_ERROR)))
+							 "WHERE file_node_id == ? AND type == ?",
+							 {reinterpret_id_cast<int>(fileId), locationTypeToInt(LOCATION_ERROR)})
 							 .id != 0;
 	if (fileHasErrors != complete)
 	{
@@ -911,68 +1140,97 @@ void SqliteIndexStorage::setNodeType(int type, Id nodeId)
 }
 
 std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForFile(
-	const FilePath& filePath, const std::string& query) const
+	const FilePath& filePath) const
 {
-	std::shared_ptr<SourceLocationFile> ret = std::make_shared<SourceLocationFile>(
-		filePath, L"", true, false, false);
+	return getSourceLocationsForFile(filePath, SourceLocationFilter());
+}
 
-	const StorageFile file = getFileByPath(filePath.wstr());
-	if (file.id == 0)	 // early out
-	{
-		return ret;
-	}
+std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForLinesInFile(
+	const FilePath& filePath, size_t startLine, size_t endLine) const
+{
+	SourceLocationFilter filter;
+	filter.startLine = startLine;
+	filter.endLine = endLine;
+	return getSourceLocationsForFile(filePath, filter);
+}
 
-	ret->setLanguage(file.languageIdentifier);
-	ret->setIsComplete(file.complete);
-	ret->setIsIndexed(file.indexed);
+std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsOfTypeInFile(
+	const FilePath& filePath, LocationType type) const
+{
+	SourceLocationFilter filter;
+	filter.type = locationTypeToInt(type);
+	return getSourceLocationsForFile(filePath, filter);
+}
 
-	std::vector<StorageSourceLocation> sourceLocations = doGetAll<StorageSourceLocation>(
-		"WHERE file_node_id == " + to_string(file.id) + " " + query);
+void SqliteIndexStorage::removePackedSourceLocations(const std::string& fileIds)
+{
+	executeStatement("DELETE FROM source_location_file WHERE file_node_id IN (" + fileIds + ");");
+}
 
-	std::vector<Id> sourceLocationIds;
-	sourceLocationIds.reserve(sourceLocations.size());
-	for (const StorageSourceLocation& storageLocation: sourceLocations)
+void SqliteIndexStorage::removePackedSourceLocationsOfOccurrences(
+	const std::vector<StorageOccurrence>& occurrences)
+{
+	if (occurrences.empty())
 	{
-		sourceLocationIds.push_back(storageLocation.id);
+		return;
 	}
 
-	std::map<Id, std::vector<Id>> sourceLocationIdToElementIds;
-	for (const StorageOccurrence& occurrence: getOccurrencesForLocationIds(sourceLocationIds))
+	std::set<Id> sourceLocationIds;
+	for (const StorageOccurrence& occurrence: occurrences)
 	{
-		sourceLocationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
+		sourceLocationIds.insert(occurrence.sourceLocationId);
 	}
+	removePackedSourceLocations(
+		"SELECT DISTINCT file_node_id FROM source_location WHERE id IN (" +
+		utility::join(utility::toStrings(utility::toVector(sourceLocationIds)), ',') + ")");
+}
 
-	for (const StorageSourceLocation& location: sourceLocations)
+void SqliteIndexStorage::packSourceLocations()
+{
+	std::vector<Id> fileIds;
 	{
-		auto it = sourceLocationIdToElementIds.find(location.id);
-
-		ret->addSourceLocation(
-			intToLocationType(location.type),
-			location.id,
-			it != sourceLocationIdToElementIds.end() ? it->second : std::vector<Id>(),
-			location.startLine,
-			location.startCol,
-			location.endLine,
-			location.endCol);
+		CachedQuery cachedQuery = executeCachedQuery(
+			"SELECT DISTINCT file_node_id FROM source_location WHERE file_node_id NOT IN ("
+			"SELECT file_node_id FROM source_location_file);",
+			{});
+		CppSQLite3Query& q = cachedQuery.query;
+		while (!q.eof())
+		{
+			fileIds.push_back(q.getIntField(0, 0));
+			q.nextRow();
+		}
 	}
 
-	return ret;
-}
+	if (fileIds.empty())
+	{
+		return;
+	}
 
-std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForLinesInFile(
-	const FilePath& filePath, size_t startLine, size_t endLine) const
-{
-	return getSourceLocationsForFile(
-		filePath,
-		"AND start_line <= " + std::to_string(endLine) +
-			" AND end_line >= " + std::to_string(startLine));
-}
+	beginTransaction();
+	try
+	{
+		CppSQLite3Statement insertStmt = m_database.compileStatement(
+			"INSERT INTO source_location_file(file_node_id, locations) VALUES(?, ?);");
 
-std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsOfTypeInFile(
-	const FilePath& filePath, LocationType type) const
-{
-	return getSourceLocationsForFile(
-		filePath, "AND type == " + std::to_string(locationTypeToInt(type)));
+		for (const Id fileId: fileIds)
+		{
+			const std::string locations = packSourceLocationsOfFile(fileId);
+
+			insertStmt.bind(1, reinterpret_id_cast<int>(fileId));
+			insertStmt.bind(
+				2,
+				reinterpret_cast<const unsigned char*>(locations.data()),
+				static_cast<int>(locations.size()));
+			insertStmt.execDML();
+			insertStmt.reset();
+		}
+		commitTransaction();
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+		rollbackTransaction();
+	}
 }
 
 std::shared_ptr<SourceLocationCollection> SqliteIndexStorage::getSourceLocationsForElementIds(
@@ -986,13 +1244,15 @@ std::shared_ptr<SourceLocationCollection> SqliteIndexStorage::getSourceLocations
 		sourceLocationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
 	}
 
-	CppSQLite3Query q = executeQuery(
+	CachedQuery cachedQuery = executeCachedQuery(
 		"SELECT source_location.id, file.path, source_location.start_line, "
 		"source_location.start_column, "
 		"source_location.end_line, source_location.end_column, source_location.type "
 		"FROM source_location INNER JOIN file ON (file.id = source_location.file_node_id) "
-		"WHERE source_location.id IN (" +
-		utility::join(utility::toStrings(sourceLocationIds), ',') + ");");
+		"WHERE " +
+			getIdSetCondition("source_location.id") + ";",
+		{serializeIdSet(sourceLocationIds)});
+	CppSQLite3Query& q = cachedQuery.query;
 
 	std::shared_ptr<SourceLocationCollection> ret = std::make_shared<SourceLocationCollection>();
 
@@ -1036,33 +1296,34 @@ std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForLocationIds(
 	const std::vector<Id>& locationIds) const
 {
 	return doGetAll<StorageOccurrence>(
-		"WHERE source_location_id IN (" + utility::join(utility::toStrings(locationIds), ',') + ")");
+		"WHERE " + getIdSetCondition("source_location_id"), {serializeIdSet(locationIds)});
 }
 
 std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForElementIds(
 	const std::vector<Id>& elementIds) const
 {
 	return doGetAll<StorageOccurrence>(
-		"WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+		"WHERE " + getIdSetCondition("element_id"), {serializeIdSet(elementIds)});
 }
 
 StorageComponentAccess SqliteIndexStorage::getComponentAccessByNodeId(Id nodeId) const
 {
-	return doGetFirst<StorageComponentAccess>("WHERE node_id == " + to_string(nodeId));
+	return doGetFirst<StorageComponentAccess>(
+		"WHERE node_id == ?", {reinterpret_id_cast<int>(nodeId)});
 }
 
 std::vector<StorageComponentAccess> SqliteIndexStorage::getComponentAccessesByNodeIds(
 	const std::vector<Id>& nodeIds) const
 {
 	return doGetAll<StorageComponentAccess>(
-		"WHERE node_id IN (" + utility::join(utility::toStrings(nodeIds), ',') + ")");
+		"WHERE " + getIdSetCondition("node_id"), {serializeIdSet(nodeIds)});
 }
 
 std::vector<StorageElementComponent> SqliteIndexStorage::getElementComponentsByElementIds(
 	const std::vector<Id>& elementIds) const
 {
 	return doGetAll<StorageElementComponent>(
-		"WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+		"WHERE " + getIdSetCondition("element_id"), {serializeIdSet(elementIds)});
 }
 
 std::vector<ErrorInfo> SqliteIndexStorage::getAllErrorInfos() const
@@ -1208,6 +1469,178 @@ std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices(
 	return indices;
 }
 
+void SqliteIndexStorage::clearTempIndices()
+{
+	m_tempNodeNameIndex.clear();
+	m_tempWNodeNameIndex.clear();
+	m_tempNodeTypes.clear();
+	m_tempEdgeIndex.clear();
+	m_tempLocalSymbolIndex.clear();
+	m_tempSourceLocationIndices.clear();
+}
+
+void SqliteIndexStorage::injectAttachedDatabase()
+{
+	// Every injected element is mapped to the id of the equal element of this database. Elements
+	// without one keep their injected id shifted behind all ids that are used here.
+	const std::string elementIdOffset = std::to_string(
+		m_database.execScalar("SELECT IFNULL(MAX(id), 0) FROM main.element;", 0));
+	const std::string sourceLocationIdOffset = std::to_string(
+		m_database.execScalar("SELECT IFNULL(MAX(id), 0) FROM main.source_location;", 0));
+	const std::string dictionaryIdOffset = std::to_string(
+		m_database.execScalar("SELECT IFNULL(MAX(id), 0) FROM main.filecontent_dictionary;", 0));
+
+	m_database.execDML("DROP TABLE IF EXISTS temp.injected_element_id;");
+	m_database.execDML(
+		"CREATE TEMP TABLE injected_element_id("
+		"injected_id INTEGER PRIMARY KEY, id INTEGER NOT NULL, is_new INTEGER NOT NULL);");
+	m_database.execDML("DROP TABLE IF EXISTS temp.injected_source_location_id;");
+	m_database.execDML(
+		"CREATE TEMP TABLE injected_source_location_id("
+		"injected_id INTEGER PRIMARY KEY, id INTEGER NOT NULL, is_new INTEGER NOT NULL);");
+
+	// errors are equal if message and fatality match
+	m_database.execDML((
+		"INSERT INTO temp.injected_element_id(injected_id, id, is_new) "
+		"SELECT e.id, IFNULL(MIN(o.id), " + elementIdOffset + " + e.id), MIN(o.id) IS NULL "
+		"FROM injected.error e "
+		"LEFT JOIN main.error o ON o.message = e.message AND o.fatal = e.fatal "
+		"GROUP BY e.id;").c_str());
+
+	// nodes are equal if their serialized names match, the higher node type wins
+	m_database.execDML((
+		"INSERT INTO temp.injected_element_id(injected_id, id, is_new) "
+		"SELECT n.id, IFNULL(o.id, " + elementIdOffset + " + n.id), o.id IS NULL "
+		"FROM injected.node n "
+		"LEFT JOIN main.node o ON o.serialized_name = n.serialized_name;").c_str());
+	m_database.execDML(
+		"UPDATE main.node SET type = n.type "
+		"FROM temp.injected_element_id m JOIN injected.node n ON n.id = m.injected_id "
+		"WHERE main.node.id = m.id AND NOT m.is_new AND n.type > main.node.type;");
+
+	// only local symbols of the form 'name<id>' are merged
+	m_database.execDML((
+		"INSERT INTO temp.injected_element_id(injected_id, id, is_new) "
+		"SELECT l.id, IFNULL(o.id, " + elementIdOffset + " + l.id), o.id IS NULL "
+		"FROM injected.local_symbol l "
+		"LEFT JOIN main.local_symbol o ON o.name = l.name AND l.name LIKE '%<%>';").c_str());
+
+	// edges are equal if type, source and target match, edges of unknown nodes are dropped
+	m_database.execDML((
+		"INSERT INTO temp.injected_element_id(injected_id, id, is_new) "
+		"SELECT e.id, IFNULL(o.id, " + elementIdOffset + " + e.id), o.id IS NULL "
+		"FROM injected.edge e "
+		"JOIN temp.injected_element_id s ON s.injected_id = e.source_node_id "
+		"JOIN temp.injected_element_id t ON t.injected_id = e.target_node_id "
+		"LEFT JOIN main.edge o "
+		"ON o.type = e.type AND o.source_node_id = s.id AND o.target_node_id = t.id;").c_str());
+
+	m_database.execDML(
+		"INSERT INTO main.element(id) SELECT id FROM temp.injected_element_id WHERE is_new;");
+
+	m_database.execDML(
+		"INSERT INTO main.error(id, message, fatal, indexed, translation_unit) "
+		"SELECT m.id, e.message, e.fatal, e.indexed, e.translation_unit "
+		"FROM injected.error e JOIN temp.injected_element_id m ON m.injected_id = e.id "
+		"WHERE m.is_new;");
+	m_database.execDML(
+		"INSERT INTO main.node(id, type, serialized_name) "
+		"SELECT m.id, n.type, n.serialized_name "
+		"FROM injected.node n JOIN temp.injected_element_id m ON m.injected_id = n.id "
+		"WHERE m.is_new;");
+	m_database.execDML(
+		"INSERT INTO main.local_symbol(id, name) "
+		"SELECT m.id, l.name "
+		"FROM injected.local_symbol l JOIN temp.injected_element_id m ON m.injected_id = l.id "
+		"WHERE m.is_new;");
+	m_database.execDML(
+		"INSERT INTO main.edge(id, type, source_node_id, target_node_id) "
+		"SELECT m.id, e.type, s.id, t.id "
+		"FROM injected.edge e JOIN temp.injected_element_id m ON m.injected_id = e.id "
+		"JOIN temp.injected_element_id s ON s.injected_id = e.source_node_id "
+		"JOIN temp.injected_element_id t ON t.injected_id = e.target_node_id "
+		"WHERE m.is_new;");
+	m_database.execDML(
+		"INSERT OR IGNORE INTO main.symbol(id, definition_kind) "
+		"SELECT m.id, s.definition_kind "
+		"FROM injected.symbol s JOIN temp.injected_element_id m ON m.injected_id = s.id;");
+
+	// known files only get upgraded, the completeness follows the rule of setFileCompleteIfNoError
+	m_database.execDML(
+		"UPDATE main.file SET indexed = 1, line_count = f.line_count "
+		"FROM temp.injected_element_id m JOIN injected.file f ON f.id = m.injected_id "
+		"WHERE main.file.id = m.id AND f.indexed AND NOT main.file.indexed;");
+	m_database.execDML((
+		"UPDATE main.file SET complete = f.complete "
+		"FROM temp.injected_element_id m JOIN injected.file f ON f.id = m.injected_id "
+		"WHERE main.file.id = m.id AND main.file.complete != f.complete "
+		"AND f.complete != EXISTS(SELECT 1 FROM main.source_location l "
+		"WHERE l.file_node_id = main.file.id AND l.type = " +
+		std::to_string(locationTypeToInt(LOCATION_ERROR)) + ");").c_str());
+	m_database.execDML(
+		"INSERT INTO main.file(id, path, language, modification_time, indexed, complete, line_count) "
+		"SELECT m.id, f.path, f.language, f.modification_time, f.indexed, f.complete, f.line_count "
+		"FROM injected.file f JOIN temp.injected_element_id m ON m.injected_id = f.id "
+		"WHERE NOT EXISTS(SELECT 1 FROM main.file o WHERE o.id = m.id) "
+		"AND NOT EXISTS(SELECT 1 FROM main.file o WHERE o.path = f.path);");
+
+	// file contents stay compressed, their dictionaries are copied along
+	m_database.execDML((
+		"INSERT INTO main.filecontent_dictionary(id, dictionary) "
+		"SELECT id + " + dictionaryIdOffset + ", dictionary FROM injected.filecontent_dictionary;")
+						   .c_str());
+	m_database.execDML((
+		"INSERT INTO main.filecontent(id, dictionary_id, content) "
+		"SELECT m.id, CASE WHEN c.dictionary_id > 0 THEN c.dictionary_id + " +
+		dictionaryIdOffset + " ELSE c.dictionary_id END, c.content "
+		"FROM injected.filecontent c JOIN temp.injected_element_id m ON m.injected_id = c.id "
+		"WHERE EXISTS(SELECT 1 FROM main.file o WHERE o.id = m.id AND o.indexed) "
+		"AND NOT EXISTS(SELECT 1 FROM main.filecontent o WHERE o.id = m.id);").c_str());
+
+	// source locations are equal if file, range and type match
+	m_database.execDML((
+		"INSERT INTO temp.injected_source_location_id(injected_id, id, is_new) "
+		"SELECT l.id, IFNULL(o.id, " + sourceLocationIdOffset + " + l.id), o.id IS NULL "
+		"FROM injected.source_location l "
+		"JOIN temp.injected_element_id f ON f.injected_id = l.file_node_id "
+		"LEFT JOIN main.source_location o ON o.file_node_id = f.id "
+		"AND o.start_line = l.start_line AND o.start_column = l.start_column "
+		"AND o.end_line = l.end_line AND o.end_column = l.end_column AND o.type = l.type;")
+						   .c_str());
+	m_database.execDML(
+		"INSERT INTO main.source_location("
+		"id, file_node_id, start_line, start_column, end_line, end_column, type) "
+		"SELECT m.id, f.id, l.start_line, l.start_column, l.end_line, l.end_column, l.type "
+		"FROM injected.source_location l "
+		"JOIN temp.injected_source_location_id m ON m.injected_id = l.id "
+		"JOIN temp.injected_element_id f ON f.injected_id = l.file_node_id "
+		"WHERE m.is_new;");
+
+	m_database.execDML(
+		"INSERT OR IGNORE INTO main.occurrence(element_id, source_location_id) "
+		"SELECT e.id, l.id FROM injected.occurrence o "
+		"JOIN temp.injected_element_id e ON e.injected_id = o.element_id "
+		"JOIN temp.injected_source_location_id l ON l.injected_id = o.source_location_id;");
+	m_database.execDML(
+		"INSERT INTO main.element_component(element_id, type, data) "
+		"SELECT m.id, c.type, c.data "
+		"FROM injected.element_component c "
+		"JOIN temp.injected_element_id m ON m.injected_id = c.element_id;");
+	m_database.execDML(
+		"INSERT OR IGNORE INTO main.component_access(node_id, type) "
+		"SELECT m.id, a.type "
+		"FROM injected.component_access a JOIN temp.injected_element_id m ON m.injected_id = a.node_id;");
+
+	// all injected occurrences belong to injected source locations
+	m_database.execDML(
+		"DELETE FROM main.source_location_file WHERE file_node_id IN ("
+		"SELECT f.id FROM injected.source_location l "
+		"JOIN temp.injected_element_id f ON f.injected_id = l.file_node_id);");
+
+	m_database.execDML("DROP TABLE temp.injected_element_id;");
+	m_database.execDML("DROP TABLE temp.injected_source_location_id;");
+}
+
 void SqliteIndexStorage::clearTables()
 {
 	try
@@ -1215,9 +1648,11 @@ void SqliteIndexStorage::clearTables()
 		m_database.execDML("DROP TABLE IF EXISTS main.error;");
 		m_database.execDML("DROP TABLE IF EXISTS main.component_access;");
 		m_database.execDML("DROP TABLE IF EXISTS main.occurrence;");
+		m_database.execDML("DROP TABLE IF EXISTS main.source_location_file;");
 		m_database.execDML("DROP TABLE IF EXISTS main.source_location;");
 		m_database.execDML("DROP TABLE IF EXISTS main.local_symbol;");
 		m_database.execDML("DROP TABLE IF EXISTS main.filecontent;");
+		m_database.execDML("DROP TABLE IF EXISTS main.filecontent_dictionary;");
 		m_database.execDML("DROP TABLE IF EXISTS main.file;");
 		m_database.execDML("DROP TABLE IF EXISTS main.symbol;");
 		m_database.execDML("DROP TABLE IF EXISTS main.node;");
@@ -1230,6 +1665,10 @@ void SqliteIndexStorage::clearTables()
 	{
 		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
 	}
+
+	std::lock_guard<std::mutex> lock(m_fileContentDictionariesMutex);
+	m_fileContentDictionaries.clear();
+	m_currentFileContentDictionaryId = -1;
 }
 
 void SqliteIndexStorage::setupTables()
@@ -1289,10 +1728,17 @@ void SqliteIndexStorage::setupTables()
 			"PRIMARY KEY(id), "
 			"FOREIGN KEY(id) REFERENCES node(id) ON DELETE CASCADE);");
 
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS filecontent_dictionary("
+			"id INTEGER, "
+			"dictionary BLOB, "
+			"PRIMARY KEY(id));");
+
 		m_database.execDML(
 			"CREATE TABLE IF NOT EXISTS filecontent("
 			"id INTEGER, "
-			"content TEXT, "
+			"dictionary_id INTEGER, "
+			"content BLOB, "
 			"PRIMARY KEY(id), "
 			"FOREIGN KEY(id) REFERENCES file(id)"
 			"ON DELETE CASCADE "
@@ -1325,6 +1771,13 @@ void SqliteIndexStorage::setupTables()
 			"FOREIGN KEY(element_id) REFERENCES element(id) ON DELETE CASCADE, "
 			"FOREIGN KEY(source_location_id) REFERENCES source_location(id) ON DELETE CASCADE);");
 
+		m_database.execDML(
+			"CREATE TABLE IF NOT EXISTS source_location_file("
+			"file_node_id INTEGER NOT NULL, "
+			"locations BLOB, "
+			"PRIMARY KEY(file_node_id), "
+			"FOREIGN KEY(file_node_id) REFERENCES node(id) ON DELETE CASCADE);");
+
 		m_database.execDML(
 			"CREATE TABLE IF NOT EXISTS component_access("
 			"node_id INTEGER NOT NULL, "
@@ -1418,15 +1871,22 @@ void SqliteIndexStorage::setupPrecompiledStatements()
 				stmt.bind(int(index) * 2 + 2, int(componentAccess.type));
 			},
 			m_database);
+		m_insertElementComponentBatchStatement.compile(
+			"INSERT INTO element_component(element_id, type, data) VALUES",
+			3,
+			[](CppSQLite3Statement& stmt, const StorageElementComponent& component, size_t index) {
+				stmt.bind(int(index) * 3 + 1, reinterpret_id_cast<int>(component.elementId));
+				stmt.bind(int(index) * 3 + 2, component.type);
+				stmt.bind(int(index) * 3 + 3, utility::encodeToUtf8(component.data).c_str());
+			},
+			m_database);
 
 		m_insertElementStmt = m_database.compileStatement("INSERT INTO element(id) VALUES(NULL);");
-		m_insertElementComponentStmt = m_database.compileStatement(
-			"INSERT INTO element_component(id, element_id, type, data) VALUES(NULL, ?, ?, ?);");
 		m_insertFileStmt = m_database.compileStatement(
 			"INSERT INTO file(id, path, language, modification_time, indexed, complete, "
 			"line_count) VALUES(?, ?, ?, ?, ?, ?, ?);");
 		m_insertFileContentStmt = m_database.compileStatement(
-			"INSERT INTO filecontent(id, content) VALUES(?, ?);");
+			"INSERT INTO filecontent(id, dictionary_id, content) VALUES(?, ?, ?);");
 		m_checkErrorExistsStmt = m_database.compileStatement(
 			"SELECT id FROM error WHERE "
 			"message = ? AND "
@@ -1446,12 +1906,332 @@ void SqliteIndexStorage::setupPrecompiledStatements()
 	}
 }
 
+std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForFile(
+	const FilePath& filePath, const SourceLocationFilter& filter) const
+{
+	std::shared_ptr<SourceLocationFile> ret = std::make_shared<SourceLocationFile>(
+		filePath, L"", true, false, false);
+
+	const StorageFile file = getFileByPath(filePath.wstr());
+	if (file.id == 0)	 // early out
+	{
+		return ret;
+	}
+
+	ret->setLanguage(file.languageIdentifier);
+	ret->setIsComplete(file.complete);
+	ret->setIsIndexed(file.indexed);
+
+	if (unpackSourceLocations(file.id, filter, *ret))
+	{
+		return ret;
+	}
+
+	std::string query = "WHERE file_node_id == ?";
+	QueryParameters parameters = {reinterpret_id_cast<int>(file.id)};
+	if (filter.startLine > 0 || filter.endLine != SourceLocationFilter().endLine)
+	{
+		query += " AND start_line <= ? AND end_line >= ?";
+		parameters.push_back(static_cast<int>(filter.endLine));
+		parameters.push_back(static_cast<int>(filter.startLine));
+	}
+	if (filter.type != -1)
+	{
+		query += " AND type == ?";
+		parameters.push_back(filter.type);
+	}
+
+	std::vector<StorageSourceLocation> sourceLocations = doGetAll<StorageSourceLocation>(
+		query, parameters);
+
+	std::vector<Id> sourceLocationIds;
+	sourceLocationIds.reserve(sourceLocations.size());
+	for (const StorageSourceLocation& storageLocation: sourceLocations)
+	{
+		sourceLocationIds.push_back(storageLocation.id);
+	}
+
+	std::map<Id, std::vector<Id>> sourceLocationIdToElementIds;
+	for (const StorageOccurrence& occurrence: getOccurrencesForLocationIds(sourceLocationIds))
+	{
+		sourceLocationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
+	}
+
+	for (const StorageSourceLocation& location: sourceLocations)
+	{
+		auto it = sourceLocationIdToElementIds.find(location.id);
+
+		ret->addSourceLocation(
+			intToLocationType(location.type),
+			location.id,
+			it != sourceLocationIdToElementIds.end() ? it->second : std::vector<Id>(),
+			location.startLine,
+			location.startCol,
+			location.endLine,
+			location.endCol);
+	}
+
+	return ret;
+}
+
+std::string SqliteIndexStorage::packSourceLocationsOfFile(Id fileId) const
+{
+	// Locations are sorted by start line and stored as varints of the differences to the
+	// previous location, so most values fit into a single byte:
+	// count, {id delta, type, start line delta, start column, line count, end column,
+	// element count, {element id delta}}
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT source_location.id, source_location.type, source_location.start_line, "
+		"source_location.start_column, source_location.end_line, source_location.end_column, "
+		"occurrence.element_id "
+		"FROM source_location "
+		"LEFT JOIN occurrence ON (occurrence.source_location_id = source_location.id) "
+		"WHERE source_location.file_node_id == ? "
+		"ORDER BY source_location.start_line, source_location.id, occurrence.element_id;",
+		{reinterpret_id_cast<int>(fileId)});
+	CppSQLite3Query& q = cachedQuery.query;
+
+	std::string locations;
+	std::vector<Id> elementIds;
+	size_t locationCount = 0;
+	int64_t previousId = 0;
+	int64_t previousStartLine = 0;
+	int64_t previousElementId = 0;
+
+	auto appendElementIds = [&]() {
+		appendVarInt(locations, elementIds.size());
+		for (const Id elementId: elementIds)
+		{
+			appendVarInt(
+				locations, zigZagEncode(reinterpret_id_cast<int64_t>(elementId) - previousElementId));
+			previousElementId = reinterpret_id_cast<int64_t>(elementId);
+		}
+		elementIds.clear();
+	};
+
+	while (!q.eof())
+	{
+		const int64_t id = q.getIntField(0, 0);
+		if (id != previousId || locationCount == 0)
+		{
+			if (locationCount > 0)
+			{
+				appendElementIds();
+			}
+
+			const int64_t startLine = q.getIntField(2, 0);
+			appendVarInt(locations, zigZagEncode(id - previousId));
+			appendVarInt(locations, q.getIntField(1, 0));
+			appendVarInt(locations, startLine - previousStartLine);
+			appendVarInt(locations, std::max(q.getIntField(3, 0), 0));
+			appendVarInt(locations, std::max<int64_t>(q.getIntField(4, 0) - startLine, 0));
+			appendVarInt(locations, std::max(q.getIntField(5, 0), 0));
+
+			previousId = id;
+			previousStartLine = startLine;
+			locationCount++;
+		}
+
+		if (!q.fieldIsNull(6))
+		{
+			elementIds.push_back(q.getIntField(6, 0));
+		}
+
+		q.nextRow();
+	}
+
+	if (locationCount > 0)
+	{
+		appendElementIds();
+	}
+
+	std::string ret;
+	appendVarInt(ret, locationCount);
+	return ret + locations;
+}
+
+bool SqliteIndexStorage::unpackSourceLocations(
+	Id fileId, const SourceLocationFilter& filter, SourceLocationFile& file) const
+{
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT locations FROM source_location_file WHERE file_node_id == ?;",
+		{reinterpret_id_cast<int>(fileId)});
+	CppSQLite3Query& q = cachedQuery.query;
+	if (q.eof())
+	{
+		return false;
+	}
+
+	int size = 0;
+	const unsigned char* it = q.getBlobField(0, size);
+	const unsigned char* end = it + size;
+
+	uint64_t locationCount = 0;
+	if (!readVarInt(it, end, locationCount))
+	{
+		return false;
+	}
+
+	struct Location
+	{
+		Id id;
+		int type;
+		size_t startLine;
+		size_t startColumn;
+		size_t endLine;
+		size_t endColumn;
+		std::vector<Id> elementIds;
+	};
+
+	// everything is decoded before adding the locations, so corrupted data can still fall back to
+	// the source_location table
+	std::vector<Location> locations;
+	int64_t id = 0;
+	uint64_t startLine = 0;
+	int64_t elementId = 0;
+	for (uint64_t i = 0; i < locationCount; i++)
+	{
+		uint64_t idDelta, type, startLineDelta, startColumn, lineCount, endColumn, elementCount;
+		if (!readVarInt(it, end, idDelta) || !readVarInt(it, end, type) ||
+			!readVarInt(it, end, startLineDelta) || !readVarInt(it, end, startColumn) ||
+			!readVarInt(it, end, lineCount) || !readVarInt(it, end, endColumn) ||
+			!readVarInt(it, end, elementCount) || elementCount > uint64_t(end - it))
+		{
+			LOG_ERROR("Packed source locations of file " + to_string(fileId) + " are corrupted.");
+			return false;
+		}
+
+		id += zigZagDecode(idDelta);
+		startLine += startLineDelta;
+
+		std::vector<Id> elementIds;
+		elementIds.reserve(elementCount);
+		for (uint64_t j = 0; j < elementCount; j++)
+		{
+			uint64_t elementIdDelta = 0;
+			if (!readVarInt(it, end, elementIdDelta))
+			{
+				LOG_ERROR("Packed source locations of file " + to_string(fileId) + " are corrupted.");
+				return false;
+			}
+			elementId += zigZagDecode(elementIdDelta);
+			elementIds.push_back(Id(elementId));
+		}
+
+		if (startLine > filter.endLine)
+		{
+			// locations are sorted by start line
+			break;
+		}
+
+		const uint64_t endLine = startLine + lineCount;
+		if (endLine < filter.startLine || (filter.type != -1 && int(type) != filter.type))
+		{
+			continue;
+		}
+
+		locations.push_back(
+			{Id(id), int(type), startLine, startColumn, endLine, endColumn, std::move(elementIds)});
+	}
+
+	for (Location& location: locations)
+	{
+		file.addSourceLocation(
+			intToLocationType(location.type),
+			location.id,
+			std::move(location.elementIds),
+			location.startLine,
+			location.startColumn,
+			location.endLine,
+			location.endColumn);
+	}
+
+	return true;
+}
+
+std::shared_ptr<TextAccess> SqliteIndexStorage::createFileContent(CppSQLite3Query& query) const
+{
+	int size = 0;
+	const unsigned char* data = query.getBlobField(1, size);
+
+	std::shared_ptr<CompressedText> text = CompressedText::create(
+		std::string(reinterpret_cast<const char*>(data), size),
+		getFileContentDictionary(query.getIntField(0, 0)));
+	if (!text)
+	{
+		LOG_ERROR("Stored file content has an unknown format.");
+		return TextAccess::createFromString("");
+	}
+
+	return TextAccess::createFromCompressedText(text);
+}
+
+std::shared_ptr<const CompressedTextDictionary> SqliteIndexStorage::getFileContentDictionary(
+	int dictionaryId) const
+{
+	if (dictionaryId == 0)
+	{
+		return nullptr;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_fileContentDictionariesMutex);
+		auto it = m_fileContentDictionaries.find(dictionaryId);
+		if (it != m_fileContentDictionaries.end())
+		{
+			return it->second;
+		}
+	}
+
+	std::shared_ptr<const CompressedTextDictionary> dictionary;
+	try
+	{
+		CachedQuery cachedQuery = executeCachedQuery(
+			"SELECT dictionary FROM filecontent_dictionary WHERE id = ?;", {dictionaryId});
+		CppSQLite3Query& q = cachedQuery.query;
+		if (!q.eof())
+		{
+			int size = 0;
+			const unsigned char* data = q.getBlobField(0, size);
+			dictionary = std::make_shared<CompressedTextDictionary>(
+				std::string(reinterpret_cast<const char*>(data), size));
+		}
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+	}
+
+	if (!dictionary)
+	{
+		LOG_ERROR("Missing file content dictionary " + std::to_string(dictionaryId) + ".");
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_fileContentDictionariesMutex);
+	return m_fileContentDictionaries.emplace(dictionaryId, dictionary).first->second;
+}
+
+int SqliteIndexStorage::getCurrentFileContentDictionaryId() const
+{
+	std::lock_guard<std::mutex> lock(m_fileContentDictionariesMutex);
+	if (m_currentFileContentDictionaryId < 0)
+	{
+		m_currentFileContentDictionaryId = executeCachedStatementScalar(
+			"SELECT MAX(id) FROM filecontent_dictionary;", {}, 0);
+	}
+	return m_currentFileContentDictionaryId;
+}
+
 template <>
 void SqliteIndexStorage::forEach<StorageEdge>(
-	const std::string& query, std::function<void(StorageEdge&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageEdge&&)> func) const
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, type, source_node_id, target_node_id FROM edge " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT id, type, source_node_id, target_node_id FROM edge " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1471,9 +2251,13 @@ void SqliteIndexStorage::forEach<StorageEdge>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageNode>(
-	const std::string& query, std::function<void(StorageNode&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageNode&&)> func) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, serialized_name FROM node " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT id, type, serialized_name FROM node " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1492,9 +2276,13 @@ void SqliteIndexStorage::forEach<StorageNode>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageSymbol>(
-	const std::string& query, std::function<void(StorageSymbol&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageSymbol&&)> func) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, definition_kind FROM symbol " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT id, definition_kind FROM symbol " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1512,10 +2300,13 @@ void SqliteIndexStorage::forEach<StorageSymbol>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageFile>(
-	const std::string& query, std::function<void(StorageFile&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageFile&&)> func) const
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, path, language, modification_time, indexed, complete FROM file " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT id, path, language, modification_time, indexed, complete FROM file " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1542,9 +2333,13 @@ void SqliteIndexStorage::forEach<StorageFile>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageLocalSymbol>(
-	const std::string& query, std::function<void(StorageLocalSymbol&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageLocalSymbol&&)> func) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, name FROM local_symbol " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT id, name FROM local_symbol " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1562,12 +2357,15 @@ void SqliteIndexStorage::forEach<StorageLocalSymbol>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageSourceLocation>(
-	const std::string& query, std::function<void(StorageSourceLocation&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageSourceLocation&&)> func) const
 {
-	CppSQLite3Query q = executeQuery(
+	CachedQuery cachedQuery = executeCachedQuery(
 		"SELECT id, file_node_id, start_line, start_column, end_line, end_column, type FROM "
 		"source_location " +
-		query + ";");
+		query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1592,10 +2390,13 @@ void SqliteIndexStorage::forEach<StorageSourceLocation>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageOccurrence>(
-	const std::string& query, std::function<void(StorageOccurrence&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageOccurrence&&)> func) const
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT element_id, source_location_id FROM occurrence " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT element_id, source_location_id FROM occurrence " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1613,9 +2414,13 @@ void SqliteIndexStorage::forEach<StorageOccurrence>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageComponentAccess>(
-	const std::string& query, std::function<void(StorageComponentAccess&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageComponentAccess&&)> func) const
 {
-	CppSQLite3Query q = executeQuery("SELECT node_id, type FROM component_access " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT node_id, type FROM component_access " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1633,10 +2438,13 @@ void SqliteIndexStorage::forEach<StorageComponentAccess>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageElementComponent>(
-	const std::string& query, std::function<void(StorageElementComponent&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageElementComponent&&)> func) const
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT element_id, type, data FROM element_component " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT element_id, type, data FROM element_component " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1655,10 +2463,13 @@ void SqliteIndexStorage::forEach<StorageElementComponent>(
 
 template <>
 void SqliteIndexStorage::forEach<StorageError>(
-	const std::string& query, std::function<void(StorageError&&)> func) const
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageError&&)> func) const
 {
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, message, fatal, indexed, translation_unit FROM error " + query + ";");
+	CachedQuery cachedQuery = executeCachedQuery(
+		"SELECT id, message, fatal, indexed, translation_unit FROM error " + query + ";", parameters);
+	CppSQLite3Query& q = cachedQuery.query;
 
 	while (!q.eof())
 	{
@@ -1,7 +1,10 @@
 #ifndef SQLITE_INDEX_STORAGE_H
 #define SQLITE_INDEX_STORAGE_H
 
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -29,6 +32,8 @@ class Version;
 class SourceLocationCollection;
 class SourceLocationFile;
 
+class CompressedTextDictionary;
+
 class SqliteIndexStorage: public SqliteStorage
 {
 public:
@@ -69,6 +74,12 @@ public:
 	void addElementComponents(const std::vector<StorageElementComponent>& components);
 	StorageError addError(const StorageErrorData& data);
 
+	// Adds the contents of another index database to this one and merges existing elements like
+	// the add functions above. The database gets attached and its ids are remapped by set based
+	// queries, so none of its tables is loaded into memory. Returns false if the merge failed and
+	// was rolled back.
+	bool injectDatabase(const FilePath& dbFilePath);
+
 	void removeElement(Id id);
 	void removeElements(const std::vector<Id>& ids);
 	void removeOccurrence(const StorageOccurrence& occurrence);
@@ -110,17 +121,25 @@ public:
 	std::shared_ptr<TextAccess> getFileContentByPath(const std::wstring& filePath) const;
 	std::shared_ptr<TextAccess> getFileContentById(Id fileId) const;
 
+	// Trains a compression dictionary on the stored file contents and recompresses them with it.
+	// Does nothing if the storage already has a dictionary, new files are compressed with it.
+	void trainFileContentDictionary();
+
 	void setFileIndexed(Id fileId, bool indexed);
 	void setFileCompleteIfNoError(Id fileId, const std::wstring& filePath, bool complete);
 	void setNodeType(int type, Id nodeId);
 
-	std::shared_ptr<SourceLocationFile> getSourceLocationsForFile(
-		const FilePath& filePath, const std::string& query = "") const;
+	std::shared_ptr<SourceLocationFile> getSourceLocationsForFile(const FilePath& filePath) const;
 	std::shared_ptr<SourceLocationFile> getSourceLocationsForLinesInFile(
 		const FilePath& filePath, size_t startLine, size_t endLine) const;
 	std::shared_ptr<SourceLocationFile> getSourceLocationsOfTypeInFile(
 		const FilePath& filePath, LocationType type) const;
 
+	// Stores the source locations of all files without packed locations as one delta encoded blob
+	// per file, which loads much faster than the rows of the source_location table. Any change to
+	// the source locations or occurrences of a file drops its blob again.
+	void packSourceLocations();
+
 	std::shared_ptr<SourceLocationCollection> getSourceLocationsForElementIds(
 		const std::vector<Id>& elementIds) const;
 
@@ -148,7 +167,7 @@ public:
 	{
 		if (id != 0)
 		{
-			return doGetFirst<ResultType>("WHERE id == " + to_string(id));
+			return doGetFirst<ResultType>("WHERE id == ?", {reinterpret_id_cast<int>(id)});
 		}
 		return ResultType();
 	}
@@ -159,7 +178,7 @@ public:
 		if (ids.size())
 		{
 			return doGetAll<ResultType>(
-				"WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")");
+				"WHERE " + getIdSetCondition("id"), {serializeIdSet(ids)});
 		}
 		return std::vector<ResultType>();
 	}
@@ -167,13 +186,13 @@ public:
 	template <typename StorageType>
 	void forEach(std::function<void(StorageType&&)> func) const
 	{
-		forEach("", func);
+		forEach("", {}, func);
 	}
 
 	template <typename StorageType>
 	void forEachOfType(int type, std::function<void(StorageType&&)> func) const
 	{
-		forEach("WHERE type == " + std::to_string(type), func);
+		forEach("WHERE type == ?", {type}, func);
 	}
 
 	template <typename StorageType>
@@ -181,7 +200,7 @@ public:
 	{
 		if (ids.size())
 		{
-			forEach("WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")", func);
+			forEach("WHERE " + getIdSetCondition("id"), {serializeIdSet(ids)}, func);
 		}
 	}
 
@@ -237,23 +256,52 @@ private:
 
 	static std::vector<std::pair<int, SqliteDatabaseIndex>> getIndices();
 
+	void clearTempIndices();
+	void injectAttachedDatabase();
+
 	void clearTables() override;
 	void setupTables() override;
 	void setupPrecompiledStatements() override;
 
+	struct SourceLocationFilter
+	{
+		size_t startLine = 0;
+		size_t endLine = std::numeric_limits<size_t>::max();
+		int type = -1;
+	};
+
+	std::shared_ptr<SourceLocationFile> getSourceLocationsForFile(
+		const FilePath& filePath, const SourceLocationFilter& filter) const;
+	// packed locations become stale when the locations or occurrences of their file change, so
+	// every write drops them with one statement instead of once per changed row
+	// fileIds is a comma separated id list or a query selecting file node ids
+	void removePackedSourceLocations(const std::string& fileIds);
+	void removePackedSourceLocationsOfOccurrences(const std::vector<StorageOccurrence>& occurrences);
+	std::string packSourceLocationsOfFile(Id fileId) const;
+	// returns false if there are no packed locations for the file
+	bool unpackSourceLocations(
+		Id fileId, const SourceLocationFilter& filter, SourceLocationFile& file) const;
+
+	// expects the dictionary id and the compressed content in the first two columns
+	std::shared_ptr<TextAccess> createFileContent(CppSQLite3Query& query) const;
+	std::shared_ptr<const CompressedTextDictionary> getFileContentDictionary(int dictionaryId) const;
+	int getCurrentFileContentDictionaryId() const;
+
 	template <typename ResultType>
-	std::vector<ResultType> doGetAll(const std::string& query) const
+	std::vector<ResultType> doGetAll(
+		const std::string& query, const QueryParameters& parameters = {}) const
 	{
 		std::vector<ResultType> elements;
-		forEach<ResultType>(
-			query, [&elements](ResultType&& element) { elements.emplace_back(element); });
+		forEach<ResultType>(query, parameters, [&elements](ResultType&& element) {
+			elements.emplace_back(element);
+		});
 		return elements;
 	}
 
 	template <typename ResultType>
-	ResultType doGetFirst(const std::string& query) const
+	ResultType doGetFirst(const std::string& query, const QueryParameters& parameters = {}) const
 	{
-		std::vector<ResultType> results = doGetAll<ResultType>(query + " LIMIT 1");
+		std::vector<ResultType> results = doGetAll<ResultType>(query + " LIMIT 1", parameters);
 		if (results.size() > 0)
 		{
 			return results[0];
@@ -262,7 +310,10 @@ private:
 	}
 
 	template <typename StorageType>
-	void forEach(const std::string& query, std::function<void(StorageType&&)> func) const;
+	void forEach(
+		const std::string& query,
+		const QueryParameters& parameters,
+		std::function<void(StorageType&&)> func) const;
 
 	LowMemoryStringMap<std::string, Id> m_tempNodeNameIndex;
 	LowMemoryStringMap<std::wstring, Id> m_tempWNodeNameIndex;
@@ -359,44 +410,68 @@ private:
 	InsertBatchStatement<StorageSourceLocationData> m_insertSourceLocationBatchStatement;
 	InsertBatchStatement<StorageOccurrence> m_insertOccurrenceBatchStatement;
 	InsertBatchStatement<StorageComponentAccess> m_insertComponentAccessBatchStatement;
+	InsertBatchStatement<StorageElementComponent> m_insertElementComponentBatchStatement;
 
 	CppSQLite3Statement m_insertElementStmt;
-	CppSQLite3Statement m_insertElementComponentStmt;
 	CppSQLite3Statement m_insertFileStmt;
 	CppSQLite3Statement m_insertFileContentStmt;
 	CppSQLite3Statement m_checkErrorExistsStmt;
 	CppSQLite3Statement m_insertErrorStmt;
+
+	mutable std::map<int, std::shared_ptr<const CompressedTextDictionary>> m_fileContentDictionaries;
+	mutable int m_currentFileContentDictionaryId = -1;
+	mutable std::mutex m_fileContentDictionariesMutex;
 };
 
 template <>
 void SqliteIndexStorage::forEach<StorageEdge>(
-	const std::string& query, std::function<void(StorageEdge&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageEdge&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageNode>(
-	const std::string& query, std::function<void(StorageNode&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageNode&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageSymbol>(
-	const std::string& query, std::function<void(StorageSymbol&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageSymbol&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageFile>(
-	const std::string& query, std::function<void(StorageFile&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageFile&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageLocalSymbol>(
-	const std::string& query, std::function<void(StorageLocalSymbol&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageLocalSymbol&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageSourceLocation>(
-	const std::string& query, std::function<void(StorageSourceLocation&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageSourceLocation&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageOccurrence>(
-	const std::string& query, std::function<void(StorageOccurrence&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageOccurrence&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageComponentAccess>(
-	const std::string& query, std::function<void(StorageComponentAccess&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageComponentAccess&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageElementComponent>(
-	const std::string& query, std::function<void(StorageElementComponent&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageElementComponent&&)> func) const;
 template <>
 void SqliteIndexStorage::forEach<StorageError>(
-	const std::string& query, std::function<void(StorageError&&)> func) const;
+	const std::string& query,
+	const QueryParameters& parameters,
+	std::function<void(StorageError&&)> func) const;
 
 #endif	  // SQLITE_INDEX_STORAGE_H
@@ -1,10 +1,15 @@
 #include "SqliteStorage.h"
 
+#include <charconv>
+
 #include "FileSystem.h"
 #include "TimeStamp.h"
 #include "logging.h"
 #include "utilityString.h"
 
+const size_t SqliteStorage::s_maxReadConnectionCount = 32;
+const std::chrono::seconds SqliteStorage::s_maxReadConnectionIdleTime(30);
+
 SqliteStorage::SqliteStorage(const FilePath& dbFilePath): m_dbFilePath(dbFilePath.getCanonical())
 {
 	if (!m_dbFilePath.getParentDirectory().empty() && !m_dbFilePath.getParentDirectory().exists())
@@ -29,6 +34,13 @@ SqliteStorage::SqliteStorage(const FilePath& dbFilePath): m_dbFilePath(dbFilePat
 
 SqliteStorage::~SqliteStorage()
 {
+	{
+		// all statements need to be finalized before the database can be closed
+		std::lock_guard<std::mutex> lock(m_connectionsMutex);
+		m_readConnections.clear();
+		m_cachedStatements.clear();
+	}
+
 	try
 	{
 		m_database.close();
@@ -84,17 +96,20 @@ void SqliteStorage::setVersion(size_t version)
 
 void SqliteStorage::beginTransaction()
 {
+	m_transactionThreadId = std::this_thread::get_id();
 	executeStatement("BEGIN TRANSACTION;");
 }
 
 void SqliteStorage::commitTransaction()
 {
 	executeStatement("COMMIT TRANSACTION;");
+	m_transactionThreadId = std::thread::id();
 }
 
 void SqliteStorage::rollbackTransaction()
 {
 	executeStatement("ROLLBACK TRANSACTION;");
+	m_transactionThreadId = std::thread::id();
 }
 
 void SqliteStorage::optimizeMemory() const
@@ -102,6 +117,81 @@ void SqliteStorage::optimizeMemory() const
 	executeStatement("VACUUM;");
 }
 
+void SqliteStorage::checkpoint() const
+{
+	if (m_concurrentReadsEnabled)
+	{
+		executeStatement("PRAGMA wal_checkpoint(TRUNCATE);");
+	}
+}
+
+std::vector<FilePath> SqliteStorage::getWalFilePaths(const FilePath& dbFilePath)
+{
+	return {FilePath(dbFilePath.wstr() + L"-wal"), FilePath(dbFilePath.wstr() + L"-shm")};
+}
+
+void SqliteStorage::checkpointFile(const FilePath& dbFilePath)
+{
+	if (!dbFilePath.recheckExists() || !getWalFilePaths(dbFilePath)[0].recheckExists())
+	{
+		return;
+	}
+
+	try
+	{
+		// opening the database recovers the log, closing the last connection removes it
+		CppSQLite3DB database;
+		database.open(utility::encodeToUtf8(dbFilePath.wstr()).c_str());
+		database.execQuery("PRAGMA wal_checkpoint(TRUNCATE);");
+		database.close();
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(
+			L"Failed to checkpoint database file \"" + dbFilePath.wstr() + L"\" with message: " +
+			utility::decodeFromUtf8(e.errorMessage()));
+	}
+}
+
+void SqliteStorage::removeDatabaseFile(const FilePath& dbFilePath)
+{
+	FileSystem::remove(dbFilePath);
+
+	for (const FilePath& walFilePath: getWalFilePaths(dbFilePath))
+	{
+		FileSystem::remove(walFilePath);
+	}
+}
+
+bool SqliteStorage::renameDatabaseFile(const FilePath& from, const FilePath& to)
+{
+	checkpointFile(from);
+
+	// a stale log next to the target would be applied to the renamed database
+	const std::vector<FilePath> toWalFilePaths = getWalFilePaths(to);
+	for (const FilePath& walFilePath: toWalFilePaths)
+	{
+		FileSystem::remove(walFilePath);
+	}
+
+	if (!FileSystem::rename(from, to))
+	{
+		return false;
+	}
+
+	// only left if the checkpoint failed, SQLite recovers the log when the database is opened
+	const std::vector<FilePath> fromWalFilePaths = getWalFilePaths(from);
+	for (size_t i = 0; i < fromWalFilePaths.size(); i++)
+	{
+		if (fromWalFilePaths[i].recheckExists())
+		{
+			FileSystem::rename(fromWalFilePaths[i], toWalFilePaths[i]);
+		}
+	}
+
+	return true;
+}
+
 FilePath SqliteStorage::getDbFilePath() const
 {
 	return m_dbFilePath;
@@ -128,6 +218,21 @@ TimeStamp SqliteStorage::getTime() const
 	return TimeStamp(getMetaValue("timestamp"));
 }
 
+void SqliteStorage::enableConcurrentReads()
+{
+	CppSQLite3Query q = executeQuery("PRAGMA journal_mode=WAL;");
+	if (!q.eof() && std::string(q.getStringField(0, "")) == "wal")
+	{
+		m_concurrentReadsEnabled = true;
+	}
+	else
+	{
+		LOG_WARNING(
+			L"Unable to enable write-ahead logging for database \"" + m_dbFilePath.wstr() +
+			L"\", queries will not run concurrently.");
+	}
+}
+
 void SqliteStorage::setupMetaTable()
 {
 	try
@@ -253,6 +358,73 @@ CppSQLite3Query SqliteStorage::executeQuery(CppSQLite3Statement& statement)
 	return CppSQLite3Query();
 }
 
+SqliteStorage::CachedQuery SqliteStorage::executeCachedQuery(
+	const std::string& statement, const QueryParameters& parameters) const
+{
+	CachedQuery cachedQuery;
+	try
+	{
+		cachedQuery.statement = getCachedStatement(statement, parameters);
+		cachedQuery.query = cachedQuery.statement->execQuery();
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+	}
+	return cachedQuery;
+}
+
+int SqliteStorage::executeCachedStatementScalar(
+	const std::string& statement, const QueryParameters& parameters, const int nullValue) const
+{
+	int ret = 0;
+	try
+	{
+		CachedQuery cachedQuery = executeCachedQuery(statement, parameters);
+
+		if (!cachedQuery.statement || cachedQuery.query.eof() || cachedQuery.query.numFields() < 1)
+		{
+			char error[] = "Invalid scalar query";
+			throw CppSQLite3Exception(CPPSQLITE_ERROR, error, false);
+		}
+
+		ret = cachedQuery.query.getIntField(0, nullValue);
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+	}
+
+	return ret;
+}
+
+std::string SqliteStorage::getIdSetCondition(const std::string& column)
+{
+	return column + " IN (SELECT value FROM json_each(?))";
+}
+
+std::string SqliteStorage::serializeIdSet(const std::vector<Id>& ids)
+{
+	std::string str;
+	str.reserve(ids.size() * 8 + 2);
+	str.push_back('[');
+
+	char buffer[24];
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		if (i != 0)
+		{
+			str.push_back(',');
+		}
+		const std::to_chars_result result = std::to_chars(
+			buffer, buffer + sizeof(buffer), static_id_cast<Id::type>(ids[i]));
+		str.append(buffer, result.ptr);
+	}
+
+	str.push_back(']');
+	return str;
+}
+
 bool SqliteStorage::hasTable(const std::string& tableName) const
 {
 	CppSQLite3Query q = executeQuery(
@@ -294,3 +466,171 @@ void SqliteStorage::insertOrUpdateMetaValue(const std::string& key, const std::s
 	stmt.bind(3, value.c_str());
 	executeStatement(stmt);
 }
+
+std::shared_ptr<CppSQLite3Statement> SqliteStorage::getCachedStatement(
+	const std::string& statement, const QueryParameters& parameters) const
+{
+	std::shared_ptr<CppSQLite3Statement> stmt;
+	{
+		std::lock_guard<std::mutex> lock(m_connectionsMutex);
+
+		CppSQLite3DB* database = &m_database;
+		StatementCache* cachedStatements = &m_cachedStatements;
+		ReadConnection* readConnection = getReadConnection();
+		if (readConnection)
+		{
+			database = &readConnection->database;
+			cachedStatements = &readConnection->cachedStatements;
+			readConnection->usedStatementCount++;
+			readConnection->lastUseTime = std::chrono::steady_clock::now();
+		}
+
+		// returns the statement to the cache and allows closing its read connection again
+		auto release = [this, readConnection](CachedStatement* entry) {
+			std::lock_guard<std::mutex> lock(m_connectionsMutex);
+			if (entry)
+			{
+				entry->inUse = false;
+			}
+			if (readConnection)
+			{
+				readConnection->usedStatementCount--;
+			}
+		};
+
+		try
+		{
+			std::unique_ptr<CachedStatement>& cachedStatement = (*cachedStatements)[statement];
+			if (!cachedStatement)
+			{
+				CppSQLite3Statement compiledStatement = database->compileStatement(
+					statement.c_str());
+				cachedStatement = std::make_unique<CachedStatement>();
+				cachedStatement->statement = compiledStatement;
+			}
+
+			if (!cachedStatement->inUse)
+			{
+				cachedStatement->inUse = true;
+
+				CachedStatement* entry = cachedStatement.get();
+				stmt = std::shared_ptr<CppSQLite3Statement>(
+					&entry->statement, [entry, release](CppSQLite3Statement* s) {
+						try
+						{
+							s->reset();
+						}
+						catch (CppSQLite3Exception& e)
+						{
+							LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+						}
+						release(entry);
+					});
+			}
+			else
+			{
+				// the cached statement is still used by an outer query
+				stmt = std::shared_ptr<CppSQLite3Statement>(
+					new CppSQLite3Statement(database->compileStatement(statement.c_str())),
+					[release](CppSQLite3Statement* s) {
+						delete s;
+						release(nullptr);
+					});
+			}
+		}
+		catch (CppSQLite3Exception&)
+		{
+			if (readConnection)
+			{
+				readConnection->usedStatementCount--;
+			}
+			throw;
+		}
+	}
+
+	for (size_t i = 0; i < parameters.size(); i++)
+	{
+		const int index = static_cast<int>(i + 1);
+		if (const int* value = std::get_if<int>(&parameters[i]))
+		{
+			stmt->bind(index, *value);
+		}
+		else
+		{
+			stmt->bind(index, std::get<std::string>(parameters[i]).c_str());
+		}
+	}
+
+	return stmt;
+}
+
+SqliteStorage::ReadConnection* SqliteStorage::getReadConnection() const
+{
+	const std::thread::id threadId = std::this_thread::get_id();
+	if (!m_concurrentReadsEnabled || m_transactionThreadId == threadId)
+	{
+		return nullptr;
+	}
+
+	auto it = m_readConnections.find(threadId);
+	if (it != m_readConnections.end())
+	{
+		return it->second.get();
+	}
+
+	closeIdleReadConnections();
+
+	if (m_readConnections.size() >= s_maxReadConnectionCount)
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<ReadConnection> readConnection = std::make_unique<ReadConnection>();
+	try
+	{
+		readConnection->database.open(utility::encodeToUtf8(m_dbFilePath.wstr()).c_str());
+		readConnection->database.execDML("PRAGMA query_only=ON;");
+	}
+	catch (CppSQLite3Exception& e)
+	{
+		LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+		return nullptr;
+	}
+
+	ReadConnection* ret = readConnection.get();
+	m_readConnections.emplace(threadId, std::move(readConnection));
+	return ret;
+}
+
+void SqliteStorage::closeIdleReadConnections() const
+{
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	auto leastRecentlyUsed = m_readConnections.end();
+	for (auto it = m_readConnections.begin(); it != m_readConnections.end();)
+	{
+		if (it->second->usedStatementCount)
+		{
+			it++;
+		}
+		else if (now - it->second->lastUseTime > s_maxReadConnectionIdleTime)
+		{
+			it = m_readConnections.erase(it);
+		}
+		else
+		{
+			if (leastRecentlyUsed == m_readConnections.end() ||
+				it->second->lastUseTime < leastRecentlyUsed->second->lastUseTime)
+			{
+				leastRecentlyUsed = it;
+			}
+			it++;
+		}
+	}
+
+	if (m_readConnections.size() >= s_maxReadConnectionCount &&
+		leastRecentlyUsed != m_readConnections.end())
+	{
+		m_readConnections.erase(leastRecentlyUsed);
+	}
+}
@@ -1,10 +1,21 @@
 #ifndef SQLITE_STORAGE_H
 #define SQLITE_STORAGE_H
 
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
 #include "CppSQLite3.h"
 
 #include "FilePath.h"
 #include "SqliteDatabaseIndex.h"
+#include "types.h"
 
 class SqliteStorageMigration;
 class TimeStamp;
@@ -27,6 +38,19 @@ public:
 
 	void optimizeMemory() const;
 
+	// moves all changes from the write-ahead log into the database file, so it can be copied
+	void checkpoint() const;
+
+	// a database file in write-ahead log mode keeps committed changes in "<file>-wal" and the
+	// log index in "<file>-shm" until all connections are closed
+	static std::vector<FilePath> getWalFilePaths(const FilePath& dbFilePath);
+	// moves the changes left in the write-ahead log of a database file without open connections,
+	// e.g. after a crash, into the database file
+	static void checkpointFile(const FilePath& dbFilePath);
+	static void removeDatabaseFile(const FilePath& dbFilePath);
+	// moves the database file together with what remains of its write-ahead log
+	static bool renameDatabaseFile(const FilePath& from, const FilePath& to);
+
 	FilePath getDbFilePath() const;
 
 	bool isEmpty() const;
@@ -36,6 +60,25 @@ public:
 	TimeStamp getTime() const;
 
 protected:
+	// values that get bound to the '?' placeholders of a query in order
+	typedef std::vector<std::variant<int, std::string>> QueryParameters;
+
+	struct CachedQuery
+	{
+		std::shared_ptr<CppSQLite3Statement> statement;
+		CppSQLite3Query query;
+	};
+
+	// Id sets are bound as a single parameter that gets expanded by a table-valued function, so
+	// queries that differ only in their ids share one compiled statement.
+	static std::string getIdSetCondition(const std::string& column);
+	static std::string serializeIdSet(const std::vector<Id>& ids);
+
+	// Switches the database to write-ahead logging. Afterwards cached queries run on a read-only
+	// connection per thread instead of serializing on m_database, except for the queries of the
+	// thread that has a transaction open.
+	void enableConcurrentReads();
+
 	void setupMetaTable();
 	void clearMetaTable();
 
@@ -46,6 +89,12 @@ protected:
 	CppSQLite3Query executeQuery(const std::string& statement) const;
 	static CppSQLite3Query executeQuery(CppSQLite3Statement& statement);
 
+	// Statements are compiled once per query text and reused afterwards. The statement of the
+	// returned query stays reserved until the query gets destroyed.
+	CachedQuery executeCachedQuery(const std::string& statement, const QueryParameters& parameters) const;
+	int executeCachedStatementScalar(
+		const std::string& statement, const QueryParameters& parameters, const int nullValue) const;
+
 	bool hasTable(const std::string& tableName) const;
 
 	std::string getMetaValue(const std::string& key) const;
@@ -60,8 +109,46 @@ private:
 	virtual void setupTables() = 0;
 	virtual void setupPrecompiledStatements() = 0;
 
+	struct CachedStatement
+	{
+		CppSQLite3Statement statement;
+		bool inUse = false;
+	};
+
+	typedef std::map<std::string, std::unique_ptr<CachedStatement>> StatementCache;
+
+	struct ReadConnection
+	{
+		CppSQLite3DB database;
+		StatementCache cachedStatements;
+		// statements of this connection that are handed out, the connection stays open meanwhile
+		size_t usedStatementCount = 0;
+		std::chrono::steady_clock::time_point lastUseTime;
+	};
+
+	static const size_t s_maxReadConnectionCount;
+	static const std::chrono::seconds s_maxReadConnectionIdleTime;
+
+	std::shared_ptr<CppSQLite3Statement> getCachedStatement(
+		const std::string& statement, const QueryParameters& parameters) const;
+	// expects m_connectionsMutex to be locked
+	ReadConnection* getReadConnection() const;
+	// Threads do not tell when they exit, so the connections of threads that did not query for a
+	// while get closed once another thread needs a connection. If all connections are taken the
+	// one that was used least recently gets closed as well. Expects m_connectionsMutex to be locked.
+	void closeIdleReadConnections() const;
+
 	std::vector<std::pair<int, SqliteDatabaseIndex>> m_indices;
 
+	// guards the statement caches and the read connections
+	mutable std::mutex m_connectionsMutex;
+	mutable StatementCache m_cachedStatements;
+	mutable std::map<std::thread::id, std::unique_ptr<ReadConnection>> m_readConnections;
+
+	bool m_concurrentReadsEnabled = false;
+	// other connections do not see the uncommitted changes of the transaction of this thread
+	std::atomic<std::thread::id> m_transactionThreadId;
+
 	bool m_precompiledStatementsInitialized = false;
 
 	friend SqliteStorageMigration;
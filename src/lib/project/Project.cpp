@@ -11,6 +11,7 @@
 #include "SourceGroup.h"
 #include "SourceGroupFactory.h"
 #include "SourceGroupStatusType.h"
+#include "SqliteStorage.h"
 #include "StorageCache.h"
 #include "StorageProvider.h"
 #include "TaskBuildIndex.h"
@@ -151,7 +152,7 @@ void Project::load(std::shared_ptr<DialogView> dialogView)
 				else
 				{
 					LOG_INFO("Discarding temporary indexing data on user's decision");
-					FileSystem::remove(tempDbPath);
+					SqliteStorage::removeDatabaseFile(tempDbPath);
 				}
 			}
 			else
@@ -159,7 +160,7 @@ void Project::load(std::shared_ptr<DialogView> dialogView)
 				LOG_INFO(
 					"Switching to temporary indexing data because no other persistent data was "
 					"found");
-				FileSystem::rename(tempDbPath, dbPath);
+				SqliteStorage::renameDatabaseFile(tempDbPath, dbPath);
 			}
 		}
 	}
@@ -545,6 +546,11 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
 	{
 		// store the indexed data into the temp db but keep the current state to allow browsing
 		// while indexing
+		m_storage->checkpoint();
+
+		// a stale write-ahead log would be applied to the copied database
+		SqliteStorage::removeDatabaseFile(tempIndexDbFilePath);
+
 		FileSystem::copyFile(indexDbFilePath, tempIndexDbFilePath);
 	}
 
@@ -810,8 +816,8 @@ bool Project::swapToTempStorageFile(
 {
 	try
 	{
-		FileSystem::remove(indexDbFilePath);
-		FileSystem::rename(tempIndexDbFilePath, indexDbFilePath);
+		SqliteStorage::removeDatabaseFile(indexDbFilePath);
+		SqliteStorage::renameDatabaseFile(tempIndexDbFilePath, indexDbFilePath);
 	}
 	catch (std::exception& /*e*/)
 	{
@@ -835,7 +841,7 @@ void Project::discardTempStorage()
 	if (tempIndexDbPath.exists())
 	{
 		LOG_INFO("Discarding temporary indexing data");
-		FileSystem::remove(tempIndexDbPath);
+		SqliteStorage::removeDatabaseFile(tempIndexDbPath);
 	}
 }
 
@@ -1,6 +1,9 @@
 #include "RefreshInfoGenerator.h"
 
+#include <unordered_set>
+
 #include "FileInfo.h"
+#include "FilePathHandle.h"
 #include "FileSystem.h"
 #include "PersistentStorage.h"
 #include "RefreshInfo.h"
@@ -9,20 +12,40 @@
 #include "TextAccess.h"
 #include "utility.h"
 
+namespace
+{
+std::unordered_set<FilePathHandle> getHandles(const std::set<FilePath>& filePaths)
+{
+	std::unordered_set<FilePathHandle> handles;
+	handles.reserve(filePaths.size());
+	for (const FilePath& filePath: filePaths)
+	{
+		handles.insert(FilePathHandle::intern(filePath));
+	}
+	return handles;
+}
+
+bool containsHandle(const std::unordered_set<FilePathHandle>& handles, const FilePath& filePath)
+{
+	return handles.find(FilePathHandle::find(filePath)) != handles.end();
+}
+}	 // namespace
+
 RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 	const std::vector<std::shared_ptr<SourceGroup>>& sourceGroups,
 	std::shared_ptr<const PersistentStorage> storage)
 {
 	// 1) Divide filepaths that are already known by the storage to "unchanged and indexed",
 	// "unchanged and non-indexed" and "changed"
-	std::set<FilePath> unchangedIndexedFilePaths;
-	std::set<FilePath> unchangedNonindexedFilePaths;
+	// membership is tested with interned handles, comparing paths is too slow for large projects
+	std::unordered_set<FilePathHandle> unchangedIndexedFilePaths;
+	std::unordered_set<FilePathHandle> unchangedNonindexedFilePaths;
 	std::set<FilePath> changedFilePaths;
 
 	{
 		const std::vector<FileInfo> fileInfosFromStorage = storage->getFileInfoForAllFiles();
 
-		std::set<FilePath> alreadyKnownPaths;
+		std::unordered_set<FilePathHandle> alreadyKnownPaths;
 		{
 			const std::set<FilePath> filePathsFromStorage = utility::toSet(
 				utility::convert<FileInfo, FilePath>(
@@ -32,9 +55,11 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 			{
 				if (sourceGroup->getStatus() == SOURCE_GROUP_STATUS_ENABLED)
 				{
-					utility::append(
-						alreadyKnownPaths,
-						sourceGroup->filterToContainedFilePaths(filePathsFromStorage));
+					for (const FilePath& path:
+						 sourceGroup->filterToContainedFilePaths(filePathsFromStorage))
+					{
+						alreadyKnownPaths.insert(FilePathHandle::intern(path));
+					}
 				}
 			}
 		}
@@ -42,7 +67,7 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 		// checking source and header files
 		for (const FileInfo& info: fileInfosFromStorage)
 		{
-			if (alreadyKnownPaths.find(info.path) != alreadyKnownPaths.end() && info.path.exists())
+			if (containsHandle(alreadyKnownPaths, info.path) && info.path.exists())
 			{
 				if (storage->getFilePathIndexed(info.path))
 				{
@@ -52,7 +77,7 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 					}
 					else
 					{
-						unchangedIndexedFilePaths.insert(info.path);
+						unchangedIndexedFilePaths.insert(FilePathHandle::intern(info.path));
 					}
 				}
 				else
@@ -62,7 +87,7 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 			}
 			else if (!storage->getFilePathIndexed(info.path) && !didFileChange(info, storage))
 			{
-				unchangedNonindexedFilePaths.insert(info.path);
+				unchangedNonindexedFilePaths.insert(FilePathHandle::intern(info.path));
 			}
 			else	// file has been removed
 			{
@@ -99,7 +124,9 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 	}
 
 	// 2.3.2) Get sets of referenced files
-	const std::set<FilePath> staticReferencedFilePaths = storage->getReferenced(staticSourceFiles);
+	const std::unordered_set<FilePathHandle> staticReferencedFilePaths = getHandles(
+		storage->getReferenced(staticSourceFiles));
+	const std::unordered_set<FilePathHandle> staticSourceFileHandles = getHandles(staticSourceFiles);
 	const std::set<FilePath> dynamicReferencedFilePaths = storage->getReferenced(filesToClear);
 
 	// 2.3.3) Add "dynamicReferencedFilePaths" to "filesToClear" that are not referenced by static
@@ -108,20 +135,20 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
 	//        re-indexing.
 	for (const FilePath& path: dynamicReferencedFilePaths)
 	{
-		if (staticReferencedFilePaths.find(path) == staticReferencedFilePaths.end() &&
-			staticSourceFiles.find(path) == staticSourceFiles.end())
+		if (!containsHandle(staticReferencedFilePaths, path) &&
+			!containsHandle(staticSourceFileHandles, path))
 		{
 			filesToClear.insert(path);
 		}
 	}
 
 	// 3) Figure out which files need to be indexed
+	const std::unordered_set<FilePathHandle> filesToClearHandles = getHandles(filesToClear);
 	std::set<FilePath> filesToIndex;
 	for (const FilePath& path: allSourceFilePathsFromSourcegroups)
 	{
-		if (filesToClear.find(path) != filesToClear.end() ||	// file will be cleared
-			unchangedIndexedFilePaths.find(path) ==
-				unchangedIndexedFilePaths.end())	// file has been changed or added
+		if (containsHandle(filesToClearHandles, path) ||	// file will be cleared
+			!containsHandle(unchangedIndexedFilePaths, path))	 // file has been changed or added
 		{
 			filesToIndex.insert(path);
 		}
@@ -155,11 +182,11 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForIncompleteFiles(
 
 	std::set<FilePath> incompleteFiles;
 	{
-		const std::set<FilePath> filesToClear = utility::concat(
-			info.filesToClear, info.nonIndexedFilesToClear);
+		const std::unordered_set<FilePathHandle> filesToClear = getHandles(
+			utility::concat(info.filesToClear, info.nonIndexedFilesToClear));
 		for (const FilePath& path: storage->getIncompleteFiles())
 		{
-			if (filesToClear.find(path) == filesToClear.end())
+			if (!containsHandle(filesToClear, path))
 			{
 				incompleteFiles.insert(path);
 			}
@@ -341,6 +341,16 @@ void ApplicationSettings::setVerboseIndexerLoggingEnabled(bool value)
 	setValue<bool>("application/verbose_indexer_logging_enabled", value);
 }
 
+bool ApplicationSettings::getTracingEnabled() const
+{
+	return getValue<bool>("application/tracing_enabled", false);
+}
+
+void ApplicationSettings::setTracingEnabled(bool value)
+{
+	setValue<bool>("application/tracing_enabled", value);
+}
+
 FilePath ApplicationSettings::getLogDirectoryPath() const
 {
 	return FilePath(getValue<std::wstring>(
@@ -82,6 +82,9 @@ public:
 	bool getVerboseIndexerLoggingEnabled() const;
 	void setVerboseIndexerLoggingEnabled(bool loggingEnabled);
 
+	bool getTracingEnabled() const;
+	void setTracingEnabled(bool tracingEnabled);
+
 	FilePath getLogDirectoryPath() const;
 	void setLogDirectoryPath(const FilePath& path);
 
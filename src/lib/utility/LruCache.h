@@ -0,0 +1,114 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <list>
+#include <map>
+#include <utility>
+
+// Keeps the values of the most recently used keys, the least recently used one is dropped when the
+// cache is full. Not thread-safe.
+template <typename KeyType, typename ValType>
+class LruCache
+{
+public:
+	LruCache(size_t maxSize);
+
+	// returns nullptr if the key is not cached, the pointer is valid until the cache changes
+	const ValType* getValue(const KeyType& key);
+	bool contains(const KeyType& key) const;
+
+	void setValue(const KeyType& key, ValType value);
+	void clear();
+
+	size_t getSize() const;
+	size_t getHitCount() const;
+	size_t getMissCount() const;
+
+private:
+	// most recently used first
+	std::list<std::pair<KeyType, ValType>> m_entries;
+	std::map<KeyType, typename std::list<std::pair<KeyType, ValType>>::iterator> m_index;
+	size_t m_maxSize;
+
+	size_t m_hitCount = 0;
+	size_t m_missCount = 0;
+};
+
+template <typename KeyType, typename ValType>
+LruCache<KeyType, ValType>::LruCache(size_t maxSize): m_maxSize(maxSize)
+{
+}
+
+template <typename KeyType, typename ValType>
+const ValType* LruCache<KeyType, ValType>::getValue(const KeyType& key)
+{
+	auto it = m_index.find(key);
+	if (it == m_index.end())
+	{
+		++m_missCount;
+		return nullptr;
+	}
+
+	++m_hitCount;
+	m_entries.splice(m_entries.begin(), m_entries, it->second);
+	return &it->second->second;
+}
+
+template <typename KeyType, typename ValType>
+bool LruCache<KeyType, ValType>::contains(const KeyType& key) const
+{
+	return m_index.find(key) != m_index.end();
+}
+
+template <typename KeyType, typename ValType>
+void LruCache<KeyType, ValType>::setValue(const KeyType& key, ValType value)
+{
+	auto it = m_index.find(key);
+	if (it != m_index.end())
+	{
+		it->second->second = std::move(value);
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return;
+	}
+
+	if (!m_maxSize)
+	{
+		return;
+	}
+
+	if (m_entries.size() >= m_maxSize)
+	{
+		m_index.erase(m_entries.back().first);
+		m_entries.pop_back();
+	}
+
+	m_entries.emplace_front(key, std::move(value));
+	m_index.emplace(key, m_entries.begin());
+}
+
+template <typename KeyType, typename ValType>
+void LruCache<KeyType, ValType>::clear()
+{
+	m_entries.clear();
+	m_index.clear();
+}
+
+template <typename KeyType, typename ValType>
+size_t LruCache<KeyType, ValType>::getSize() const
+{
+	return m_entries.size();
+}
+
+template <typename KeyType, typename ValType>
+size_t LruCache<KeyType, ValType>::getHitCount() const
+{
+	return m_hitCount;
+}
+
+template <typename KeyType, typename ValType>
+size_t LruCache<KeyType, ValType>::getMissCount() const
+{
+	return m_missCount;
+}
+
+#endif	  // LRU_CACHE_H
@@ -0,0 +1,76 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// Unbounded lock-free queue for many producers and a single consumer. Pushing never blocks, a push
+// that is still in progress may make pop return false until it is finished.
+template <typename T>
+class MpscQueue
+{
+public:
+	MpscQueue();
+	~MpscQueue();
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	// may be called from any thread
+	void push(T value);
+
+	// must only be called by the consumer thread
+	bool pop(T& value);
+
+private:
+	struct Node
+	{
+		T value = T();
+		std::atomic<Node*> next = nullptr;
+	};
+
+	// producers append behind the head, the consumer owns the tail, which is an already popped node
+	std::atomic<Node*> m_head;
+	Node* m_tail;
+};
+
+template <typename T>
+MpscQueue<T>::MpscQueue(): m_head(new Node()), m_tail(m_head.load())
+{
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue()
+{
+	T value;
+	while (pop(value))
+		;
+	delete m_tail;
+}
+
+template <typename T>
+void MpscQueue<T>::push(T value)
+{
+	Node* node = new Node();
+	node->value = std::move(value);
+
+	Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+}
+
+template <typename T>
+bool MpscQueue<T>::pop(T& value)
+{
+	Node* next = m_tail->next.load(std::memory_order_acquire);
+	if (!next)
+	{
+		return false;
+	}
+
+	value = std::move(next->value);
+	delete m_tail;
+	m_tail = next;
+	return true;
+}
+
+#endif	  // MPSC_QUEUE_H
@@ -0,0 +1,87 @@
+#include "FilePathHandle.h"
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "FilePath.h"
+
+namespace
+{
+class FilePathInterner
+{
+public:
+	static FilePathInterner& getInstance()
+	{
+		static FilePathInterner s_instance;
+		return s_instance;
+	}
+
+	const FilePath* find(const std::wstring& path) const
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		std::unordered_map<std::wstring, const FilePath*>::const_iterator it = m_paths.find(path);
+		return it != m_paths.end() ? it->second : nullptr;
+	}
+
+	const FilePath* intern(std::wstring path)
+	{
+		if (const FilePath* filePath = find(path))
+		{
+			return filePath;
+		}
+
+		std::unique_lock<std::shared_mutex> lock(m_mutex);
+		std::unordered_map<std::wstring, const FilePath*>::const_iterator it = m_paths.find(path);
+		if (it != m_paths.end())
+		{
+			return it->second;
+		}
+
+		// deque elements keep their address when more paths get added
+		m_filePaths.emplace_back(path);
+		m_paths.emplace(std::move(path), &m_filePaths.back());
+		return &m_filePaths.back();
+	}
+
+	size_t size() const
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		return m_filePaths.size();
+	}
+
+private:
+	std::deque<FilePath> m_filePaths;
+	std::unordered_map<std::wstring, const FilePath*> m_paths;
+	mutable std::shared_mutex m_mutex;
+};
+}	 // namespace
+
+FilePathHandle FilePathHandle::intern(const FilePath& filePath)
+{
+	return FilePathHandle(FilePathInterner::getInstance().intern(filePath.wstr()));
+}
+
+FilePathHandle FilePathHandle::find(const FilePath& filePath)
+{
+	return FilePathHandle(FilePathInterner::getInstance().find(filePath.wstr()));
+}
+
+size_t FilePathHandle::getInternedPathCount()
+{
+	return FilePathInterner::getInstance().size();
+}
+
+bool FilePathHandle::isNull() const
+{
+	return m_path == nullptr;
+}
+
+const FilePath& FilePathHandle::getFilePath() const
+{
+	static const FilePath s_emptyPath;
+	return m_path ? *m_path : s_emptyPath;
+}
+
+FilePathHandle::FilePathHandle(const FilePath* path): m_path(path) {}
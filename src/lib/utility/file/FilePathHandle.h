@@ -0,0 +1,61 @@
+#ifndef FILE_PATH_HANDLE_H
+#define FILE_PATH_HANDLE_H
+
+#include <cstddef>
+#include <functional>
+
+class FilePath;
+
+// Handle of a file path interned in a process wide table. Paths with the same string share one
+// handle, so copying, comparing and hashing a handle does not touch the path. Interned paths are
+// kept until the process ends.
+class FilePathHandle
+{
+public:
+	// returns the handle of 'filePath', the path gets interned if it was not before
+	static FilePathHandle intern(const FilePath& filePath);
+
+	// returns a null handle if 'filePath' was never interned
+	static FilePathHandle find(const FilePath& filePath);
+
+	static size_t getInternedPathCount();
+
+	FilePathHandle() = default;
+
+	bool isNull() const;
+
+	// The interned path is shared by all threads, copy it before relying on its cached file system
+	// state. Returns an empty path for null handles.
+	const FilePath& getFilePath() const;
+
+	bool operator==(const FilePathHandle& other) const
+	{
+		return m_path == other.m_path;
+	}
+
+	bool operator!=(const FilePathHandle& other) const
+	{
+		return m_path != other.m_path;
+	}
+
+private:
+	friend struct std::hash<FilePathHandle>;
+
+	explicit FilePathHandle(const FilePath* path);
+
+	const FilePath* m_path = nullptr;
+};
+
+namespace std
+{
+template <>
+struct hash<FilePathHandle>
+{
+	size_t operator()(const FilePathHandle& handle) const noexcept
+	{
+		return std::hash<const FilePath*>()(handle.m_path);
+	}
+};
+}	 // namespace std
+
+#endif	  // FILE_PATH_HANDLE_H
@@ -2,13 +2,13 @@
 
 #include "FilePath.h"
 #include "FilePathFilter.h"
+#include "utilityString.h"
 
 FileRegister::FileRegister(
 	const FilePath& currentPath,
 	const std::set<FilePath>& indexedPaths,
 	const std::set<FilePathFilter>& excludeFilters)
 	: m_currentPath(currentPath)
-	, m_indexedPaths(indexedPaths)
 	, m_excludeFilters(excludeFilters)
 	, m_hasFilePathCache([&](const std::wstring& f) {
 		const FilePath filePath(f);
@@ -21,23 +21,40 @@ FileRegister::FileRegister(
 
 		if (!ret)
 		{
-			for (const FilePath& indexedPath: m_indexedPaths)
+			ret = m_indexedFilePaths.find(FilePathHandle::find(filePath)) !=
+				m_indexedFilePaths.end();
+		}
+
+		if (!ret && filePath.exists())
+		{
+			// paths with other "./" or "../" components or through symbolic links
+			ret = m_indexedFilePaths.find(FilePathHandle::find(filePath.getCanonical())) !=
+				m_indexedFilePaths.end();
+
+			// paths that only differ in case name the same file on some file systems
+			if (!ret)
 			{
-				if (indexedPath.isDirectory())
+				auto range = m_indexedFilePathsByName.equal_range(
+					utility::toLowerCase(filePath.fileName()));
+				for (auto it = range.first; it != range.second; it++)
 				{
-					if (indexedPath.contains(filePath))
+					if (it->second == filePath)
 					{
 						ret = true;
 						break;
 					}
 				}
-				else
+			}
+		}
+
+		if (!ret)
+		{
+			for (const FilePath& indexedDirectoryPath: m_indexedDirectoryPaths)
+			{
+				if (indexedDirectoryPath.contains(filePath))
 				{
-					if (indexedPath == filePath)
-					{
-						ret = true;
-						break;
-					}
+					ret = true;
+					break;
 				}
 			}
 		}
@@ -49,6 +66,25 @@ FileRegister::FileRegister(
 		return ret;
 	})
 {
+	// indexed files are matched by their interned handles, only directories need to be searched
+	for (const FilePath& indexedPath: indexedPaths)
+	{
+		if (indexedPath.isDirectory())
+		{
+			m_indexedDirectoryPaths.push_back(indexedPath);
+		}
+		else
+		{
+			m_indexedFilePaths.insert(FilePathHandle::intern(indexedPath));
+
+			if (indexedPath.exists())
+			{
+				m_indexedFilePaths.insert(FilePathHandle::intern(indexedPath.getCanonical()));
+				m_indexedFilePathsByName.emplace(
+					utility::toLowerCase(indexedPath.fileName()), indexedPath);
+			}
+		}
+	}
 }
 
 FileRegister::~FileRegister() = default;
@@ -2,8 +2,12 @@
 #define FILE_REGISTER_H
 
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "FilePath.h"
+#include "FilePathHandle.h"
 #include "UnorderedCache.h"
 
 class FilePathFilter;
@@ -21,7 +25,11 @@ public:
 
 private:
 	const FilePath& m_currentPath;
-	const std::set<FilePath> m_indexedPaths;
+	// holds the handles of the indexed files as given and, for existing files, of their canonical paths
+	std::unordered_set<FilePathHandle> m_indexedFilePaths;
+	// existing indexed files by lower case file name, for file systems that ignore the case
+	std::unordered_multimap<std::wstring, FilePath> m_indexedFilePathsByName;
+	std::vector<FilePath> m_indexedDirectoryPaths;
 	const std::set<FilePathFilter> m_excludeFilters;
 	mutable UnorderedCache<std::wstring, bool> m_hasFilePathCache;
 };
@@ -1,57 +1,45 @@
 #include "SharedMemory.h"
 
+#include "Platform.h"
 #include "SharedMemoryGarbageCollector.h"
 #include "logging.h"
 
 const char* SharedMemory::s_memoryNamePrefix = "srctrlmem_";
 const char* SharedMemory::s_mutexNamePrefix = "srctrlmtx_";
+const char* SharedMemory::s_generationKeyName = "memory_generation";
+
+const bool SharedMemory::s_keepsMemoryMapped = !utility::Platform::isWindows();
 
 SharedMemory::ScopedAccess::ScopedAccess(SharedMemory* memory)
 	: boost::interprocess::scoped_lock<boost::interprocess::named_mutex>(memory->getMutex())
-	//, m_memory(boost::interprocess::open_only, memory->getMemoryName().c_str())
+	, m_sharedMemory(memory)
+	, m_memory(memory->getMappedMemory())
 	, m_memoryName(memory->getMemoryName())
 	, m_minimumMemorySize(memory->getInitialMemorySize())
 {
-	try
-	{
-		m_memory = boost::interprocess::managed_shared_memory(
-			boost::interprocess::open_only, memory->getMemoryName().c_str());
-	}
-	catch (boost::interprocess::interprocess_exception& e)
-	{
-		LOG_ERROR_STREAM(
-			<< "boost exception thrown at ScopedAccess constructor - " << memory->getMemoryName()
-			<< ": " << e.what());
-
-		// Behaves the same as the initializer construction, with the error printed out
-		// throw e;
+}
 
-		boost::interprocess::permissions permissions;
-		permissions.set_unrestricted();
-		m_memory = boost::interprocess::managed_shared_memory(
-			boost::interprocess::open_or_create,
-			memory->getMemoryName().c_str(),
-			memory->getInitialMemorySize(),
-			nullptr,
-			permissions);
+SharedMemory::ScopedAccess::~ScopedAccess()
+{
+	if (!s_keepsMemoryMapped)
+	{
+		m_sharedMemory->unmapMemory();
 	}
 }
 
-SharedMemory::ScopedAccess::~ScopedAccess() = default;
-
 SharedMemory::Allocator* SharedMemory::ScopedAccess::getAllocator()
 {
-	return m_memory.get_segment_manager();
+	return m_memory->get_segment_manager();
 }
 
 size_t SharedMemory::ScopedAccess::getMemorySize() const
 {
-	return m_memory.get_size();
+	return m_memory->get_size();
 }
 
 size_t SharedMemory::ScopedAccess::getFreeMemorySize() const
 {
-	return m_memory.get_free_memory();
+	return m_memory->get_free_memory();
 }
 
 size_t SharedMemory::ScopedAccess::getUsedMemorySize() const
@@ -61,12 +49,11 @@ size_t SharedMemory::ScopedAccess::getUsedMemorySize() const
 
 void SharedMemory::ScopedAccess::growMemory(size_t size)
 {
-	m_memory = boost::interprocess::managed_shared_memory();
+	m_sharedMemory->unmapMemory();
 
 	boost::interprocess::managed_shared_memory::grow(m_memoryName.c_str(), size);
 
-	m_memory = boost::interprocess::managed_shared_memory(
-		boost::interprocess::open_only, m_memoryName.c_str());
+	m_memory = m_sharedMemory->mapMemory(true);
 }
 
 void SharedMemory::ScopedAccess::shrinkToFitMemory()
@@ -76,12 +63,11 @@ void SharedMemory::ScopedAccess::shrinkToFitMemory()
 		return;
 	}
 
-	m_memory = boost::interprocess::managed_shared_memory();
+	m_sharedMemory->unmapMemory();
 
 	boost::interprocess::managed_shared_memory::shrink_to_fit(m_memoryName.c_str());
 
-	m_memory = boost::interprocess::managed_shared_memory(
-		boost::interprocess::open_only, m_memoryName.c_str());
+	m_memory = m_sharedMemory->mapMemory(true);
 }
 
 std::string SharedMemory::ScopedAccess::logString() const
@@ -202,6 +188,8 @@ SharedMemory::~SharedMemory()
 {
 	try
 	{
+		unmapMemory();
+
 		if (m_mode == CREATE_AND_DELETE)
 		{
 			SharedMemoryGarbageCollector* collector = SharedMemoryGarbageCollector::getInstance();
@@ -280,3 +268,55 @@ size_t SharedMemory::getInitialMemorySize() const
 {
 	return m_initialMemorySize;
 }
+
+boost::interprocess::managed_shared_memory* SharedMemory::getMappedMemory()
+{
+	// the generation is read through the old mapping, which stays valid because segments never
+	// move and the counter is allocated before the segment grows for the first time
+	if (m_memory && *m_generation == m_mappedGeneration)
+	{
+		return m_memory.get();
+	}
+
+	unmapMemory();
+	return mapMemory(false);
+}
+
+boost::interprocess::managed_shared_memory* SharedMemory::mapMemory(bool sizeChanged)
+{
+	try
+	{
+		m_memory = std::make_unique<boost::interprocess::managed_shared_memory>(
+			boost::interprocess::open_only, getMemoryName().c_str());
+	}
+	catch (boost::interprocess::interprocess_exception& e)
+	{
+		LOG_ERROR_STREAM(
+			<< "boost exception thrown at shared memory mapping - " << getMemoryName() << ": "
+			<< e.what());
+
+		boost::interprocess::permissions permissions;
+		permissions.set_unrestricted();
+		m_memory = std::make_unique<boost::interprocess::managed_shared_memory>(
+			boost::interprocess::open_or_create,
+			getMemoryName().c_str(),
+			getInitialMemorySize(),
+			nullptr,
+			permissions);
+	}
+
+	m_generation = m_memory->find_or_construct<size_t>(s_generationKeyName)(0);
+	if (sizeChanged)
+	{
+		(*m_generation)++;
+	}
+	m_mappedGeneration = *m_generation;
+
+	return m_memory.get();
+}
+
+void SharedMemory::unmapMemory()
+{
+	m_memory.reset();
+	m_generation = nullptr;
+}
@@ -1,6 +1,7 @@
 #ifndef SHARED_MEMORY_H
 #define SHARED_MEMORY_H
 
+#include <memory>
 #include <string>
 
 #include <boost/interprocess/containers/deque.hpp>
@@ -41,6 +42,11 @@ public:
 	using Set =
 		boost::interprocess::set<T, std::less<T>, boost::interprocess::allocator<T, Allocator>>;
 
+	// Segments stay mapped between accesses and are only mapped again after their size changed.
+	// Windows can't resize a segment that other processes have mapped, so there every access maps
+	// the segment anew.
+	static const bool s_keepsMemoryMapped;
+
 	// Names addressing shared memory objects longer than 29 characters can throw an exception
 	static std::string checkName(const std::string& name);
 	static std::string checkSharedMemory(const std::string& name);
@@ -67,37 +73,38 @@ public:
 		template <typename T>
 		T* accessValue(const std::string& key)
 		{
-			return m_memory.find_or_construct<T>(key.c_str())();
+			return m_memory->find_or_construct<T>(key.c_str())();
 		}
 
 		template <typename T>
 		T* accessValues(const std::string& key, size_t count)
 		{
-			return m_memory.find_or_construct<T>(key.c_str())[count]();
+			return m_memory->find_or_construct<T>(key.c_str())[count]();
 		}
 
 		template <typename T>
 		T* accessValueWithAllocator(const std::string& key)
 		{
-			return m_memory.find_or_construct<T>(key.c_str())(getAllocator());
+			return m_memory->find_or_construct<T>(key.c_str())(getAllocator());
 		}
 
 		template <typename T>
 		T* accessValuesWithAllocator(const std::string& key, size_t count)
 		{
-			return m_memory.find_or_construct<T>(key.c_str())[count](getAllocator());
+			return m_memory->find_or_construct<T>(key.c_str())[count](getAllocator());
 		}
 
 		template <typename T>
 		void destroyValue(const std::string& key)
 		{
-			m_memory.destroy<T>(key.c_str());
+			m_memory->destroy<T>(key.c_str());
 		}
 
 		std::string logString() const;
 
 	private:
-		boost::interprocess::managed_shared_memory m_memory;
+		SharedMemory* m_sharedMemory;
+		boost::interprocess::managed_shared_memory* m_memory;
 		std::string m_memoryName;
 		size_t m_minimumMemorySize;
 	};
@@ -107,6 +114,7 @@ public:
 private:
 	static const char* s_memoryNamePrefix;
 	static const char* s_mutexNamePrefix;
+	static const char* s_generationKeyName;
 
 	std::string getMemoryName() const;
 	std::string getMutexName() const;
@@ -115,11 +123,22 @@ private:
 
 	size_t getInitialMemorySize() const;
 
+	// these must only be called while holding the mutex
+	boost::interprocess::managed_shared_memory* getMappedMemory();
+	boost::interprocess::managed_shared_memory* mapMemory(bool sizeChanged);
+	void unmapMemory();
+
 	std::shared_ptr<boost::interprocess::named_mutex> m_mutex;
 	std::string m_name;
 	AccessMode m_mode;
 
 	size_t m_initialMemorySize;
+
+	std::unique_ptr<boost::interprocess::managed_shared_memory> m_memory;
+
+	// counts the size changes of the segment and lives within it
+	size_t* m_generation = nullptr;
+	size_t m_mappedGeneration = 0;
 };
 
 #endif	  // SHARED_MEMORY_H
@@ -0,0 +1,86 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Fixed size lock-free ring for exactly one producer and one consumer. It holds no pointers to
+// itself, so it can be placed in shared memory and used by two processes, as long as 'T' is valid
+// in both of them (e.g. an offset_ptr into the same segment).
+template <typename T, size_t Capacity>
+class SpscRing
+{
+public:
+	static_assert(std::atomic<size_t>::is_always_lock_free, "ring indices need lock-free atomics");
+
+	SpscRing() = default;
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	// must only be called by the producer, returns false if the ring is full
+	bool push(const T& value);
+
+	// must only be called by the consumer, returns false if the ring is empty
+	bool pop(T& value);
+
+	// may be called by both sides, the result can be outdated by the time it is used
+	size_t size() const;
+	bool isFull() const;
+
+private:
+	// padded to a cache line, because shared memory allocations are not aligned to them
+	struct Index
+	{
+		std::atomic<size_t> value = 0;
+		char padding[64 - sizeof(std::atomic<size_t>)];
+	};
+
+	// the indices are only ever increased, the slot of an index is 'index % Capacity'
+	Index m_readIndex;
+	Index m_writeIndex;
+	T m_slots[Capacity];
+};
+
+template <typename T, size_t Capacity>
+bool SpscRing<T, Capacity>::push(const T& value)
+{
+	const size_t writeIndex = m_writeIndex.value.load(std::memory_order_relaxed);
+	if (writeIndex - m_readIndex.value.load(std::memory_order_acquire) >= Capacity)
+	{
+		return false;
+	}
+
+	m_slots[writeIndex % Capacity] = value;
+	m_writeIndex.value.store(writeIndex + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t Capacity>
+bool SpscRing<T, Capacity>::pop(T& value)
+{
+	const size_t readIndex = m_readIndex.value.load(std::memory_order_relaxed);
+	if (readIndex == m_writeIndex.value.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	value = m_slots[readIndex % Capacity];
+	m_readIndex.value.store(readIndex + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t Capacity>
+size_t SpscRing<T, Capacity>::size() const
+{
+	const size_t readIndex = m_readIndex.value.load(std::memory_order_acquire);
+	return m_writeIndex.value.load(std::memory_order_acquire) - readIndex;
+}
+
+template <typename T, size_t Capacity>
+bool SpscRing<T, Capacity>::isFull() const
+{
+	return size() >= Capacity;
+}
+
+#endif	  // SPSC_RING_H
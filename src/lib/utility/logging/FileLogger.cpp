@@ -48,34 +48,54 @@ FileLogger::FileLogger()
 	, m_logFileName(L"log")
 	, m_logDirectory(L"user/log/")
 {
-	updateLogFileName();
+	updateLogFileName(false);
+
+	m_writerThread = std::thread(&FileLogger::writerLoop, this);
+}
+
+FileLogger::~FileLogger()
+{
+	m_stopped = true;
+	m_wakeUpCount++;
+	m_wakeUpCount.notify_one();
+
+	m_writerThread.join();
 }
 
 FilePath FileLogger::getLogFilePath() const
 {
+	std::lock_guard<std::mutex> lock(m_fileMutex);
 	return m_currentLogFilePath;
 }
 
 void FileLogger::setLogFilePath(const FilePath& filePath)
 {
+	flush();
+
+	std::lock_guard<std::mutex> lock(m_fileMutex);
 	m_currentLogFilePath = filePath;
 	m_logFileName = L"";
 }
 
 void FileLogger::setLogDirectory(const FilePath& filePath)
 {
-	m_logDirectory = filePath;
-	FileSystem::createDirectories(m_logDirectory);
+	{
+		std::lock_guard<std::mutex> lock(m_fileMutex);
+		m_logDirectory = filePath;
+	}
+	FileSystem::createDirectories(filePath);
 }
 
 void FileLogger::setFileName(const std::wstring& fileName)
 {
+	flush();
+
+	std::lock_guard<std::mutex> lock(m_fileMutex);
 	if (fileName != m_logFileName)
 	{
 		m_logFileName = fileName;
-		m_currentLogLineCount = 0;
 		m_currentLogFileCount = 0;
-		updateLogFileName();
+		updateLogFileName(false);
 	}
 }
 
@@ -94,19 +114,28 @@ void FileLogger::logError(const LogMessage& message)
 	logMessage("ERROR", message);
 }
 
-void FileLogger::setMaxLogLineCount(unsigned int lineCount)
+void FileLogger::setMaxLogFileSize(size_t byteCount)
 {
-	m_maxLogLineCount = lineCount;
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	m_maxLogFileSize = byteCount;
 }
 
 void FileLogger::setMaxLogFileCount(unsigned int fileCount)
 {
+	std::lock_guard<std::mutex> lock(m_fileMutex);
 	m_maxLogFileCount = fileCount;
+	updateLogFileName(false);
 }
 
 void FileLogger::deleteLogFiles(const std::wstring& cutoffDate)
 {
-	for (const FilePath& file: FileSystem::getFilePathsFromDirectory(m_logDirectory, {L".txt"}))
+	FilePath logDirectory;
+	{
+		std::lock_guard<std::mutex> lock(m_fileMutex);
+		logDirectory = m_logDirectory;
+	}
+
+	for (const FilePath& file: FileSystem::getFilePathsFromDirectory(logDirectory, {L".txt"}))
 	{
 		if (file.fileName() < cutoffDate)
 		{
@@ -115,61 +144,131 @@ void FileLogger::deleteLogFiles(const std::wstring& cutoffDate)
 	}
 }
 
-void FileLogger::updateLogFileName()
+void FileLogger::flush()
+{
+	const uint64_t pushedLineCount = m_pushedLineCount.load(std::memory_order_acquire);
+
+	uint64_t writtenLineCount = m_writtenLineCount.load(std::memory_order_acquire);
+	while (writtenLineCount < pushedLineCount)
+	{
+		m_writtenLineCount.wait(writtenLineCount, std::memory_order_acquire);
+		writtenLineCount = m_writtenLineCount.load(std::memory_order_acquire);
+	}
+}
+
+void FileLogger::updateLogFileName(bool rotate)
 {
 	if (m_logFileName.empty())
 	{
 		return;
 	}
 
-	bool fileChanged = false;
-
 	std::wstring currentLogFilePath = m_logDirectory.wstr() + m_logFileName;
 	if (m_maxLogFileCount > 0)
 	{
-		currentLogFilePath += L"_";
-		if (m_currentLogLineCount >= m_maxLogLineCount)
+		if (rotate)
 		{
-			m_currentLogLineCount = 0;
-
 			m_currentLogFileCount++;
 			if (m_currentLogFileCount >= m_maxLogFileCount)
 			{
 				m_currentLogFileCount = 0;
 			}
-			fileChanged = true;
 		}
-		currentLogFilePath += std::to_wstring(m_currentLogFileCount);
+		currentLogFilePath += L"_" + std::to_wstring(m_currentLogFileCount);
 	}
 	currentLogFilePath += L".txt";
 
 	m_currentLogFilePath = FilePath(currentLogFilePath);
 
-	if (fileChanged)
+	if (rotate)
 	{
+		// the ring wrapped around or the file is left over from an earlier run
+		m_fileStream.close();
 		FileSystem::remove(m_currentLogFilePath);
 	}
 }
 
 void FileLogger::logMessage(const std::string& type, const LogMessage& message)
 {
-	std::ofstream fileStream;
-	fileStream.open(m_currentLogFilePath.str(), std::ios::app);
-	fileStream << message.getTimeString("%H:%M:%S") << " | ";
-	fileStream << message.threadId << " | ";
+	std::string line = message.getTimeString("%H:%M:%S") + " | ";
+
+	std::stringstream threadId;
+	threadId << message.threadId;
+	line += threadId.str() + " | ";
 
 	if (message.filePath.size())
 	{
-		fileStream << message.getFileName() << ':' << message.line << ' ' << message.functionName
-				   << "() | ";
+		line += message.getFileName() + ':' + std::to_string(message.line) + ' ' +
+			message.functionName + "() | ";
 	}
 
-	fileStream << type << ": " << utility::encodeToUtf8(message.message) << std::endl;
-	fileStream.close();
+	line += type + ": " + utility::encodeToUtf8(message.message) + '\n';
 
-	m_currentLogLineCount++;
-	if (m_maxLogFileCount > 0)
+	m_lines.push(std::move(line));
+	m_pushedLineCount.fetch_add(1, std::memory_order_release);
+
+	m_wakeUpCount.fetch_add(1, std::memory_order_release);
+	m_wakeUpCount.notify_one();
+}
+
+void FileLogger::writerLoop()
+{
+	uint64_t writtenLineCount = 0;
+	std::string line;
+
+	while (true)
+	{
+		const uint64_t wakeUpCount = m_wakeUpCount.load(std::memory_order_acquire);
+
+		if (writtenLineCount == m_pushedLineCount.load(std::memory_order_acquire))
+		{
+			if (m_stopped)
+			{
+				break;
+			}
+
+			m_wakeUpCount.wait(wakeUpCount, std::memory_order_acquire);
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_fileMutex);
+			while (m_lines.pop(line))
+			{
+				writeLine(line);
+				writtenLineCount++;
+			}
+			m_fileStream.flush();
+		}
+
+		m_writtenLineCount.store(writtenLineCount, std::memory_order_release);
+		m_writtenLineCount.notify_all();
+
+		// a line may be counted while its push is not finished yet
+		std::this_thread::yield();
+	}
+
+	std::lock_guard<std::mutex> lock(m_fileMutex);
+	m_fileStream.close();
+}
+
+void FileLogger::writeLine(const std::string& line)
+{
+	if (m_openLogFilePath != m_currentLogFilePath || !m_fileStream.is_open())
+	{
+		m_fileStream.close();
+		m_fileStream.open(m_currentLogFilePath.str(), std::ios::app);
+		m_openLogFilePath = m_currentLogFilePath;
+		m_currentLogFileSize = m_fileStream.is_open()
+			? static_cast<size_t>(m_fileStream.seekp(0, std::ios::end).tellp())
+			: 0;
+	}
+
+	m_fileStream << line;
+	m_currentLogFileSize += line.size();
+
+	if (m_maxLogFileSize > 0 && m_maxLogFileCount > 0 && m_currentLogFileSize >= m_maxLogFileSize)
 	{
-		updateLogFileName();
+		updateLogFileName(true);
 	}
 }
@@ -1,12 +1,20 @@
 #ifndef FILE_LOGGER_H
 #define FILE_LOGGER_H
 
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "FilePath.h"
 #include "LogMessage.h"
 #include "Logger.h"
+#include "MpscQueue.h"
 
+// Logging threads only format the line and push it to a lock-free queue. A background thread keeps
+// the log file open and writes the queued lines in batches.
 class FileLogger: public Logger
 {
 public:
@@ -14,35 +22,54 @@ public:
 		const std::wstring& prefix = L"", const std::wstring& suffix = L"", int offsetDays = 0);
 
 	FileLogger();
+	~FileLogger() override;
 
 	FilePath getLogFilePath() const;
 	void setLogFilePath(const FilePath& filePath);
 
 	void setLogDirectory(const FilePath& filePath);
 	void setFileName(const std::wstring& fileName);
-	void setMaxLogLineCount(unsigned int logCount);
+	void setMaxLogFileSize(size_t byteCount);
 
 	// setting the max log file count to 0 will disable ringlogging
 	void setMaxLogFileCount(unsigned int amount);
 
 	void deleteLogFiles(const std::wstring& cutoffDate);
 
+	// blocks until all lines logged before were written to the file
+	void flush();
+
 private:
 	void logInfo(const LogMessage& message) override;
 	void logWarning(const LogMessage& message) override;
 	void logError(const LogMessage& message) override;
 
 	void logMessage(const std::string& type, const LogMessage& message);
-	void updateLogFileName();
+	void updateLogFileName(bool rotate);
+
+	void writerLoop();
+	void writeLine(const std::string& line);
 
 	std::wstring m_logFileName;
 	FilePath m_logDirectory;
 	FilePath m_currentLogFilePath;
 
-	unsigned int m_maxLogLineCount = 0;
+	size_t m_maxLogFileSize = 0;
 	unsigned int m_maxLogFileCount = 0;
-	unsigned int m_currentLogLineCount = 0;
 	unsigned int m_currentLogFileCount = 0;
+
+	// guards the settings above and the file, which is only accessed by the writer thread
+	mutable std::mutex m_fileMutex;
+	std::ofstream m_fileStream;
+	FilePath m_openLogFilePath;
+	size_t m_currentLogFileSize = 0;
+
+	MpscQueue<std::string> m_lines;
+	std::atomic<uint64_t> m_pushedLineCount = 0;
+	std::atomic<uint64_t> m_writtenLineCount = 0;
+	std::atomic<uint64_t> m_wakeUpCount = 0;
+	std::atomic<bool> m_stopped = false;
+	std::thread m_writerThread;
 };
 
 #endif	  // FILE_LOGGER_H
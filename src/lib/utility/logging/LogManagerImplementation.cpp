@@ -88,11 +88,12 @@ void LogManagerImplementation::logInfo(
 	const std::string& function,
 	const unsigned int line)
 {
+	const LogMessage logMessage(message, file, function, line, getTime(), std::this_thread::get_id());
+
 	std::lock_guard<std::mutex> lockGuardLogger(m_loggerMutex);
 	for (unsigned int i = 0; i < m_loggers.size(); i++)
 	{
-		m_loggers[i]->onInfo(
-			LogMessage(message, file, function, line, getTime(), std::this_thread::get_id()));
+		m_loggers[i]->onInfo(logMessage);
 	}
 }
 
@@ -102,11 +103,12 @@ void LogManagerImplementation::logWarning(
 	const std::string& function,
 	const unsigned int line)
 {
+	const LogMessage logMessage(message, file, function, line, getTime(), std::this_thread::get_id());
+
 	std::lock_guard<std::mutex> lockGuardLogger(m_loggerMutex);
 	for (unsigned int i = 0; i < m_loggers.size(); i++)
 	{
-		m_loggers[i]->onWarning(
-			LogMessage(message, file, function, line, getTime(), std::this_thread::get_id()));
+		m_loggers[i]->onWarning(logMessage);
 	}
 }
 
@@ -116,11 +118,12 @@ void LogManagerImplementation::logError(
 	const std::string& function,
 	const unsigned int line)
 {
+	const LogMessage logMessage(message, file, function, line, getTime(), std::this_thread::get_id());
+
 	std::lock_guard<std::mutex> lockGuardLogger(m_loggerMutex);
 	for (unsigned int i = 0; i < m_loggers.size(); i++)
 	{
-		m_loggers[i]->onError(
-			LogMessage(message, file, function, line, getTime(), std::this_thread::get_id()));
+		m_loggers[i]->onError(logMessage);
 	}
 }
 
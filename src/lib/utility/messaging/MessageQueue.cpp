@@ -1,6 +1,5 @@
 #include "MessageQueue.h"
 
-#include <chrono>
 #include <thread>
 
 #include "MessageBase.h"
@@ -85,8 +84,11 @@ void MessageQueue::addMessageFilter(std::shared_ptr<MessageFilter> filter)
 
 void MessageQueue::pushMessage(std::shared_ptr<MessageBase> message)
 {
-	std::lock_guard<std::mutex> lock(m_messageBufferMutex);
-	m_messageBuffer.push_back(message);
+	{
+		std::lock_guard<std::mutex> lock(m_messageBufferMutex);
+		m_messageBuffer.push_back(message);
+	}
+	m_messageBufferCondition.notify_one();
 }
 
 void MessageQueue::processMessage(std::shared_ptr<MessageBase> message, bool asNextTask)
@@ -132,16 +134,14 @@ void MessageQueue::startMessageLoop()
 	{
 		processMessages();
 
-		{
-			std::lock_guard<std::mutex> lock(m_loopMutex);
+		std::unique_lock<std::mutex> lock(m_messageBufferMutex);
+		m_messageBufferCondition.wait(
+			lock, [this]() { return !m_messageBuffer.empty() || !loopIsRunning(); });
 
-			if (!m_loopIsRunning)
-			{
-				break;
-			}
+		if (!loopIsRunning())
+		{
+			break;
 		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(25));
 	}
 
 	{
@@ -151,6 +151,7 @@ void MessageQueue::startMessageLoop()
 			m_threadIsRunning = false;
 		}
 	}
+	m_threadCondition.notify_all();
 }
 
 void MessageQueue::stopMessageLoop()
@@ -166,18 +167,14 @@ void MessageQueue::stopMessageLoop()
 		m_loopIsRunning = false;
 	}
 
-	while (true)
 	{
-		{
-			std::lock_guard<std::mutex> lock(m_threadMutex);
-			if (!m_threadIsRunning)
-			{
-				break;
-			}
-		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(25));
+		// the buffer mutex makes sure the loop is either before its check or already waiting
+		std::lock_guard<std::mutex> lock(m_messageBufferMutex);
 	}
+	m_messageBufferCondition.notify_all();
+
+	std::unique_lock<std::mutex> lock(m_threadMutex);
+	m_threadCondition.wait(lock, [this]() { return !m_threadIsRunning; });
 }
 
 bool MessageQueue::loopIsRunning() const
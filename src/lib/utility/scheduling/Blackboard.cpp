@@ -14,13 +14,36 @@ bool Blackboard::exists(const std::string& key)
 
 bool Blackboard::clear(const std::string& key)
 {
-	std::lock_guard<std::mutex> lock(m_itemMutex);
-
-	ItemMap::const_iterator it = m_items.find(key);
-	if (it != m_items.end())
 	{
+		std::lock_guard<std::mutex> lock(m_itemMutex);
+
+		ItemMap::const_iterator it = m_items.find(key);
+		if (it == m_items.end())
+		{
+			return false;
+		}
+
 		m_items.erase(it);
-		return true;
+		m_changeCount++;
 	}
-	return false;
+
+	notifyChange();
+	return true;
+}
+
+size_t Blackboard::getChangeCount()
+{
+	std::lock_guard<std::mutex> lock(m_itemMutex);
+	return m_changeCount;
+}
+
+void Blackboard::waitForChange(size_t changeCount, std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(m_itemMutex);
+	m_changeCondition.wait_for(lock, timeout, [&]() { return m_changeCount != changeCount; });
+}
+
+void Blackboard::notifyChange()
+{
+	m_changeCondition.notify_all();
 }
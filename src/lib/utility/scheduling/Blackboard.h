@@ -1,6 +1,8 @@
 #ifndef BLACKBOARD_H
 #define BLACKBOARD_H
 
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
@@ -45,22 +47,37 @@ public:
 	bool exists(const std::string& key);
 	bool clear(const std::string& key);
 
+	// number of modifications so far, used as reference point for 'waitForChange'
+	size_t getChangeCount();
+
+	// blocks until the blackboard was modified after 'changeCount' or the timeout expired
+	void waitForChange(size_t changeCount, std::chrono::milliseconds timeout);
+
 private:
+	void notifyChange();
+
 	typedef std::map<std::string, std::shared_ptr<BlackboardItemBase>> ItemMap;
 
 	std::shared_ptr<Blackboard> m_parent;
 
 	ItemMap m_items;
 	std::mutex m_itemMutex;
+
+	size_t m_changeCount = 0;
+	std::condition_variable m_changeCondition;
 };
 
 
 template <typename T>
 void Blackboard::set(const std::string& key, const T& value)
 {
-	std::lock_guard<std::mutex> lock(m_itemMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_itemMutex);
 
-	m_items[key] = std::make_shared<BlackboardItem<T>>(value);
+		m_items[key] = std::make_shared<BlackboardItem<T>>(value);
+		m_changeCount++;
+	}
+	notifyChange();
 }
 
 template <typename T>
@@ -90,21 +107,31 @@ bool Blackboard::get(const std::string& key, T& value)
 template <typename T>
 bool Blackboard::update(const std::string& key, std::function<T(const T&)> updater)
 {
-	std::lock_guard<std::mutex> lock(m_itemMutex);
-
-	ItemMap::const_iterator it = m_items.find(key);
-	if (it != m_items.end())
+	bool updated = false;
 	{
-		if (std::shared_ptr<BlackboardItem<T>> item = std::dynamic_pointer_cast<BlackboardItem<T>>(
-				it->second))
+		std::lock_guard<std::mutex> lock(m_itemMutex);
+
+		ItemMap::const_iterator it = m_items.find(key);
+		if (it != m_items.end())
 		{
-			item->value = updater(item->value);
-			return true;
+			if (std::shared_ptr<BlackboardItem<T>> item =
+					std::dynamic_pointer_cast<BlackboardItem<T>>(it->second))
+			{
+				item->value = updater(item->value);
+				m_changeCount++;
+				updated = true;
+			}
 		}
 	}
 
-	LOG_WARNING("Entry for \"" + key + "\" not found on blackboard.");
-	return false;
+	if (!updated)
+	{
+		LOG_WARNING("Entry for \"" + key + "\" not found on blackboard.");
+		return false;
+	}
+
+	notifyChange();
+	return true;
 }
 
 #endif	  // BLACKBOARD_H
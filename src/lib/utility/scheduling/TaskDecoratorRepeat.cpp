@@ -1,7 +1,8 @@
 #include "TaskDecoratorRepeat.h"
 
 #include <chrono>
-#include <thread>
+
+#include "Blackboard.h"
 
 TaskDecoratorRepeat::TaskDecoratorRepeat(ConditionType condition, TaskState exitState, size_t delayMS)
 	: m_condition(condition), m_exitState(exitState), m_delayMS(delayMS)
@@ -29,7 +30,8 @@ Task::TaskState TaskDecoratorRepeat::doUpdate(std::shared_ptr<Blackboard> blackb
 		break;
 	}
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(m_delayMS));
+	// repeat early if the blackboard changes, because that is what most repeated tasks wait for
+	blackboard->waitForChange(blackboard->getChangeCount(), std::chrono::milliseconds(m_delayMS));
 
 	return state;
 }
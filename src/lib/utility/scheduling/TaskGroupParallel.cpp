@@ -34,7 +34,12 @@ void TaskGroupParallel::doEnter(std::shared_ptr<Blackboard> blackboard)
 
 Task::TaskState TaskGroupParallel::doUpdate(std::shared_ptr<Blackboard>  /*blackboard*/)
 {
-	std::this_thread::sleep_for(std::chrono::milliseconds(25));
+	{
+		// return at least every 25 ms so the scheduler can terminate this group if required
+		std::unique_lock<std::mutex> lock(m_activeTaskCountMutex);
+		m_activeTaskCountCondition.wait_for(
+			lock, std::chrono::milliseconds(25), [this]() { return m_activeTaskCount <= 0; });
+	}
 
 	if (m_tasks.size() != 0 && m_activeTaskCount > 0)
 	{
@@ -60,7 +65,10 @@ void TaskGroupParallel::doReset(std::shared_ptr<Blackboard> blackboard)
 		m_tasks[i]->taskRunner->reset();
 		if (!m_tasks[i]->active)
 		{
-			m_activeTaskCount++;
+			{
+				std::lock_guard<std::mutex> lock(m_activeTaskCountMutex);
+				m_activeTaskCount++;
+			}
 
 			m_tasks[i]->thread->join();
 			m_tasks[i]->active = true;
@@ -94,7 +102,11 @@ void TaskGroupParallel::processTaskThreaded(std::shared_ptr<TaskInfo> taskInfo,
 	std::shared_ptr<Blackboard> blackboard)
 {
 	ScopedFunctor functor([&]() {
-		m_activeTaskCount--;
+		{
+			std::lock_guard<std::mutex> lock(m_activeTaskCountMutex);
+			m_activeTaskCount--;
+		}
+		m_activeTaskCountCondition.notify_all();
 	});
 
 	while (true)
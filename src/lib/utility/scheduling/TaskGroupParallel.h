@@ -2,6 +2,8 @@
 #define TASK_GROUP_PARALLEL_H
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 #include "TaskGroup.h"
@@ -38,6 +40,10 @@ private:
 
 	std::atomic<bool> m_taskFailed;
 	std::atomic<int> m_activeTaskCount;
+
+	// notified whenever a task thread finishes, so the group does not need to poll
+	std::mutex m_activeTaskCountMutex;
+	std::condition_variable m_activeTaskCountCondition;
 };
 
 #endif	  // TASK_GROUP_PARALLEL_H
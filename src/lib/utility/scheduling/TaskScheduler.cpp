@@ -1,6 +1,5 @@
 #include "TaskScheduler.h"
 
-#include <chrono>
 #include <thread>
 
 #include "ScopedFunctor.h"
@@ -18,22 +17,28 @@ TaskScheduler::~TaskScheduler()
 
 void TaskScheduler::pushTask(std::shared_ptr<Task> task)
 {
-	std::lock_guard<std::mutex> lock(m_tasksMutex);
-	m_taskRunners.push_back(std::make_shared<TaskRunner>(task));
+	{
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+		m_taskRunners.push_back(std::make_shared<TaskRunner>(task));
+	}
+	m_tasksCondition.notify_one();
 }
 
 void TaskScheduler::pushNextTask(std::shared_ptr<Task> task)
 {
-	std::lock_guard<std::mutex> lock(m_tasksMutex);
-
-	if (m_taskRunners.size() == 0)
-	{
-		m_taskRunners.push_front(std::make_shared<TaskRunner>(task));
-	}
-	else
 	{
-		m_taskRunners.insert(m_taskRunners.begin() + 1, std::make_shared<TaskRunner>(task));
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+
+		if (m_taskRunners.size() == 0)
+		{
+			m_taskRunners.push_front(std::make_shared<TaskRunner>(task));
+		}
+		else
+		{
+			m_taskRunners.insert(m_taskRunners.begin() + 1, std::make_shared<TaskRunner>(task));
+		}
 	}
+	m_tasksCondition.notify_one();
 }
 
 void TaskScheduler::startSchedulerLoopThreaded()
@@ -62,16 +67,13 @@ void TaskScheduler::startSchedulerLoop()
 	{
 		processTasks();
 
-		{
-			std::lock_guard<std::mutex> lock(m_loopMutex);
+		std::unique_lock<std::mutex> lock(m_tasksMutex);
+		m_tasksCondition.wait(lock, [this]() { return !m_taskRunners.empty() || !loopIsRunning(); });
 
-			if (!m_loopIsRunning)
-			{
-				break;
-			}
+		if (!loopIsRunning())
+		{
+			break;
 		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(25));
 	}
 
 	{
@@ -81,6 +83,7 @@ void TaskScheduler::startSchedulerLoop()
 			m_threadIsRunning = false;
 		}
 	}
+	m_threadCondition.notify_all();
 }
 
 void TaskScheduler::stopSchedulerLoop()
@@ -96,18 +99,14 @@ void TaskScheduler::stopSchedulerLoop()
 		m_loopIsRunning = false;
 	}
 
-	while (true)
 	{
-		{
-			std::lock_guard<std::mutex> lock(m_threadMutex);
-			if (!m_threadIsRunning)
-			{
-				break;
-			}
-		}
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(25));
+		// the tasks mutex makes sure the loop is either before its check or already waiting
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
 	}
+	m_tasksCondition.notify_all();
+
+	std::unique_lock<std::mutex> lock(m_threadMutex);
+	m_threadCondition.wait(lock, [this]() { return !m_threadIsRunning; });
 }
 
 bool TaskScheduler::loopIsRunning() const
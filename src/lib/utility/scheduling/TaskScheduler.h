@@ -1,6 +1,7 @@
 #ifndef TASK_SCHEDULER_H
 #define TASK_SCHEDULER_H
 
+#include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -41,6 +42,10 @@ private:
 	mutable std::mutex m_tasksMutex;
 	mutable std::mutex m_loopMutex;
 	mutable std::mutex m_threadMutex;
+
+	// wake up the scheduler loop when tasks arrive and waiters when the loop thread ends
+	std::condition_variable m_tasksCondition;
+	std::condition_variable m_threadCondition;
 };
 
 #endif	  // TASK_SCHEDULER_H
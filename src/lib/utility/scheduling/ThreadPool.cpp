@@ -0,0 +1,204 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+std::shared_ptr<ThreadPool> ThreadPool::s_instance;
+std::mutex ThreadPool::s_instanceMutex;
+
+thread_local ThreadPool* ThreadPool::s_currentPool = nullptr;
+thread_local size_t ThreadPool::s_currentWorkerIndex = 0;
+
+std::shared_ptr<ThreadPool> ThreadPool::getInstance()
+{
+	std::lock_guard<std::mutex> lock(s_instanceMutex);
+	if (!s_instance)
+	{
+		s_instance = std::make_shared<ThreadPool>(
+			std::max<size_t>(1, std::thread::hardware_concurrency()));
+	}
+	return s_instance;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+	threadCount = std::max<size_t>(1, threadCount);
+
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		m_queues.push_back(std::make_unique<TaskQueue>());
+	}
+
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeUpMutex);
+		m_stopped = true;
+	}
+	m_wakeUpCondition.notify_all();
+
+	for (std::thread& thread: m_threads)
+	{
+		thread.join();
+	}
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+	return m_threads.size();
+}
+
+void ThreadPool::parallelFor(size_t count, std::function<void(size_t)> function)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	std::atomic<size_t> nextIndex = 0;
+	std::function<void()> work = [&]() {
+		for (size_t i = nextIndex++; i < count; i = nextIndex++)
+		{
+			function(i);
+		}
+	};
+
+	std::vector<std::future<void>> futures;
+	for (size_t i = 1; i < std::min(count, getThreadCount() + 1); i++)
+	{
+		futures.push_back(submit(work));
+	}
+
+	std::exception_ptr exception;
+	try
+	{
+		work();
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+		nextIndex = count;
+	}
+
+	// the helpers reference local state, so all of them need to finish before leaving
+	for (std::future<void>& future: futures)
+	{
+		try
+		{
+			wait(future);
+		}
+		catch (...)
+		{
+			if (!exception)
+			{
+				exception = std::current_exception();
+			}
+			nextIndex = count;
+		}
+	}
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+void ThreadPool::push(std::function<void()> task)
+{
+	const size_t queueIndex = s_currentPool == this ? s_currentWorkerIndex
+													: m_nextQueueIndex++ % m_queues.size();
+
+	// count first, so the counter never drops below the number of queued tasks
+	{
+		std::lock_guard<std::mutex> lock(m_wakeUpMutex);
+		m_pendingTaskCount++;
+	}
+
+	{
+		TaskQueue& queue = *m_queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	m_wakeUpCondition.notify_one();
+}
+
+bool ThreadPool::runPendingTask()
+{
+	std::function<void()> task;
+	if (!popTask(task))
+	{
+		return false;
+	}
+
+	task();
+	return true;
+}
+
+bool ThreadPool::popTask(std::function<void()>& task)
+{
+	if (m_pendingTaskCount == 0)
+	{
+		return false;
+	}
+
+	const bool isWorker = s_currentPool == this;
+	const size_t firstIndex = isWorker ? s_currentWorkerIndex : 0;
+
+	// workers take the newest task of their own queue, which is most likely still in cache
+	if (isWorker)
+	{
+		TaskQueue& queue = *m_queues[firstIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			m_pendingTaskCount--;
+			return true;
+		}
+	}
+
+	// steal the oldest task of another queue
+	for (size_t i = 0; i < m_queues.size(); i++)
+	{
+		TaskQueue& queue = *m_queues[(firstIndex + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			m_pendingTaskCount--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::workerLoop(size_t workerIndex)
+{
+	s_currentPool = this;
+	s_currentWorkerIndex = workerIndex;
+
+	while (true)
+	{
+		if (runPendingTask())
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_wakeUpMutex);
+		m_wakeUpCondition.wait(lock, [this]() { return m_pendingTaskCount > 0 || m_stopped; });
+
+		if (m_stopped)
+		{
+			break;
+		}
+	}
+}
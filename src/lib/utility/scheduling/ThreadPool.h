@@ -0,0 +1,106 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Shared executor for short-lived parallel work. Every worker owns a task queue: tasks submitted
+// from a worker go to its own queue, other tasks are distributed round-robin, and idle workers
+// steal from the queues of busy ones.
+class ThreadPool
+{
+public:
+	static std::shared_ptr<ThreadPool> getInstance();
+
+	ThreadPool(size_t threadCount);
+	~ThreadPool();
+
+	size_t getThreadCount() const;
+
+	// If 'cancelled' is set before the task started, the task is dropped and 'get' on the returned
+	// future throws a std::future_error.
+	template <typename FunctionType>
+	std::future<std::invoke_result_t<FunctionType>> submit(
+		FunctionType function, std::shared_ptr<std::atomic<bool>> cancelled = nullptr);
+
+	// Runs queued tasks while waiting, so it is safe to wait from within a pool thread.
+	template <typename T>
+	T wait(std::future<T>& future);
+
+	// Calls 'function' for every index in [0, count) on the pool and the calling thread. Indices are
+	// handed out one by one, so uneven work does not leave threads idle.
+	void parallelFor(size_t count, std::function<void(size_t)> function);
+
+private:
+	struct TaskQueue
+	{
+		std::deque<std::function<void()>> tasks;
+		std::mutex mutex;
+	};
+
+	void push(std::function<void()> task);
+	bool runPendingTask();
+	bool popTask(std::function<void()>& task);
+	void workerLoop(size_t workerIndex);
+
+	static std::shared_ptr<ThreadPool> s_instance;
+	static std::mutex s_instanceMutex;
+
+	static thread_local ThreadPool* s_currentPool;
+	static thread_local size_t s_currentWorkerIndex;
+
+	std::vector<std::unique_ptr<TaskQueue>> m_queues;
+	std::vector<std::thread> m_threads;
+
+	std::atomic<size_t> m_nextQueueIndex = 0;
+	std::atomic<size_t> m_pendingTaskCount = 0;
+	bool m_stopped = false;
+
+	std::mutex m_wakeUpMutex;
+	std::condition_variable m_wakeUpCondition;
+};
+
+template <typename FunctionType>
+std::future<std::invoke_result_t<FunctionType>> ThreadPool::submit(
+	FunctionType function, std::shared_ptr<std::atomic<bool>> cancelled)
+{
+	typedef std::invoke_result_t<FunctionType> ResultType;
+
+	std::shared_ptr<std::packaged_task<ResultType()>> task =
+		std::make_shared<std::packaged_task<ResultType()>>(std::move(function));
+	std::future<ResultType> future = task->get_future();
+
+	push([task, cancelled]() mutable {
+		if (!cancelled || !*cancelled)
+		{
+			(*task)();
+		}
+		// destroying the task without running it breaks the promise of the future
+		task.reset();
+	});
+
+	return future;
+}
+
+template <typename T>
+T ThreadPool::wait(std::future<T>& future)
+{
+	while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		if (!runPendingTask())
+		{
+			future.wait_for(std::chrono::microseconds(100));
+		}
+	}
+	return future.get();
+}
+
+#endif	  // THREAD_POOL_H
@@ -0,0 +1,309 @@
+#include "CompressedText.h"
+
+#include <algorithm>
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include "logging.h"
+
+namespace
+{
+const char s_magic[4] = {'S', 'T', 'Z', '1'};
+const int s_compressionLevel = 3;
+const size_t s_minSampleCount = 8;
+
+struct ContextDeleter
+{
+	void operator()(ZSTD_CCtx* context) const
+	{
+		ZSTD_freeCCtx(context);
+	}
+
+	void operator()(ZSTD_DCtx* context) const
+	{
+		ZSTD_freeDCtx(context);
+	}
+};
+
+// creating a context allocates its work space, so every thread keeps one
+ZSTD_CCtx* getCompressionContext()
+{
+	thread_local std::unique_ptr<ZSTD_CCtx, ContextDeleter> context(ZSTD_createCCtx());
+	return context.get();
+}
+
+ZSTD_DCtx* getDecompressionContext()
+{
+	thread_local std::unique_ptr<ZSTD_DCtx, ContextDeleter> context(ZSTD_createDCtx());
+	return context.get();
+}
+
+void appendUInt32(std::string& data, size_t value)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		data.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+	}
+}
+
+bool readUInt32(const std::string& data, size_t& offset, size_t& value)
+{
+	if (offset + 4 > data.size())
+	{
+		return false;
+	}
+
+	value = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		value |= size_t(static_cast<unsigned char>(data[offset + i])) << (8 * i);
+	}
+	offset += 4;
+	return true;
+}
+}	 // namespace
+
+const size_t CompressedTextDictionary::s_maxSize = 112640;
+const size_t CompressedTextDictionary::s_maxSampleSize = 100 * s_maxSize;
+
+std::shared_ptr<CompressedTextDictionary> CompressedTextDictionary::train(
+	const std::vector<std::string>& samples)
+{
+	std::string sampleBuffer;
+	std::vector<size_t> sampleSizes;
+	for (const std::string& sample: samples)
+	{
+		if (sampleBuffer.size() + sample.size() > s_maxSampleSize)
+		{
+			break;
+		}
+		sampleBuffer += sample;
+		sampleSizes.push_back(sample.size());
+	}
+
+	if (sampleSizes.size() < s_minSampleCount || sampleBuffer.size() < 4 * s_maxSize)
+	{
+		return nullptr;
+	}
+
+	std::string dictionary(s_maxSize, '\0');
+	const size_t dictionarySize = ZDICT_trainFromBuffer(
+		dictionary.data(),
+		dictionary.size(),
+		sampleBuffer.data(),
+		sampleSizes.data(),
+		static_cast<unsigned int>(sampleSizes.size()));
+
+	if (ZDICT_isError(dictionarySize))
+	{
+		LOG_INFO(
+			std::string("Unable to train file content dictionary: ") +
+			ZDICT_getErrorName(dictionarySize));
+		return nullptr;
+	}
+
+	dictionary.resize(dictionarySize);
+	return std::make_shared<CompressedTextDictionary>(std::move(dictionary));
+}
+
+CompressedTextDictionary::CompressedTextDictionary(std::string data)
+	: m_data(std::move(data))
+	, m_compressionDictionary(ZSTD_createCDict(m_data.data(), m_data.size(), s_compressionLevel))
+	, m_decompressionDictionary(ZSTD_createDDict(m_data.data(), m_data.size()))
+{
+}
+
+CompressedTextDictionary::~CompressedTextDictionary()
+{
+	ZSTD_freeCDict(m_compressionDictionary);
+	ZSTD_freeDDict(m_decompressionDictionary);
+}
+
+const std::string& CompressedTextDictionary::getData() const
+{
+	return m_data;
+}
+
+
+const unsigned int CompressedText::s_chunkLineCount = 128;
+
+std::string CompressedText::compress(
+	const std::vector<std::string>& lines, const CompressedTextDictionary* dictionary)
+{
+	const size_t chunkCount = (lines.size() + s_chunkLineCount - 1) / s_chunkLineCount;
+
+	std::string header(s_magic, sizeof(s_magic));
+	appendUInt32(header, lines.size());
+	appendUInt32(header, s_chunkLineCount);
+	appendUInt32(header, chunkCount);
+
+	std::string frames;
+	std::string chunkText;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const size_t lastLineIndex = std::min<size_t>(lines.size(), (i + 1) * s_chunkLineCount);
+
+		chunkText.clear();
+		for (size_t j = i * s_chunkLineCount; j < lastLineIndex; j++)
+		{
+			chunkText += lines[j];
+		}
+
+		const size_t offset = frames.size();
+		frames.resize(offset + ZSTD_compressBound(chunkText.size()));
+
+		const size_t compressedSize = dictionary
+			? ZSTD_compress_usingCDict(
+				  getCompressionContext(),
+				  frames.data() + offset,
+				  frames.size() - offset,
+				  chunkText.data(),
+				  chunkText.size(),
+				  dictionary->m_compressionDictionary)
+			: ZSTD_compressCCtx(
+				  getCompressionContext(),
+				  frames.data() + offset,
+				  frames.size() - offset,
+				  chunkText.data(),
+				  chunkText.size(),
+				  s_compressionLevel);
+
+		if (ZSTD_isError(compressedSize))
+		{
+			LOG_ERROR(std::string("Unable to compress text: ") + ZSTD_getErrorName(compressedSize));
+			return "";
+		}
+
+		frames.resize(offset + compressedSize);
+		appendUInt32(header, compressedSize);
+		appendUInt32(header, chunkText.size());
+	}
+
+	return header + frames;
+}
+
+std::shared_ptr<CompressedText> CompressedText::create(
+	std::string data, std::shared_ptr<const CompressedTextDictionary> dictionary)
+{
+	if (data.compare(0, sizeof(s_magic), s_magic, sizeof(s_magic)) != 0)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<CompressedText> text(new CompressedText());
+
+	size_t offset = sizeof(s_magic);
+	size_t lineCount = 0;
+	size_t chunkLineCount = 0;
+	size_t chunkCount = 0;
+	if (!readUInt32(data, offset, lineCount) || !readUInt32(data, offset, chunkLineCount) ||
+		!readUInt32(data, offset, chunkCount) || chunkLineCount == 0 ||
+		chunkCount != (lineCount + chunkLineCount - 1) / chunkLineCount)
+	{
+		return nullptr;
+	}
+
+	text->m_lineCount = static_cast<unsigned int>(lineCount);
+	text->m_chunkLineCount = static_cast<unsigned int>(chunkLineCount);
+
+	size_t frameOffset = offset + 8 * chunkCount;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		Chunk chunk;
+		if (!readUInt32(data, offset, chunk.compressedSize) || !readUInt32(data, offset, chunk.size))
+		{
+			return nullptr;
+		}
+		chunk.offset = frameOffset;
+		frameOffset += chunk.compressedSize;
+		text->m_chunks.push_back(chunk);
+	}
+
+	if (frameOffset != data.size())
+	{
+		return nullptr;
+	}
+
+	text->m_data = std::move(data);
+	text->m_dictionary = dictionary;
+	return text;
+}
+
+unsigned int CompressedText::getLineCount() const
+{
+	return m_lineCount;
+}
+
+size_t CompressedText::getChunkCount() const
+{
+	return m_chunks.size();
+}
+
+size_t CompressedText::getChunkIndex(unsigned int lineIndex) const
+{
+	return lineIndex / m_chunkLineCount;
+}
+
+unsigned int CompressedText::getFirstLineIndex(size_t chunkIndex) const
+{
+	return static_cast<unsigned int>(chunkIndex * m_chunkLineCount);
+}
+
+std::string CompressedText::decompressChunkText(size_t chunkIndex) const
+{
+	if (chunkIndex >= m_chunks.size())
+	{
+		return "";
+	}
+
+	const Chunk& chunk = m_chunks[chunkIndex];
+	std::string text(chunk.size, '\0');
+
+	const size_t size = m_dictionary
+		? ZSTD_decompress_usingDDict(
+			  getDecompressionContext(),
+			  text.data(),
+			  text.size(),
+			  m_data.data() + chunk.offset,
+			  chunk.compressedSize,
+			  m_dictionary->m_decompressionDictionary)
+		: ZSTD_decompressDCtx(
+			  getDecompressionContext(),
+			  text.data(),
+			  text.size(),
+			  m_data.data() + chunk.offset,
+			  chunk.compressedSize);
+
+	if (ZSTD_isError(size) || size != chunk.size)
+	{
+		LOG_ERROR(
+			"Unable to decompress text chunk " + std::to_string(chunkIndex) + ": " +
+			(ZSTD_isError(size) ? ZSTD_getErrorName(size) : "size mismatch"));
+		return "";
+	}
+
+	return text;
+}
+
+std::vector<std::string> CompressedText::decompressChunk(size_t chunkIndex) const
+{
+	const std::string text = decompressChunkText(chunkIndex);
+
+	std::vector<std::string> lines;
+	size_t prevIndex = 0;
+	size_t index = text.find('\n');
+	while (index != std::string::npos)
+	{
+		lines.push_back(text.substr(prevIndex, index + 1 - prevIndex));
+		prevIndex = index + 1;
+		index = text.find('\n', prevIndex);
+	}
+
+	if (prevIndex < text.length())
+	{
+		lines.push_back(text.substr(prevIndex));
+	}
+
+	return lines;
+}
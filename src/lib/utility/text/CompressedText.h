@@ -0,0 +1,84 @@
+#ifndef COMPRESSED_TEXT_H
+#define COMPRESSED_TEXT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+// Zstandard dictionary trained on the file contents of one project. Small files compress much
+// better with a dictionary because they share most of their vocabulary.
+class CompressedTextDictionary
+{
+public:
+	static const size_t s_maxSize;
+	static const size_t s_maxSampleSize;
+
+	// returns nullptr if there are not enough samples to train a useful dictionary
+	static std::shared_ptr<CompressedTextDictionary> train(const std::vector<std::string>& samples);
+
+	explicit CompressedTextDictionary(std::string data);
+	~CompressedTextDictionary();
+
+	CompressedTextDictionary(const CompressedTextDictionary&) = delete;
+	CompressedTextDictionary& operator=(const CompressedTextDictionary&) = delete;
+
+	const std::string& getData() const;
+
+private:
+	friend class CompressedText;
+
+	const std::string m_data;
+	ZSTD_CDict_s* m_compressionDictionary;
+	ZSTD_DDict_s* m_decompressionDictionary;
+};
+
+
+// Text split into chunks of lines that are compressed independently, so a range of lines can be
+// decoded without decoding the whole text.
+class CompressedText
+{
+public:
+	static const unsigned int s_chunkLineCount;
+
+	// 'dictionary' may be null, the same dictionary is needed for decompression
+	static std::string compress(
+		const std::vector<std::string>& lines, const CompressedTextDictionary* dictionary);
+
+	// returns nullptr if 'data' was not created by 'compress'
+	static std::shared_ptr<CompressedText> create(
+		std::string data, std::shared_ptr<const CompressedTextDictionary> dictionary);
+
+	unsigned int getLineCount() const;
+	size_t getChunkCount() const;
+
+	/**
+	 * @param lineIndex: starts with 0
+	 */
+	size_t getChunkIndex(unsigned int lineIndex) const;
+	unsigned int getFirstLineIndex(size_t chunkIndex) const;
+
+	// both return an empty result if the chunk is corrupted
+	std::string decompressChunkText(size_t chunkIndex) const;
+	std::vector<std::string> decompressChunk(size_t chunkIndex) const;
+
+private:
+	struct Chunk
+	{
+		size_t offset;
+		size_t compressedSize;
+		size_t size;
+	};
+
+	CompressedText() = default;
+
+	std::string m_data;
+	std::shared_ptr<const CompressedTextDictionary> m_dictionary;
+	unsigned int m_lineCount = 0;
+	unsigned int m_chunkLineCount = 0;
+	std::vector<Chunk> m_chunks;
+};
+
+#endif	  // COMPRESSED_TEXT_H
@@ -2,6 +2,7 @@
 
 #include <fstream>
 
+#include "CompressedText.h"
 #include "logging.h"
 
 namespace
@@ -77,6 +78,19 @@ std::shared_ptr<TextAccess> TextAccess::createFromLines(
 	return result;
 }
 
+std::shared_ptr<TextAccess> TextAccess::createFromCompressedText(
+	std::shared_ptr<const CompressedText> compressedText, const FilePath& filePath)
+{
+	std::shared_ptr<TextAccess> result(new TextAccess());
+
+	result->m_lines.resize(compressedText->getLineCount());
+	result->m_filePath = filePath;
+	result->m_decompressedChunks.resize(compressedText->getChunkCount(), false);
+	result->m_compressedText = compressedText;
+
+	return result;
+}
+
 unsigned int TextAccess::getLineCount() const
 {
 	return static_cast<unsigned int>(m_lines.size());
@@ -99,6 +113,7 @@ std::string TextAccess::getLine(const unsigned int lineNumber) const
 		return "";
 	}
 
+	decompressLines(lineNumber, lineNumber);
 	return m_lines[lineNumber - 1];	   // -1 to correct for use as index
 }
 
@@ -110,6 +125,8 @@ std::vector<std::string> TextAccess::getLines(
 		return std::vector<std::string>();
 	}
 
+	decompressLines(firstLineNumber, lastLineNumber);
+
 	std::vector<std::string>::iterator first = m_lines.begin() + firstLineNumber -
 		1;	  // -1 to correct for use as index
 	std::vector<std::string>::iterator last = m_lines.begin() + lastLineNumber;
@@ -118,11 +135,14 @@ std::vector<std::string> TextAccess::getLines(
 
 const std::vector<std::string>& TextAccess::getAllLines() const
 {
+	decompressLines(1, getLineCount());
 	return m_lines;
 }
 
 std::string TextAccess::getText() const
 {
+	decompressLines(1, getLineCount());
+
 	std::string result;
 
 	for (unsigned int i = 0; i < m_lines.size(); i++)
@@ -239,3 +259,32 @@ bool TextAccess::checkIndexIntervalInRange(const unsigned int firstIndex, const
 
 	return true;
 }
+
+void TextAccess::decompressLines(
+	const unsigned int firstLineNumber, const unsigned int lastLineNumber) const
+{
+	if (!m_compressedText || firstLineNumber < 1 || firstLineNumber > lastLineNumber)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_decompressionMutex);
+
+	const size_t firstChunkIndex = m_compressedText->getChunkIndex(firstLineNumber - 1);
+	const size_t lastChunkIndex = m_compressedText->getChunkIndex(lastLineNumber - 1);
+	for (size_t i = firstChunkIndex; i <= lastChunkIndex && i < m_decompressedChunks.size(); i++)
+	{
+		if (m_decompressedChunks[i])
+		{
+			continue;
+		}
+
+		std::vector<std::string> lines = m_compressedText->decompressChunk(i);
+		const unsigned int firstLineIndex = m_compressedText->getFirstLineIndex(i);
+		for (size_t j = 0; j < lines.size() && firstLineIndex + j < m_lines.size(); j++)
+		{
+			m_lines[firstLineIndex + j] = std::move(lines[j]);
+		}
+		m_decompressedChunks[i] = true;
+	}
+}
@@ -2,11 +2,14 @@
 #define TEXT_ACCESS_H
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "FilePath.h"
 
+class CompressedText;
+
 class TextAccess
 {
 public:
@@ -15,6 +18,9 @@ public:
 		const std::string& text, const FilePath& filePath = FilePath());
 	static std::shared_ptr<TextAccess> createFromLines(
 		const std::vector<std::string>& lines, const FilePath& filePath = FilePath());
+	// lines are decompressed chunk by chunk when they are accessed for the first time
+	static std::shared_ptr<TextAccess> createFromCompressedText(
+		std::shared_ptr<const CompressedText> compressedText, const FilePath& filePath = FilePath());
 
 	virtual ~TextAccess() = default;
 
@@ -47,8 +53,14 @@ private:
 	bool checkIndexInRange(const unsigned int index) const;
 	bool checkIndexIntervalInRange(const unsigned int firstIndex, const unsigned int lastIndex) const;
 
+	void decompressLines(const unsigned int firstLineNumber, const unsigned int lastLineNumber) const;
+
 	FilePath m_filePath;
-	std::vector<std::string> m_lines;
+	mutable std::vector<std::string> m_lines;
+
+	std::shared_ptr<const CompressedText> m_compressedText;
+	mutable std::vector<bool> m_decompressedChunks;
+	mutable std::mutex m_decompressionMutex;
 };
 
 #endif	  // TEXT_ACCESS_H
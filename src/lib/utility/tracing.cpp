@@ -1,66 +1,299 @@
 #include "tracing.h"
 
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
 #include <set>
+#include <sstream>
 
-std::shared_ptr<Tracer> Tracer::s_instance;
-Id Tracer::s_nextTraceId = 0;
+#include "FilePath.h"
+#include "logging.h"
 
-Tracer* Tracer::getInstance()
+namespace
+{
+std::string getFileName(const char* filePath)
+{
+	const std::string path = filePath ? filePath : "";
+	const size_t pos = path.find_last_of("/\\");
+	return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+std::string getEventName(const TraceEvent& event)
+{
+	return (event.eventName && *event.eventName) ? event.eventName : event.functionName;
+}
+
+std::string getLocationName(const TraceEvent& event)
+{
+	return getFileName(event.fileName) + ":" + std::to_string(event.lineNumber);
+}
+
+void writeJsonString(std::ostream& stream, const std::string& str)
 {
-	if (!s_instance)
+	stream << '"';
+	for (const char c: str)
 	{
-		s_instance = std::shared_ptr<Tracer>(new Tracer());
+		switch (c)
+		{
+		case '"':
+			stream << "\\\"";
+			break;
+		case '\\':
+			stream << "\\\\";
+			break;
+		case '\n':
+			stream << "\\n";
+			break;
+		case '\t':
+			stream << "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c)
+					   << std::dec << std::setfill(' ');
+			}
+			else
+			{
+				stream << c;
+			}
+		}
 	}
+	stream << '"';
+}
 
-	return s_instance.get();
+void writeMicroseconds(std::ostream& stream, uint64_t nanoseconds)
+{
+	stream << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000
+		   << std::setfill(' ');
 }
+}	 // namespace
 
-std::shared_ptr<TraceEvent> Tracer::startEvent(const std::string& eventName)
+
+const size_t TraceBuffer::s_capacity = 1 << 15;
+
+TraceBuffer::TraceBuffer(uint32_t threadIndex): m_threadIndex(threadIndex), m_slots(s_capacity) {}
+
+uint32_t TraceBuffer::getThreadIndex() const
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_threadIndex;
+}
 
-	const std::thread::id id = std::this_thread::get_id();
+void TraceBuffer::addEvent(const TraceEvent& event)
+{
+	const uint64_t index = m_writeCount.load(std::memory_order_relaxed);
+	Slot& slot = m_slots[index % s_capacity];
+
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.eventName.store(event.eventName, std::memory_order_relaxed);
+	slot.functionName.store(event.functionName, std::memory_order_relaxed);
+	slot.fileName.store(event.fileName, std::memory_order_relaxed);
+	slot.lineNumber.store(event.lineNumber, std::memory_order_relaxed);
+	slot.depth.store(event.depth, std::memory_order_relaxed);
+	slot.startTime.store(event.startTime, std::memory_order_relaxed);
+	slot.duration.store(event.duration, std::memory_order_relaxed);
+
+	slot.sequence.store(2 * index + 2, std::memory_order_release);
+	m_writeCount.store(index + 1, std::memory_order_release);
+}
 
-	std::shared_ptr<TraceEvent> event = std::make_shared<TraceEvent>(
-		eventName, s_nextTraceId++, m_startedEvents[id].size());
+std::vector<TraceEvent> TraceBuffer::getEvents() const
+{
+	const uint64_t end = m_writeCount.load(std::memory_order_acquire);
+	const uint64_t begin = std::max(
+		m_clearCount.load(std::memory_order_relaxed), end > s_capacity ? end - s_capacity : 0);
 
-	m_events[id].push_back(event);
-	m_startedEvents[id].push(event.get());
+	std::vector<TraceEvent> events;
+	events.reserve(end - begin);
+	for (uint64_t i = begin; i < end; i++)
+	{
+		const Slot& slot = m_slots[i % s_capacity];
 
-	return event;
+		// skip slots the owning thread is writing or has already reused for a newer event
+		const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence != 2 * i + 2)
+		{
+			continue;
+		}
+
+		TraceEvent event;
+		event.eventName = slot.eventName.load(std::memory_order_relaxed);
+		event.functionName = slot.functionName.load(std::memory_order_relaxed);
+		event.fileName = slot.fileName.load(std::memory_order_relaxed);
+		event.lineNumber = slot.lineNumber.load(std::memory_order_relaxed);
+		event.depth = slot.depth.load(std::memory_order_relaxed);
+		event.startTime = slot.startTime.load(std::memory_order_relaxed);
+		event.duration = slot.duration.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+		{
+			events.push_back(event);
+		}
+	}
+
+	return events;
 }
 
-void Tracer::finishEvent(std::shared_ptr<TraceEvent>  /*event*/)
+void TraceBuffer::clear()
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
+	m_clearCount.store(m_writeCount.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
 
-	const std::thread::id id = std::this_thread::get_id();
+std::atomic<bool> Tracer::s_enabled = false;
+thread_local Tracer::ThreadBuffer Tracer::s_threadBuffer;
 
-	m_startedEvents[id].pop();
+Tracer::ThreadBuffer::~ThreadBuffer()
+{
+	if (buffer)
+	{
+		Tracer::getInstance()->releaseBuffer(buffer);
+	}
+}
+
+Tracer* Tracer::getInstance()
+{
+	static Tracer s_instance;
+	return &s_instance;
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+uint64_t Tracer::now() const
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+									 std::chrono::steady_clock::now() - m_startTime)
+									 .count());
+}
+
+TraceBuffer* Tracer::getBufferForCurrentThread()
+{
+	if (!s_threadBuffer.buffer)
+	{
+		// buffers are owned by the tracer, so events of finished threads can still be exported
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		if (!m_freeBuffers.empty())
+		{
+			s_threadBuffer.buffer = m_freeBuffers.back();
+			m_freeBuffers.pop_back();
+		}
+		else
+		{
+			m_buffers.push_back(
+				std::make_shared<TraceBuffer>(static_cast<uint32_t>(m_buffers.size())));
+			s_threadBuffer.buffer = m_buffers.back().get();
+		}
+	}
+	return s_threadBuffer.buffer;
 }
 
-void Tracer::printTraces()
+size_t Tracer::getBufferCount() const
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	return m_buffers.size();
+}
 
-	size_t unfinishEvents = 0;
-	for (auto& p: m_startedEvents)
+std::string Tracer::getChromeTrace() const
+{
+	std::vector<std::shared_ptr<TraceBuffer>> buffers;
 	{
-		unfinishEvents += p.second.size();
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		buffers = m_buffers;
 	}
 
-	if (unfinishEvents > 0)
+	std::stringstream ss;
+	ss << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+	bool first = true;
+	for (const std::shared_ptr<TraceBuffer>& buffer: buffers)
 	{
-		std::cout << "TRACING: Trace events are still running." << std::endl;
-		return;
+		const std::vector<TraceEvent> events = buffer->getEvents();
+		if (events.empty())
+		{
+			continue;
+		}
+
+		const uint32_t threadIndex = buffer->getThreadIndex();
+
+		ss << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+		   << threadIndex << ",\"args\":{\"name\":\"thread " << threadIndex << "\"}}";
+		first = false;
+
+		for (const TraceEvent& event: events)
+		{
+			ss << ",\n{\"ph\":\"X\",\"cat\":\"sourcetrail\",\"pid\":1,\"tid\":" << threadIndex
+			   << ",\"name\":";
+			writeJsonString(ss, getEventName(event));
+			ss << ",\"ts\":";
+			writeMicroseconds(ss, event.startTime);
+			ss << ",\"dur\":";
+			writeMicroseconds(ss, event.duration);
+			ss << ",\"args\":{\"function\":";
+			writeJsonString(ss, event.functionName ? event.functionName : "");
+			ss << ",\"location\":";
+			writeJsonString(ss, getLocationName(event));
+			ss << "}}";
+		}
+	}
+
+	ss << "\n]}\n";
+	return ss.str();
+}
+
+bool Tracer::exportChromeTrace(const FilePath& filePath) const
+{
+	std::ofstream fileStream;
+	fileStream.open(filePath.str(), std::ios::out | std::ios::trunc);
+	if (!fileStream.is_open())
+	{
+		LOG_ERROR(L"Unable to write trace file: " + filePath.wstr());
+		return false;
+	}
+
+	fileStream << getChromeTrace();
+	fileStream.close();
+
+	LOG_INFO(L"Wrote trace file: " + filePath.wstr());
+	return true;
+}
+
+void Tracer::printTraces() const
+{
+	std::vector<std::shared_ptr<TraceBuffer>> buffers;
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		buffers = m_buffers;
+	}
+
+	std::map<uint32_t, std::vector<TraceEvent>> threadEvents;
+	for (const std::shared_ptr<TraceBuffer>& buffer: buffers)
+	{
+		std::vector<TraceEvent> events = buffer->getEvents();
+		if (!events.empty())
+		{
+			// events are recorded when they finish, print them in the order they started
+			std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+				return a.startTime < b.startTime;
+			});
+			threadEvents.emplace(buffer->getThreadIndex(), std::move(events));
+		}
 	}
-	else if (m_events.empty())
+
+	if (threadEvents.empty())
 	{
 		std::cout << "TRACING: No trace events collected." << std::endl;
 		return;
 	}
 
-
 	std::cout << "TRACING\n--------------------------\n" << std::endl;
 
 	std::cout << "HISTORY:\n\n";
@@ -69,23 +302,24 @@ void Tracer::printTraces()
 	std::cout << "-----------------------------------------------------------------";
 	std::cout << "------------------------------------------------------------\n";
 
-	for (auto& p: m_events)
+	for (const auto& p: threadEvents)
 	{
 		std::cout << "thread: " << p.first << std::endl;
 
-		for (const std::shared_ptr<TraceEvent>& event: p.second)
+		for (const TraceEvent& event: p.second)
 		{
-			std::cout.width(8 + 2 * event->depth);
-			std::cout << std::right << std::setprecision(3) << std::fixed << event->time;
+			std::cout.width(8 + 2 * event.depth);
+			std::cout << std::right << std::setprecision(3) << std::fixed << event.duration / 1e9;
 
-			std::cout.width(17 - 2 * event->depth);
+			std::cout.width(17 - 2 * event.depth);
 			std::cout << " ";
 
 			std::cout.width(25);
-			std::cout << std::left << event->eventName;
+			std::cout << std::left << getEventName(event);
 
 			std::cout.width(50);
-			std::cout << (event->functionName + "()") << event->locationName << std::endl;
+			std::cout << (std::string(event.functionName) + "()") << getLocationName(event)
+					  << std::endl;
 		}
 
 		std::cout << std::endl;
@@ -99,34 +333,26 @@ void Tracer::printTraces()
 
 	struct AccumulatedTraceEvent
 	{
-		TraceEvent* event;
+		const TraceEvent* event;
 		size_t count;
-		float time;
+		double time;
 	};
 
 	std::map<std::string, AccumulatedTraceEvent> accumulatedEvents;
 
-	for (auto& p: m_events)
+	for (const auto& p: threadEvents)
 	{
-		for (const std::shared_ptr<TraceEvent>& event: p.second)
+		for (const TraceEvent& event: p.second)
 		{
-			const std::string name = event->eventName + event->functionName + event->locationName;
+			const std::string name = getEventName(event) + event.functionName +
+				getLocationName(event);
 
-			std::pair<std::map<std::string, AccumulatedTraceEvent>::iterator, bool> p =
-				accumulatedEvents.emplace(name, AccumulatedTraceEvent());
+			std::pair<std::map<std::string, AccumulatedTraceEvent>::iterator, bool> it =
+				accumulatedEvents.emplace(name, AccumulatedTraceEvent {&event, 0, 0.0});
 
-			AccumulatedTraceEvent* acc = &p.first->second;
-			if (p.second)
-			{
-				acc->event = event.get();
-				acc->time = static_cast<float>(event->time);
-				acc->count = 1;
-			}
-			else
-			{
-				acc->time += static_cast<float>(event->time);
-				acc->count++;
-			}
+			AccumulatedTraceEvent* acc = &it.first->second;
+			acc->time += event.duration / 1e9;
+			acc->count++;
 		}
 	}
 
@@ -137,7 +363,7 @@ void Tracer::printTraces()
 			return a.time > b.time;
 		});
 
-	for (const auto &p: accumulatedEvents)
+	for (const auto& p: accumulatedEvents)
 	{
 		sortedEvents.insert(p.second);
 	}
@@ -151,122 +377,51 @@ void Tracer::printTraces()
 		std::cout << acc.count << "       ";
 
 		std::cout.width(25);
-		std::cout << std::left << acc.event->eventName;
+		std::cout << std::left << getEventName(*acc.event);
 
 		std::cout.width(50);
-		std::cout << (acc.event->functionName + "()") << acc.event->locationName << std::endl;
+		std::cout << (std::string(acc.event->functionName) + "()") << getLocationName(*acc.event)
+				  << std::endl;
 	}
 
 	std::cout << std::endl;
-
-	m_events.clear();
 }
 
-Tracer::Tracer() = default;
-
-
-std::shared_ptr<AccumulatingTracer> AccumulatingTracer::s_instance;
-Id AccumulatingTracer::s_nextTraceId = 0;
-
-AccumulatingTracer* AccumulatingTracer::getInstance()
+void Tracer::clear()
 {
-	if (!s_instance)
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	for (const std::shared_ptr<TraceBuffer>& buffer: m_buffers)
 	{
-		s_instance = std::shared_ptr<AccumulatingTracer>(new AccumulatingTracer());
+		buffer->clear();
 	}
-
-	return s_instance.get();
 }
 
-std::shared_ptr<TraceEvent> AccumulatingTracer::startEvent(const std::string& eventName)
-{
-	std::lock_guard<std::mutex> lock(m_mutex);
-
-	const std::thread::id id = std::this_thread::get_id();
+Tracer::Tracer(): m_startTime(std::chrono::steady_clock::now()) {}
 
-	std::shared_ptr<TraceEvent> event = std::make_shared<TraceEvent>(
-		eventName, s_nextTraceId++, m_startedEvents[id].size());
-
-	m_startedEvents[id].push(event.get());
-
-	return event;
-}
-
-void AccumulatingTracer::finishEvent(std::shared_ptr<TraceEvent> event)
+void Tracer::releaseBuffer(TraceBuffer* buffer)
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
-
-	const std::thread::id id = std::this_thread::get_id();
-
-	m_startedEvents[id].pop();
-
-	const std::string name = event->eventName + event->functionName + event->locationName;
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	m_freeBuffers.push_back(buffer);
+}
 
-	std::pair<std::map<std::string, AccumulatedTraceEvent>::iterator, bool> p =
-		m_accumulatedEvents.emplace(name, AccumulatedTraceEvent());
 
-	AccumulatedTraceEvent* acc = &p.first->second;
-	if (p.second)
-	{
-		acc->event = TraceEvent(*event);
-		acc->time = event->time;
-		acc->count = 1;
-	}
-	else
-	{
-		acc->time += event->time;
-		acc->count++;
-	}
+void ScopedTrace::start(
+	const char* eventName, const char* fileName, int lineNumber, const char* functionName)
+{
+	Tracer* tracer = Tracer::getInstance();
+	m_buffer = tracer->getBufferForCurrentThread();
+
+	m_event.eventName = eventName;
+	m_event.functionName = functionName;
+	m_event.fileName = fileName;
+	m_event.lineNumber = lineNumber;
+	m_event.depth = m_buffer->depth++;
+	m_event.startTime = tracer->now();
 }
 
-void AccumulatingTracer::printTraces()
+void ScopedTrace::finish()
 {
-	std::lock_guard<std::mutex> lock(m_mutex);
-
-	for (auto& p: m_startedEvents)
-	{
-		if (!p.second.empty())
-		{
-			std::cout << "TRACING: Trace events are still running." << std::endl;
-		}
-	}
-
-	std::cout << "\nREPORT:\n\n";
-	std::cout << "    time      count      name                     function";
-	std::cout << "                                          location\n";
-	std::cout << "-----------------------------------------------------------------";
-	std::cout << "------------------------------------------------------------\n";
-
-	std::multiset<
-		AccumulatedTraceEvent,
-		std::function<bool(const AccumulatedTraceEvent&, const AccumulatedTraceEvent&)>>
-		sortedEvents([](const AccumulatedTraceEvent& a, const AccumulatedTraceEvent& b) {
-			return a.time > b.time;
-		});
-
-	for (const auto &p: m_accumulatedEvents)
-	{
-		sortedEvents.insert(p.second);
-	}
-
-	for (const AccumulatedTraceEvent& acc: sortedEvents)
-	{
-		std::cout.width(8);
-		std::cout << std::right << std::setprecision(3) << std::fixed << acc.time;
-
-		std::cout.width(10);
-		std::cout << acc.count << "       ";
-
-		std::cout.width(25);
-		std::cout << std::left << acc.event.eventName;
-
-		std::cout.width(50);
-		std::cout << (acc.event.functionName + "()") << acc.event.locationName << std::endl;
-	}
-
-	std::cout << std::endl;
-
-	m_accumulatedEvents.clear();
+	m_event.duration = Tracer::getInstance()->now() - m_event.startTime;
+	m_buffer->depth--;
+	m_buffer->addEvent(m_event);
 }
-
-AccumulatingTracer::AccumulatingTracer() = default;
@@ -1,155 +1,158 @@
 #ifndef TRACING_H
 #define TRACING_H
 
-
-// #define TRACING_ENABLED
-// #define USE_ACCUMULATED_TRACING
-
-
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <stack>
-#include <thread>
+#include <string>
+#include <vector>
 
-#include "FilePath.h"
-#include "TimeStamp.h"
-#include "types.h"
-#include "utilityString.h"
+class FilePath;
 
+// Names, functions and files are expected to be string literals, so recording an event does not
+// allocate.
 struct TraceEvent
 {
-public:
-	TraceEvent():  id(0), depth(0), time(0.0) {}
-
-	TraceEvent(const std::string& eventName, Id id, size_t depth)
-		: eventName(eventName), id(id), depth(depth), time(0.0)
-	{
-	}
-
-	std::string eventName;
-	Id id;
-	size_t depth;
-
-	std::string functionName;
-	std::string locationName;
-
-	double time;
+	const char* eventName = nullptr;
+	const char* functionName = nullptr;
+	const char* fileName = nullptr;
+	int lineNumber = 0;
+	uint32_t depth = 0;
+
+	// nanoseconds since the tracer was created
+	uint64_t startTime = 0;
+	uint64_t duration = 0;
 };
 
-
-class Tracer
+// Fixed size event buffer that is written only by the thread it belongs to. Once it is full the
+// oldest events get overwritten.
+class TraceBuffer
 {
 public:
-	static Tracer* getInstance();
+	static const size_t s_capacity;
 
-	std::shared_ptr<TraceEvent> startEvent(const std::string& eventName);
-	void finishEvent(std::shared_ptr<TraceEvent> event);
+	TraceBuffer(uint32_t threadIndex);
 
-	void printTraces();
+	uint32_t getThreadIndex() const;
 
-private:
-	static std::shared_ptr<Tracer> s_instance;
-	static Id s_nextTraceId;
+	void addEvent(const TraceEvent& event);
 
-	Tracer();
-	Tracer(const Tracer&) = delete;
-	void operator=(const Tracer&) = delete;
+	// may be called from any thread, events overwritten while copying are left out
+	std::vector<TraceEvent> getEvents() const;
+
+	void clear();
 
-	std::map<std::thread::id, std::vector<std::shared_ptr<TraceEvent>>> m_events;
-	std::map<std::thread::id, std::stack<TraceEvent*>> m_startedEvents;
+	uint32_t depth = 0;
 
-	std::mutex m_mutex;
+private:
+	// Slot of a single event guarded by a sequence lock. The sequence is odd while the event with
+	// write count (sequence - 1) / 2 gets written and even once the event with write count
+	// sequence / 2 - 1 is complete, so readers can tell which event they copied and whether it was
+	// overwritten meanwhile.
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence = 0;
+		std::atomic<const char*> eventName = nullptr;
+		std::atomic<const char*> functionName = nullptr;
+		std::atomic<const char*> fileName = nullptr;
+		std::atomic<int> lineNumber = 0;
+		std::atomic<uint32_t> depth = 0;
+		std::atomic<uint64_t> startTime = 0;
+		std::atomic<uint64_t> duration = 0;
+	};
+
+	const uint32_t m_threadIndex;
+	std::vector<Slot> m_slots;
+	std::atomic<uint64_t> m_writeCount = 0;
+	std::atomic<uint64_t> m_clearCount = 0;
 };
 
 
-class AccumulatingTracer
+class Tracer
 {
 public:
-	static AccumulatingTracer* getInstance();
+	static Tracer* getInstance();
 
-	std::shared_ptr<TraceEvent> startEvent(const std::string& eventName);
-	void finishEvent(std::shared_ptr<TraceEvent> event);
+	static bool isEnabled()
+	{
+		return s_enabled.load(std::memory_order_relaxed);
+	}
+	void setEnabled(bool enabled);
+
+	uint64_t now() const;
+	TraceBuffer* getBufferForCurrentThread();
 
-	void printTraces();
+	// including the buffers of finished threads that wait to be reused
+	size_t getBufferCount() const;
+
+	// Writes all recorded events in the Chrome trace event format, which can be opened with
+	// chrome://tracing or ui.perfetto.dev.
+	std::string getChromeTrace() const;
+	bool exportChromeTrace(const FilePath& filePath) const;
+
+	void printTraces() const;
+	void clear();
 
 private:
-	struct AccumulatedTraceEvent
+	// hands the buffer back to the tracer when its thread finishes
+	struct ThreadBuffer
 	{
-		TraceEvent event;
-		size_t count;
-		double time;
+		~ThreadBuffer();
+
+		TraceBuffer* buffer = nullptr;
 	};
 
-	static std::shared_ptr<AccumulatingTracer> s_instance;
-	static Id s_nextTraceId;
+	static std::atomic<bool> s_enabled;
+	static thread_local ThreadBuffer s_threadBuffer;
 
-	AccumulatingTracer();
-	AccumulatingTracer(const AccumulatingTracer&) = delete;
-	void operator=(const AccumulatingTracer&) = delete;
+	Tracer();
+	Tracer(const Tracer&) = delete;
+	void operator=(const Tracer&) = delete;
 
-	std::map<std::string, AccumulatedTraceEvent> m_accumulatedEvents;
-	std::map<std::thread::id, std::stack<TraceEvent*>> m_startedEvents;
+	void releaseBuffer(TraceBuffer* buffer);
 
-	std::mutex m_mutex;
+	const std::chrono::steady_clock::time_point m_startTime;
+
+	// Buffers of finished threads keep their events until a new thread reuses them, so the thread
+	// index of a buffer may be shared by threads that did not run at the same time.
+	std::vector<std::shared_ptr<TraceBuffer>> m_buffers;
+	std::vector<TraceBuffer*> m_freeBuffers;
+	mutable std::mutex m_buffersMutex;
 };
 
 
-template <typename TracerType>
 class ScopedTrace
 {
 public:
-	ScopedTrace(
-		const std::string& eventName,
-		const std::string& fileName,
-		int lineNumber,
-		const std::string& functionName);
-	~ScopedTrace();
-
-private:
-	std::shared_ptr<TraceEvent> m_event;
-	TimeStamp m_timeStamp;
-};
-
-template <typename TracerType>
-ScopedTrace<TracerType>::ScopedTrace(
-	const std::string& eventName,
-	const std::string& fileName,
-	int lineNumber,
-	const std::string& functionName)
-{
-	m_event = TracerType::getInstance()->startEvent(eventName);
-	m_event->functionName = functionName;
-	m_event->locationName = utility::encodeToUtf8(FilePath(fileName).fileName()) + ":" +
-		std::to_string(lineNumber);
-
-	m_timeStamp = TimeStamp::now();
-}
-
-template <typename TracerType>
-ScopedTrace<TracerType>::~ScopedTrace()
-{
-	m_event->time = TimeStamp::durationSeconds(m_timeStamp);
-	TracerType::getInstance()->finishEvent(m_event);
-}
+	ScopedTrace(const char* eventName, const char* fileName, int lineNumber, const char* functionName)
+	{
+		if (Tracer::isEnabled())
+		{
+			start(eventName, fileName, lineNumber, functionName);
+		}
+	}
 
+	~ScopedTrace()
+	{
+		if (m_buffer)
+		{
+			finish();
+		}
+	}
 
-#ifdef TRACING_ENABLED
-#	ifdef USE_ACCUMULATED_TRACING
-#		define TRACE(...)                                                                    \
-			ScopedTrace<AccumulatingTracer> __trace__(                                             \
-				std::string(__VA_ARGS__), __FILE__, __LINE__, __FUNCTION__)
+private:
+	void start(const char* eventName, const char* fileName, int lineNumber, const char* functionName);
+	void finish();
 
-#		define PRINT_TRACES() AccumulatingTracer::getInstance()->printTraces()
-#	else
-#		define TRACE(...)                                                                    \
-			ScopedTrace<Tracer> __trace__(std::string(__VA_ARGS__), __FILE__, __LINE__, __FUNCTION__)
+	TraceBuffer* m_buffer = nullptr;
+	TraceEvent m_event;
+};
 
-#		define PRINT_TRACES() Tracer::getInstance()->printTraces()
-#	endif
 
+#define TRACE(...) ScopedTrace __trace__("" __VA_ARGS__, __FILE__, __LINE__, __FUNCTION__)
 
-#else
-#	define TRACE(...)
-#	define PRINT_TRACES()
-#endif
+#define PRINT_TRACES() Tracer::getInstance()->printTraces()
 
 #endif	  // TRACING_H
@@ -10,20 +10,13 @@ void CxxIndexerCommandProvider::addCommand(const std::shared_ptr<IndexerCommandC
 	std::shared_ptr<CommandRepresentation> representation = std::make_shared<CommandRepresentation>();
 
 	{
-		for (const FilePath& indexedPath: command->getIndexedPaths())
+		const std::set<FilePath>& indexedPaths = command->getIndexedPaths();
+		representation->m_indexedPaths.reserve(indexedPaths.size());
+		for (const FilePath& indexedPath: indexedPaths)
 		{
-			std::map<FilePath, Id>::const_iterator it = m_indexedPathsToIds.find(indexedPath);
-			if (it != m_indexedPathsToIds.end())
-			{
-				representation->m_indexedPathIds.emplace(it->second);
-			}
-			else
-			{
-				const Id id = getId();
-				m_indexedPathsToIds[indexedPath] = id;
-				m_idsToIndexedPaths[id] = indexedPath;
-				representation->m_indexedPathIds.emplace(id);
-			}
+			const FilePathHandle handle = FilePathHandle::intern(indexedPath);
+			m_indexedPaths.insert(handle);
+			representation->m_indexedPaths.push_back(handle);
 		}
 	}
 
@@ -66,19 +59,8 @@ void CxxIndexerCommandProvider::addCommand(const std::shared_ptr<IndexerCommandC
 	}
 
 	{
-		const FilePath workingDirectory = command->getWorkingDirectory();
-		std::map<FilePath, Id>::const_iterator it = m_workingDirectoriesToIds.find(workingDirectory);
-		if (it != m_workingDirectoriesToIds.end())
-		{
-			representation->m_workingDirectoryId = it->second;
-		}
-		else
-		{
-			const Id id = getId();
-			m_workingDirectoriesToIds[workingDirectory] = id;
-			m_idsToWorkingDirectories[id] = workingDirectory;
-			representation->m_workingDirectoryId = id;
-		}
+		representation->m_workingDirectory = FilePathHandle::intern(command->getWorkingDirectory());
+		m_workingDirectories.insert(representation->m_workingDirectory);
 	}
 
 	{
@@ -171,10 +153,10 @@ size_t CxxIndexerCommandProvider::size() const
 void CxxIndexerCommandProvider::logStats() const
 {
 	LOG_INFO("CxxIndexerCommandProvider stats:");
-	LOG_INFO("\tindexed path count: " + std::to_string(m_idsToIndexedPaths.size()));
+	LOG_INFO("\tindexed path count: " + std::to_string(m_indexedPaths.size()));
 	LOG_INFO("\texclude filter count: " + std::to_string(m_idsToExcludeFilters.size()));
 	LOG_INFO("\tinclude filter count: " + std::to_string(m_idsToIncludeFilters.size()));
-	LOG_INFO("\tworking directory count: " + std::to_string(m_idsToWorkingDirectories.size()));
+	LOG_INFO("\tworking directory count: " + std::to_string(m_workingDirectories.size()));
 	LOG_INFO("\tcompiler flag count: " + std::to_string(m_idsToCompilerFlags.size()));
 }
 
@@ -187,9 +169,9 @@ std::shared_ptr<IndexerCommandCxx> CxxIndexerCommandProvider::representationToCo
 	const FilePath& sourceFilePath, std::shared_ptr<CommandRepresentation> representation)
 {
 	std::set<FilePath> indexedPaths;
-	for (const Id id: representation->m_indexedPathIds)
+	for (const FilePathHandle& handle: representation->m_indexedPaths)
 	{
-		indexedPaths.insert(m_idsToIndexedPaths[id]);
+		indexedPaths.insert(handle.getFilePath());
 	}
 
 	std::set<FilePathFilter> excludeFilters;
@@ -204,7 +186,7 @@ std::shared_ptr<IndexerCommandCxx> CxxIndexerCommandProvider::representationToCo
 		includeFilters.insert(FilePathFilter(m_idsToIncludeFilters[id]));
 	}
 
-	FilePath workingDirectory = m_idsToWorkingDirectories[representation->m_workingDirectoryId];
+	FilePath workingDirectory = representation->m_workingDirectory.getFilePath();
 
 	std::vector<std::wstring> compilerFlags;
 	for (const Id id: representation->m_compilerFlagIds)
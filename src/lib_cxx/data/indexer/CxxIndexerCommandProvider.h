@@ -5,7 +5,9 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "FilePathHandle.h"
 #include "IndexerCommandProvider.h"
 #include "types.h"
 
@@ -27,10 +29,10 @@ public:
 private:
 	struct CommandRepresentation
 	{
-		std::set<Id> m_indexedPathIds;
+		std::vector<FilePathHandle> m_indexedPaths;
 		std::set<Id> m_excludeFilterIds;
 		std::set<Id> m_includeFilterIds;
-		Id m_workingDirectoryId;
+		FilePathHandle m_workingDirectory;
 		std::vector<Id> m_compilerFlagIds;
 	};
 
@@ -42,16 +44,16 @@ private:
 
 	std::multimap<FilePath, std::shared_ptr<CommandRepresentation>> m_commands;
 
-	std::map<Id, FilePath> m_idsToIndexedPaths;
-	std::map<FilePath, Id> m_indexedPathsToIds;
 	std::map<Id, std::wstring> m_idsToExcludeFilters;
 	std::map<std::wstring, Id> m_excludeFiltersToIds;
 	std::map<Id, std::wstring> m_idsToIncludeFilters;
 	std::map<std::wstring, Id> m_includeFiltersToIds;
-	std::map<Id, FilePath> m_idsToWorkingDirectories;
-	std::map<FilePath, Id> m_workingDirectoriesToIds;
 	std::map<Id, std::wstring> m_idsToCompilerFlags;
 	std::unordered_map<std::wstring, Id> m_compilerFlagsToIds;
+
+	// paths are interned, these are only kept for the stats
+	std::unordered_set<FilePathHandle> m_indexedPaths;
+	std::unordered_set<FilePathHandle> m_workingDirectories;
 };
 
 #endif	  // CXX_INDEXER_COMMAND_PROVIDER_H
@@ -3,6 +3,7 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
+#include "CompilationDatabase.h"
 #include "MessageStatus.h"
 #include "OrderedCache.h"
 #include "ResourcePaths.h"
@@ -10,13 +11,11 @@
 #include "utilityApp.h"
 #include "utilitySourceGroupCxx.h"
 #include "utilityString.h"
-#include <clang/Tooling/CompilationDatabase.h>
-#include <clang/Tooling/JSONCompilationDatabase.h>
 
 std::vector<FilePath> IndexerCommandCxx::getSourceFilesFromCDB(const FilePath& cdbPath)
 {
 	std::string error;
-	std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb = utility::loadCDB(cdbPath, &error);
+	std::shared_ptr<utility::CompilationDatabase> cdb = utility::loadCDB(cdbPath, &error);
 
 	if (!error.empty())
 	{
@@ -30,7 +29,7 @@ std::vector<FilePath> IndexerCommandCxx::getSourceFilesFromCDB(const FilePath& c
 }
 
 std::vector<FilePath> IndexerCommandCxx::getSourceFilesFromCDB(
-	std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb, const FilePath& cdbPath)
+	std::shared_ptr<utility::CompilationDatabase> cdb, const FilePath& cdbPath)
 {
 	std::vector<FilePath> filePaths;
 	if (cdb)
@@ -38,26 +37,25 @@ std::vector<FilePath> IndexerCommandCxx::getSourceFilesFromCDB(
 		OrderedCache<FilePath, FilePath> canonicalDirectoryPathCache(
 			[](const FilePath& path) { return path.getCanonical(); });
 
-		for (const std::string& fileString: cdb->getAllFiles())
+		std::set<FilePath> addedFilePaths;
+		for (const utility::CompilationDatabase::Command& command: cdb->getCommands())
 		{
-			FilePath path = FilePath(utility::decodeFromUtf8(fileString));
+			FilePath path = FilePath(utility::decodeFromUtf8(command.file));
 			if (!path.isAbsolute())
 			{
-				std::vector<clang::tooling::CompileCommand> commands = cdb->getCompileCommands(
-					fileString);
-				if (!commands.empty())
-				{
-					path = FilePath(utility::decodeFromUtf8(
-										commands.front().Directory + '/' + commands.front().Filename))
-							   .makeCanonical();
-				}
+				path = FilePath(utility::decodeFromUtf8(command.directory + '/' + command.file))
+						   .makeCanonical();
 			}
 			if (!path.isAbsolute())
 			{
 				path = cdbPath.getParentDirectory().getConcatenated(path).makeCanonical();
 			}
-			filePaths.push_back(canonicalDirectoryPathCache.getValue(path.getParentDirectory())
-									.concatenate(path.fileName()));
+			path = canonicalDirectoryPathCache.getValue(path.getParentDirectory())
+					   .concatenate(path.fileName());
+			if (addedFilePaths.insert(path).second)
+			{
+				filePaths.push_back(path);
+			}
 		}
 	}
 	return filePaths;
@@ -8,9 +8,9 @@
 
 class FilePath;
 
-namespace clang::tooling
+namespace utility
 {
-class JSONCompilationDatabase;
+class CompilationDatabase;
 }
 
 class IndexerCommandCxx: public IndexerCommand
@@ -18,7 +18,7 @@ class IndexerCommandCxx: public IndexerCommand
 public:
 	static std::vector<FilePath> getSourceFilesFromCDB(const FilePath& cdbPath);
 	static std::vector<FilePath> getSourceFilesFromCDB(
-		std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb, const FilePath& cdbPath);
+		std::shared_ptr<utility::CompilationDatabase> cdb, const FilePath& cdbPath);
 
 	static std::wstring getCompilerFlagLanguageStandard(const std::wstring& languageStandard);
 	static std::vector<std::wstring> getCompilerFlagsForSystemHeaderSearchPaths(
@@ -1,11 +1,13 @@
 #include "SourceGroupCxxCdb.h"
 
-#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <unordered_map>
+
 #include <clang/Tooling/Tooling.h>
 
 #include "Application.h"
 #include "ApplicationSettings.h"
 #include "ClangInvocationInfo.h"
+#include "CompilationDatabase.h"
 #include "CxxCompilationDatabaseSingle.h"
 #include "CxxIndexerCommandProvider.h"
 #include "IndexerCommandCxx.h"
@@ -53,7 +55,7 @@ std::set<FilePath> SourceGroupCxxCdb::getAllSourceFilePaths() const
 }
 
 std::set<FilePath> SourceGroupCxxCdb::getAllSourceFilePaths(
-	std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb) const
+	std::shared_ptr<utility::CompilationDatabase> cdb) const
 {
 	std::set<FilePath> sourceFilePaths;
 
@@ -82,7 +84,7 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
 		std::make_shared<CxxIndexerCommandProvider>();
 
 	const FilePath cdbPath = m_settings->getCompilationDatabasePathExpandedAndAbsolute();
-	std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb = utility::loadCDB(cdbPath);
+	std::shared_ptr<utility::CompilationDatabase> cdb = utility::loadCDB(cdbPath);
 	if (!cdb)
 	{
 		return provider;
@@ -99,12 +101,16 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
 		m_settings->getExcludeFiltersExpandedAndAbsolute());
 	const std::set<FilePath>& sourceFilePaths = getAllSourceFilePaths(cdb);
 
-	for (const clang::tooling::CompileCommand& command: cdb->getAllCompileCommands())
+	// commands sharing an argument list only need their own source and output file decoded
+	std::unordered_map<const utility::CompilationDatabase::ArgumentList*, std::vector<std::wstring>>
+		decodedArgumentLists;
+
+	for (const utility::CompilationDatabase::Command& command: cdb->getCommands())
 	{
-		FilePath sourcePath = FilePath(utility::decodeFromUtf8(command.Filename)).makeCanonical();
+		FilePath sourcePath = FilePath(utility::decodeFromUtf8(command.file)).makeCanonical();
 		if (!sourcePath.isAbsolute())
 		{
-			sourcePath = FilePath(utility::decodeFromUtf8(command.Directory + '/' + command.Filename))
+			sourcePath = FilePath(utility::decodeFromUtf8(command.directory + '/' + command.file))
 							 .makeCanonical();
 			if (!sourcePath.isAbsolute())
 			{
@@ -115,12 +121,34 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
 		if (info.filesToIndex.find(sourcePath) != info.filesToIndex.end() &&
 			sourceFilePaths.find(sourcePath) != sourceFilePaths.end())
 		{
-			std::vector<std::wstring> cdbFlags = utility::convert<std::string, std::wstring>(
-				command.CommandLine, [](const std::string& s) { return utility::decodeFromUtf8(s); });
+			const utility::CompilationDatabase::ArgumentList* argumentList =
+				command.argumentList.get();
+
+			auto it = decodedArgumentLists.find(argumentList);
+			if (it == decodedArgumentLists.end())
+			{
+				it = decodedArgumentLists
+						 .emplace(
+							 argumentList,
+							 utility::convert<std::string, std::wstring>(
+								 argumentList->arguments,
+								 [](const std::string& s) { return utility::decodeFromUtf8(s); }))
+						 .first;
+			}
+
+			std::vector<std::wstring> cdbFlags = it->second;
+			if (argumentList->fileIndex != std::string::npos)
+			{
+				cdbFlags[argumentList->fileIndex] = utility::decodeFromUtf8(command.file);
+			}
+			if (argumentList->outputIndex != std::string::npos)
+			{
+				cdbFlags[argumentList->outputIndex] = utility::decodeFromUtf8(command.output);
+			}
 
 			utility::removeIncludePchFlag(cdbFlags);
 
-			if (command.CommandLine.size() != cdbFlags.size())
+			if (argumentList->arguments.size() != cdbFlags.size())
 			{
 				utility::append(cdbFlags, includePchFlags);
 			}
@@ -130,7 +158,7 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
 				utility::concat(indexedHeaderPaths, {sourcePath}),
 				excludeFilters,
 				std::set<FilePathFilter>(),
-				FilePath(utility::decodeFromUtf8(command.Directory)),
+				FilePath(utility::decodeFromUtf8(command.directory)),
 				utility::concat(cdbFlags, compilerFlags)));
 		}
 	}
@@ -159,18 +187,17 @@ std::shared_ptr<Task> SourceGroupCxxCdb::getPreIndexTask(
 	if (m_settings->getUseCompilerFlags())
 	{
 		const FilePath cdbPath = m_settings->getCompilationDatabasePathExpandedAndAbsolute();
-		std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb = utility::loadCDB(cdbPath);
+		std::shared_ptr<utility::CompilationDatabase> cdb = utility::loadCDB(cdbPath);
 		if (cdb)
 		{
 			const std::set<FilePath> sourceFilePaths = getAllSourceFilePaths(cdb);
-			for (const clang::tooling::CompileCommand& command: cdb->getAllCompileCommands())
+			for (const utility::CompilationDatabase::Command& command: cdb->getCommands())
 			{
-				FilePath sourcePath =
-					FilePath(utility::decodeFromUtf8(command.Filename)).makeCanonical();
+				FilePath sourcePath = FilePath(utility::decodeFromUtf8(command.file)).makeCanonical();
 				if (!sourcePath.isAbsolute())
 				{
 					sourcePath = FilePath(utility::decodeFromUtf8(
-											  command.Directory + '/' + command.Filename))
+											  command.directory + '/' + command.file))
 									 .makeCanonical();
 					if (!sourcePath.isAbsolute())
 					{
@@ -180,9 +207,10 @@ std::shared_ptr<Task> SourceGroupCxxCdb::getPreIndexTask(
 				}
 
 				if (sourceFilePaths.find(sourcePath) != sourceFilePaths.end() &&
-					utility::containsIncludePchFlag(command.CommandLine))
+					utility::containsIncludePchFlag(command.argumentList->arguments))
 				{
-					for (const std::string& arg: command.CommandLine)
+					const std::vector<std::string> commandLine = command.getCommandLine();
+					for (const std::string& arg: commandLine)
 					{
 						if ((!compilerFlags.empty() || utility::isPrefix<std::string>("-", arg)) &&
 							FilePath(arg).fileName() != sourcePath.fileName())
@@ -191,7 +219,8 @@ std::shared_ptr<Task> SourceGroupCxxCdb::getPreIndexTask(
 						}
 					}
 
-					CxxCompilationDatabaseSingle compilationDatabase(command);
+					CxxCompilationDatabaseSingle compilationDatabase(clang::tooling::CompileCommand(
+						command.directory, command.file, commandLine, command.output));
 					ClangInvocationInfo info = ClangInvocationInfo::getClangInvocationString(
 						&compilationDatabase);
 
@@ -9,9 +9,9 @@
 
 class FilePath;
 
-namespace clang::tooling
+namespace utility
 {
-class JSONCompilationDatabase;
+class CompilationDatabase;
 }
 
 
@@ -26,7 +26,7 @@ public:
 	std::set<FilePath> filterToContainedFilePaths(const std::set<FilePath>& filePaths) const override;
 	std::set<FilePath> getAllSourceFilePaths() const override;
 	std::set<FilePath> getAllSourceFilePaths(
-		std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb) const;
+		std::shared_ptr<utility::CompilationDatabase> cdb) const;
 	std::shared_ptr<IndexerCommandProvider> getIndexerCommandProvider(
 		const RefreshInfo& info) const override;
 	std::vector<std::shared_ptr<IndexerCommand>> getIndexerCommands(const RefreshInfo& info) const override;
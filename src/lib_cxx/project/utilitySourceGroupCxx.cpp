@@ -1,8 +1,9 @@
 #include "utilitySourceGroupCxx.h"
 
-#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <set>
 
 #include "CanonicalFilePathCache.h"
+#include "CompilationDatabase.h"
 #include "CxxCompilationDatabaseSingle.h"
 #include "CxxDiagnosticConsumer.h"
 #include "CxxParser.h"
@@ -102,35 +103,33 @@ std::shared_ptr<Task> createBuildPchTask(
 		});
 }
 
-std::shared_ptr<clang::tooling::JSONCompilationDatabase> loadCDB(
-	const FilePath& cdbPath, std::string* error)
+std::shared_ptr<CompilationDatabase> loadCDB(const FilePath& cdbPath, std::string* error)
 {
 	if (cdbPath.empty() || !cdbPath.exists())
 	{
-		return std::shared_ptr<clang::tooling::JSONCompilationDatabase>();
+		return std::shared_ptr<CompilationDatabase>();
 	}
 
-	std::string errorString;
-	std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb =
-		std::shared_ptr<clang::tooling::JSONCompilationDatabase>(
-			clang::tooling::JSONCompilationDatabase::loadFromFile(
-				utility::encodeToUtf8(cdbPath.wstr()),
-				errorString,
-				clang::tooling::JSONCommandLineSyntax::AutoDetect));
-
-	if (error && !errorString.empty())
+	std::shared_ptr<CompilationDatabase> cdb = std::make_shared<CompilationDatabase>(cdbPath);
+	if (!cdb->getError().empty())
 	{
-		*error = errorString;
+		if (error)
+		{
+			*error = cdb->getError();
+		}
+		return std::shared_ptr<CompilationDatabase>();
 	}
 
 	return cdb;
 }
 
-bool containsIncludePchFlags(std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb)
+bool containsIncludePchFlags(std::shared_ptr<CompilationDatabase> cdb)
 {
-	for (const clang::tooling::CompileCommand& command: cdb->getAllCompileCommands())
+	std::set<const CompilationDatabase::ArgumentList*> checkedArgumentLists;
+	for (const CompilationDatabase::Command& command: cdb->getCommands())
 	{
-		if (containsIncludePchFlag(command.CommandLine))
+		if (checkedArgumentLists.insert(command.argumentList.get()).second &&
+			containsIncludePchFlag(command.argumentList->arguments))
 		{
 			return true;
 		}
@@ -6,12 +6,6 @@
 #include <vector>
 
 
-namespace clang::tooling
-{
-class JSONCompilationDatabase;
-}
-
-
 class DialogView;
 class FilePath;
 class SourceGroupSettingsWithCxxPchOptions;
@@ -20,15 +14,16 @@ class Task;
 
 namespace utility
 {
+class CompilationDatabase;
+
 std::shared_ptr<Task> createBuildPchTask(
 	const SourceGroupSettingsWithCxxPchOptions* settings,
 	std::vector<std::wstring> compilerFlags,
 	std::shared_ptr<StorageProvider> storageProvider,
 	std::shared_ptr<DialogView> dialogView);
 
-std::shared_ptr<clang::tooling::JSONCompilationDatabase> loadCDB(
-	const FilePath& cdbPath, std::string* error = nullptr);
-bool containsIncludePchFlags(std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb);
+std::shared_ptr<CompilationDatabase> loadCDB(const FilePath& cdbPath, std::string* error = nullptr);
+bool containsIncludePchFlags(std::shared_ptr<CompilationDatabase> cdb);
 bool containsIncludePchFlag(const std::vector<std::string>& args);
 std::vector<std::wstring> getWithRemoveIncludePchFlag(const std::vector<std::wstring>& args);
 void removeIncludePchFlag(std::vector<std::wstring>& args);
@@ -1,22 +1,729 @@
 #include "CompilationDatabase.h"
 
+#include <fstream>
 #include <set>
-
-#include <clang/Tooling/CompilationDatabase.h>
-#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <unordered_set>
 
 #include "FilePath.h"
+#include "Platform.h"
 #include "logging.h"
 #include "utility.h"
 #include "utilityString.h"
 
+namespace
+{
+// Buffered reader for the JSON used by compilation databases. Only the first error is kept, every
+// read after an error fails.
+class JsonReader
+{
+public:
+	JsonReader(std::istream& stream): m_stream(stream), m_buffer(1 << 16) {}
+
+	// skips whitespace and returns the next character without consuming it, 0 at the end
+	char peek()
+	{
+		while (true)
+		{
+			if (m_position == m_size && !fill())
+			{
+				return 0;
+			}
+
+			const char c = m_buffer[m_position];
+			if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+			{
+				return c;
+			}
+			m_position++;
+		}
+	}
+
+	bool consume(char expected)
+	{
+		if (peek() != expected)
+		{
+			return fail(std::string("Expected '") + expected + "'");
+		}
+		m_position++;
+		return true;
+	}
+
+	// skips the UTF-8 byte order mark some editors write at the start of a file
+	void skipByteOrderMark()
+	{
+		if (m_position == m_size && !fill())
+		{
+			return;
+		}
+
+		if (m_size - m_position >= 3 && m_buffer[m_position] == '\xEF' &&
+			m_buffer[m_position + 1] == '\xBB' && m_buffer[m_position + 2] == '\xBF')
+		{
+			m_position += 3;
+		}
+	}
+
+	// consumes the ',' between two elements, returns false if there is none
+	bool consumeSeparator()
+	{
+		if (peek() == ',')
+		{
+			m_position++;
+			return true;
+		}
+		return false;
+	}
+
+	bool readString(std::string& value)
+	{
+		value.clear();
+		if (!consume('"'))
+		{
+			return false;
+		}
+
+		while (true)
+		{
+			if (m_position == m_size && !fill())
+			{
+				return fail("Unterminated string");
+			}
+
+			// plain characters are copied in runs
+			const char* begin = m_buffer.data() + m_position;
+			const char* end = m_buffer.data() + m_size;
+			const char* it = begin;
+			while (it != end && *it != '"' && *it != '\\')
+			{
+				it++;
+			}
+			value.append(begin, it);
+			m_position += it - begin;
+
+			if (it == end)
+			{
+				continue;
+			}
+
+			m_position++;
+			if (*it == '"')
+			{
+				return true;
+			}
+
+			if (!readEscapeSequence(value))
+			{
+				return false;
+			}
+		}
+	}
+
+	bool readStringArray(std::vector<std::string>& values)
+	{
+		values.clear();
+		if (!consume('['))
+		{
+			return false;
+		}
+
+		if (peek() != ']')
+		{
+			do
+			{
+				values.emplace_back();
+				if (!readString(values.back()))
+				{
+					return false;
+				}
+			} while (consumeSeparator());
+		}
+
+		return consume(']');
+	}
+
+	bool skipValue()
+	{
+		const char c = peek();
+		if (c == '"')
+		{
+			std::string value;
+			return readString(value);
+		}
+
+		if (c == '[' || c == '{')
+		{
+			const char close = (c == '[' ? ']' : '}');
+			m_position++;
+			if (peek() != close)
+			{
+				do
+				{
+					std::string key;
+					if (c == '{' && (!readString(key) || !consume(':')))
+					{
+						return false;
+					}
+					if (!skipValue())
+					{
+						return false;
+					}
+				} while (consumeSeparator());
+			}
+			return consume(close);
+		}
+
+		// numbers, true, false and null
+		size_t length = 0;
+		while (m_position < m_size || fill())
+		{
+			const char n = m_buffer[m_position];
+			if (!std::isalnum(static_cast<unsigned char>(n)) && n != '+' && n != '-' && n != '.')
+			{
+				break;
+			}
+			m_position++;
+			length++;
+		}
+		return length > 0 || fail("Unexpected character");
+	}
+
+	bool fail(const std::string& message)
+	{
+		if (m_error.empty())
+		{
+			m_error = message + " at offset " + std::to_string(m_offset + m_position) + ".";
+		}
+		return false;
+	}
+
+	const std::string& getError() const
+	{
+		return m_error;
+	}
+
+private:
+	bool fill()
+	{
+		if (!m_error.empty())
+		{
+			return false;
+		}
+
+		m_offset += m_size;
+		m_position = 0;
+		m_stream.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+		m_size = static_cast<size_t>(m_stream.gcount());
+		return m_size > 0;
+	}
+
+	bool next(char& c)
+	{
+		if (m_position == m_size && !fill())
+		{
+			return false;
+		}
+		c = m_buffer[m_position++];
+		return true;
+	}
+
+	bool readEscapeSequence(std::string& value)
+	{
+		char c = 0;
+		if (!next(c))
+		{
+			return fail("Unterminated string");
+		}
+
+		switch (c)
+		{
+		case '"':
+		case '\\':
+		case '/':
+			value += c;
+			return true;
+		case 'b':
+			value += '\b';
+			return true;
+		case 'f':
+			value += '\f';
+			return true;
+		case 'n':
+			value += '\n';
+			return true;
+		case 'r':
+			value += '\r';
+			return true;
+		case 't':
+			value += '\t';
+			return true;
+		case 'u':
+			break;
+		default:
+			return fail("Invalid escape sequence");
+		}
+
+		unsigned int codePoint = 0;
+		if (!readHex(codePoint))
+		{
+			return false;
+		}
+
+		if (codePoint >= 0xD800 && codePoint < 0xDC00)
+		{
+			char backslash = 0;
+			char u = 0;
+			unsigned int lowSurrogate = 0;
+			if (!next(backslash) || !next(u) || backslash != '\\' || u != 'u' ||
+				!readHex(lowSurrogate) || lowSurrogate < 0xDC00 || lowSurrogate >= 0xE000)
+			{
+				return fail("Invalid surrogate pair");
+			}
+			codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+		}
+
+		if (codePoint < 0x80)
+		{
+			value += static_cast<char>(codePoint);
+		}
+		else if (codePoint < 0x800)
+		{
+			value += static_cast<char>(0xC0 | (codePoint >> 6));
+			value += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			value += static_cast<char>(0xE0 | (codePoint >> 12));
+			value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			value += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			value += static_cast<char>(0xF0 | (codePoint >> 18));
+			value += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			value += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		return true;
+	}
+
+	bool readHex(unsigned int& value)
+	{
+		value = 0;
+		for (size_t i = 0; i < 4; i++)
+		{
+			char c = 0;
+			if (!next(c) || !std::isxdigit(static_cast<unsigned char>(c)))
+			{
+				return fail("Invalid unicode escape");
+			}
+			value = value * 16 +
+				static_cast<unsigned int>(
+						std::isdigit(static_cast<unsigned char>(c)) ? c - '0'
+																	: std::tolower(c) - 'a' + 10);
+		}
+		return true;
+	}
+
+	std::istream& m_stream;
+	std::vector<char> m_buffer;
+	size_t m_position = 0;
+	size_t m_size = 0;
+	size_t m_offset = 0;
+	std::string m_error;
+};
+
+// splits like clang does for the 'command' of an entry on non Windows platforms
+std::vector<std::string> splitGnuCommandLine(const std::string& commandLine)
+{
+	std::vector<std::string> arguments;
+
+	size_t i = 0;
+	while (true)
+	{
+		while (i < commandLine.size() && commandLine[i] == ' ')
+		{
+			i++;
+		}
+		if (i == commandLine.size())
+		{
+			break;
+		}
+
+		std::string argument;
+		while (i < commandLine.size() && commandLine[i] != ' ')
+		{
+			const char c = commandLine[i++];
+			if (c == '"')
+			{
+				while (i < commandLine.size() && commandLine[i] != '"')
+				{
+					if (commandLine[i] == '\\' && i + 1 < commandLine.size())
+					{
+						i++;
+					}
+					argument += commandLine[i++];
+				}
+				i++;
+			}
+			else if (c == '\'')
+			{
+				while (i < commandLine.size() && commandLine[i] != '\'')
+				{
+					argument += commandLine[i++];
+				}
+				i++;
+			}
+			else if (c == '\\')
+			{
+				if (i < commandLine.size())
+				{
+					argument += commandLine[i++];
+				}
+			}
+			else
+			{
+				argument += c;
+			}
+		}
+		arguments.push_back(argument);
+	}
+
+	return arguments;
+}
+
+// splits like clang does for the 'command' of an entry on Windows, where quotes in the program name
+// only group and backslashes only escape quotes
+std::vector<std::string> splitWindowsCommandLine(const std::string& commandLine)
+{
+	std::vector<std::string> arguments;
+
+	auto isWhitespace = [](char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	};
+
+	size_t i = 0;
+	while (true)
+	{
+		while (i < commandLine.size() && isWhitespace(commandLine[i]))
+		{
+			i++;
+		}
+		if (i == commandLine.size())
+		{
+			break;
+		}
+
+		std::string argument;
+		bool quoted = false;
+		while (i < commandLine.size() && (quoted || !isWhitespace(commandLine[i])))
+		{
+			const char c = commandLine[i++];
+			if (arguments.empty())
+			{
+				if (c == '"')
+				{
+					quoted = !quoted;
+				}
+				else
+				{
+					argument += c;
+				}
+			}
+			else if (c == '\\')
+			{
+				size_t backslashCount = 1;
+				while (i < commandLine.size() && commandLine[i] == '\\')
+				{
+					backslashCount++;
+					i++;
+				}
+
+				if (i < commandLine.size() && commandLine[i] == '"')
+				{
+					argument.append(backslashCount / 2, '\\');
+					if (backslashCount % 2 == 1)
+					{
+						argument += '"';
+						i++;
+					}
+				}
+				else
+				{
+					argument.append(backslashCount, '\\');
+				}
+			}
+			else if (c == '"')
+			{
+				if (quoted && i < commandLine.size() && commandLine[i] == '"')
+				{
+					argument += '"';
+					i++;
+				}
+				else
+				{
+					quoted = !quoted;
+				}
+			}
+			else
+			{
+				argument += c;
+			}
+		}
+		arguments.push_back(argument);
+	}
+
+	return arguments;
+}
+
+// drops compiler wrappers, so 'ccache g++ -c a.cpp' is read as 'g++ -c a.cpp' like clang does
+void unwrapCommandLine(std::vector<std::string>& arguments)
+{
+	static const std::set<std::string> sourceExtensions = {
+		"c", "C", "cc", "cpp", "cxx", "c++", "cu", "i", "ii", "m", "mm", "s", "S"};
+
+	while (arguments.size() >= 2)
+	{
+		std::string wrapper = arguments.front().substr(arguments.front().find_last_of("/\\") + 1);
+		if (utility::isPostfix<std::string>(".exe", utility::toLowerCase(wrapper)))
+		{
+			wrapper.resize(wrapper.size() - 4);
+		}
+		if (wrapper != "ccache" && wrapper != "distcc" && wrapper != "sccache")
+		{
+			break;
+		}
+
+		// 'ccache a.cpp' calls the default compiler
+		const std::string& compiler = arguments[1];
+		const size_t extensionPosition = compiler.find_last_of('.');
+		if (utility::isPrefix<std::string>("-", compiler) ||
+			(extensionPosition != std::string::npos &&
+			 sourceExtensions.find(compiler.substr(extensionPosition + 1)) != sourceExtensions.end()))
+		{
+			break;
+		}
+
+		arguments.erase(arguments.begin());
+	}
+}
+
+struct ArgumentListHash
+{
+	size_t operator()(
+		const std::shared_ptr<const utility::CompilationDatabase::ArgumentList>& list) const
+	{
+		size_t hash = list->fileIndex * 31 + list->outputIndex;
+		for (const std::string& argument: list->arguments)
+		{
+			hash = hash * 1000003 ^ std::hash<std::string>()(argument);
+		}
+		return hash;
+	}
+};
+
+struct ArgumentListEqual
+{
+	bool operator()(
+		const std::shared_ptr<const utility::CompilationDatabase::ArgumentList>& a,
+		const std::shared_ptr<const utility::CompilationDatabase::ArgumentList>& b) const
+	{
+		return a->fileIndex == b->fileIndex && a->outputIndex == b->outputIndex &&
+			a->arguments == b->arguments;
+	}
+};
+
+typedef std::unordered_set<
+	std::shared_ptr<const utility::CompilationDatabase::ArgumentList>,
+	ArgumentListHash,
+	ArgumentListEqual>
+	ArgumentListSet;
+
+std::shared_ptr<const utility::CompilationDatabase::ArgumentList> shareArgumentList(
+	std::vector<std::string> arguments,
+	utility::CompilationDatabase::Command& command,
+	ArgumentListSet& argumentLists)
+{
+	std::shared_ptr<utility::CompilationDatabase::ArgumentList> list =
+		std::make_shared<utility::CompilationDatabase::ArgumentList>();
+
+	for (size_t i = 1; i < arguments.size(); i++)
+	{
+		if (list->fileIndex == std::string::npos && arguments[i] == command.file)
+		{
+			list->fileIndex = i;
+			arguments[i].clear();
+		}
+		else if (
+			list->outputIndex == std::string::npos && arguments[i - 1] == "-o" &&
+			(command.output.empty() || arguments[i] == command.output))
+		{
+			command.output = arguments[i];
+			list->outputIndex = i;
+			arguments[i].clear();
+		}
+	}
+	list->arguments = std::move(arguments);
+
+	return *argumentLists.insert(list).first;
+}
+
+bool readCommand(
+	JsonReader& reader, ArgumentListSet& argumentLists, utility::CompilationDatabase::Command& command)
+{
+	if (!reader.consume('{'))
+	{
+		return false;
+	}
+
+	bool hasDirectory = false;
+	bool hasFile = false;
+	bool hasCommandLine = false;
+	bool hasArguments = false;
+	std::string commandLine;
+	std::vector<std::string> arguments;
+
+	if (reader.peek() != '}')
+	{
+		std::string key;
+		do
+		{
+			if (!reader.readString(key) || !reader.consume(':'))
+			{
+				return false;
+			}
+
+			bool success = true;
+			if (key == "directory")
+			{
+				success = reader.readString(command.directory);
+				hasDirectory = true;
+			}
+			else if (key == "file")
+			{
+				success = reader.readString(command.file);
+				hasFile = true;
+			}
+			else if (key == "output")
+			{
+				success = reader.readString(command.output);
+			}
+			else if (key == "command")
+			{
+				success = reader.readString(commandLine);
+				hasCommandLine = true;
+			}
+			else if (key == "arguments")
+			{
+				success = reader.readStringArray(arguments);
+				hasArguments = true;
+			}
+			else
+			{
+				success = reader.skipValue();
+			}
+
+			if (!success)
+			{
+				return false;
+			}
+		} while (reader.consumeSeparator());
+	}
+
+	if (!reader.consume('}'))
+	{
+		return false;
+	}
+
+	if (!hasDirectory)
+	{
+		return reader.fail("Missing key \"directory\"");
+	}
+	if (!hasFile)
+	{
+		return reader.fail("Missing key \"file\"");
+	}
+	if (!hasCommandLine && !hasArguments)
+	{
+		return reader.fail("Missing key \"command\" or \"arguments\"");
+	}
+
+	// 'arguments' are preferred, like clang does
+	if (!hasArguments)
+	{
+		if constexpr (utility::Platform::isWindows())
+		{
+			arguments = splitWindowsCommandLine(commandLine);
+		}
+		else
+		{
+			arguments = splitGnuCommandLine(commandLine);
+		}
+	}
+	unwrapCommandLine(arguments);
+
+	command.argumentList = shareArgumentList(std::move(arguments), command, argumentLists);
+	return true;
+}
+}	 // namespace
+
+std::vector<std::string> utility::CompilationDatabase::Command::getCommandLine() const
+{
+	std::vector<std::string> commandLine = argumentList->arguments;
+	if (argumentList->fileIndex != std::string::npos)
+	{
+		commandLine[argumentList->fileIndex] = file;
+	}
+	if (argumentList->outputIndex != std::string::npos)
+	{
+		commandLine[argumentList->outputIndex] = output;
+	}
+	return commandLine;
+}
+
 utility::CompilationDatabase::CompilationDatabase(const FilePath& filePath): m_filePath(filePath)
 {
-	init();
+	std::ifstream stream(m_filePath.str(), std::ios::binary);
+	if (stream)
+	{
+		init(stream);
+	}
+	else
+	{
+		m_error = "Could not open file.";
+	}
+
+	if (!m_error.empty())
+	{
+		LOG_ERROR(
+			L"Loading compilation database from file \"" + m_filePath.wstr() +
+			L"\" failed with error: " + utility::decodeFromUtf8(m_error));
+	}
+}
+
+utility::CompilationDatabase::CompilationDatabase(std::istream& stream)
+{
+	init(stream);
+}
+
+const std::string& utility::CompilationDatabase::getError() const
+{
+	return m_error;
+}
+
+const std::vector<utility::CompilationDatabase::Command>& utility::CompilationDatabase::getCommands()
+	const
+{
+	return m_commands;
+}
+
+size_t utility::CompilationDatabase::getArgumentListCount() const
+{
+	return m_argumentListCount;
 }
 
 std::vector<FilePath> utility::CompilationDatabase::getAllHeaderPaths() const
 {
+	initHeaderPaths();
 	std::vector<FilePath> paths = utility::concat(m_headers, m_systemHeaders);
 	paths = utility::unique(paths);
 	return paths;
@@ -24,85 +731,116 @@ std::vector<FilePath> utility::CompilationDatabase::getAllHeaderPaths() const
 
 std::vector<FilePath> utility::CompilationDatabase::getHeaderPaths() const
 {
+	initHeaderPaths();
 	return m_headers;
 }
 
 std::vector<FilePath> utility::CompilationDatabase::getSystemHeaderPaths() const
 {
+	initHeaderPaths();
 	return m_systemHeaders;
 }
 
 std::vector<FilePath> utility::CompilationDatabase::getFrameworkHeaderPaths() const
 {
+	initHeaderPaths();
 	return m_frameworkHeaders;
 }
 
-void utility::CompilationDatabase::init()
+void utility::CompilationDatabase::init(std::istream& stream)
 {
-	std::string error;
-	std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb(
-		clang::tooling::JSONCompilationDatabase::loadFromFile(
-			utility::encodeToUtf8(m_filePath.wstr()),
-			error,
-			clang::tooling::JSONCommandLineSyntax::AutoDetect));
+	JsonReader reader(stream);
+	ArgumentListSet argumentLists;
 
-	if (!cdb)
+	reader.skipByteOrderMark();
+
+	bool success = reader.consume('[');
+	if (success && reader.peek() != ']')
 	{
-		LOG_ERROR(
-			L"Loading compilation database from file \"" + m_filePath.wstr() +
-			L"\" failed with error: " + utility::decodeFromUtf8(error));
+		do
+		{
+			m_commands.emplace_back();
+			success = readCommand(reader, argumentLists, m_commands.back());
+		} while (success && reader.consumeSeparator());
+	}
+	success = success && reader.consume(']');
+
+	if (success && reader.peek() != 0)
+	{
+		reader.fail("Unexpected content after the database");
+		success = false;
+	}
+
+	if (!success)
+	{
+		m_error = reader.getError();
+		m_commands.clear();
 		return;
 	}
 
-	std::vector<clang::tooling::CompileCommand> commands = cdb->getAllCompileCommands();
+	m_commands.shrink_to_fit();
+	m_argumentListCount = argumentLists.size();
+}
+
+void utility::CompilationDatabase::initHeaderPaths() const
+{
+	if (m_headerPathsInitialized)
+	{
+		return;
+	}
+	m_headerPathsInitialized = true;
+
 	std::set<FilePath> frameworkHeaders;
 	std::set<FilePath> systemHeaders;
 	std::set<FilePath> headers;
 
+	// commands sharing directory and arguments only differ in their source and output file
+	std::set<std::pair<std::string, const ArgumentList*>> processedArgumentLists;
+
+	const std::string frameworkIncludeFlag = "-iframework";
+	const std::string systemIncludeFlag = "-isystem";
+	const std::string quoteFlag = "-iquote";
+	const std::string includeFlag = "-I";
+	for (const Command& command: m_commands)
 	{
-		const std::wstring frameworkIncludeFlag = L"-iframework";
-		const std::wstring systemIncludeFlag = L"-isystem";
-		const std::wstring quoteFlag = L"-iquote";
-		const std::wstring includeFlag = L"-I";
-		for (clang::tooling::CompileCommand& command: commands)
+		if (!processedArgumentLists.emplace(command.directory, command.argumentList.get()).second)
 		{
-			const std::wstring commandDirectory = utility::decodeFromUtf8(command.Directory);
-			for (size_t i = 0; i < command.CommandLine.size(); i++)
+			continue;
+		}
+
+		const std::wstring commandDirectory = utility::decodeFromUtf8(command.directory);
+		const std::vector<std::string> commandLine = command.getCommandLine();
+		for (size_t i = 0; i < commandLine.size(); i++)
+		{
+			std::string argument = commandLine[i];
+			if (i + 1 < commandLine.size() &&
+				!utility::isPrefix<std::string>("-", commandLine[i + 1]))
 			{
-				std::wstring argument = utility::decodeFromUtf8(command.CommandLine[i]);
-				if (i + 1 < command.CommandLine.size() &&
-					!utility::isPrefix<std::string>("-", command.CommandLine[i + 1]))
-				{
-					argument += utility::decodeFromUtf8(command.CommandLine[++i]);
-				}
+				argument += commandLine[++i];
+			}
 
-				if (utility::isPrefix(frameworkIncludeFlag, argument))
-				{
-					frameworkHeaders.insert(
-						FilePath(
-							utility::trim(argument.substr(frameworkIncludeFlag.size())),
-							commandDirectory)
-							.makeCanonical());
-				}
-				else if (utility::isPrefix(systemIncludeFlag, argument))
-				{
-					systemHeaders.insert(FilePath(
-											 utility::trim(argument.substr(systemIncludeFlag.size())),
-											 commandDirectory)
-											 .makeCanonical());
-				}
-				else if (utility::isPrefix(quoteFlag, argument))
-				{
-					headers.insert(
-						FilePath(utility::trim(argument.substr(quoteFlag.size())), commandDirectory)
-							.makeCanonical());
-				}
-				else if (utility::isPrefix(includeFlag, argument))
-				{
-					headers.insert(
-						FilePath(utility::trim(argument.substr(includeFlag.size())), commandDirectory)
-							.makeCanonical());
-				}
+			auto getPath = [&argument, &commandDirectory](const std::string& flag) {
+				return FilePath(
+						   utility::decodeFromUtf8(utility::trim(argument.substr(flag.size()))),
+						   commandDirectory)
+					.makeCanonical();
+			};
+
+			if (utility::isPrefix(frameworkIncludeFlag, argument))
+			{
+				frameworkHeaders.insert(getPath(frameworkIncludeFlag));
+			}
+			else if (utility::isPrefix(systemIncludeFlag, argument))
+			{
+				systemHeaders.insert(getPath(systemIncludeFlag));
+			}
+			else if (utility::isPrefix(quoteFlag, argument))
+			{
+				headers.insert(getPath(quoteFlag));
+			}
+			else if (utility::isPrefix(includeFlag, argument))
+			{
+				headers.insert(getPath(includeFlag));
 			}
 		}
 	}
@@ -1,6 +1,8 @@
 #ifndef UTILITY_COMPILATION_DATABASE_H
 #define UTILITY_COMPILATION_DATABASE_H
 
+#include <istream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -8,10 +10,40 @@
 
 namespace utility
 {
+// Reads a JSON compilation database in a single pass over a buffered stream, without building a
+// document tree. All strings stay UTF-8 encoded. Commands whose command lines only differ in the
+// source file and the output file they name share one argument list, so databases with many
+// entries but few distinct flag sets stay small.
 class CompilationDatabase
 {
 public:
+	struct ArgumentList
+	{
+		// the arguments naming the source file and the output file of a command are left empty
+		std::vector<std::string> arguments;
+		size_t fileIndex = std::string::npos;
+		size_t outputIndex = std::string::npos;
+	};
+
+	struct Command
+	{
+		std::vector<std::string> getCommandLine() const;
+
+		std::string directory;
+		std::string file;
+		// taken from the command line if the entry has no output
+		std::string output;
+		std::shared_ptr<const ArgumentList> argumentList;
+	};
+
 	CompilationDatabase(const FilePath& filePath);
+	CompilationDatabase(std::istream& stream);
+
+	// empty if the database was read successfully
+	const std::string& getError() const;
+
+	const std::vector<Command>& getCommands() const;
+	size_t getArgumentListCount() const;
 
 	std::vector<FilePath> getAllHeaderPaths() const;
 	std::vector<FilePath> getHeaderPaths() const;
@@ -19,12 +51,18 @@ public:
 	std::vector<FilePath> getFrameworkHeaderPaths() const;
 
 private:
-	void init();
+	void init(std::istream& stream);
+	void initHeaderPaths() const;
 
 	FilePath m_filePath;
-	std::vector<FilePath> m_headers;
-	std::vector<FilePath> m_systemHeaders;
-	std::vector<FilePath> m_frameworkHeaders;
+	std::string m_error;
+	std::vector<Command> m_commands;
+	size_t m_argumentListCount = 0;
+
+	mutable bool m_headerPathsInitialized = false;
+	mutable std::vector<FilePath> m_headers;
+	mutable std::vector<FilePath> m_systemHeaders;
+	mutable std::vector<FilePath> m_frameworkHeaders;
 };
 
 }	 // namespace utility
@@ -1,15 +1,18 @@
 #include "IncludeProcessing.h"
 
+#include <cstring>
+#include <fstream>
 #include <iterator>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 
-#include "ApplicationSettings.h"
 #include "FilePath.h"
 #include "FileTree.h"
 #include "IncludeDirective.h"
 #include "TextAccess.h"
-#include "TextCodec.h"
+#include "ThreadPool.h"
 #include "utility.h"
 #include "utilityString.h"
 
@@ -22,6 +25,174 @@ struct IncludeDirectiveComparator
 		return a.getIncludedFile() < b.getIncludedFile();
 	}
 };
+
+// same characters as the std::isspace used for trimming lines before
+bool isWhitespace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// Checks a single line for an include directive without decoding it. Only the included path is
+// decoded, the directive itself is plain ASCII.
+void scanIncludeLine(
+	const char* begin,
+	const char* end,
+	const FilePath& filePath,
+	unsigned int lineNumber,
+	std::vector<IncludeDirective>& includeDirectives)
+{
+	const char* it = begin;
+	while (it != end && isWhitespace(*it))
+	{
+		it++;
+	}
+	if (it == end || *it != '#')
+	{
+		return;
+	}
+
+	it++;
+	while (it != end && isWhitespace(*it))
+	{
+		it++;
+	}
+
+	static const size_t keywordLength = std::strlen("include");
+	if (size_t(end - it) < keywordLength || std::memcmp(it, "include", keywordLength) != 0)
+	{
+		return;
+	}
+	it += keywordLength;
+
+	auto findBetween = [it, end](char open, char close) {
+		const char* first = std::find(it, end, open);
+		if (first != end)
+		{
+			const char* last = std::find(first + 1, end, close);
+			if (last != end)
+			{
+				return std::string(first + 1, last);
+			}
+		}
+		return std::string();
+	};
+
+	std::string includeString = findBetween('<', '>');
+	bool usesBrackets = true;
+	if (includeString.empty())
+	{
+		includeString = findBetween('"', '"');
+		usesBrackets = false;
+	}
+
+	if (!includeString.empty())
+	{
+		includeDirectives.push_back(IncludeDirective(
+			FilePath(utility::decodeFromUtf8(includeString)), filePath, lineNumber, usesBrackets));
+	}
+}
+
+// Visits all files reachable through include directives. The files found at the same depth are
+// scanned in parallel, every file is scanned at most once over the lifetime of the crawler.
+class IncludeCrawler
+{
+public:
+	// 'resolve' returns the canonical path of the included file or an empty path, 'shouldCrawl'
+	// decides whether the directives of a resolved file are processed as well
+	IncludeCrawler(
+		std::function<FilePath(const IncludeDirective&)> resolve,
+		std::function<bool(const FilePath&)> shouldCrawl)
+		: m_resolve(resolve), m_shouldCrawl(shouldCrawl)
+	{
+	}
+
+	// returns all directives that could not be resolved
+	std::vector<IncludeDirective> crawl(const std::vector<FilePath>& filePaths)
+	{
+		std::vector<FilePath> filePathsToProcess;
+		for (const FilePath& filePath: filePaths)
+		{
+			FilePath canonicalPath = filePath.getAbsolute().makeCanonical();
+			if (markVisited(canonicalPath))
+			{
+				filePathsToProcess.push_back(canonicalPath);
+			}
+		}
+
+		std::vector<IncludeDirective> unresolvedIncludeDirectives;
+		while (!filePathsToProcess.empty())
+		{
+			std::vector<std::vector<FilePath>> foundFilePaths(filePathsToProcess.size());
+			std::vector<std::vector<IncludeDirective>> unresolvedPerFile(filePathsToProcess.size());
+
+			ThreadPool::getInstance()->parallelFor(filePathsToProcess.size(), [&](size_t index) {
+				for (const IncludeDirective& includeDirective:
+					 IncludeProcessing::getIncludeDirectives(filePathsToProcess[index]))
+				{
+					const FilePath resolvedPath = resolve(includeDirective);
+					if (resolvedPath.empty())
+					{
+						unresolvedPerFile[index].push_back(includeDirective);
+					}
+					else if (m_shouldCrawl(resolvedPath) && markVisited(resolvedPath))
+					{
+						foundFilePaths[index].push_back(resolvedPath);
+					}
+				}
+			});
+
+			filePathsToProcess.clear();
+			for (size_t i = 0; i < foundFilePaths.size(); i++)
+			{
+				utility::append(filePathsToProcess, foundFilePaths[i]);
+				for (const IncludeDirective& includeDirective: unresolvedPerFile[i])
+				{
+					unresolvedIncludeDirectives.push_back(includeDirective);
+				}
+			}
+		}
+
+		return unresolvedIncludeDirectives;
+	}
+
+private:
+	// returns false if the file was visited before
+	bool markVisited(const FilePath& filePath)
+	{
+		std::lock_guard<std::mutex> lock(m_visitedMutex);
+		return m_visitedFilePaths.insert(filePath.wstr()).second;
+	}
+
+	// the result only depends on the directory of the including file and the spelling of the include
+	FilePath resolve(const IncludeDirective& includeDirective)
+	{
+		const std::wstring key = includeDirective.getIncludingFile().getParentDirectory().wstr() +
+			L'\n' + includeDirective.getIncludedFile().wstr();
+		{
+			std::lock_guard<std::mutex> lock(m_resolvedMutex);
+			auto it = m_resolvedPaths.find(key);
+			if (it != m_resolvedPaths.end())
+			{
+				return it->second;
+			}
+		}
+
+		const FilePath resolvedPath = m_resolve(includeDirective);
+
+		std::lock_guard<std::mutex> lock(m_resolvedMutex);
+		m_resolvedPaths.emplace(key, resolvedPath);
+		return resolvedPath;
+	}
+
+	std::function<FilePath(const IncludeDirective&)> m_resolve;
+	std::function<bool(const FilePath&)> m_shouldCrawl;
+
+	std::unordered_set<std::wstring> m_visitedFilePaths;
+	std::mutex m_visitedMutex;
+
+	std::unordered_map<std::wstring, FilePath> m_resolvedPaths;
+	std::mutex m_resolvedMutex;
+};
 }	 // namespace
 
 std::vector<IncludeDirective> IncludeProcessing::getUnresolvedIncludeDirectives(
@@ -31,7 +202,28 @@ std::vector<IncludeDirective> IncludeProcessing::getUnresolvedIncludeDirectives(
 	const size_t desiredQuantileCount,
 	std::function<void(float)> progress)
 {
-	std::unordered_set<std::wstring> processedFilePaths;
+	// contains() caches whether the indexed path is a directory, fill that cache before the crawler
+	// calls it from several threads
+	for (const FilePath& indexedPath: indexedPaths)
+	{
+		indexedPath.isDirectory();
+	}
+
+	IncludeCrawler crawler(
+		[&headerSearchDirectories](const IncludeDirective& includeDirective) {
+			return resolveIncludeDirective(includeDirective, headerSearchDirectories).makeCanonical();
+		},
+		[&indexedPaths](const FilePath& filePath) {
+			for (const FilePath& indexedPath: indexedPaths)
+			{
+				if (indexedPath.contains(filePath))
+				{
+					return true;
+				}
+			}
+			return false;
+		});
+
 	std::set<IncludeDirective, IncludeDirectiveComparator> unresolvedIncludeDirectives;
 
 	std::vector<std::vector<FilePath>> parts = utility::splitToEquallySizedParts(
@@ -41,8 +233,7 @@ std::vector<IncludeDirective> IncludeProcessing::getUnresolvedIncludeDirectives(
 	{
 		progress(float(i) / parts.size());
 
-		const std::vector<IncludeDirective> directives = doGetUnresolvedIncludeDirectives(
-			utility::toSet(parts[i]), processedFilePaths, indexedPaths, headerSearchDirectories);
+		const std::vector<IncludeDirective> directives = crawler.crawl(parts[i]);
 		std::copy(
 			directives.begin(),
 			directives.end(),
@@ -77,68 +268,49 @@ std::set<FilePath> IncludeProcessing::getHeaderSearchDirectories(
 	}
 
 	std::set<FilePath> headerSearchDirectories;
-	std::unordered_set<std::wstring> processedFilePaths;
-	std::vector<std::vector<FilePath>> parts = utility::splitToEquallySizedParts(
-		utility::toVector(sourceFilePaths), desiredQuantileCount);
+	std::mutex headerSearchDirectoriesMutex;
 
-	for (size_t i = 0; i < parts.size(); i++)
-	{
-		progress(float(i) / parts.size());
-
-		std::set<FilePath> unprocessedFilePaths(parts[i].begin(), parts[i].end());
-
-		while (!unprocessedFilePaths.empty())
-		{
-			std::transform(
-				unprocessedFilePaths.begin(),
-				unprocessedFilePaths.end(),
-				std::inserter(processedFilePaths, processedFilePaths.begin()),
-				[](const FilePath& p) { return p.getAbsolute().wstr(); });
-
-			std::set<FilePath> unprocessedFilePathsForNextIteration;
+	IncludeCrawler crawler(
+		[&](const IncludeDirective& includeDirective) {
+			const FilePath includedFilePath = includeDirective.getIncludedFile();
 
-			for (const FilePath& unprocessedFilePath: unprocessedFilePaths)
+			FilePath foundIncludedPath = resolveIncludeDirective(
+				includeDirective, currentHeaderSearchDirectories);
+			if (foundIncludedPath.empty())
 			{
-				for (const IncludeDirective& includeDirective:
-					 getIncludeDirectives(unprocessedFilePath))
+				for (std::shared_ptr<FileTree> existingFileTree: existingFileTrees)
 				{
-					const FilePath includedFilePath = includeDirective.getIncludedFile();
-
-					FilePath foundIncludedPath = resolveIncludeDirective(
-						includeDirective, currentHeaderSearchDirectories);
-					if (foundIncludedPath.empty())
+					// TODO: handle the case where a file can be found by two different paths
+					const FilePath rootPath = existingFileTree->getAbsoluteRootPathForRelativeFilePath(
+						includedFilePath);
+					if (!rootPath.empty())
 					{
-						for (std::shared_ptr<FileTree> existingFileTree: existingFileTrees)
+						foundIncludedPath = rootPath.getConcatenated(includedFilePath);
+						if (foundIncludedPath.exists())
 						{
-							// TODO: handle the case where a file can be found by two different paths
-							const FilePath rootPath =
-								existingFileTree->getAbsoluteRootPathForRelativeFilePath(
-									includedFilePath);
-							if (!rootPath.empty())
-							{
-								foundIncludedPath = rootPath.getConcatenated(includedFilePath);
-								if (foundIncludedPath.exists())
-								{
-									headerSearchDirectories.insert(rootPath);
-									break;
-								}
-							}
-						}
-					}
-					if (foundIncludedPath.exists())
-					{
-						foundIncludedPath.makeCanonical();
-						if (processedFilePaths.find(foundIncludedPath.wstr()) ==
-							processedFilePaths.end())
-						{
-							unprocessedFilePathsForNextIteration.insert(foundIncludedPath);
+							std::lock_guard<std::mutex> lock(headerSearchDirectoriesMutex);
+							headerSearchDirectories.insert(rootPath);
+							break;
 						}
 					}
 				}
 			}
+			if (foundIncludedPath.exists())
+			{
+				return foundIncludedPath.makeCanonical();
+			}
+			return FilePath();
+		},
+		[](const FilePath&  /*filePath*/) { return true; });
 
-			unprocessedFilePaths = unprocessedFilePathsForNextIteration;
-		}
+	std::vector<std::vector<FilePath>> parts = utility::splitToEquallySizedParts(
+		utility::toVector(sourceFilePaths), desiredQuantileCount);
+
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		progress(float(i) / parts.size());
+
+		crawler.crawl(parts[i]);
 	}
 
 	progress(1.0f);
@@ -148,98 +320,60 @@ std::set<FilePath> IncludeProcessing::getHeaderSearchDirectories(
 
 std::vector<IncludeDirective> IncludeProcessing::getIncludeDirectives(const FilePath& filePath)
 {
-	if (filePath.exists())
+	std::vector<IncludeDirective> includeDirectives;
+
+	std::ifstream file(filePath.str(), std::ios::binary | std::ios::ate);
+	if (!file)
 	{
-		return getIncludeDirectives(TextAccess::createFromFile(filePath));
+		return includeDirectives;
 	}
-	return std::vector<IncludeDirective>();
-}
 
-std::vector<IncludeDirective> IncludeProcessing::getIncludeDirectives(
-	std::shared_ptr<TextAccess> textAccess)
-{
-	std::vector<IncludeDirective> includeDirectives;
+	std::string text(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0);
+	file.read(text.data(), static_cast<std::streamsize>(text.size()));
+	text.resize(static_cast<size_t>(file.gcount()));
 
-	TextCodec codec(ApplicationSettings::getInstance()->getTextEncoding());
-	const std::vector<std::string> lines = textAccess->getAllLines();
-	for (unsigned i = 0; i < lines.size(); i++)
+	// lines end with '\n', '\r\n' or '\r' like in TextAccess, line numbers are 1 based
+	const char* lineBegin = text.data();
+	const char* const textEnd = text.data() + text.size();
+	for (unsigned int lineNumber = 1; lineBegin <= textEnd; lineNumber++)
 	{
-		const std::wstring line = codec.decode(lines[i]);
-		const std::wstring lineTrimmedToHash = utility::trim(line);
-		if (utility::isPrefix<std::wstring>(L"#", lineTrimmedToHash))
+		const char* lineEnd = lineBegin;
+		while (lineEnd != textEnd && *lineEnd != '\n' && *lineEnd != '\r')
 		{
-			const std::wstring lineTrimmedToInclude = utility::trim(lineTrimmedToHash.substr(1));
-			if (utility::isPrefix<std::wstring>(L"include", lineTrimmedToInclude))
-			{
-				std::wstring includeString = utility::substrBetween<std::wstring>(
-					lineTrimmedToInclude, L"<", L">");
-				bool usesBrackets = true;
-				if (includeString.empty())
-				{
-					includeString = utility::substrBetween<std::wstring>(
-						lineTrimmedToInclude, L"\"", L"\"");
-					usesBrackets = false;
-				}
+			lineEnd++;
+		}
 
-				if (!includeString.empty())
-				{
-					// lines are 1 based
-					includeDirectives.push_back(IncludeDirective(
-						FilePath(includeString), textAccess->getFilePath(), i + 1, usesBrackets));
-				}
-			}
+		scanIncludeLine(lineBegin, lineEnd, filePath, lineNumber, includeDirectives);
+
+		if (lineEnd == textEnd)
+		{
+			break;
 		}
+		lineBegin = lineEnd + (*lineEnd == '\r' && lineEnd + 1 != textEnd && lineEnd[1] == '\n' ? 2 : 1);
 	}
 
 	return includeDirectives;
 }
 
-std::vector<IncludeDirective> IncludeProcessing::doGetUnresolvedIncludeDirectives(
-	std::set<FilePath> filePathsToProcess,
-	std::unordered_set<std::wstring>& processedFilePaths,
-	const std::set<FilePath>& indexedPaths,
-	const std::set<FilePath>& headerSearchDirectories)
+std::vector<IncludeDirective> IncludeProcessing::getIncludeDirectives(
+	std::shared_ptr<TextAccess> textAccess)
 {
-	std::vector<IncludeDirective> unresolvedIncludeDirectives;
+	std::vector<IncludeDirective> includeDirectives;
 
-	while (!filePathsToProcess.empty())
+	const std::vector<std::string> lines = textAccess->getAllLines();
+	for (unsigned i = 0; i < lines.size(); i++)
 	{
-		std::transform(
-			filePathsToProcess.begin(),
-			filePathsToProcess.end(),
-			std::inserter(processedFilePaths, processedFilePaths.begin()),
-			[](const FilePath& p) { return p.getAbsolute().makeCanonical().wstr(); });
-
-		std::set<FilePath> filePathsToProcessForNextIteration;
-
-		for (const FilePath& filePath: filePathsToProcess)
-		{
-			for (const IncludeDirective& includeDirective: getIncludeDirectives(filePath))
-			{
-				const FilePath resolvedIncludePath =
-					resolveIncludeDirective(includeDirective, headerSearchDirectories).makeCanonical();
-				if (resolvedIncludePath.empty())
-				{
-					unresolvedIncludeDirectives.push_back(includeDirective);
-				}
-				else if (processedFilePaths.find(resolvedIncludePath.wstr()) == processedFilePaths.end())
-				{
-					for (const FilePath& indexedPath: indexedPaths)
-					{
-						if (indexedPath.contains(resolvedIncludePath))
-						{
-							filePathsToProcessForNextIteration.insert(resolvedIncludePath);
-							break;
-						}
-					}
-				}
-			}
-		}
-		filePathsToProcess.clear();
-		filePathsToProcess.swap(filePathsToProcessForNextIteration);
+		// lines are 1 based
+		scanIncludeLine(
+			lines[i].data(),
+			lines[i].data() + lines[i].size(),
+			textAccess->getFilePath(),
+			i + 1,
+			includeDirectives);
 	}
 
-	return unresolvedIncludeDirectives;
+	return includeDirectives;
 }
 
 FilePath IncludeProcessing::resolveIncludeDirective(
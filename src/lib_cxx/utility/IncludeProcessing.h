@@ -1,14 +1,12 @@
 #ifndef INCLUDE_PROCESSING_H
 #define INCLUDE_PROCESSING_H
 
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
-#include "OrderedCache.h"
-
 class FilePath;
 class IncludeDirective;
 class TextAccess;
@@ -35,12 +33,6 @@ public:
 	static std::vector<IncludeDirective> getIncludeDirectives(std::shared_ptr<TextAccess> textAccess);
 
 private:
-	static std::vector<IncludeDirective> doGetUnresolvedIncludeDirectives(
-		std::set<FilePath> filePathsToProcess,
-		std::unordered_set<std::wstring>& processedFilePaths,
-		const std::set<FilePath>& indexedPaths,
-		const std::set<FilePath>& headerSearchDirectories);
-
 	static FilePath resolveIncludeDirective(
 		const IncludeDirective& includeDirective, const std::set<FilePath>& headerSearchDirectories);
 
@@ -1,15 +1,41 @@
 #include "QtCodeFile.h"
 
+#include <QFontMetrics>
 #include <QStyle>
 #include <QVBoxLayout>
 
+#include "ApplicationSettings.h"
 #include "MessageChangeFileView.h"
 
 #include "QtCodeFileTitleBar.h"
 #include "QtCodeNavigator.h"
 #include "QtCodeSnippet.h"
+#include "SourceLocation.h"
 #include "SourceLocationFile.h"
 
+namespace
+{
+int getEstimatedSnippetHeight(const CodeSnippetParams& params)
+{
+	ApplicationSettings* appSettings = ApplicationSettings::getInstance().get();
+	QFont font(appSettings->getFontName().c_str());
+	font.setPixelSize(appSettings->getFontSize());
+	const int lineHeight = QFontMetrics(font).lineSpacing();
+
+	// the code area adds 5 pixels below its lines, scope lines are about as high as a code line
+	int lineCount = static_cast<int>(params.endLineNumber - params.startLineNumber + 1);
+	if (!params.title.empty() && !params.isOverview)
+	{
+		lineCount++;
+	}
+	if (!params.footer.empty())
+	{
+		lineCount++;
+	}
+	return lineCount * lineHeight + 5;
+}
+}	 // namespace
+
 QtCodeFile::QtCodeFile(const FilePath& filePath, QtCodeNavigator* navigator, bool isFirst)
 	:  m_navigator(navigator), m_filePath(filePath) 
 {
@@ -43,6 +69,10 @@ QtCodeFile::QtCodeFile(const FilePath& filePath, QtCodeNavigator* navigator, boo
 	m_snippetLayout->setSpacing(0);
 	layout->addLayout(m_snippetLayout);
 
+	m_placeholder = new QWidget(this);
+	m_placeholder->hide();
+	layout->addWidget(m_placeholder);
+
 	setMinimized();
 	update();
 }
@@ -64,29 +94,39 @@ const QtCodeFileTitleBar* QtCodeFile::getTitleBar() const
 	return m_titleBar;
 }
 
-QtCodeSnippet* QtCodeFile::addCodeSnippet(const CodeSnippetParams& params)
+void QtCodeFile::addCodeSnippet(const CodeSnippetParams& params)
 {
-	QtCodeSnippet* snippet = new QtCodeSnippet(params, m_navigator, this);
-
 	if (params.isOverview)
 	{
 		m_titleBar->getTitleButton()->setProject(params.title);
 	}
 
-	if (params.locationFile->isWhole() || m_isWholeFile)
+	if (params.locationFile->isWhole())
 	{
 		m_isWholeFile = true;
-		snippet->setIsActiveFile(true);
 	}
 
-	m_snippetLayout->addWidget(snippet);
-	m_snippets.push_back(snippet);
-
-	return snippet;
+	m_pendingSnippetParams.push_back(params);
+	m_placeholder->setFixedHeight(m_placeholder->minimumHeight() + getEstimatedSnippetHeight(params));
 }
 
 void QtCodeFile::updateSourceLocations(const CodeSnippetParams& params)
 {
+	if (m_isWholeFile && m_pendingSnippetParams.size() == 1)
+	{
+		m_pendingSnippetParams[0].locationFile = params.locationFile;
+		return;
+	}
+
+	for (CodeSnippetParams& pendingParams: m_pendingSnippetParams)
+	{
+		if (pendingParams.startLineNumber == params.startLineNumber &&
+			pendingParams.endLineNumber == params.endLineNumber)
+		{
+			pendingParams.locationFile = params.locationFile;
+		}
+	}
+
 	if (m_isWholeFile && m_snippets.size() == 1)
 	{
 		m_snippets[0]->updateSourceLocations(params);
@@ -103,6 +143,53 @@ void QtCodeFile::updateSourceLocations(const CodeSnippetParams& params)
 	}
 }
 
+bool QtCodeFile::hasPendingSnippets() const
+{
+	return !m_pendingSnippetParams.empty();
+}
+
+void QtCodeFile::createPendingSnippets()
+{
+	if (m_pendingSnippetParams.empty())
+	{
+		return;
+	}
+
+	const bool visible = !m_placeholder->isHidden();
+
+	for (const CodeSnippetParams& params: m_pendingSnippetParams)
+	{
+		QtCodeSnippet* snippet = createSnippet(params);
+		snippet->setVisible(visible);
+	}
+	m_pendingSnippetParams.clear();
+	clearPlaceholder();
+
+	updateSnippets();
+
+	for (QtCodeSnippet* snippet: m_snippets)
+	{
+		snippet->updateContent();
+	}
+}
+
+std::vector<std::pair<size_t, size_t>> QtCodeFile::getSnippetLineNumbers() const
+{
+	std::vector<std::pair<size_t, size_t>> lineNumbers;
+
+	for (QtCodeSnippet* snippet: m_snippets)
+	{
+		lineNumbers.emplace_back(snippet->getStartLineNumber(), snippet->getEndLineNumber());
+	}
+
+	for (const CodeSnippetParams& params: m_pendingSnippetParams)
+	{
+		lineNumbers.emplace_back(params.startLineNumber, params.endLineNumber);
+	}
+
+	return lineNumbers;
+}
+
 const std::vector<QtCodeSnippet*>& QtCodeFile::getSnippets() const
 {
 	return m_snippets;
@@ -123,8 +210,10 @@ std::vector<QtCodeSnippet*> QtCodeFile::getVisibleSnippets() const
 	return snippets;
 }
 
-QtCodeSnippet* QtCodeFile::getSnippetForLocationId(Id locationId) const
+QtCodeSnippet* QtCodeFile::getSnippetForLocationId(Id locationId)
 {
+	createPendingSnippets();
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		if (snippet->getLineNumberForLocationId(locationId))
@@ -136,8 +225,10 @@ QtCodeSnippet* QtCodeFile::getSnippetForLocationId(Id locationId) const
 	return nullptr;
 }
 
-QtCodeSnippet* QtCodeFile::getSnippetForLine(unsigned int line) const
+QtCodeSnippet* QtCodeFile::getSnippetForLine(unsigned int line)
 {
+	createPendingSnippets();
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		if (snippet->getStartLineNumber() <= line && line <= snippet->getEndLineNumber())
@@ -149,10 +240,17 @@ QtCodeSnippet* QtCodeFile::getSnippetForLine(unsigned int line) const
 	return nullptr;
 }
 
-std::pair<QtCodeSnippet*, Id> QtCodeFile::getFirstSnippetWithActiveLocationId(Id tokenId) const
+std::pair<QtCodeSnippet*, Id> QtCodeFile::getFirstSnippetWithActiveLocationId(Id tokenId)
 {
 	std::pair<QtCodeSnippet*, Id> result(nullptr, 0);
 
+	// whether locations are active is only known to the code areas, but creating them is expensive,
+	// so pending snippets only get created if they show an active location
+	if (hasActiveLocationInPendingSnippets(tokenId))
+	{
+		createPendingSnippets();
+	}
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		Id locationId = snippet->getFirstActiveLocationId(tokenId);
@@ -237,6 +335,7 @@ void QtCodeFile::setMinimized()
 	{
 		snippet->hide();
 	}
+	m_placeholder->hide();
 
 	m_titleBar->setMinimized();
 }
@@ -247,13 +346,14 @@ void QtCodeFile::setSnippets()
 	{
 		snippet->show();
 	}
+	m_placeholder->setVisible(hasPendingSnippets());
 
 	m_titleBar->setSnippets();
 }
 
 bool QtCodeFile::hasSnippets() const
 {
-	return m_snippets.size() > 0;
+	return m_snippets.size() > 0 || hasPendingSnippets();
 }
 
 void QtCodeFile::clearSnippets()
@@ -271,6 +371,9 @@ void QtCodeFile::clearSnippets()
 	}
 
 	m_snippets.clear();
+
+	m_pendingSnippetParams.clear();
+	clearPlaceholder();
 }
 
 void QtCodeFile::updateSnippets()
@@ -302,6 +405,11 @@ void QtCodeFile::updateTitleBar()
 void QtCodeFile::findScreenMatches(
 	const std::wstring& query, std::vector<std::pair<QtCodeArea*, Id>>* screenMatches)
 {
+	if (!m_placeholder->isHidden())
+	{
+		createPendingSnippets();
+	}
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		if (snippet->isVisible())
@@ -331,6 +439,15 @@ bool QtCodeFile::hasFocus(const CodeFocusHandler::Focus& focus) const
 
 bool QtCodeFile::setFocus(Id locationId)
 {
+	for (const CodeSnippetParams& params: m_pendingSnippetParams)
+	{
+		if (params.locationFile->getSourceLocationById(locationId))
+		{
+			createPendingSnippets();
+			break;
+		}
+	}
+
 	for (QtCodeSnippet* snippet: m_snippets)
 	{
 		if (snippet->setFocus(locationId))
@@ -345,8 +462,9 @@ bool QtCodeFile::setFocus(Id locationId)
 bool QtCodeFile::moveFocus(const CodeFocusHandler::Focus& focus, CodeFocusHandler::Direction direction)
 {
 	if (direction == CodeFocusHandler::Direction::DOWN && focus.file == this && !isCollapsed() &&
-		m_snippets.size())
+		hasSnippets())
 	{
+		createPendingSnippets();
 		m_snippets[0]->focusTop();
 		return true;
 	}
@@ -394,8 +512,9 @@ void QtCodeFile::focusTop()
 
 void QtCodeFile::focusBottom()
 {
-	if (!isCollapsed() && m_snippets.size())
+	if (!isCollapsed() && hasSnippets())
 	{
+		createPendingSnippets();
 		m_snippets.back()->focusBottom();
 	}
 	else
@@ -471,6 +590,84 @@ void QtCodeFile::clickedMaximizeButton()
 	msg.dispatch();
 }
 
+QtCodeSnippet* QtCodeFile::createSnippet(const CodeSnippetParams& params)
+{
+	QtCodeSnippet* snippet = new QtCodeSnippet(params, m_navigator, this);
+
+	if (m_isWholeFile)
+	{
+		snippet->setIsActiveFile(true);
+	}
+
+	m_snippetLayout->addWidget(snippet);
+	m_snippets.push_back(snippet);
+
+	return snippet;
+}
+
+void QtCodeFile::clearPlaceholder()
+{
+	m_placeholder->hide();
+	m_placeholder->setFixedHeight(0);
+}
+
+bool QtCodeFile::hasActiveLocationInPendingSnippets(Id tokenId) const
+{
+	if (m_pendingSnippetParams.empty())
+	{
+		return false;
+	}
+
+	// same as the annotations of QtCodeArea
+	const std::set<Id>& activeTokenIds = m_navigator->getCurrentActiveTokenIds();
+	const std::set<Id>& activeLocationIds = m_navigator->getCurrentActiveLocationIds();
+	const std::set<Id>& activeLocalLocationIds = m_navigator->getCurrentActiveLocalLocationIds();
+
+	for (const CodeSnippetParams& params: m_pendingSnippetParams)
+	{
+		if (!params.locationFile)
+		{
+			continue;
+		}
+
+		bool hasActiveLocation = false;
+		params.locationFile->forEachSourceLocation([&](const SourceLocation* location) {
+			if (hasActiveLocation ||
+				(location->getType() != LOCATION_TOKEN && location->getType() != LOCATION_SCOPE))
+			{
+				return;
+			}
+
+			const SourceLocation* startLocation = location->getStartLocation();
+			const SourceLocation* endLocation = location->getEndLocation();
+			if ((startLocation && startLocation->getLineNumber() > params.endLineNumber) ||
+				(endLocation && endLocation->getLineNumber() < params.startLineNumber))
+			{
+				return;
+			}
+
+			const Id locationId = location->getLocationId();
+			bool hasToken = tokenId == 0;
+			bool isActive = activeLocationIds.find(locationId) != activeLocationIds.end() ||
+				activeLocalLocationIds.find(locationId) != activeLocalLocationIds.end();
+			for (const Id id: location->getTokenIds())
+			{
+				hasToken = hasToken || id == tokenId;
+				isActive = isActive || activeTokenIds.find(id) != activeTokenIds.end();
+			}
+
+			hasActiveLocation = hasToken && isActive;
+		});
+
+		if (hasActiveLocation)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void QtCodeFile::updateRefCount(int refCount)
 {
 	if (m_isWholeFile)
@@ -20,6 +20,8 @@ class QtCodeSnippet;
 class QVBoxLayout;
 class TimeStamp;
 
+// Snippets are only created once the file gets scrolled into view. Until then a placeholder with
+// the estimated height of the snippets takes their place.
 class QtCodeFile: public QFrame
 {
 	Q_OBJECT
@@ -34,15 +36,21 @@ public:
 
 	const QtCodeFileTitleBar* getTitleBar() const;
 
-	QtCodeSnippet* addCodeSnippet(const CodeSnippetParams& params);
+	void addCodeSnippet(const CodeSnippetParams& params);
 	void updateSourceLocations(const CodeSnippetParams& params);
 
+	bool hasPendingSnippets() const;
+	void createPendingSnippets();
+
+	// including the snippets that are not created yet
+	std::vector<std::pair<size_t, size_t>> getSnippetLineNumbers() const;
+
 	const std::vector<QtCodeSnippet*>& getSnippets() const;
 	std::vector<QtCodeSnippet*> getVisibleSnippets() const;
-	QtCodeSnippet* getSnippetForLocationId(Id locationId) const;
-	QtCodeSnippet* getSnippetForLine(unsigned int line) const;
+	QtCodeSnippet* getSnippetForLocationId(Id locationId);
+	QtCodeSnippet* getSnippetForLine(unsigned int line);
 
-	std::pair<QtCodeSnippet*, Id> getFirstSnippetWithActiveLocationId(Id tokenId) const;
+	std::pair<QtCodeSnippet*, Id> getFirstSnippetWithActiveLocationId(Id tokenId);
 
 	void requestWholeFileContent(size_t targetLineNumber);
 	void updateContent();
@@ -79,6 +87,12 @@ public slots:
 	void clickedMaximizeButton();
 
 private:
+	QtCodeSnippet* createSnippet(const CodeSnippetParams& params);
+	void clearPlaceholder();
+
+	// whether a pending snippet would show a location the code areas mark as active
+	bool hasActiveLocationInPendingSnippets(Id tokenId) const;
+
 	void updateRefCount(int refCount);
 
 	QtCodeNavigator* m_navigator;
@@ -88,6 +102,9 @@ private:
 	QVBoxLayout* m_snippetLayout;
 	std::vector<QtCodeSnippet*> m_snippets;
 
+	std::vector<CodeSnippetParams> m_pendingSnippetParams;
+	QWidget* m_placeholder;
+
 	const FilePath m_filePath;
 	bool m_isWholeFile = false;
 };
@@ -80,6 +80,11 @@ QtCodeFileList::QtCodeFileList(QtCodeNavigator* navigator)
 
 	m_scrollSpeedChangeListener.setScrollBar(m_scrollArea->verticalScrollBar());
 
+	connect(
+		m_scrollArea->verticalScrollBar(),
+		&QScrollBar::valueChanged,
+		this,
+		&QtCodeFileList::createVisibleSnippets);
 	connect(
 		m_scrollArea->verticalScrollBar(),
 		&QScrollBar::valueChanged,
@@ -152,17 +157,17 @@ void QtCodeFileList::addFile(const CodeFileParams& params)
 	else
 	{
 		bool same = true;
-		const std::vector<QtCodeSnippet*> snippets = file->getSnippets();
-		if (params.snippetParams.size() != snippets.size())
+		const std::vector<std::pair<size_t, size_t>> lineNumbers = file->getSnippetLineNumbers();
+		if (params.snippetParams.size() != lineNumbers.size())
 		{
 			same = false;
 		}
 		else
 		{
-			for (size_t i = 0; i < snippets.size(); i++)
+			for (size_t i = 0; i < lineNumbers.size(); i++)
 			{
-				if (params.snippetParams[i].startLineNumber != snippets[i]->getStartLineNumber() ||
-					params.snippetParams[i].endLineNumber != snippets[i]->getEndLineNumber())
+				if (params.snippetParams[i].startLineNumber != lineNumbers[i].first ||
+					params.snippetParams[i].endLineNumber != lineNumbers[i].second)
 				{
 					same = false;
 					break;
@@ -221,6 +226,8 @@ void QtCodeFileList::updateFiles()
 		file->show();
 	}
 
+	createVisibleSnippets();
+
 	// Perform delayed so all widgets are already visible
 	QTimer::singleShot(100, this, &QtCodeFileList::updateSnippetTitleAndScrollBarSlot);
 }
@@ -240,6 +247,16 @@ void QtCodeFileList::scrollTo(
 		return;
 	}
 
+	if (file->hasPendingSnippets())
+	{
+		// the lines of the created snippets are only known after they were laid out
+		file->createPendingSnippets();
+		QTimer::singleShot(0, this, [=, this]() {
+			scrollTo(filePath, lineNumber, locationId, scopeLocationId, animated, target, focusTarget);
+		});
+		return;
+	}
+
 	QtCodeSnippet* snippet = nullptr;
 
 	Id targetLocationId = scopeLocationId ? scopeLocationId : locationId;
@@ -390,7 +407,7 @@ void QtCodeFileList::maximizeFirstFile()
 	}
 }
 
-std::pair<QtCodeFile*, Id> QtCodeFileList::getFirstFileWithActiveLocationId() const
+std::pair<QtCodeFile*, Id> QtCodeFileList::getFirstFileWithActiveLocationId()
 {
 	for (QtCodeFile* file: m_files)
 	{
@@ -404,12 +421,14 @@ std::pair<QtCodeFile*, Id> QtCodeFileList::getFirstFileWithActiveLocationId() co
 	return std::make_pair(nullptr, 0);
 }
 
-std::pair<QtCodeSnippet*, Id> QtCodeFileList::getFirstSnippetAndActiveLocationId() const
+std::pair<QtCodeSnippet*, Id> QtCodeFileList::getFirstSnippetAndActiveLocationId()
 {
 	std::pair<QtCodeSnippet*, Id> result(nullptr, 0);
 
 	if (m_files.size())
 	{
+		m_files[0]->createPendingSnippets();
+
 		std::vector<QtCodeSnippet*> snippets = m_files[0]->getVisibleSnippets();
 		if (snippets.size())
 		{
@@ -423,10 +442,31 @@ std::pair<QtCodeSnippet*, Id> QtCodeFileList::getFirstSnippetAndActiveLocationId
 
 void QtCodeFileList::resizeEvent(QResizeEvent*  /*event*/)
 {
+	createVisibleSnippets();
+
 	clearSnippetTitleAndScrollBar();
 	updateSnippetTitleAndScrollBar();
 }
 
+void QtCodeFileList::createVisibleSnippets()
+{
+	// lays out the files right away, otherwise files shown just now are all at the top
+	m_filesArea->layout()->activate();
+
+	const int margin = m_scrollArea->viewport()->height();
+	const QRect visibleRect = QRect(-m_filesArea->pos(), m_scrollArea->viewport()->size())
+								  .adjusted(0, -margin, 0, margin);
+
+	for (QtCodeFile* file: m_files)
+	{
+		if (file->hasPendingSnippets() && !file->isHidden() &&
+			visibleRect.intersects(file->geometry()))
+		{
+			file->createPendingSnippets();
+		}
+	}
+}
+
 void QtCodeFileList::updateSnippetTitleAndScrollBarSlot()
 {
 	updateSnippetTitleAndScrollBar(0);
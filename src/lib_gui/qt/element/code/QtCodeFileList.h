@@ -66,13 +66,16 @@ public:
 
 	void maximizeFirstFile();
 
-	std::pair<QtCodeFile*, Id> getFirstFileWithActiveLocationId() const;
-	std::pair<QtCodeSnippet*, Id> getFirstSnippetAndActiveLocationId() const;
+	std::pair<QtCodeFile*, Id> getFirstFileWithActiveLocationId();
+	std::pair<QtCodeSnippet*, Id> getFirstSnippetAndActiveLocationId();
 
 protected:
 	void resizeEvent(QResizeEvent* event) override;
 
 private slots:
+	// creates the snippets of files within one view height of the visible area
+	void createVisibleSnippets();
+
 	void updateSnippetTitleAndScrollBarSlot();
 	void updateSnippetTitleAndScrollBar(int value = 0);
 
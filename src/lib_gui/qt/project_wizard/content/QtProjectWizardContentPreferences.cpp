@@ -7,6 +7,7 @@
 #include <QLineEdit>
 #include <QTimer>
 
+#include "Application.h"
 #include "ApplicationSettings.h"
 #include "FileLogger.h"
 #include "FileSystem.h"
@@ -14,6 +15,7 @@
 #include "TextCodec.h"
 #include "ResourcePaths.h"
 #include "logging.h"
+#include "tracing.h"
 #include "utility.h"
 #include "utilityApp.h"
 #include "utilityPathDetection.h"
@@ -255,6 +257,16 @@ void QtProjectWizardContentPreferences::populate(QGridLayout* layout, int& row)
 		layout,
 		row);
 
+	m_tracingEnabled = addCheckBox(
+		QStringLiteral("Tracing"),
+		QStringLiteral("Enable performance tracing"),
+		QStringLiteral(
+			"<p>Record timings of indexing, storage queries and view updates. The trace is saved to "
+			"the log directory when Sourcetrail closes or tracing gets disabled and can be opened "
+			"with chrome://tracing or ui.perfetto.dev.</p>"),
+		layout,
+		row);
+
 	m_logPath = new QtLocationPicker(this);
 	m_logPath->setPickDirectory(true);
 	addLabelAndWidget(QStringLiteral("Log Directory Path"), m_logPath, layout, row);
@@ -499,6 +511,7 @@ void QtProjectWizardContentPreferences::load()
 	m_loggingEnabled->setChecked(appSettings->getLoggingEnabled());
 	m_verboseIndexerLoggingEnabled->setChecked(appSettings->getVerboseIndexerLoggingEnabled());
 	m_verboseIndexerLoggingEnabled->setEnabled(m_loggingEnabled->isChecked());
+	m_tracingEnabled->setChecked(appSettings->getTracingEnabled());
 	if (m_logPath)
 	{
 		m_logPath->setText(QString::fromStdWString(appSettings->getLogDirectoryPath().wstr()));
@@ -576,6 +589,16 @@ void QtProjectWizardContentPreferences::save()
 		}
 	}
 
+	if (appSettings->getTracingEnabled() != m_tracingEnabled->isChecked())
+	{
+		appSettings->setTracingEnabled(m_tracingEnabled->isChecked());
+		Tracer::getInstance()->setEnabled(m_tracingEnabled->isChecked());
+		if (!m_tracingEnabled->isChecked())
+		{
+			Application::saveTraces();
+		}
+	}
+
 	int sourcetrailPort = m_sourcetrailPort->text().toInt();
 	if (sourcetrailPort)
 		appSettings->setSourcetrailPort(sourcetrailPort);
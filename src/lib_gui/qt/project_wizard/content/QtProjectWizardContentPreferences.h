@@ -123,6 +123,7 @@ private:
 
 	QCheckBox* m_loggingEnabled;
 	QCheckBox* m_verboseIndexerLoggingEnabled;
+	QCheckBox* m_tracingEnabled;
 	QtLocationPicker* m_logPath;
 
 	QLineEdit* m_sourcetrailPort;
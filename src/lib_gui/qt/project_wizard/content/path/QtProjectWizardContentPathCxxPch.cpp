@@ -52,7 +52,7 @@ bool QtProjectWizardContentPathCxxPch::check()
 			std::dynamic_pointer_cast<SourceGroupSettingsCxxCdb>(m_settings))
 	{
 		const FilePath cdbPath = cdbSettings->getCompilationDatabasePathExpandedAndAbsolute();
-		std::shared_ptr<clang::tooling::JSONCompilationDatabase> cdb = utility::loadCDB(cdbPath);
+		std::shared_ptr<utility::CompilationDatabase> cdb = utility::loadCDB(cdbPath);
 		if (!cdb)
 		{
 			QtMessageBox msgBox(m_window);
@@ -1,5 +1,8 @@
 #include "QtHighlighter.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -27,11 +30,17 @@ const QtHighlighter::HighlightType QtHighlighter::HighlightType::QUOTATION("quot
 const QtHighlighter::HighlightType QtHighlighter::HighlightType::TEXT("text");
 const QtHighlighter::HighlightType QtHighlighter::HighlightType::TYPE("type");
 
-std::map<std::wstring, std::vector<QtHighlighter::HighlightingRule>> QtHighlighter::s_highlightingRules;
+std::map<std::wstring, std::shared_ptr<const QtHighlighter::HighlightingRules>> QtHighlighter::s_highlightingRules;
 std::map<QtHighlighter::HighlightType, QTextCharFormat> QtHighlighter::s_charFormats;
 
+std::map<QtHighlighter::TokenCacheKey, std::shared_ptr<QtHighlighter::TokenizedText>> QtHighlighter::s_tokenCache;
+std::deque<QtHighlighter::TokenCacheKey> QtHighlighter::s_tokenCacheOrder;
+int QtHighlighter::s_tokenCacheLineCount = 0;
+
 namespace
 {
+// texts with more lines in total get dropped from the token cache, oldest first
+const int TOKEN_CACHE_MAX_LINE_COUNT = 200000;
 
 string highlightTypeToString(QtHighlighter::HighlightType type)
 {
@@ -45,8 +54,34 @@ QtHighlighter::HighlightType highlightTypeFromString(const string &typeStr)
 	return (!foundEnums.empty()) ? foundEnums.front() : QtHighlighter::HighlightType::TEXT;
 }
 
+bool isWordCharacter(QChar c)
+{
+	return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+// returns the word of a pattern like \bword\b, or an empty string for any other pattern
+QString getWordOfPattern(const QString& pattern)
+{
+	if (pattern.size() < 5 || !pattern.startsWith(QStringLiteral("\\b")) ||
+		!pattern.endsWith(QStringLiteral("\\b")))
+	{
+		return QString();
+	}
+
+	QString word = pattern.mid(2, pattern.size() - 4);
+	for (QChar c: word)
+	{
+		if (!(c.isLetterOrNumber() && c.unicode() < 128) && c != QLatin1Char('_'))
+		{
+			return QString();
+		}
+	}
+	return word;
 }
 
+}	 // namespace
+
+
 void QtHighlighter::loadHighlightingRules()
 {
 	ColorScheme* scheme = ColorScheme::getInstance().get();
@@ -79,7 +114,7 @@ void QtHighlighter::loadHighlightingRules()
 			continue;
 		}
 
-		std::vector<HighlightingRule> rules;
+		std::shared_ptr<HighlightingRules> rules = std::make_shared<HighlightingRules>();
 
 		for (QJsonArray docArray = doc.array(); QJsonValueRef value: docArray)
 		{
@@ -90,27 +125,40 @@ void QtHighlighter::loadHighlightingRules()
 
 			QJsonObject ruleObj = value.toObject();
 
-			HighlightType type = highlightTypeFromString(
+			HighlightingRule rule;
+			rule.type = highlightTypeFromString(
 				ruleObj.value(QStringLiteral("type")).toString().toStdString());
-
-			bool priority = ruleObj.value(QStringLiteral("priority")).toBool();
+			rule.priority = ruleObj.value(QStringLiteral("priority")).toBool();
 
 			QJsonArray patterns = ruleObj.value(QStringLiteral("patterns")).toArray();
 			for (QJsonValueRef pattern: patterns)
 			{
-				if (pattern.isString())
+				if (!pattern.isString())
+				{
+					continue;
+				}
+
+				QString word = rule.priority ? QString() : getWordOfPattern(pattern.toString());
+				if (!word.isEmpty())
+				{
+					rules->words.insert(word, rules->rules.size());
+				}
+				else
 				{
-					rules.push_back(HighlightingRule(type, QRegularExpression(pattern.toString()), priority));
+					rule.patterns.push_back(QRegularExpression(pattern.toString()));
 				}
 			}
 
+			rules->rules.push_back(rule);
+
 			QJsonObject range = ruleObj.value(QStringLiteral("range")).toObject();
 			if (!range.empty())
 			{
-				rules.push_back(HighlightingRule(
-					type, QRegularExpression(range.value("start").toString()), priority, true));
-				rules.push_back(
-					HighlightingRule(type, QRegularExpression(range.value("end").toString()), priority, true));
+				RangeRule rangeRule;
+				rangeRule.type = rule.type;
+				rangeRule.start = QRegularExpression(range.value(QStringLiteral("start")).toString());
+				rangeRule.end = QRegularExpression(range.value(QStringLiteral("end")).toString());
+				rules->rangeRules.push_back(rangeRule);
 			}
 		}
 
@@ -121,10 +169,14 @@ void QtHighlighter::loadHighlightingRules()
 void QtHighlighter::clearHighlightingRules()
 {
 	s_highlightingRules.clear();
+
+	s_tokenCache.clear();
+	s_tokenCacheOrder.clear();
+	s_tokenCacheLineCount = 0;
 }
 
 QtHighlighter::QtHighlighter(QTextDocument* document, const std::wstring& language)
-	: m_document(document)
+	: m_document(document), m_language(language)
 {
 	if (!s_highlightingRules.size())
 	{
@@ -144,43 +196,22 @@ void QtHighlighter::highlightDocument()
 
 	QTextDocument* doc = document();
 
-	int docStart = 0;
-	int docEnd = 0;
-	for (int i = 0; i < doc->blockCount(); i++)
-	{
-		docEnd += doc->findBlockByLineNumber(i).length();
-	}
-
-	if (docEnd > 0)
-	{
-		docEnd -= 1;
-	}
-
-	applyFormat(docStart, docEnd, s_charFormats[HighlightType::TEXT]);
+	applyFormat(0, std::max(doc->characterCount() - 1, 0), s_charFormats[HighlightType::TEXT]);
 
 	m_highlightedLines.clear();
-	m_highlightedLines.resize(document()->blockCount(), false);
-
-	if (m_highlightingRules.empty())
-	{
-		return;
-	}
+	m_highlightedLines.resize(doc->blockCount(), false);
 
-	std::vector<HighlightingRule> singleLineRules;
-	for (const HighlightingRule& rule: m_highlightingRules)
+	m_tokenizedText.reset();
+	if (m_highlightingRules)
 	{
-		if (rule.priority && !rule.multiLine)
-		{
-			singleLineRules.emplace_back(rule);
-		}
+		m_tokenizedText = getTokenizedText(m_language, doc);
 	}
-	createRanges(doc, singleLineRules);
 }
 
 void QtHighlighter::highlightRange(int startLine, int endLine)
 {
 	if (startLine < 0 || endLine < 0 || startLine > endLine ||
-		endLine > int(m_highlightedLines.size()))
+		endLine >= int(m_highlightedLines.size()))
 	{
 		return;
 	}
@@ -200,55 +231,33 @@ void QtHighlighter::highlightRange(int startLine, int endLine)
 		return;
 	}
 
-	QTextDocument* doc = document();
-	QTextBlock start = doc->findBlockByLineNumber(startLine);
-	QTextBlock end = doc->findBlockByLineNumber(endLine + 1);
-
-	/*
-	const HighlightingRule* singleLineCommentRule = nullptr;
-	const HighlightingRule* quotationRule = nullptr;
-
-	for (const HighlightingRule& rule: m_highlightingRules)
+	if (m_tokenizedText)
 	{
-		if (rule.type == HighlightType::COMMENT && !rule.multiLine)
-		{
-			singleLineCommentRule = &rule;
-		}
-		else if (rule.type == HighlightType::QUOTATION)
-		{
-			quotationRule = &rule;
-		}
+		tokenizeLines(endLine);
 	}
-	*/
+
+	QTextDocument* doc = document();
+	QTextBlock start = doc->findBlockByNumber(startLine);
+	QTextBlock end = doc->findBlockByNumber(endLine + 1);
 
 	int index = startLine;
 	for (QTextBlock it = start; it != end; it = it.next())
 	{
 		if (!m_highlightedLines[index])
 		{
-			applyFormat(
-				it.position(), it.position() + it.length() - 1, s_charFormats[HighlightType::TEXT]);
+			const int pos = it.position();
+			applyFormat(pos, pos + it.length() - 1, s_charFormats[HighlightType::TEXT]);
 
-			for (const HighlightingRule& rule: m_highlightingRules)
+			if (m_tokenizedText && index < int(m_tokenizedText->lineTokens.size()))
 			{
-				if (rule.multiLine)
-				{
-					continue;
-				}
-
-				if (rule.priority)
+				for (const HighlightingToken& token: m_tokenizedText->lineTokens[index])
 				{
-					formatBlockIfInRange(it, rule.type, m_singleLineRanges);
+					auto formatIt = s_charFormats.find(token.type);
+					if (formatIt != s_charFormats.end())
+					{
+						applyFormat(pos + token.start, pos + token.end, formatIt->second);
+					}
 				}
-				else
-				{
-					formatBlockForRule(it, rule, m_singleLineRanges);
-				}
-			}
-
-			if (m_multiLineRanges.size())
-			{
-				formatBlockIfInRange(it, m_multiLineRanges);
 			}
 		}
 		index++;
@@ -286,298 +295,241 @@ QTextCharFormat QtHighlighter::getFormat(int  /*startPosition*/, int endPosition
 	return cursor.charFormat();
 }
 
-void QtHighlighter::createRanges(QTextDocument* doc, const std::vector<HighlightingRule>& singleLineRules)
+std::shared_ptr<QtHighlighter::TokenizedText> QtHighlighter::getTokenizedText(
+	const std::wstring& language, QTextDocument* doc)
 {
-	m_singleLineRanges.clear();
-	m_multiLineRanges.clear();
+	const QString text = doc->toPlainText();
+	const TokenCacheKey key(language, qHash(text), int(text.size()));
 
-	for (QTextBlock it = doc->begin(); it != doc->end(); it = it.next())
+	auto it = s_tokenCache.find(key);
+	if (it != s_tokenCache.end() && it->second->text == text)
 	{
-		for (const HighlightingRule& rule: singleLineRules)
-		{
-			utility::append(m_singleLineRanges, getRangesForRule(it, rule));
-		}
+		return it->second;
 	}
 
-	// remove ranges starting inside others
-	{
-		std::map<std::pair<int, int>, size_t> sortedRangesToIndex;
-		for (size_t i = 0; i < m_singleLineRanges.size(); i++)
-		{
-			const HighlightingRange& range = m_singleLineRanges[i];
-			sortedRangesToIndex.emplace(pair(range.start, range.end), i);
-		}
+	// a different text with the same hash replaces the cached one
+	std::shared_ptr<TokenizedText> tokenizedText = std::make_shared<TokenizedText>();
+	tokenizedText->text = text;
+	tokenizedText->lineCount = doc->blockCount();
 
-		std::set<size_t> indicesToErase;
-		const std::pair<int, int>* topRange = nullptr;
-		for (const auto& p: sortedRangesToIndex)
-		{
-			if (topRange && p.first.first <= topRange->second)
-			{
-				indicesToErase.insert(p.second);
-			}
-			else
-			{
-				topRange = &p.first;
-			}
-		}
+	if (it != s_tokenCache.end())
+	{
+		s_tokenCacheLineCount -= it->second->lineCount;
+		it->second = tokenizedText;
+	}
+	else
+	{
+		s_tokenCache.emplace(key, tokenizedText);
+		s_tokenCacheOrder.push_back(key);
+	}
+	s_tokenCacheLineCount += tokenizedText->lineCount;
 
-		for (auto it = indicesToErase.rbegin(); it != indicesToErase.rend(); it++)
-		{
-			m_singleLineRanges.erase(m_singleLineRanges.begin() + *it);
-		}
+	while (s_tokenCacheLineCount > TOKEN_CACHE_MAX_LINE_COUNT && s_tokenCacheOrder.size() > 1)
+	{
+		auto oldestIt = s_tokenCache.find(s_tokenCacheOrder.front());
+		s_tokenCacheLineCount -= oldestIt->second->lineCount;
+		s_tokenCache.erase(oldestIt);
+		s_tokenCacheOrder.pop_front();
 	}
 
-	m_multiLineRanges = createMultiLineRanges(doc, m_singleLineRanges);
+	return tokenizedText;
 }
 
-std::vector<QtHighlighter::HighlightingRange> QtHighlighter::createMultiLineRanges(
-	QTextDocument* doc, const std::vector<HighlightingRange> &ranges)
+void QtHighlighter::tokenizeLines(int lastLine)
 {
-	std::vector<HighlightingRange> multiLineRanges;
+	TokenizedText& tokenizedText = *m_tokenizedText;
 
-	const HighlightingRule* startRule = nullptr;
+	int line = int(tokenizedText.lineTokens.size());
+	for (QTextBlock block = document()->findBlockByNumber(line); block.isValid() && line <= lastLine;
+		 block = block.next())
+	{
+		tokenizedText.lineTokens.push_back(tokenizeLine(block.text(), tokenizedText.openRangeRule));
+		line++;
+	}
+}
 
-	for (const HighlightingRule& rule: m_highlightingRules)
+// Tokenizes one line in a single pass. The priority patterns and the starts of the range rules are
+// matched at the current position, the earliest match becomes a token and the search goes on behind
+// it. Matches of the other rules are dropped if they start inside such a token. A range that is not
+// closed by the end of the line is continued by the next line through 'openRangeRule'.
+std::vector<QtHighlighter::HighlightingToken> QtHighlighter::tokenizeLine(
+	const QString& text, int& openRangeRule) const
+{
+	const HighlightingRules& rules = *m_highlightingRules;
+
+	struct Candidate
+	{
+		const QRegularExpression* pattern = nullptr;
+		size_t ruleIndex = 0;
+		bool isRange = false;
+
+		// start of the whole match, the token may only cover its first capture group
+		int matchStart = -1;
+		int start = -1;
+		int end = -1;
+		bool exhausted = false;
+	};
+
+	std::vector<Candidate> candidates;
+	for (size_t i = 0; i < rules.rules.size(); i++)
 	{
-		if (rule.priority && rule.multiLine)
+		if (rules.rules[i].priority)
 		{
-			if (!startRule)
-			{
-				startRule = &rule;
-			}
-			else if (rule.type == startRule->type)
+			for (const QRegularExpression& pattern: rules.rules[i].patterns)
 			{
-				utility::append(
-					multiLineRanges, createMultiLineRangesForRules(doc, ranges, startRule, &rule));
-				startRule = nullptr;
+				candidates.push_back({&pattern, i, false});
 			}
 		}
 	}
+	for (size_t i = 0; i < rules.rangeRules.size(); i++)
+	{
+		candidates.push_back({&rules.rangeRules[i].start, i, true});
+	}
 
-	return multiLineRanges;
-}
-
-std::vector<QtHighlighter::HighlightingRange> QtHighlighter::createMultiLineRangesForRules(
-	QTextDocument* doc,
-	const std::vector<HighlightingRange> &ranges,
-	const HighlightingRule* startRule,
-	const HighlightingRule* endRule)
-{
-	std::vector<HighlightingRange> multiLineRanges;
-
-	QTextCursor cursorStart(doc);
-	QTextCursor cursorEnd(doc);
+	// tokens of the priority rules by rule index
+	std::vector<std::vector<HighlightingToken>> ruleTokens(rules.rules.size());
+	std::vector<HighlightingToken> rangeTokens;
+	// all tokens above sorted by position, they don't overlap
+	std::vector<HighlightingToken> exclusiveTokens;
 
-	while (true)
+	const int length = int(text.size());
+	int pos = 0;
+	int rangeStart = 0;
+	while (pos <= length)
 	{
-		while (true)
+		if (openRangeRule >= 0)
 		{
-			cursorStart = document()->find(startRule->pattern, cursorStart);
-			if (cursorStart.isNull())
+			const RangeRule& rangeRule = rules.rangeRules[openRangeRule];
+			const QRegularExpressionMatch match = rangeRule.end.match(text, pos);
+			const int end = match.hasMatch() ? int(match.capturedEnd()) : length;
+
+			if (rangeStart < end)
 			{
-				break;
+				rangeTokens.push_back({rangeRule.type, rangeStart, end});
+				exclusiveTokens.push_back(rangeTokens.back());
 			}
 
-			if (!isInRange(cursorStart.selectionEnd() - 1, ranges))
+			if (!match.hasMatch())
 			{
 				break;
 			}
-			else
-			{
-				cursorStart.setPosition(cursorStart.selectionEnd() + 1);
-			}
+
+			openRangeRule = -1;
+			pos = std::max(end, pos + 1);
+			continue;
 		}
 
-		if (cursorStart.isNull())
+		Candidate* next = nullptr;
+		for (Candidate& candidate: candidates)
 		{
-			break;
+			if (!candidate.exhausted && candidate.matchStart < pos)
+			{
+				const QRegularExpressionMatch match = candidate.pattern->match(text, pos);
+				if (!match.hasMatch())
+				{
+					candidate.exhausted = true;
+					continue;
+				}
+
+				const int group = (match.lastCapturedIndex() > 0 && match.capturedStart(1) >= 0) ? 1 : 0;
+				candidate.matchStart = int(match.capturedStart());
+				candidate.start = int(match.capturedStart(group));
+				candidate.end = int(match.capturedEnd(group));
+			}
+
+			if (!candidate.exhausted && candidate.start >= pos &&
+				(!next || candidate.start < next->start ||
+				 (candidate.start == next->start && candidate.end < next->end)))
+			{
+				next = &candidate;
+			}
 		}
 
-		cursorEnd = document()->find(endRule->pattern, cursorStart);
-		if (cursorEnd.isNull())
+		if (!next)
 		{
 			break;
 		}
 
-		multiLineRanges.emplace_back(
-			HighlightingRange(startRule->type, cursorStart.selectionStart(), cursorEnd.position()));
-
-		cursorStart = cursorEnd;
-	}
-
-	return multiLineRanges;
-}
-
-QtHighlighter::HighlightingRule::HighlightingRule(
-	HighlightType type, const QRegularExpression& regExp, bool priority, bool multiLine)
-	: type(type), pattern(regExp), priority(priority), multiLine(multiLine)
-{
-}
-
-bool QtHighlighter::isInRange(int pos, const std::vector<HighlightingRange> &ranges)
-{
-	for (const HighlightingRange& range: ranges)
-	{
-		if (pos >= range.start && pos <= range.end)
+		if (next->isRange)
 		{
-			return true;
+			openRangeRule = int(next->ruleIndex);
+			rangeStart = next->start;
+			pos = std::max(next->end, pos + 1);
 		}
-	}
-	return false;
-}
-
-/* Previous version with QRegExp:
-std::vector<std::tuple<QtHighlighter::HighlightType, int, int>> QtHighlighter::getRangesForRule(
-	const QTextBlock& block, const HighlightingRule& rule)
-{
-	const int pos = block.position();
-	const QString text = block.text();
-	QRegExp expression(rule.pattern);
-	int index = expression.indexIn(text);
-
-	std::vector<std::tuple<HighlightType, int, int>> ranges;
-
-	while (index >= 0)
-	{
-		const int length = expression.matchedLength();
-		if (expression.capturedTexts().size() > 1)
+		else if (next->start < next->end)
 		{
-			const QString cap = expression.capturedTexts().at(1);
-			const int start = text.indexOf(cap, index);
-			ranges.push_back(std::make_tuple(rule.type, pos + start, pos + start + cap.length()));
+			ruleTokens[next->ruleIndex].push_back(
+				{rules.rules[next->ruleIndex].type, next->start, next->end});
+			exclusiveTokens.push_back(ruleTokens[next->ruleIndex].back());
+			pos = next->end;
 		}
 		else
 		{
-			ranges.push_back(std::make_tuple(rule.type, pos + index, pos + index + length));
+			pos = next->start + 1;
 		}
-		index = expression.indexIn(block.text(), index + length);
-	}
-	return ranges;
-}
-*/
-
-std::vector<QtHighlighter::HighlightingRange> QtHighlighter::getRangesForRule(const QTextBlock& block,
-	const HighlightingRule& rule)
-{
-	const int pos = block.position();
-	const QString text = block.text();
-	std::vector<HighlightingRange> ranges;
-
-	for (const QRegularExpressionMatch &match : rule.pattern.globalMatch(text)) {
-		int index = match.capturedStart();
-		int length = match.capturedLength();
-
-		if (match.capturedTexts().size() > 1) {
-			const QString cap = match.capturedTexts().at(1);
-			const int start = text.indexOf(cap, index);
-			ranges.push_back(HighlightingRange(rule.type, pos + start, pos + start + cap.length()));
-		} else
-			ranges.push_back(HighlightingRange(rule.type, pos + index, pos + index + length));
 	}
-	return ranges;
-}
 
-/* Previous version with QRegExp:
-void QtHighlighter::formatBlockForRule(const QTextBlock& block, const HighlightingRule& rule,
-	std::vector<std::tuple<HighlightType, int, int>>* ranges)
-{
-	if (s_charFormats.find(rule.type) == s_charFormats.end())
+	for (size_t i = 0; i < rules.rules.size(); i++)
 	{
-		return;
-	}
-
-	const QTextCharFormat& format = s_charFormats.find(rule.type)->second;
-
-	QRegExp expression(rule.pattern);
-	int pos = block.position();
-	int index = expression.indexIn(block.text());
-
-	while (index >= 0)
-	{
-		int length = expression.matchedLength();
-
-		if (!isInRange(pos + index, *ranges))
+		const HighlightingRule& rule = rules.rules[i];
+		if (rule.priority)
 		{
-			applyFormat(pos + index, pos + index + length, format);
+			continue;
 		}
 
-		index = expression.indexIn(block.text(), index + length);
-	}
-}
-*/
-
-void QtHighlighter::formatBlockForRule( const QTextBlock& block, const HighlightingRule& rule,
-	const std::vector<HighlightingRange> &ranges)
-{
-	if (s_charFormats.find(rule.type) == s_charFormats.end())
-		return;
-
-	const QTextCharFormat& format = s_charFormats.find(rule.type)->second;
-
-	int pos = block.position();
-	for (const QRegularExpressionMatch &match : rule.pattern.globalMatch(block.text())) {
-		int index = match.capturedStart();
-		int length = match.capturedLength();
-		if (!isInRange(pos + index, ranges))
-			applyFormat(pos + index, pos + index + length, format);
-	}
-}
-
-void QtHighlighter::formatBlockIfInRange(
-	const QTextBlock& block,
-	HighlightType type,
-	const std::vector<HighlightingRange> &ranges)
-{
-	int startPos = block.position();
-	int endPos = startPos + block.length() - 1;
-
-	if (s_charFormats.find(type) == s_charFormats.end())
-	{
-		return;
-	}
-
-	const QTextCharFormat& format = s_charFormats.find(type)->second;
-
-	for (auto range: ranges)
-	{
-		if (type == range.type)
+		for (const QRegularExpression& pattern: rule.patterns)
 		{
-			int start = std::max(range.start, startPos);
-			int end = std::min(range.end, endPos);
-
-			if (start <= end)
+			for (const QRegularExpressionMatch& match: pattern.globalMatch(text))
 			{
-				applyFormat(start, end, format);
+				const int start = int(match.capturedStart());
+				const int end = int(match.capturedEnd());
+				if (start < end && !isInTokens(start, exclusiveTokens))
+				{
+					ruleTokens[i].push_back({rule.type, start, end});
+				}
 			}
 		}
 	}
-}
-
-void QtHighlighter::formatBlockIfInRange(
-	const QTextBlock& block, const std::vector<HighlightingRange> &ranges)
-{
-	int startPos = block.position();
-	int endPos = startPos + block.length() - 1;
 
-	for (auto range: ranges)
+	if (!rules.words.isEmpty())
 	{
-		HighlightType type = range.type;
-		if (s_charFormats.find(type) == s_charFormats.end())
+		int wordStart = -1;
+		for (int i = 0; i <= length; i++)
 		{
-			continue;
+			const bool isWordChar = i < length && isWordCharacter(text[i]);
+			if (isWordChar && wordStart < 0)
+			{
+				wordStart = i;
+			}
+			else if (!isWordChar && wordStart >= 0)
+			{
+				auto it = rules.words.constFind(text.mid(wordStart, i - wordStart));
+				if (it != rules.words.constEnd() && !isInTokens(wordStart, exclusiveTokens))
+				{
+					ruleTokens[it.value()].push_back({rules.rules[it.value()].type, wordStart, i});
+				}
+				wordStart = -1;
+			}
 		}
+	}
 
-		const QTextCharFormat& format = s_charFormats.find(type)->second;
+	std::vector<HighlightingToken> tokens;
+	for (const std::vector<HighlightingToken>& tokensOfRule: ruleTokens)
+	{
+		utility::append(tokens, tokensOfRule);
+	}
+	utility::append(tokens, rangeTokens);
+	return tokens;
+}
 
-		int start = std::max(range.start, startPos);
-		int end = std::min(range.end, endPos);
+bool QtHighlighter::isInTokens(int pos, const std::vector<HighlightingToken>& sortedTokens)
+{
+	auto it = std::upper_bound(
+		sortedTokens.begin(), sortedTokens.end(), pos, [](int p, const HighlightingToken& token) {
+			return p < token.start;
+		});
 
-		if (start <= end)
-		{
-			applyFormat(start, end, format);
-		}
-	}
+	return it != sortedTokens.begin() && pos < std::prev(it)->end;
 }
 
 QTextDocument* QtHighlighter::document() const
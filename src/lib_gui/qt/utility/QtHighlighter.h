@@ -1,7 +1,16 @@
 #ifndef QT_HIGHLIGHTER_H
 #define QT_HIGHLIGHTER_H
 
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <QHash>
 #include <QRegularExpression>
+#include <QString>
 #include <QTextCharFormat>
 
 #include <aidkit/enum_class.hpp>
@@ -46,57 +55,70 @@ public:
 private:
 	struct HighlightingRule
 	{
-		HighlightingRule() = default;
-		HighlightingRule(
-			HighlightType type, const QRegularExpression& regExp, bool priority, bool multiLine = false);
-
 		HighlightType type = HighlightType::TEXT;
-		QRegularExpression pattern;
+		std::vector<QRegularExpression> patterns;
 		bool priority = false;
-		bool multiLine = false;
 	};
 
-	struct HighlightingRange
+	struct RangeRule
+	{
+		HighlightType type = HighlightType::TEXT;
+		QRegularExpression start;
+		QRegularExpression end;
+	};
+
+	struct HighlightingRules
+	{
+		std::vector<HighlightingRule> rules;
+		std::vector<RangeRule> rangeRules;
+		// patterns matching a single word are looked up here instead, maps to the index of the rule
+		QHash<QString, size_t> words;
+	};
+
+	struct HighlightingToken
 	{
 		HighlightType type = HighlightType::TEXT;
+		// relative to the start of the line
 		int start = 0;
 		int end = 0;
 	};
 
-	void createRanges(QTextDocument* doc, const std::vector<HighlightingRule>& quotationRules);
-	std::vector<HighlightingRange> createMultiLineRanges(
-		QTextDocument* doc, const std::vector<HighlightingRange> &ranges);
-	std::vector<HighlightingRange> createMultiLineRangesForRules(
-		QTextDocument* doc,
-		const std::vector<HighlightingRange> &ranges,
-		const HighlightingRule* startRule,
-		const HighlightingRule* endRule);
-
-	static bool isInRange(int index, const std::vector<HighlightingRange>& ranges);
-	static std::vector<HighlightingRange> getRangesForRule(
-		const QTextBlock& block, const HighlightingRule& rule);
-
-	void formatBlockForRule(
-		const QTextBlock& block,
-		const HighlightingRule& rule,
-		const std::vector<HighlightingRange> &ranges);
-	void formatBlockIfInRange(
-		const QTextBlock& block,
-		HighlightType type,
-		const std::vector<HighlightingRange> &ranges);
-	void formatBlockIfInRange(
-		const QTextBlock& block, const std::vector<HighlightingRange> &ranges);
+	// Tokens of the lines of a text in the order their formats get applied. The lines are tokenized
+	// on demand, the text is shared by all highlighters showing the same content.
+	struct TokenizedText
+	{
+		// compared on lookup, because the cache key only holds a hash of it
+		QString text;
+		std::vector<std::vector<HighlightingToken>> lineTokens;
+		// index of the range rule still open after the last tokenized line, -1 if none
+		int openRangeRule = -1;
+		int lineCount = 0;
+	};
+
+	using TokenCacheKey = std::tuple<std::wstring, size_t, int>;
+
+	static std::shared_ptr<TokenizedText> getTokenizedText(
+		const std::wstring& language, QTextDocument* doc);
+
+	void tokenizeLines(int lastLine);
+	std::vector<HighlightingToken> tokenizeLine(const QString& text, int& openRangeRule) const;
+
+	static bool isInTokens(int pos, const std::vector<HighlightingToken>& sortedTokens);
 
 	QTextDocument* document() const;
 
-	static std::map<std::wstring, std::vector<HighlightingRule>> s_highlightingRules;
+	static std::map<std::wstring, std::shared_ptr<const HighlightingRules>> s_highlightingRules;
 	static std::map<HighlightType, QTextCharFormat> s_charFormats;
 
+	static std::map<TokenCacheKey, std::shared_ptr<TokenizedText>> s_tokenCache;
+	static std::deque<TokenCacheKey> s_tokenCacheOrder;
+	static int s_tokenCacheLineCount;
+
 	QTextDocument* m_document;
+	std::wstring m_language;
 
-	std::vector<HighlightingRule> m_highlightingRules;
-	std::vector<HighlightingRange> m_singleLineRanges;
-	std::vector<HighlightingRange> m_multiLineRanges;
+	std::shared_ptr<const HighlightingRules> m_highlightingRules;
+	std::shared_ptr<TokenizedText> m_tokenizedText;
 	std::vector<bool> m_highlightedLines;
 };
 
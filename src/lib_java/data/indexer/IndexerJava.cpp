@@ -1,10 +1,22 @@
 #include "IndexerJava.h"
 
+#include "JavaEnvironment.h"
+#include "JavaEnvironmentFactory.h"
 #include "JavaParser.h"
 
+std::atomic<int> IndexerJava::s_instanceCount = 0;
+
+IndexerJava::IndexerJava()
+{
+	s_instanceCount++;
+}
+
 IndexerJava::~IndexerJava()
 {
-	JavaParser::clearCaches();
+	if (--s_instanceCount == 0)
+	{
+		JavaParser::clearCaches();
+	}
 }
 
 void IndexerJava::doIndex(
@@ -12,5 +24,15 @@ void IndexerJava::doIndex(
 	std::shared_ptr<ParserClientImpl> parserClient,
 	std::shared_ptr<IndexerStateInfo> m_indexerStateInfo)
 {
-	JavaParser(parserClient, m_indexerStateInfo).buildIndex(indexerCommand);
+	JavaParser parser(parserClient, m_indexerStateInfo);
+
+	if (!m_javaEnvironment)
+	{
+		if (std::shared_ptr<JavaEnvironmentFactory> factory = JavaEnvironmentFactory::getInstance())
+		{
+			m_javaEnvironment = factory->createEnvironment();
+		}
+	}
+
+	parser.buildIndex(indexerCommand);
 }
@@ -1,14 +1,18 @@
 #ifndef INDEXER_JAVA_H
 #define INDEXER_JAVA_H
 
+#include <atomic>
+
 #include "Indexer.h"
 #include "IndexerCommandJava.h"
 
+class JavaEnvironment;
 struct IndexerStateInfo;
 
 class IndexerJava: public Indexer<IndexerCommandJava>
 {
 public:
+	IndexerJava();
 	~IndexerJava() override;
 
 private:
@@ -16,6 +20,13 @@ private:
 		std::shared_ptr<IndexerCommandJava> indexerCommand,
 		std::shared_ptr<ParserClientImpl> parserClient,
 		std::shared_ptr<IndexerStateInfo> m_indexerStateInfo) override;
+
+	// the caches of the JVM are shared by all indexer threads, so they are only cleared when the
+	// last indexer goes away
+	static std::atomic<int> s_instanceCount;
+
+	// keeps the indexer thread attached to the JVM between source files
+	std::shared_ptr<JavaEnvironment> m_javaEnvironment;
 };
 
 #endif	  // INDEXER_JAVA_H
@@ -33,9 +33,13 @@ std::function<Ret(Args...)> loadFunctionFromLibrary(boost::dll::shared_library *
 boost::dll::shared_library JavaEnvironmentFactory::s_jvmLibrary;
 std::shared_ptr<JavaEnvironmentFactory> JavaEnvironmentFactory::s_instance;
 std::string JavaEnvironmentFactory::s_classPath;
+std::mutex JavaEnvironmentFactory::s_instanceMutex;
 
 void JavaEnvironmentFactory::createInstance(const std::string &classPath, std::string *errorString)
 {
+	// indexer threads may try to create the instance concurrently, but there can only be one JVM
+	std::lock_guard<std::mutex> lock(s_instanceMutex);
+
 	if (s_instance)
 	{
 		if (classPath == s_classPath)
@@ -131,6 +135,7 @@ void JavaEnvironmentFactory::createInstance(const std::string &classPath, std::s
 
 std::shared_ptr<JavaEnvironmentFactory> JavaEnvironmentFactory::getInstance()
 {
+	std::lock_guard<std::mutex> lock(s_instanceMutex);
 	return s_instance;
 }
 
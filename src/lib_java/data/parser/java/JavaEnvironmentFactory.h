@@ -27,6 +27,7 @@ private:
 	static boost::dll::shared_library s_jvmLibrary;
 	static std::shared_ptr<JavaEnvironmentFactory> s_instance;
 	static std::string s_classPath;
+	static std::mutex s_instanceMutex;
 
 	JavaEnvironmentFactory(JavaVM* jvm);
 
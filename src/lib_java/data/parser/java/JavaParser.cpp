@@ -1,5 +1,7 @@
 #include "JavaParser.h"
 
+#include <cstring>
+
 #include "ApplicationSettings.h"
 #include "IndexerStateInfo.h"
 #include "JavaEnvironmentFactory.h"
@@ -39,7 +41,13 @@ JavaParser::JavaParser(
 	if (factory)
 	{
 		m_javaEnvironment = factory->createEnvironment();
+	}
+
+	std::lock_guard<std::mutex> lock(s_parsersMutex);
 
+	// native methods are registered for the class and not per thread, so doing this once suffices
+	if (m_javaEnvironment && !s_nativeMethodsRegistered)
+	{
 		std::vector<JavaEnvironment::NativeMethod> methods;
 
 		methods.push_back({"getInterrupted", "(I)Z", (void*)&JavaParser::GetInterrupted});
@@ -47,43 +55,18 @@ JavaParser::JavaParser(
 		methods.push_back({"logWarning", "(ILjava/lang/String;)V", (void*)&JavaParser::LogWarning});
 		methods.push_back({"logError", "(ILjava/lang/String;)V", (void*)&JavaParser::LogError});
 		methods.push_back(
-			{"recordSymbol", "(ILjava/lang/String;III)V", (void*)&JavaParser::RecordSymbol});
-		methods.push_back(
-			{"recordSymbolWithLocation",
-			 "(ILjava/lang/String;IIIIIII)V",
-			 (void*)&JavaParser::RecordSymbolWithLocation});
-		methods.push_back(
-			{"recordSymbolWithLocationAndScope",
-			 "(ILjava/lang/String;IIIIIIIIIII)V",
-			 (void*)&JavaParser::RecordSymbolWithLocationAndScope});
-		methods.push_back(
-			{"recordSymbolWithLocationAndScopeAndSignature",
-			 "(ILjava/lang/String;IIIIIIIIIIIIIII)V",
-			 (void*)&JavaParser::RecordSymbolWithLocationAndScopeAndSignature});
-		methods.push_back(
-			{"recordReference",
-			 "(IILjava/lang/String;Ljava/lang/String;IIII)V",
-			 (void*)&JavaParser::RecordReference});
-		methods.push_back(
-			{"recordQualifierLocation",
-			 "(ILjava/lang/String;IIII)V",
-			 (void*)&JavaParser::RecordQualifierLocation});
-		methods.push_back(
-			{"recordLocalSymbol", "(ILjava/lang/String;IIII)V", (void*)&JavaParser::RecordLocalSymbol});
-		methods.push_back({"recordComment", "(IIIII)V", (void*)&JavaParser::RecordComment});
-		methods.push_back(
-			{"recordError", "(ILjava/lang/String;IIIIII)V", (void*)&JavaParser::RecordError});
+			{"recordBatch", "(ILjava/nio/ByteBuffer;I)V", (void*)&JavaParser::RecordBatch});
 
 		m_javaEnvironment->registerNativeMethods("com/sourcetrail/JavaIndexer", methods);
+		s_nativeMethodsRegistered = true;
 	}
-	{
-		std::lock_guard<std::mutex> lock(s_parsersMutex);
-		s_parsers[m_id] = this;
-	}
+
+	s_parsers[m_id] = this;
 }
 
 JavaParser::~JavaParser()
 {
+	std::lock_guard<std::mutex> lock(s_parsersMutex);
 	s_parsers.erase(m_id);
 }
 
@@ -118,6 +101,8 @@ void JavaParser::buildIndex(
 	{
 		m_currentFilePath = sourceFilePath;
 		m_currentFileId = m_client->recordFile(sourceFilePath, true);
+		m_batchStrings.clear();
+		m_batchStringSymbolIds.clear();
 		m_client->recordFileLanguage(m_currentFileId, L"java");
 
 		// remove tabs because they screw with javaparser's location resolver
@@ -140,12 +125,28 @@ void JavaParser::buildIndex(
 	}
 }
 
-int JavaParser::s_nextParserId = 0;
+std::atomic<int> JavaParser::s_nextParserId = 0;
 
 std::map<int, JavaParser*> JavaParser::s_parsers;
 
 std::mutex JavaParser::s_parsersMutex;
 
+bool JavaParser::s_nativeMethodsRegistered = false;
+
+JavaParser* JavaParser::getParser(jint parserId)
+{
+	std::lock_guard<std::mutex> lock(s_parsersMutex);
+
+	std::map<int, JavaParser*>::iterator it = s_parsers.find(int(parserId));
+	if (it != s_parsers.end())
+	{
+		return it->second;
+	}
+
+	LOG_ERROR("parser with id " + std::to_string(parserId) + " not found");
+	return nullptr;
+}
+
 
 // definition of native methods
 
@@ -169,172 +170,209 @@ void JavaParser::doLogError(jstring jError)
 	LOG_ERROR_STREAM_BARE(<< "Indexer - " << m_javaEnvironment->toStdString(jError));
 }
 
-void JavaParser::doRecordSymbol(jstring jSymbolName, jint jSymbolKind, jint jAccess, jint jDefinitionKind)
-{
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
-}
-
-void JavaParser::doRecordSymbolWithLocation(
-	jstring jSymbolName,
-	jint jSymbolKind,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn,
-	jint jAccess,
-	jint jDefinitionKind)
+void JavaParser::doRecordBatch(const char* data, size_t size)
 {
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::TOKEN);
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
-}
+	size_t offset = 0;
+	bool valid = true;
 
-void JavaParser::doRecordSymbolWithLocationAndScope(
-	jstring jSymbolName,
-	jint jSymbolKind,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn,
-	jint scopeBeginLine,
-	jint scopeBeginColumn,
-	jint scopeEndLine,
-	jint scopeEndColumn,
-	jint jAccess,
-	jint jDefinitionKind)
-{
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::TOKEN);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, scopeBeginLine, scopeBeginColumn, scopeEndLine, scopeEndColumn),
-		ParseLocationType::SCOPE);
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
-}
-
-void JavaParser::doRecordSymbolWithLocationAndScopeAndSignature(
-	jstring jSymbolName,
-	jint jSymbolKind,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn,
-	jint scopeBeginLine,
-	jint scopeBeginColumn,
-	jint scopeEndLine,
-	jint scopeEndColumn,
-	jint signatureBeginLine,
-	jint signatureBeginColumn,
-	jint signatureEndLine,
-	jint signatureEndColumn,
-	jint jAccess,
-	jint jDefinitionKind)
-{
-	Id symbolId = getOrCreateSymbolId(jSymbolName);
-	m_client->recordSymbolKind(symbolId, intToSymbolKind(jSymbolKind));
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::TOKEN);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, scopeBeginLine, scopeBeginColumn, scopeEndLine, scopeEndColumn),
-		ParseLocationType::SCOPE);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(
-			m_currentFileId, signatureBeginLine, signatureBeginColumn, signatureEndLine, signatureEndColumn),
-		ParseLocationType::SIGNATURE);
-	m_client->recordAccessKind(symbolId, intToAccessKind(jAccess));
-	m_client->recordDefinitionKind(symbolId, intToDefinitionKind(jDefinitionKind));
-}
-
-void JavaParser::doRecordReference(
-	jint jReferenceKind,
-	jstring jReferencedName,
-	jstring jContextName,
-	jint beginLine,
-	jint beginColumn,
-	jint endLine,
-	jint endColumn)
-{
-	m_client->recordReference(
-		intToReferenceKind(jReferenceKind),
-		getOrCreateSymbolId(jReferencedName),
-		getOrCreateSymbolId(jContextName),
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn));
-}
+	auto readInt = [&]() -> jint {
+		jint value = 0;
+		if (offset + sizeof(jint) <= size)
+		{
+			std::memcpy(&value, data + offset, sizeof(jint));
+		}
+		else
+		{
+			valid = false;
+		}
+		offset += sizeof(jint);
+		return value;
+	};
+
+	auto readLocation = [&]() -> ParseLocation {
+		const jint beginLine = readInt();
+		const jint beginColumn = readInt();
+		const jint endLine = readInt();
+		const jint endColumn = readInt();
+		return ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn);
+	};
+
+	auto readSymbolId = [&]() -> Id {
+		const jint nameIndex = readInt();
+		if (nameIndex < 0 || static_cast<size_t>(nameIndex) >= m_batchStrings.size())
+		{
+			valid = false;
+			return 0;
+		}
+		return getOrCreateSymbolId(static_cast<size_t>(nameIndex));
+	};
 
-void JavaParser::doRecordQualifierLocation(
-	jstring jQualifierName, jint beginLine, jint beginColumn, jint endLine, jint endColumn)
-{
-	Id symbolId = getOrCreateSymbolId(jQualifierName);
-	m_client->recordLocation(
-		symbolId,
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn),
-		ParseLocationType::QUALIFIER);
-}
+	auto readString = [&]() -> std::string {
+		const jint index = readInt();
+		if (index < 0 || static_cast<size_t>(index) >= m_batchStrings.size())
+		{
+			valid = false;
+			return "";
+		}
+		return m_batchStrings[static_cast<size_t>(index)];
+	};
 
-void JavaParser::doRecordLocalSymbol(
-	jstring jSymbolName, jint beginLine, jint beginColumn, jint endLine, jint endColumn)
-{
-	m_client->recordLocalSymbol(
-		NameHierarchy::deserialize(
-			utility::decodeFromUtf8(m_javaEnvironment->toStdString(jSymbolName)))
-			.getQualifiedName(),
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn));
-}
+	while (valid && offset < size)
+	{
+		const RecordKind recordKind = RecordKind(readInt());
+		switch (recordKind)
+		{
+		case RecordKind::STRING:
+		{
+			const jint length = readInt();
+			if (length < 0 || offset + static_cast<size_t>(length) > size)
+			{
+				valid = false;
+				break;
+			}
+			m_batchStrings.emplace_back(data + offset, static_cast<size_t>(length));
+			m_batchStringSymbolIds.push_back(0);
+			offset += static_cast<size_t>(length);
+			break;
+		}
+		case RecordKind::SYMBOL:
+		{
+			const Id symbolId = readSymbolId();
+			const jint symbolKind = readInt();
+			const jint access = readInt();
+			const jint definitionKind = readInt();
+			if (valid)
+			{
+				m_client->recordSymbolKind(symbolId, intToSymbolKind(symbolKind));
+				m_client->recordAccessKind(symbolId, intToAccessKind(access));
+				m_client->recordDefinitionKind(symbolId, intToDefinitionKind(definitionKind));
+			}
+			break;
+		}
+		case RecordKind::SYMBOL_WITH_LOCATION:
+		case RecordKind::SYMBOL_WITH_LOCATION_AND_SCOPE:
+		case RecordKind::SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE:
+		{
+			const Id symbolId = readSymbolId();
+			const jint symbolKind = readInt();
+
+			std::vector<std::pair<ParseLocation, ParseLocationType>> locations;
+			locations.emplace_back(readLocation(), ParseLocationType::TOKEN);
+			if (recordKind != RecordKind::SYMBOL_WITH_LOCATION)
+			{
+				locations.emplace_back(readLocation(), ParseLocationType::SCOPE);
+			}
+			if (recordKind == RecordKind::SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE)
+			{
+				locations.emplace_back(readLocation(), ParseLocationType::SIGNATURE);
+			}
+
+			const jint access = readInt();
+			const jint definitionKind = readInt();
+			if (valid)
+			{
+				m_client->recordSymbolKind(symbolId, intToSymbolKind(symbolKind));
+				for (const auto& [location, locationType]: locations)
+				{
+					m_client->recordLocation(symbolId, location, locationType);
+				}
+				m_client->recordAccessKind(symbolId, intToAccessKind(access));
+				m_client->recordDefinitionKind(symbolId, intToDefinitionKind(definitionKind));
+			}
+			break;
+		}
+		case RecordKind::REFERENCE:
+		{
+			const jint referenceKind = readInt();
+			const Id referencedSymbolId = readSymbolId();
+			const Id contextSymbolId = readSymbolId();
+			const ParseLocation location = readLocation();
+			if (valid)
+			{
+				m_client->recordReference(
+					intToReferenceKind(referenceKind), referencedSymbolId, contextSymbolId, location);
+			}
+			break;
+		}
+		case RecordKind::QUALIFIER_LOCATION:
+		{
+			const Id symbolId = readSymbolId();
+			const ParseLocation location = readLocation();
+			if (valid)
+			{
+				m_client->recordLocation(symbolId, location, ParseLocationType::QUALIFIER);
+			}
+			break;
+		}
+		case RecordKind::LOCAL_SYMBOL:
+		{
+			const std::string name = readString();
+			const ParseLocation location = readLocation();
+			if (valid)
+			{
+				m_client->recordLocalSymbol(
+					NameHierarchy::deserialize(utility::decodeFromUtf8(name)).getQualifiedName(),
+					location);
+			}
+			break;
+		}
+		case RecordKind::COMMENT:
+		{
+			const ParseLocation location = readLocation();
+			if (valid)
+			{
+				m_client->recordComment(location);
+			}
+			break;
+		}
+		case RecordKind::ERROR:
+		{
+			const std::string message = readString();
+			const bool fatal = readInt();
+			const bool indexed = readInt();
+			const ParseLocation location = readLocation();
+			if (valid)
+			{
+				m_client->recordError(
+					utility::decodeFromUtf8(message),
+					fatal,
+					indexed,
+					FilePath(),
+					ParseLocation(m_currentFileId, location.startLineNumber, location.startColumnNumber));
+			}
+			break;
+		}
+		default:
+			valid = false;
+			break;
+		}
+	}
 
-void JavaParser::doRecordComment(jint beginLine, jint beginColumn, jint endLine, jint endColumn)
-{
-	m_client->recordComment(
-		ParseLocation(m_currentFileId, beginLine, beginColumn, endLine, endColumn));
+	if (!valid)
+	{
+		LOG_ERROR(
+			"malformed record batch received from Java indexer for file " + m_currentFilePath.str());
+	}
 }
 
-void JavaParser::doRecordError(
-	jstring jMessage,
-	jint jFatal,
-	jint jIndexed,
-	jint beginLine,
-	jint beginColumn,
-	jint  /*endLine*/,
-	jint  /*endColumn*/)
+Id JavaParser::getOrCreateSymbolId(size_t nameIndex)
 {
-	bool fatal = jFatal;
-	bool indexed = jIndexed;
-
-	m_client->recordError(
-		utility::decodeFromUtf8(m_javaEnvironment->toStdString(jMessage)),
-		fatal,
-		indexed,
-		FilePath(),
-		ParseLocation(m_currentFileId, beginLine, beginColumn));
-}
+	Id& symbolId = m_batchStringSymbolIds[nameIndex];
+	if (symbolId)
+	{
+		return symbolId;
+	}
 
-Id JavaParser::getOrCreateSymbolId(jstring jSymbolName)
-{
-	std::string name = m_javaEnvironment->toStdString(jSymbolName);
+	const std::string& name = m_batchStrings[nameIndex];
 
 	auto it = m_symbolNameToIdMap.find(name);
 	if (it != m_symbolNameToIdMap.end())
 	{
-		return it->second;
+		symbolId = it->second;
+		return symbolId;
 	}
 
-	Id symbolId = m_client->recordSymbol(NameHierarchy::deserialize(utility::decodeFromUtf8(name)));
+	symbolId = m_client->recordSymbol(NameHierarchy::deserialize(utility::decodeFromUtf8(name)));
 
 	m_symbolNameToIdMap.emplace(name, symbolId);
 	return symbolId;
@@ -1,10 +1,12 @@
 #ifndef JAVA_PARSER_H
 #define JAVA_PARSER_H
 
+#include <atomic>
 #include <jni.h>
 #include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "FilePath.h"
 #include "IndexerCommandJava.h"
@@ -163,78 +165,66 @@ private:
 #define DEF_RELAYING_METHOD(NAME, PARAMETERS, ARGUMENTS)                                           \
 	static void NAME(JNIEnv* /*env*/, jobject /*objectOrClass*/, jint parserId PARAMETERS)                 \
 	{                                                                                              \
-		std::map<int, JavaParser*>::iterator it = s_parsers.find(int(parserId));                   \
-		if (it != s_parsers.end())                                                                 \
+		if (JavaParser* parser = getParser(parserId))                                              \
 		{                                                                                          \
-			it->second->do##NAME(ARGUMENTS);                                                       \
-		}                                                                                          \
-		else                                                                                       \
-		{                                                                                          \
-			LOG_ERROR("parser with id " + std::to_string(parserId) + " not found");                \
+			parser->do##NAME(ARGUMENTS);                                                           \
 		}                                                                                          \
 	}
 
 	DEF_RELAYING_METHOD_1(LogInfo, jstring)
 	DEF_RELAYING_METHOD_1(LogWarning, jstring)
 	DEF_RELAYING_METHOD_1(LogError, jstring)
-	DEF_RELAYING_METHOD_4(RecordSymbol, jstring, jint, jint, jint)
-	DEF_RELAYING_METHOD_8(RecordSymbolWithLocation, jstring, jint, jint, jint, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_12(
-		RecordSymbolWithLocationAndScope,
-		jstring,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint)
-	DEF_RELAYING_METHOD_16(
-		RecordSymbolWithLocationAndScopeAndSignature,
-		jstring,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint,
-		jint)
-	DEF_RELAYING_METHOD_7(RecordReference, jint, jstring, jstring, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_5(RecordQualifierLocation, jstring, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_5(RecordLocalSymbol, jstring, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_4(RecordComment, jint, jint, jint, jint)
-	DEF_RELAYING_METHOD_7(RecordError, jstring, jint, jint, jint, jint, jint, jint)
-
 	static bool GetInterrupted(JNIEnv*  /*env*/, jobject  /*objectOrClass*/, jint parserId)
 	{
-		std::map<int, JavaParser*>::iterator it = s_parsers.find(int(parserId));
-		if (it != s_parsers.end())
+		if (JavaParser* parser = getParser(parserId))
 		{
-			return it->second->doGetInterrupted();
+			return parser->doGetInterrupted();
 		}
-		else
+
+		return false;
+	}
+
+	static void RecordBatch(JNIEnv* env, jobject /*objectOrClass*/, jint parserId, jobject buffer, jint size)
+	{
+		JavaParser* parser = getParser(parserId);
+		if (!parser)
 		{
-			LOG_ERROR("parser with id " + std::to_string(parserId) + " not found");
+			return;
 		}
 
-		return false;
+		const char* data = static_cast<const char*>(env->GetDirectBufferAddress(buffer));
+		if (data == nullptr || size < 0)
+		{
+			LOG_ERROR("record buffer of parser with id " + std::to_string(parserId) + " is not accessible");
+			return;
+		}
+
+		parser->doRecordBatch(data, static_cast<size_t>(size));
 	}
 
-	static int s_nextParserId;
+	// Must be in sync with the record kinds in 'RecordBuffer.java'.
+	enum class RecordKind
+	{
+		STRING = 0,
+		SYMBOL = 1,
+		SYMBOL_WITH_LOCATION = 2,
+		SYMBOL_WITH_LOCATION_AND_SCOPE = 3,
+		SYMBOL_WITH_LOCATION_AND_SCOPE_AND_SIGNATURE = 4,
+		REFERENCE = 5,
+		QUALIFIER_LOCATION = 6,
+		LOCAL_SYMBOL = 7,
+		COMMENT = 8,
+		ERROR = 9
+	};
+
+	// parsers of all indexer threads share one JVM, so the native callbacks have to find the
+	// calling parser by its id
+	static JavaParser* getParser(jint parserId);
+
+	static std::atomic<int> s_nextParserId;
 	static std::map<int, JavaParser*> s_parsers;
 	static std::mutex s_parsersMutex;
+	static bool s_nativeMethodsRegistered;
 
 
 	bool doGetInterrupted();
@@ -245,73 +235,9 @@ private:
 
 	void doLogError(jstring jError);
 
-	void doRecordSymbol(jstring jSymbolName, jint jSymbolKind, jint jAccess, jint jDefinitionKind);
-
-	void doRecordSymbolWithLocation(
-		jstring jSymbolName,
-		jint jSymbolKind,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn,
-		jint jAccess,
-		jint jDefinitionKind);
-
-	void doRecordSymbolWithLocationAndScope(
-		jstring jSymbolName,
-		jint jSymbolKind,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn,
-		jint scopeBeginLine,
-		jint scopeBeginColumn,
-		jint scopeEndLine,
-		jint scopeEndColumn,
-		jint jAccess,
-		jint jDefinitionKind);
-
-	void doRecordSymbolWithLocationAndScopeAndSignature(
-		jstring jSymbolName,
-		jint jSymbolKind,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn,
-		jint scopeBeginLine,
-		jint scopeBeginColumn,
-		jint scopeEndLine,
-		jint scopeEndColumn,
-		jint signatureBeginLine,
-		jint signatureBeginColumn,
-		jint signatureEndLine,
-		jint signatureEndColumn,
-		jint jAccess,
-		jint jDefinitionKind);
-
-	void doRecordReference(
-		jint jReferenceKind,
-		jstring jReferencedName,
-		jstring jContextName,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn);
-	void doRecordQualifierLocation(
-		jstring jQualifierName, jint beginLine, jint beginColumn, jint endLine, jint endColumn);
-	void doRecordLocalSymbol(
-		jstring jSymbolName, jint beginLine, jint beginColumn, jint endLine, jint endColumn);
-	void doRecordComment(jint beginLine, jint beginColumn, jint endLine, jint endColumn);
-	void doRecordError(
-		jstring jMessage,
-		jint jFatal,
-		jint jIndexed,
-		jint beginLine,
-		jint beginColumn,
-		jint endLine,
-		jint endColumn);
-
-	Id getOrCreateSymbolId(jstring jSymbolName);
+	void doRecordBatch(const char* data, size_t size);
+
+	Id getOrCreateSymbolId(size_t nameIndex);
 
 	std::shared_ptr<JavaEnvironment> m_javaEnvironment;
 	std::shared_ptr<IndexerStateInfo> m_indexerStateInfo;
@@ -321,6 +247,10 @@ private:
 	Id m_currentFileId;
 
 	std::map<std::string, Id> m_symbolNameToIdMap;
+
+	// string table of the file currently being indexed, filled by the records of 'doRecordBatch'
+	std::vector<std::string> m_batchStrings;
+	std::vector<Id> m_batchStringSymbolIds;
 };
 
 #endif	  // JAVA_PARSER_H
@@ -0,0 +1,176 @@
+#include "Catch2.hpp"
+
+#include "language_packages.h"
+
+#if BUILD_CXX_LANGUAGE_PACKAGE
+
+#	include <sstream>
+
+#	include "CompilationDatabase.h"
+#	include "Platform.h"
+
+namespace
+{
+utility::CompilationDatabase readDatabase(const std::string& json)
+{
+	std::istringstream stream(json);
+	return utility::CompilationDatabase(stream);
+}
+
+// entries as generated by CMake, files of the same target share their flags
+std::string createDatabase(size_t entryCount, size_t targetCount)
+{
+	std::string json = "[\n";
+	for (size_t i = 0; i < entryCount; i++)
+	{
+		const std::string target = "target_" + std::to_string(i % targetCount);
+		const std::string file = "/project/src/" + target + "/file_" + std::to_string(i) + ".cpp";
+
+		std::string command = "/usr/bin/c++ -DTARGET=\\\"" + target + "\\\"";
+		for (size_t j = 0; j < 30; j++)
+		{
+			command += " -I/project/src/" + target + "/include_" + std::to_string(j);
+		}
+		command += " -O2 -g -Wall -Wextra -std=gnu++17 -o CMakeFiles/" + target + ".dir/file_" +
+			std::to_string(i) + ".cpp.o -c " + file;
+
+		json += "{\n  \"directory\": \"/project/build\",\n  \"command\": \"" + command +
+			"\",\n  \"file\": \"" + file + "\",\n  \"output\": \"CMakeFiles/" + target +
+			".dir/file_" + std::to_string(i) + ".cpp.o\"\n}";
+		json += (i + 1 < entryCount ? ",\n" : "\n");
+	}
+	json += "]\n";
+	return json;
+}
+}	 // namespace
+
+TEST_CASE("compilation database reads arguments of entries")
+{
+	const utility::CompilationDatabase database = readDatabase(
+		"[{\"directory\": \"/build\", \"arguments\": [\"clang\", \"-DA=\\\"b c\\\"\", \"-c\", "
+		"\"a.cpp\"], \"file\": \"a.cpp\", \"extra\": {\"x\": [1, true, null]}}]");
+
+	REQUIRE(database.getError().empty());
+	REQUIRE(1 == database.getCommands().size());
+
+	const utility::CompilationDatabase::Command& command = database.getCommands().front();
+	REQUIRE("/build" == command.directory);
+	REQUIRE("a.cpp" == command.file);
+	REQUIRE(
+		std::vector<std::string>({"clang", "-DA=\"b c\"", "-c", "a.cpp"}) ==
+		command.getCommandLine());
+}
+
+TEST_CASE("compilation database splits command of entries")
+{
+	if constexpr (!utility::Platform::isWindows())
+	{
+		const utility::CompilationDatabase database = readDatabase(
+			"[{\"directory\": \"/build\", \"command\": \"ccache clang  -D A=\\\"b\\\\\\\" c\\\" "
+			"'-DB=d e' f\\\\ g.cpp\", \"file\": \"f g.cpp\"}]");
+
+		REQUIRE(database.getError().empty());
+		REQUIRE(1 == database.getCommands().size());
+		REQUIRE(
+			std::vector<std::string>({"clang", "-D", "A=b\" c", "-DB=d e", "f g.cpp"}) ==
+			database.getCommands().front().getCommandLine());
+	}
+}
+
+TEST_CASE("compilation database decodes escaped characters")
+{
+	const utility::CompilationDatabase database = readDatabase(
+		"[{\"directory\": \"/b\\u00e4\\/\\t\", \"arguments\": [\"\\ud83d\\ude00\"], \"file\": "
+		"\"a.cpp\"}]");
+
+	REQUIRE(database.getError().empty());
+	REQUIRE(1 == database.getCommands().size());
+	REQUIRE("/b\xc3\xa4/\t" == database.getCommands().front().directory);
+	REQUIRE("\xf0\x9f\x98\x80" == database.getCommands().front().getCommandLine().front());
+}
+
+TEST_CASE("compilation database shares arguments of commands that differ in files only")
+{
+	const utility::CompilationDatabase database = readDatabase(
+		"[{\"directory\": \"/build\", \"arguments\": [\"cc\", \"-o\", \"a.o\", \"-c\", \"a.c\"], "
+		"\"file\": \"a.c\"},"
+		"{\"directory\": \"/build\", \"arguments\": [\"cc\", \"-o\", \"b.o\", \"-c\", \"b.c\"], "
+		"\"file\": \"b.c\"},"
+		"{\"directory\": \"/build\", \"arguments\": [\"cc\", \"-O2\", \"-c\", \"c.c\"], "
+		"\"file\": \"c.c\"}]");
+
+	REQUIRE(database.getError().empty());
+	REQUIRE(3 == database.getCommands().size());
+	REQUIRE(2 == database.getArgumentListCount());
+
+	const std::vector<utility::CompilationDatabase::Command>& commands = database.getCommands();
+	REQUIRE(commands[0].argumentList == commands[1].argumentList);
+	REQUIRE("b.o" == commands[1].output);
+	REQUIRE(
+		std::vector<std::string>({"cc", "-o", "b.o", "-c", "b.c"}) == commands[1].getCommandLine());
+}
+
+TEST_CASE("compilation database skips byte order mark")
+{
+	const utility::CompilationDatabase database = readDatabase(
+		"\xEF\xBB\xBF[{\"directory\": \"/build\", \"arguments\": [\"cc\", \"a.c\"], \"file\": "
+		"\"a.c\"}]");
+
+	REQUIRE(database.getError().empty());
+	REQUIRE(1 == database.getCommands().size());
+	REQUIRE("a.c" == database.getCommands().front().file);
+}
+
+TEST_CASE("compilation database reports invalid content")
+{
+	REQUIRE(readDatabase("[]").getError().empty());
+	REQUIRE(!readDatabase("").getError().empty());
+	REQUIRE(!readDatabase("[{\"directory\": \"/build\", \"file\": \"a.c\"}]").getError().empty());
+	REQUIRE(
+		!readDatabase("[{\"directory\": \"/build\", \"command\": \"cc a.c\"}]").getError().empty());
+	REQUIRE(!readDatabase("[{\"file\": \"a.c\", \"command\": \"cc a.c\"}]").getError().empty());
+	REQUIRE(!readDatabase("[{\"directory\": \"/build\", \"file\": \"a.c\", \"command\": \"cc a.c")
+				 .getError()
+				 .empty());
+	REQUIRE(!readDatabase("[] []").getError().empty());
+	REQUIRE(readDatabase("[] []").getCommands().empty());
+}
+
+TEST_CASE("compilation database reads generated database")
+{
+	const utility::CompilationDatabase database = readDatabase(createDatabase(300, 10));
+
+	REQUIRE(database.getError().empty());
+	REQUIRE(300 == database.getCommands().size());
+	REQUIRE(10 == database.getArgumentListCount());
+
+	const utility::CompilationDatabase::Command& command = database.getCommands()[42];
+	REQUIRE("/project/build" == command.directory);
+	REQUIRE("/project/src/target_2/file_42.cpp" == command.file);
+	REQUIRE("CMakeFiles/target_2.dir/file_42.cpp.o" == command.output);
+
+	const std::vector<std::string> commandLine = command.getCommandLine();
+	REQUIRE(41 == commandLine.size());
+	REQUIRE("-DTARGET=target_2" == commandLine[1]);
+	REQUIRE("CMakeFiles/target_2.dir/file_42.cpp.o" == commandLine[38]);
+	REQUIRE("/project/src/target_2/file_42.cpp" == commandLine.back());
+}
+
+TEST_CASE("compilation database reads large database benchmark", "[!benchmark]")
+{
+	const std::string json = createDatabase(60000, 100);
+
+	{
+		const utility::CompilationDatabase database = readDatabase(json);
+		REQUIRE(database.getError().empty());
+		REQUIRE(60000 == database.getCommands().size());
+		REQUIRE(100 == database.getArgumentListCount());
+	}
+
+	BENCHMARK("read database with 60000 entries")
+	{
+		return readDatabase(json).getCommands().size();
+	};
+}
+
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE
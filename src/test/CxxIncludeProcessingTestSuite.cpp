@@ -4,11 +4,44 @@
 
 #if BUILD_CXX_LANGUAGE_PACKAGE
 
+#	include <fstream>
+
+#	include <boost/filesystem.hpp>
+
+#	include "FileSystem.h"
 #	include "IncludeDirective.h"
 #	include "IncludeProcessing.h"
 #	include "TextAccess.h"
 #	include "utility.h"
 
+namespace
+{
+void writeFile(const FilePath& filePath, const std::string& content)
+{
+	FileSystem::createDirectories(filePath.getParentDirectory());
+	std::ofstream file;
+	file.open(filePath.str(), std::ios::binary);
+	file << content;
+	file.close();
+}
+
+void deleteDirectory(const FilePath& directoryPath)
+{
+	// the generated projects contain sub directories
+	boost::filesystem::remove_all(directoryPath.getPath());
+}
+
+std::vector<std::wstring> getIncludedFiles(const std::vector<IncludeDirective>& includeDirectives)
+{
+	std::vector<std::wstring> includedFiles;
+	for (const IncludeDirective& includeDirective: includeDirectives)
+	{
+		includedFiles.push_back(includeDirective.getIncludedFile().wstr());
+	}
+	return includedFiles;
+}
+}	 // namespace
+
 TEST_CASE("include detection finds include with quotes")
 {
 	std::vector<IncludeDirective> includeDirectives = IncludeProcessing::getIncludeDirectives(
@@ -67,6 +100,128 @@ TEST_CASE("include detection does not find include in file without include prepr
 			.empty());
 }
 
+TEST_CASE("include detection finds includes in file with mixed line endings")
+{
+	const FilePath filePath =
+		FilePath(L"data/CxxIncludeProcessingTestSuite/temp/a.cpp").makeAbsolute();
+	writeFile(
+		filePath,
+		"#include \"a.h\"\r\n\r#include <b.h>\n  #  include \"c.h\"\rint i;\n#include \"d.h");
+
+	const std::vector<IncludeDirective> includeDirectives = IncludeProcessing::getIncludeDirectives(
+		filePath);
+
+	REQUIRE(3 == includeDirectives.size());
+	if (includeDirectives.size() == 3)
+	{
+		REQUIRE(L"a.h" == includeDirectives[0].getIncludedFile().wstr());
+		REQUIRE(1 == includeDirectives[0].getLineNumber());
+		REQUIRE(L"b.h" == includeDirectives[1].getIncludedFile().wstr());
+		REQUIRE(3 == includeDirectives[1].getLineNumber());
+		REQUIRE(L"#include <b.h>" == includeDirectives[1].getDirective());
+		REQUIRE(L"c.h" == includeDirectives[2].getIncludedFile().wstr());
+		REQUIRE(4 == includeDirectives[2].getLineNumber());
+		REQUIRE(filePath == includeDirectives[2].getIncludingFile());
+	}
+
+	deleteDirectory(FilePath(L"data/CxxIncludeProcessingTestSuite/temp").makeAbsolute());
+}
+
+TEST_CASE("unresolved include detection visits every included file once")
+{
+	const FilePath rootPath = FilePath(L"data/CxxIncludeProcessingTestSuite/temp").makeAbsolute();
+	writeFile(rootPath.getConcatenated(L"src/a.cpp"), "#include \"b.h\"\n#include \"missing_a.h\"\n");
+	writeFile(rootPath.getConcatenated(L"src/b.h"), "#include <c.h>\n#include \"missing_b.h\"\n");
+	writeFile(rootPath.getConcatenated(L"include/c.h"), "#include \"../src/b.h\"\n#include <d.h>\n");
+	writeFile(rootPath.getConcatenated(L"src/e.cpp"), "#include \"b.h\"\n#include <c.h>\n");
+
+	const std::vector<IncludeDirective> unresolvedIncludeDirectives =
+		IncludeProcessing::getUnresolvedIncludeDirectives(
+			{rootPath.getConcatenated(L"src/a.cpp"), rootPath.getConcatenated(L"src/e.cpp")},
+			{rootPath},
+			{rootPath.getConcatenated(L"include")},
+			2,
+			[](float) {});
+
+	REQUIRE(
+		std::vector<std::wstring>({L"d.h", L"missing_a.h", L"missing_b.h"}) ==
+		getIncludedFiles(unresolvedIncludeDirectives));
+
+	deleteDirectory(rootPath);
+}
+
+namespace
+{
+// every header includes 5 other headers and one of 10 missing headers, every source file
+// includes 20 headers
+std::set<FilePath> writeGeneratedProject(
+	const FilePath& rootPath, size_t headerCount, size_t sourceFileCount)
+{
+	for (size_t i = 0; i < headerCount; i++)
+	{
+		std::string content;
+		for (size_t j = 1; j <= 5; j++)
+		{
+			content += "#include \"header_" + std::to_string((i + j * 7) % headerCount) + ".h\"\n";
+		}
+		content += "#include <missing_" + std::to_string(i % 10) + ".h>\nint f" + std::to_string(i) +
+			"();\n";
+		writeFile(rootPath.getConcatenated(L"include/header_" + std::to_wstring(i) + L".h"), content);
+	}
+
+	std::set<FilePath> sourceFilePaths;
+	for (size_t i = 0; i < sourceFileCount; i++)
+	{
+		std::string content;
+		for (size_t j = 0; j < 20; j++)
+		{
+			content += "#include <header_" + std::to_string((i * 13 + j) % headerCount) + ".h>\n";
+		}
+		content += "int main() { return 0; }\n";
+
+		const FilePath sourceFilePath = rootPath.getConcatenated(
+			L"src/source_" + std::to_wstring(i) + L".cpp");
+		writeFile(sourceFilePath, content);
+		sourceFilePaths.insert(sourceFilePath);
+	}
+	return sourceFilePaths;
+}
+}	 // namespace
+
+TEST_CASE("unresolved include detection crawls generated project")
+{
+	const FilePath rootPath = FilePath(L"data/CxxIncludeProcessingTestSuite/temp").makeAbsolute();
+	const std::set<FilePath> sourceFilePaths = writeGeneratedProject(rootPath, 50, 40);
+
+	const std::vector<IncludeDirective> unresolvedIncludeDirectives =
+		IncludeProcessing::getUnresolvedIncludeDirectives(
+			sourceFilePaths, {rootPath}, {rootPath.getConcatenated(L"include")}, 4, [](float) {});
+
+	REQUIRE(10 == unresolvedIncludeDirectives.size());
+
+	deleteDirectory(rootPath);
+}
+
+TEST_CASE("unresolved include detection crawls large project benchmark", "[!benchmark]")
+{
+	const FilePath rootPath = FilePath(L"data/CxxIncludeProcessingTestSuite/temp").makeAbsolute();
+	const std::set<FilePath> sourceFilePaths = writeGeneratedProject(rootPath, 500, 2000);
+
+	auto detect = [&]() {
+		return IncludeProcessing::getUnresolvedIncludeDirectives(
+			sourceFilePaths, {rootPath}, {rootPath.getConcatenated(L"include")}, 10, [](float) {});
+	};
+
+	REQUIRE(10 == detect().size());
+
+	BENCHMARK("detect unresolved includes of 2000 source files")
+	{
+		return detect().size();
+	};
+
+	deleteDirectory(rootPath);
+}
+
 TEST_CASE("header search path detection does not find path relative to including file")
 {
 	std::vector<FilePath> headerSearchDirectories = utility::toVector(
@@ -0,0 +1,153 @@
+#include "Catch2.hpp"
+
+#include <random>
+#include <set>
+
+#include "EdgeAdjacencyCache.h"
+
+namespace
+{
+std::set<Id> getEdgeIds(const std::vector<StorageEdge>& edges)
+{
+	std::set<Id> edgeIds;
+	for (const StorageEdge& edge: edges)
+	{
+		edgeIds.insert(edge.id);
+	}
+	return edgeIds;
+}
+}	 // namespace
+
+TEST_CASE("edge adjacency cache finds edges by source and target")
+{
+	EdgeAdjacencyCache cache;
+	cache.build(
+		{StorageEdge(10, Edge::typeToInt(Edge::EDGE_CALL), 1, 2),
+		 StorageEdge(11, Edge::typeToInt(Edge::EDGE_CALL), 1, 3),
+		 StorageEdge(12, Edge::typeToInt(Edge::EDGE_USAGE), 1, 4),
+		 StorageEdge(13, Edge::typeToInt(Edge::EDGE_CALL), 2, 3)});
+
+	REQUIRE(4 == cache.getEdgeCount());
+
+	std::vector<StorageEdge> edges;
+	cache.addEdgesBySourceIds({1}, Edge::EDGE_CALL | Edge::EDGE_USAGE, &edges);
+	REQUIRE(std::set<Id>({10, 11, 12}) == getEdgeIds(edges));
+
+	edges.clear();
+	cache.addEdgesBySourceIds({1, 2}, Edge::EDGE_CALL, &edges);
+	REQUIRE(std::set<Id>({10, 11, 13}) == getEdgeIds(edges));
+
+	edges.clear();
+	cache.addEdgesByTargetIds({3}, Edge::EDGE_CALL, &edges);
+	REQUIRE(2 == edges.size());
+	for (const StorageEdge& edge: edges)
+	{
+		REQUIRE(Id(3) == edge.targetNodeId);
+		REQUIRE(Edge::typeToInt(Edge::EDGE_CALL) == edge.type);
+	}
+
+	edges.clear();
+	cache.addEdgesByTargetIds({1, 5}, ~0, &edges);
+	REQUIRE(edges.empty());
+}
+
+TEST_CASE("edge adjacency cache is empty after clear")
+{
+	EdgeAdjacencyCache cache;
+	cache.build({StorageEdge(10, Edge::typeToInt(Edge::EDGE_CALL), 1, 2)});
+	cache.clear();
+
+	std::vector<StorageEdge> edges;
+	cache.addEdgesBySourceIds({1}, ~0, &edges);
+
+	REQUIRE(0 == cache.getEdgeCount());
+	REQUIRE(edges.empty());
+}
+
+namespace
+{
+// every node calls edgeCount / nodeCount random nodes
+std::vector<StorageEdge> getRandomCallEdges(size_t nodeCount, size_t edgeCount)
+{
+	std::mt19937 random(42);
+	std::uniform_int_distribution<size_t> nodeIndex(0, nodeCount - 1);
+
+	std::vector<StorageEdge> edges;
+	edges.reserve(edgeCount);
+	for (size_t i = 0; i < edgeCount; i++)
+	{
+		const size_t sourceIndex = i % nodeCount;
+		const size_t targetIndex = nodeIndex(random);
+		edges.emplace_back(
+			nodeCount + i + 1, Edge::typeToInt(Edge::EDGE_CALL), sourceIndex + 1, targetIndex + 1);
+	}
+	return edges;
+}
+
+// returns the number of nodes reachable from node 1 over at most 'depth' call edges
+size_t getTrailNodeCount(const EdgeAdjacencyCache& cache, size_t depth)
+{
+	std::set<Id> nodeIds = {1};
+	std::vector<Id> nodeIdsToProcess = {1};
+	for (size_t i = 0; i < depth && nodeIdsToProcess.size(); i++)
+	{
+		std::vector<StorageEdge> trailEdges;
+		cache.addEdgesBySourceIds(nodeIdsToProcess, Edge::EDGE_CALL, &trailEdges);
+
+		nodeIdsToProcess.clear();
+		for (const StorageEdge& edge: trailEdges)
+		{
+			if (nodeIds.insert(edge.targetNodeId).second)
+			{
+				nodeIdsToProcess.push_back(edge.targetNodeId);
+			}
+		}
+	}
+	return nodeIds.size();
+}
+}	 // namespace
+
+TEST_CASE("edge adjacency cache of random call edges")
+{
+	const std::vector<StorageEdge> edges = getRandomCallEdges(200, 1000);
+
+	EdgeAdjacencyCache cache;
+	cache.build(edges);
+
+	REQUIRE(1000 == cache.getEdgeCount());
+
+	std::set<Id> expectedEdgeIds;
+	for (const StorageEdge& edge: edges)
+	{
+		if (edge.sourceNodeId == 1 || edge.sourceNodeId == 2)
+		{
+			expectedEdgeIds.insert(edge.id);
+		}
+	}
+
+	std::vector<StorageEdge> sourceEdges;
+	cache.addEdgesBySourceIds({1, 2}, Edge::EDGE_CALL, &sourceEdges);
+	REQUIRE(expectedEdgeIds == getEdgeIds(sourceEdges));
+
+	REQUIRE(getTrailNodeCount(cache, 20) > 100);
+}
+
+TEST_CASE("edge adjacency cache of 1M call edges benchmark", "[!benchmark]")
+{
+	const std::vector<StorageEdge> edges = getRandomCallEdges(200000, 1000000);
+
+	EdgeAdjacencyCache cache;
+	cache.build(edges);
+
+	BENCHMARK("build adjacency of 1M edges")
+	{
+		EdgeAdjacencyCache benchmarkCache;
+		benchmarkCache.build(edges);
+		return benchmarkCache.getEdgeCount();
+	};
+
+	BENCHMARK("trail of depth 20 over 1M edges")
+	{
+		return getTrailNodeCount(cache, 20);
+	};
+}
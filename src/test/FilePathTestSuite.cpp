@@ -1,6 +1,9 @@
 #include "Catch2.hpp"
 
 #include "FilePath.h"
+#include "FilePathFilter.h"
+#include "FilePathHandle.h"
+#include "FileRegister.h"
 #include "utilityApp.h"
 
 TEST_CASE("file_path_gets_created_empty")
@@ -249,3 +252,40 @@ TEST_CASE("file path is invalid for absolute and relative paths with invalid cha
 	REQUIRE(!FilePath(L"data/FilePathTestSuite/container:app").isValid());
 	REQUIRE(!FilePath(L"data/FilePathTestSuite/container:app").makeAbsolute().isValid());
 }
+
+TEST_CASE("file path handles of equal paths are equal")
+{
+	const FilePathHandle a = FilePathHandle::intern(FilePath(L"data/FilePathTestSuite/a.cpp"));
+	const FilePathHandle b = FilePathHandle::intern(FilePath(L"data/FilePathTestSuite/a.cpp"));
+	const FilePathHandle c = FilePathHandle::intern(FilePath(L"data/FilePathTestSuite/b.cpp"));
+
+	REQUIRE(!a.isNull());
+	REQUIRE(a == b);
+	REQUIRE(a != c);
+	REQUIRE(std::hash<FilePathHandle>()(a) == std::hash<FilePathHandle>()(b));
+	REQUIRE(a.getFilePath().wstr() == L"data/FilePathTestSuite/a.cpp");
+
+	REQUIRE(FilePathHandle::find(FilePath(L"data/FilePathTestSuite/b.cpp")) == c);
+	REQUIRE(FilePathHandle::find(FilePath(L"data/FilePathTestSuite/never_interned.cpp")).isNull());
+	REQUIRE(FilePathHandle().getFilePath().empty());
+}
+
+TEST_CASE("file register finds indexed files through other paths to them")
+{
+	const FilePath currentPath(L"data/FilePathTestSuite/b.cc");
+	const FileRegister fileRegister(
+		currentPath,
+		{FilePath(L"data/FilePathTestSuite/a.cpp"), FilePath(L"data/FilePathTestSuite/target/d.cpp")},
+		{});
+
+	REQUIRE(fileRegister.hasFilePath(FilePath(L"data/FilePathTestSuite/a.cpp")));
+	REQUIRE(fileRegister.hasFilePath(FilePath(L"data/../data/FilePathTestSuite/./a.cpp")));
+	REQUIRE(fileRegister.hasFilePath(FilePath(L"data/FilePathTestSuite/a.cpp").getAbsolute()));
+	REQUIRE(fileRegister.hasFilePath(currentPath));
+	REQUIRE(!fileRegister.hasFilePath(FilePath(L"data/FilePathTestSuite/with space/s.srctrlprj")));
+
+	if constexpr (!utility::Platform::isWindows())
+	{
+		REQUIRE(fileRegister.hasFilePath(FilePath(L"data/FilePathTestSuite/parent/target/d.cpp")));
+	}
+}
@@ -324,3 +324,80 @@ TEST_CASE("graph removes nodes")
 
 	REQUIRE(1 == graph.getNodeCount());
 }
+
+TEST_CASE("graph visits nodes ordered by id")
+{
+	Graph graph;
+	graph.createNode(
+		3, NodeType(NODE_SYMBOL), NameHierarchy(L"C", NAME_DELIMITER_CXX), DEFINITION_EXPLICIT);
+	Node* a = graph.createNode(
+		1, NodeType(NODE_SYMBOL), NameHierarchy(L"A", NAME_DELIMITER_CXX), DEFINITION_EXPLICIT);
+	graph.createNode(
+		2, NodeType(NODE_SYMBOL), NameHierarchy(L"B", NAME_DELIMITER_CXX), DEFINITION_EXPLICIT);
+	graph.removeNode(a);
+
+	std::vector<Id> nodeIds;
+	graph.forEachNode([&nodeIds](Node* node) { nodeIds.push_back(node->getId()); });
+
+	REQUIRE(2 == nodeIds.size());
+	REQUIRE(Id(2) == nodeIds[0]);
+	REQUIRE(Id(3) == nodeIds[1]);
+	REQUIRE(!graph.getNodeById(1));
+
+	// the sorted order is kept between visits and updated once nodes get added
+	graph.createNode(
+		1, NodeType(NODE_SYMBOL), NameHierarchy(L"A", NAME_DELIMITER_CXX), DEFINITION_EXPLICIT);
+
+	nodeIds.clear();
+	graph.forEachNode([&nodeIds](Node* node) { nodeIds.push_back(node->getId()); });
+
+	REQUIRE(std::vector<Id>({1, 2, 3}) == nodeIds);
+}
+
+TEST_CASE("graph node deserializes name hierarchy on request")
+{
+	NameHierarchy nameHierarchy(NAME_DELIMITER_CXX);
+	nameHierarchy.push(L"foo");
+	nameHierarchy.push(L"Bar");
+
+	Graph graph;
+	Node* node = graph.createNodeWithSerializedName(
+		1, NodeType(NODE_CLASS), NameHierarchy::serialize(nameHierarchy), DEFINITION_EXPLICIT);
+
+	REQUIRE(L"Bar" == node->getName());
+	REQUIRE(L"foo::Bar" == node->getFullName());
+	REQUIRE(2 == node->getNameHierarchy().size());
+
+	// deserialized once and kept by the node
+	REQUIRE(&node->getNameHierarchy() == &node->getNameHierarchy());
+
+	Graph copy;
+	REQUIRE(L"foo::Bar" == copy.addNodeAsPlainCopy(node)->getFullName());
+}
+
+TEST_CASE("graph of 200k nodes benchmark", "[!benchmark]")
+{
+	const size_t nodeCount = 200000;
+
+	std::vector<std::wstring> serializedNames;
+	serializedNames.reserve(nodeCount);
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		NameHierarchy nameHierarchy(NAME_DELIMITER_CXX);
+		nameHierarchy.push(L"project");
+		nameHierarchy.push(L"module_" + std::to_wstring(i / 100));
+		nameHierarchy.push(NameElement(L"function_" + std::to_wstring(i), L"void", L"(int, int)"));
+		serializedNames.push_back(NameHierarchy::serialize(nameHierarchy));
+	}
+
+	BENCHMARK("build overview graph of 200k nodes")
+	{
+		Graph graph;
+		for (size_t i = 0; i < nodeCount; i++)
+		{
+			graph.createNodeWithSerializedName(
+				i + 1, NodeType(NODE_FUNCTION), serializedNames[i], DEFINITION_EXPLICIT);
+		}
+		return graph.getNodeCount();
+	};
+}
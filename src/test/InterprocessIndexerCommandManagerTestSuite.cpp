@@ -0,0 +1,188 @@
+#include "Catch2.hpp"
+
+#include "language_packages.h"
+
+#if BUILD_CXX_LANGUAGE_PACKAGE && BUILD_JAVA_LANGUAGE_PACKAGE
+
+#	include <algorithm>
+
+#	include "IndexerCommandCxx.h"
+#	include "IndexerCommandJava.h"
+#	include "InterprocessIndexerCommandManager.h"
+
+namespace
+{
+std::shared_ptr<IndexerCommandCxx> createCxxCommand(size_t fileIndex, size_t targetIndex)
+{
+	const std::wstring target = L"/project/target_" + std::to_wstring(targetIndex);
+
+	std::vector<std::wstring> compilerFlags = {L"-std=c++17", L"-DTARGET=" + target};
+	for (size_t i = 0; i < 30; i++)
+	{
+		compilerFlags.push_back(L"-I" + target + L"/include_" + std::to_wstring(i));
+	}
+
+	static const std::set<FilePathFilter> excludeFilters = {
+		FilePathFilter(L"/project/external/**")};
+
+	return std::make_shared<IndexerCommandCxx>(
+		FilePath(target + L"/file_" + std::to_wstring(fileIndex) + L".cpp"),
+		std::set<FilePath>({FilePath(L"/project")}),
+		excludeFilters,
+		std::set<FilePathFilter>(),
+		FilePath(L"/project/build"),
+		compilerFlags);
+}
+
+std::vector<std::wstring> getFilterStrings(const std::set<FilePathFilter>& filters)
+{
+	std::vector<std::wstring> filterStrings;
+	for (const FilePathFilter& filter: filters)
+	{
+		filterStrings.push_back(filter.wstr());
+	}
+	return filterStrings;
+}
+
+void requireEqualCommands(
+	std::shared_ptr<IndexerCommand> expected, std::shared_ptr<IndexerCommand> command)
+{
+	REQUIRE(command);
+	REQUIRE(expected->getIndexerCommandType() == command->getIndexerCommandType());
+	REQUIRE(expected->getSourceFilePath() == command->getSourceFilePath());
+
+	if (std::shared_ptr<IndexerCommandCxx> expectedCxx =
+			std::dynamic_pointer_cast<IndexerCommandCxx>(expected))
+	{
+		std::shared_ptr<IndexerCommandCxx> commandCxx =
+			std::dynamic_pointer_cast<IndexerCommandCxx>(command);
+		REQUIRE(expectedCxx->getIndexedPaths() == commandCxx->getIndexedPaths());
+		REQUIRE(
+			getFilterStrings(expectedCxx->getExcludeFilters()) ==
+			getFilterStrings(commandCxx->getExcludeFilters()));
+		REQUIRE(
+			getFilterStrings(expectedCxx->getIncludeFilters()) ==
+			getFilterStrings(commandCxx->getIncludeFilters()));
+		REQUIRE(expectedCxx->getWorkingDirectory() == commandCxx->getWorkingDirectory());
+		REQUIRE(expectedCxx->getCompilerFlags() == commandCxx->getCompilerFlags());
+	}
+	else if (
+		std::shared_ptr<IndexerCommandJava> expectedJava =
+			std::dynamic_pointer_cast<IndexerCommandJava>(expected))
+	{
+		std::shared_ptr<IndexerCommandJava> commandJava =
+			std::dynamic_pointer_cast<IndexerCommandJava>(command);
+		REQUIRE(expectedJava->getLanguageStandard() == commandJava->getLanguageStandard());
+		REQUIRE(expectedJava->getClassPath() == commandJava->getClassPath());
+	}
+}
+}	 // namespace
+
+TEST_CASE("interprocess indexer command manager passes commands to other process")
+{
+	InterprocessIndexerCommandManager appManager("test_icm", 0, true);
+	InterprocessIndexerCommandManager indexerManager("test_icm", 1, false);
+
+	std::vector<std::shared_ptr<IndexerCommand>> commands = {
+		createCxxCommand(0, 0),
+		createCxxCommand(1, 0),
+		std::make_shared<IndexerCommandJava>(
+			FilePath(L"/project/A.java"),
+			L"12",
+			std::vector<FilePath>({FilePath(L"/lib/b.jar"), FilePath(L"/lib/a.jar")})),
+		createCxxCommand(2, 1)};
+
+	appManager.pushIndexerCommands({commands[0], commands[1]});
+	appManager.pushIndexerCommands({commands[2], commands[3]});
+	REQUIRE(4 == appManager.indexerCommandCount());
+
+	for (const std::shared_ptr<IndexerCommand>& command: commands)
+	{
+		requireEqualCommands(command, indexerManager.popIndexerCommand());
+	}
+	REQUIRE(!indexerManager.popIndexerCommand());
+}
+
+TEST_CASE("interprocess indexer command manager refills drained queue")
+{
+	InterprocessIndexerCommandManager appManager("test_icm", 0, true);
+	InterprocessIndexerCommandManager indexerManager("test_icm", 1, false);
+
+	appManager.pushIndexerCommands({createCxxCommand(0, 0), createCxxCommand(1, 1)});
+	requireEqualCommands(createCxxCommand(0, 0), indexerManager.popIndexerCommand());
+	requireEqualCommands(createCxxCommand(1, 1), indexerManager.popIndexerCommand());
+
+	// the table gets cleared, so indices the indexer remembers refer to other entries
+	appManager.pushIndexerCommands({createCxxCommand(2, 1), createCxxCommand(3, 0)});
+	requireEqualCommands(createCxxCommand(2, 1), indexerManager.popIndexerCommand());
+
+	appManager.clearIndexerCommands();
+	REQUIRE(0 == appManager.indexerCommandCount());
+
+	appManager.pushIndexerCommands({createCxxCommand(4, 2)});
+	requireEqualCommands(createCxxCommand(4, 2), indexerManager.popIndexerCommand());
+}
+
+namespace
+{
+std::vector<std::shared_ptr<IndexerCommand>> createCxxCommands(
+	size_t commandCount, size_t targetCount)
+{
+	std::vector<std::shared_ptr<IndexerCommand>> commands;
+	for (size_t i = 0; i < commandCount; i++)
+	{
+		commands.push_back(createCxxCommand(i, i % targetCount));
+	}
+	return commands;
+}
+
+void pushIndexerCommandsInBatches(
+	InterprocessIndexerCommandManager& manager,
+	const std::vector<std::shared_ptr<IndexerCommand>>& commands,
+	size_t batchSize)
+{
+	for (size_t i = 0; i < commands.size(); i += batchSize)
+	{
+		manager.pushIndexerCommands(std::vector<std::shared_ptr<IndexerCommand>>(
+			commands.begin() + i, commands.begin() + std::min(i + batchSize, commands.size())));
+	}
+}
+}	 // namespace
+
+TEST_CASE("interprocess indexer command manager passes commands in batches")
+{
+	InterprocessIndexerCommandManager appManager("test_icm", 0, true);
+	InterprocessIndexerCommandManager indexerManager("test_icm", 1, false);
+
+	const std::vector<std::shared_ptr<IndexerCommand>> commands = createCxxCommands(600, 10);
+	pushIndexerCommandsInBatches(appManager, commands, 100);
+	REQUIRE(600 == appManager.indexerCommandCount());
+
+	for (const std::shared_ptr<IndexerCommand>& command: commands)
+	{
+		requireEqualCommands(command, indexerManager.popIndexerCommand());
+	}
+	REQUIRE(!indexerManager.popIndexerCommand());
+}
+
+TEST_CASE("interprocess indexer command manager passes many commands benchmark", "[!benchmark]")
+{
+	const std::vector<std::shared_ptr<IndexerCommand>> commands = createCxxCommands(60000, 100);
+
+	BENCHMARK("push and pop 60000 commands")
+	{
+		InterprocessIndexerCommandManager appManager("test_icm", 0, true);
+		InterprocessIndexerCommandManager indexerManager("test_icm", 1, false);
+
+		pushIndexerCommandsInBatches(appManager, commands, 1000);
+
+		size_t count = 0;
+		while (indexerManager.popIndexerCommand())
+		{
+			count++;
+		}
+		return count;
+	};
+}
+
+#endif	  // BUILD_CXX_LANGUAGE_PACKAGE && BUILD_JAVA_LANGUAGE_PACKAGE
@@ -109,7 +109,10 @@ void processSourceFiles(
 		outfile.open(
 			FilePath(projectDataRoot.str() + "/" + projectName + ".timing").str(),
 			std::ios_base::app);
-		outfile << TimeStamp::now().toString() << " - " << duration << " ms\n";
+		outfile << TimeStamp::now().toString() << " - " << duration << " ms for "
+				<< sourceFilePaths.size() << " files ("
+				<< (sourceFilePaths.empty() ? 0 : duration / sourceFilePaths.size())
+				<< " ms per file)\n";
 		outfile.close();
 	}
 }
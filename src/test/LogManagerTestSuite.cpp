@@ -1,7 +1,10 @@
 #include "Catch2.hpp"
 
+#include <fstream>
 #include <thread>
 
+#include "FileLogger.h"
+#include "FileSystem.h"
 #include "LogManagerImplementation.h"
 
 namespace
@@ -131,6 +134,18 @@ void logSomeMessages(
 		logManagerImplementation->logError(message, __FILE__, __FUNCTION__, __LINE__);
 	}
 }
+
+size_t getLineCount(const FilePath& filePath)
+{
+	std::ifstream fileStream(filePath.str());
+	std::string line;
+	size_t lineCount = 0;
+	while (std::getline(fileStream, line))
+	{
+		lineCount++;
+	}
+	return lineCount;
+}
 }	 // namespace
 
 TEST_CASE("new logger can be added to manager")
@@ -285,3 +300,65 @@ TEST_CASE("logger logs threaded")
 		messageCount * 6 ==
 		logger->getErrorCount() + logger->getWarningCount() + logger->getMessageCount());
 }
+
+TEST_CASE("file logger writes all lines logged by multiple threads")
+{
+	const FilePath logFilePath(L"data/LogManagerTestSuite/threaded_log.txt");
+	FileSystem::remove(logFilePath);
+
+	LogManagerImplementation logManagerImplementation;
+	std::shared_ptr<FileLogger> logger = std::make_shared<FileLogger>();
+	logger->setLogFilePath(logFilePath);
+	logManagerImplementation.addLogger(logger);
+
+	const int messageCount = 1000;
+	std::thread thread0(logSomeMessages, &logManagerImplementation, L"foo", messageCount);
+	std::thread thread1(logSomeMessages, &logManagerImplementation, L"bar", messageCount);
+
+	thread0.join();
+	thread1.join();
+	logger->flush();
+
+	REQUIRE(messageCount * 6 == getLineCount(logFilePath));
+
+	logManagerImplementation.removeLogger(logger);
+	logger.reset();
+	FileSystem::remove(logFilePath);
+}
+
+TEST_CASE("file logger rotates log files when they exceed the max size")
+{
+	const FilePath logDirectory(L"data/LogManagerTestSuite/");
+	for (int i = 0; i < 3; i++)
+	{
+		FileSystem::remove(logDirectory.getConcatenated(L"ring_" + std::to_wstring(i) + L".txt"));
+	}
+
+	{
+		std::shared_ptr<FileLogger> logger = std::make_shared<FileLogger>();
+		logger->setLogDirectory(logDirectory);
+		logger->setFileName(L"ring");
+		logger->setMaxLogFileCount(3);
+		logger->setMaxLogFileSize(1000);
+
+		LogManagerImplementation logManagerImplementation;
+		logManagerImplementation.addLogger(logger);
+		logSomeMessages(&logManagerImplementation, L"message", 100);
+		logger->flush();
+	}
+
+	size_t lineCount = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const FilePath filePath = logDirectory.getConcatenated(
+			L"ring_" + std::to_wstring(i) + L".txt");
+		REQUIRE(filePath.exists());
+		REQUIRE(FileSystem::getFileByteSize(filePath) < 2000);
+		lineCount += getLineCount(filePath);
+		FileSystem::remove(filePath);
+	}
+
+	// older lines were dropped together with the files they were written to
+	REQUIRE(lineCount > 0);
+	REQUIRE(lineCount < 300);
+}
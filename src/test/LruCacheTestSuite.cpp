@@ -0,0 +1,76 @@
+#include "Catch2.hpp"
+
+#include <string>
+
+#include "LruCache.h"
+
+TEST_CASE("lru cache returns cached values")
+{
+	LruCache<int, std::string> cache(2);
+
+	REQUIRE(cache.getValue(1) == nullptr);
+
+	cache.setValue(1, "a");
+	cache.setValue(2, "b");
+
+	REQUIRE(2 == cache.getSize());
+	REQUIRE(cache.contains(1));
+	REQUIRE(cache.getValue(1) != nullptr);
+	REQUIRE("a" == *cache.getValue(1));
+	REQUIRE("b" == *cache.getValue(2));
+
+	cache.setValue(2, "c");
+	REQUIRE(2 == cache.getSize());
+	REQUIRE("c" == *cache.getValue(2));
+
+	REQUIRE(4 == cache.getHitCount());
+	REQUIRE(1 == cache.getMissCount());
+}
+
+TEST_CASE("lru cache drops least recently used value when full")
+{
+	LruCache<int, int> cache(3);
+
+	cache.setValue(1, 1);
+	cache.setValue(2, 2);
+	cache.setValue(3, 3);
+
+	// using 1 makes 2 the least recently used one
+	REQUIRE(cache.getValue(1) != nullptr);
+	cache.setValue(4, 4);
+
+	REQUIRE(3 == cache.getSize());
+	REQUIRE(cache.contains(1));
+	REQUIRE(!cache.contains(2));
+	REQUIRE(cache.contains(3));
+	REQUIRE(cache.contains(4));
+
+	// checking for a value does not use it
+	REQUIRE(cache.contains(3));
+	cache.setValue(5, 5);
+	REQUIRE(!cache.contains(3));
+}
+
+TEST_CASE("lru cache keeps nothing without size")
+{
+	LruCache<int, int> cache(0);
+
+	cache.setValue(1, 1);
+
+	REQUIRE(0 == cache.getSize());
+	REQUIRE(cache.getValue(1) == nullptr);
+}
+
+TEST_CASE("lru cache clears values")
+{
+	LruCache<int, int> cache(2);
+
+	cache.setValue(1, 1);
+	cache.clear();
+
+	REQUIRE(0 == cache.getSize());
+	REQUIRE(!cache.contains(1));
+
+	cache.setValue(2, 2);
+	REQUIRE(2 == *cache.getValue(2));
+}
@@ -1,6 +1,9 @@
 #include "Catch2.hpp"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 #include "Message.h"
@@ -108,6 +111,46 @@ private:
 	}
 };
 
+class TestCountingMessageListener: public MessageListener<TestMessage>
+{
+public:
+	// returns false if fewer messages were handled within a generous timeout
+	bool waitForMessageCount(int messageCount)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		return m_condition.wait_for(lock, std::chrono::seconds(10), [this, messageCount]() {
+			return m_messageCount >= messageCount;
+		});
+	}
+
+	std::atomic<int> m_messageCount = 0;
+
+private:
+	void handleMessage(TestMessage*  /*message*/) override
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_messageCount++;
+		}
+		m_condition.notify_all();
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+};
+
+// dispatches a message and waits until it was handled
+void runRoundTrip(TestCountingMessageListener& listener)
+{
+	const int messageCount = listener.m_messageCount + 1;
+	TestMessage().dispatch();
+
+	while (listener.m_messageCount < messageCount)
+	{
+		std::this_thread::yield();
+	}
+}
+
 void waitForThread()
 {
 	static const int THREAD_WAIT_TIME_MS = 20;
@@ -237,3 +280,45 @@ TEST_CASE("listener registration to front and back within message handling")
 	REQUIRE(2 == listener.m_listeners[3]->m_messageCount);
 	REQUIRE(2 == listener.m_listeners[4]->m_messageCount);
 }
+
+TEST_CASE("dispatched messages wake up the idle message loop")
+{
+	MessageQueue::getInstance()->startMessageLoopThreaded();
+
+	waitForThread();
+
+	TestCountingMessageListener listener;
+
+	// the idle loop waits without timeout, so it only handles these messages if dispatching wakes
+	// it up
+	TestMessage().dispatch();
+	const bool handledFirst = listener.waitForMessageCount(1);
+
+	waitForThread();
+
+	TestMessage().dispatch();
+	TestMessage().dispatch();
+	const bool handledAll = listener.waitForMessageCount(3);
+
+	MessageQueue::getInstance()->stopMessageLoop();
+
+	REQUIRE(handledFirst);
+	REQUIRE(handledAll);
+	REQUIRE(3 == listener.m_messageCount);
+}
+
+TEST_CASE("message round trip benchmark", "[!benchmark]")
+{
+	MessageQueue::getInstance()->startMessageLoopThreaded();
+
+	waitForThread();
+
+	TestCountingMessageListener listener;
+
+	BENCHMARK("message round trip")
+	{
+		runRoundTrip(listener);
+	};
+
+	MessageQueue::getInstance()->stopMessageLoop();
+}
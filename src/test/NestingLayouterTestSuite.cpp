@@ -0,0 +1,242 @@
+#include "Catch2.hpp"
+
+#include <random>
+
+#include "DummyEdge.h"
+#include "DummyNode.h"
+#include "Graph.h"
+#include "GraphViewStyle.h"
+#include "GraphViewStyleImpl.h"
+#include "NestingLayouter.h"
+
+namespace
+{
+class TestGraphViewStyleImpl: public GraphViewStyleImpl
+{
+public:
+	float getCharWidth(const std::string&  /*fontName*/, size_t fontSize) override
+	{
+		return fontSize * 0.6f;
+	}
+
+	float getCharHeight(const std::string&  /*fontName*/, size_t fontSize) override
+	{
+		return fontSize * 1.3f;
+	}
+
+	float getGraphViewZoomDifferenceForPlatform() override
+	{
+		return 1.0f;
+	}
+};
+
+void loadTestGraphViewStyle()
+{
+	GraphViewStyle::setImpl(std::make_shared<TestGraphViewStyleImpl>());
+	GraphViewStyle::loadStyleSettings();
+}
+
+// creates collapsed class nodes that each hold 'memberCount' methods in a public access node
+std::vector<std::shared_ptr<DummyNode>> createClassNodes(
+	Graph* graph, size_t classCount, size_t memberCount)
+{
+	std::vector<std::shared_ptr<DummyNode>> nodes;
+
+	Id id = 1;
+	for (size_t i = 0; i < classCount; i++)
+	{
+		std::shared_ptr<DummyNode> classNode = std::make_shared<DummyNode>(DummyNode::DUMMY_DATA);
+		classNode->tokenId = id++;
+		classNode->name = L"Class" + std::to_wstring(i);
+		classNode->visible = true;
+
+		Node* data = graph->createNode(
+			classNode->tokenId,
+			NodeType(NODE_CLASS),
+			NameHierarchy(classNode->name, NAME_DELIMITER_CXX),
+			DEFINITION_EXPLICIT);
+		data->setChildCount(memberCount);
+		classNode->data = data;
+
+		std::shared_ptr<DummyNode> accessNode = std::make_shared<DummyNode>(DummyNode::DUMMY_ACCESS);
+		accessNode->accessKind = ACCESS_PUBLIC;
+		classNode->subNodes.push_back(accessNode);
+
+		for (size_t j = 0; j < memberCount; j++)
+		{
+			std::shared_ptr<DummyNode> memberNode = std::make_shared<DummyNode>(
+				DummyNode::DUMMY_DATA);
+			memberNode->tokenId = id++;
+			memberNode->name = L"method" + std::to_wstring(j * (i + 1));
+			memberNode->data = graph->createNode(
+				memberNode->tokenId,
+				NodeType(NODE_METHOD),
+				NameHierarchy({classNode->name, memberNode->name}, NAME_DELIMITER_CXX),
+				DEFINITION_EXPLICIT);
+			accessNode->subNodes.push_back(memberNode);
+		}
+
+		nodes.push_back(classNode);
+	}
+
+	return nodes;
+}
+
+// sets the visibility the graph controller assigns to the members of an expanded or collapsed node
+void setExpanded(DummyNode* node, bool expanded)
+{
+	node->expanded = expanded;
+	node->childVisible = expanded;
+
+	for (const std::shared_ptr<DummyNode>& subNode: node->subNodes)
+	{
+		if (subNode->isAccessNode())
+		{
+			subNode->visible = expanded;
+			for (const std::shared_ptr<DummyNode>& member: subNode->subNodes)
+			{
+				member->visible = expanded;
+			}
+		}
+	}
+}
+
+void resetLayout(const std::vector<std::shared_ptr<DummyNode>>& nodes)
+{
+	for (const std::shared_ptr<DummyNode>& node: nodes)
+	{
+		node->forEachDummyNodeRecursive([](DummyNode* n) { n->layoutSignature = 0; });
+	}
+}
+
+bool haveEqualLayout(const DummyNode* a, const DummyNode* b)
+{
+	if (a->visible != b->visible || a->size != b->size ||
+		a->subNodes.size() != b->subNodes.size() || (a->visible && a->position != b->position))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a->subNodes.size(); i++)
+	{
+		if (!haveEqualLayout(a->subNodes[i].get(), b->subNodes[i].get()))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// expand and collapse actions of a user clicking through a large graph
+std::vector<std::pair<size_t, bool>> createExpandActions(size_t nodeCount, size_t actionCount)
+{
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<size_t> distribution(0, nodeCount - 1);
+
+	std::vector<bool> expanded(nodeCount, false);
+	std::vector<std::pair<size_t, bool>> actions;
+	for (size_t i = 0; i < actionCount; i++)
+	{
+		const size_t index = distribution(generator);
+		expanded[index] = !expanded[index];
+		actions.emplace_back(index, expanded[index]);
+	}
+	return actions;
+}
+}	 // namespace
+
+TEST_CASE("nesting layouter layouts only changed nodes")
+{
+	loadTestGraphViewStyle();
+
+	Graph graph;
+	std::vector<std::shared_ptr<DummyNode>> nodes = createClassNodes(&graph, 10, 5);
+	std::vector<std::shared_ptr<DummyEdge>> edges;
+
+	NestingLayouter layouter(Vec2i(1000, 1000), edges, 0);
+	layouter.layout(nodes);
+	REQUIRE(10 == layouter.getLayoutedNodeCount());
+
+	layouter.layout(nodes);
+	REQUIRE(0 == layouter.getLayoutedNodeCount());
+
+	setExpanded(nodes[3].get(), true);
+	layouter.layout(nodes);
+	REQUIRE(6 == layouter.getLayoutedNodeCount());
+
+	setExpanded(nodes[3].get(), false);
+	layouter.layout(nodes);
+	REQUIRE(1 == layouter.getLayoutedNodeCount());
+
+	nodes[5]->name = L"RenamedClass";
+	layouter.layout(nodes);
+	REQUIRE(1 == layouter.getLayoutedNodeCount());
+}
+
+TEST_CASE("nesting layouter keeps sizes of skipped nodes equal to a full layout")
+{
+	loadTestGraphViewStyle();
+
+	Graph graph;
+	std::vector<std::shared_ptr<DummyNode>> nodes = createClassNodes(&graph, 50, 8);
+	std::vector<std::shared_ptr<DummyEdge>> edges;
+
+	Graph fullGraph;
+	std::vector<std::shared_ptr<DummyNode>> fullNodes = createClassNodes(&fullGraph, 50, 8);
+
+	NestingLayouter layouter(Vec2i(1000, 1000), edges, 0);
+	layouter.layout(nodes);
+
+	for (const std::pair<size_t, bool>& action: createExpandActions(nodes.size(), 100))
+	{
+		setExpanded(nodes[action.first].get(), action.second);
+		setExpanded(fullNodes[action.first].get(), action.second);
+
+		layouter.layout(nodes);
+
+		resetLayout(fullNodes);
+		NestingLayouter(Vec2i(1000, 1000), edges, 0).layout(fullNodes);
+	}
+
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		REQUIRE(haveEqualLayout(nodes[i].get(), fullNodes[i].get()));
+	}
+}
+
+TEST_CASE("nesting layouter replays expand actions on large graph benchmark", "[!benchmark]")
+{
+	loadTestGraphViewStyle();
+
+	Graph graph;
+	std::vector<std::shared_ptr<DummyNode>> nodes = createClassNodes(&graph, 2000, 20);
+	std::vector<std::shared_ptr<DummyEdge>> edges;
+
+	for (size_t i = 0; i < nodes.size(); i += 2)
+	{
+		setExpanded(nodes[i].get(), true);
+	}
+
+	const std::vector<std::pair<size_t, bool>> actions = createExpandActions(nodes.size(), 50);
+
+	BENCHMARK("full layout")
+	{
+		for (const std::pair<size_t, bool>& action: actions)
+		{
+			setExpanded(nodes[action.first].get(), action.second);
+			resetLayout(nodes);
+			NestingLayouter(Vec2i(1000, 1000), edges, 0).layout(nodes);
+		}
+	};
+
+	BENCHMARK("incremental layout")
+	{
+		NestingLayouter layouter(Vec2i(1000, 1000), edges, 0);
+		for (const std::pair<size_t, bool>& action: actions)
+		{
+			setExpanded(nodes[action.first].get(), action.second);
+			layouter.layout(nodes);
+		}
+	};
+}
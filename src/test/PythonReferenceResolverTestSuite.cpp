@@ -0,0 +1,462 @@
+#include "Catch2.hpp"
+
+#include <map>
+#include <regex>
+#include <set>
+
+#include "Edge.h"
+#include "ElementComponentKind.h"
+#include "FilePath.h"
+#include "NameHierarchy.h"
+#include "NodeKind.h"
+#include "PersistentStorage.h"
+#include "PythonReferenceResolver.h"
+#include "SourceLocation.h"
+#include "SourceLocationCollection.h"
+#include "SourceLocationFile.h"
+#include "SqliteStorage.h"
+#include "TextAccess.h"
+#include "utility.h"
+#include "utilityString.h"
+
+namespace
+{
+// the matching the python post processing did before the accessed name got scanned
+std::string getAccessedNameWithRegex(const std::string& linePrefix)
+{
+	std::string accessedName;
+	{
+		std::regex regex("\\s([^\\.()\\s]+)\\.$");
+		std::smatch matches;
+		std::regex_search(linePrefix, matches, regex);
+		if (!matches.empty())
+		{
+			accessedName = matches.str(1);
+		}
+	}
+	{
+		std::regex regex("\\s(super\\(\\))\\.$");
+		std::smatch matches;
+		std::regex_search(linePrefix, matches, regex);
+		if (!matches.empty())
+		{
+			accessedName = matches.str(1);
+		}
+	}
+	return accessedName;
+}
+
+std::vector<std::string> getLinePrefixes()
+{
+	return {
+		"",
+		".",
+		"A.",
+		" A.",
+		"\tA.",
+		"	x = A.",
+		"	x = A.b.",
+		"	x = a_b1.",
+		"	x = (A.",
+		"	x = A().",
+		"	x = f(A).",
+		"	super().",
+		"	x=super().",
+		"super().",
+		"	self.super().",
+		"	 .",
+		"	x = A",
+		"	x = A. ",
+		"	x = [A.",
+		"	x = \xc3\xa4.",
+		"	return self.",
+		"	return  self."};
+}
+}	 // namespace
+
+TEST_CASE("python reference resolver scans accessed name like the regular expressions")
+{
+	for (const std::string& linePrefix: getLinePrefixes())
+	{
+		REQUIRE(
+			getAccessedNameWithRegex(linePrefix) ==
+			PythonReferenceResolver::getAccessedName(linePrefix));
+	}
+
+	REQUIRE("A" == PythonReferenceResolver::getAccessedName("	x = A."));
+	REQUIRE("super()" == PythonReferenceResolver::getAccessedName("	super()."));
+	REQUIRE(PythonReferenceResolver::getAccessedName("	x = A().").empty());
+}
+
+TEST_CASE("python reference resolver scans accessed names of many lines benchmark", "[!benchmark]")
+{
+	std::vector<std::string> linePrefixes;
+	for (size_t i = 0; i < 20000; i++)
+	{
+		linePrefixes.push_back("		value_" + std::to_string(i) + " = instance_" + std::to_string(i) + ".");
+	}
+
+	BENCHMARK("regular expressions")
+	{
+		size_t count = 0;
+		for (const std::string& linePrefix: linePrefixes)
+		{
+			count += getAccessedNameWithRegex(linePrefix).size();
+		}
+		return count;
+	};
+
+	BENCHMARK("scanner")
+	{
+		size_t count = 0;
+		for (const std::string& linePrefix: linePrefixes)
+		{
+			count += PythonReferenceResolver::getAccessedName(linePrefix).size();
+		}
+		return count;
+	};
+}
+
+namespace
+{
+const std::vector<FilePath> s_sourceFilePaths = {
+	FilePath(L"data/PythonReferenceResolverTestSuite/main.py"),
+	FilePath(L"data/PythonReferenceResolverTestSuite/other.py")};
+
+std::wstring serializeName(const std::vector<std::wstring>& names)
+{
+	NameHierarchy nameHierarchy(NAME_DELIMITER_JAVA);
+	for (const std::wstring& name: names)
+	{
+		nameHierarchy.push(name);
+	}
+	return NameHierarchy::serialize(nameHierarchy);
+}
+
+// stores the symbols of the source files and their references the way the Python indexer leaves
+// them unsolved: as edges to a placeholder node with a location of type 'unsolved'
+void fillStorage(PersistentStorage& storage)
+{
+	storage.setup();
+	storage.startInjection();
+
+	std::map<std::wstring, Id> nodeIds;
+	for (const std::pair<std::vector<std::wstring>, NodeKind>& node:
+		 std::vector<std::pair<std::vector<std::wstring>, NodeKind>> {
+			 {{L"A"}, NODE_CLASS},
+			 {{L"A", L"foo"}, NODE_METHOD},
+			 {{L"B"}, NODE_CLASS},
+			 {{L"B", L"foo"}, NODE_METHOD},
+			 {{L"C"}, NODE_CLASS},
+			 {{L"C", L"bar"}, NODE_METHOD},
+			 {{L"f"}, NODE_FUNCTION},
+			 {{L"unsolved"}, NODE_SYMBOL}})
+	{
+		const std::wstring serializedName = serializeName(node.first);
+		nodeIds[serializedName] =
+			storage.addNode(StorageNodeData(nodeKindToInt(node.second), serializedName)).first;
+	}
+
+	struct UnsolvedReference
+	{
+		Edge::EdgeType type;
+		std::vector<std::wstring> sourceName;
+		size_t line;
+		size_t startColumn;
+		size_t endColumn;
+	};
+
+	// each file is resolved on its own, so both files share the symbols but not the unsolved edges
+	for (const FilePath& sourceFilePath: s_sourceFilePaths)
+	{
+		const Id fileId = storage
+							  .addNode(StorageNodeData(
+								  nodeKindToInt(NODE_FILE),
+								  NameHierarchy::serialize(
+									  NameHierarchy(sourceFilePath.wstr(), NAME_DELIMITER_FILE))))
+							  .first;
+		storage.addFile(StorageFile(fileId, sourceFilePath.wstr(), L"python", "", true, true));
+
+		for (const UnsolvedReference& reference: std::vector<UnsolvedReference> {
+				 {Edge::EDGE_INHERITANCE, {L"C"}, 9, 9, 9},
+				 {Edge::EDGE_CALL, {L"C", L"bar"}, 11, 11, 13},
+				 {Edge::EDGE_CALL, {L"f"}, 14, 4, 6},
+				 {Edge::EDGE_CALL, {L"f"}, 15, 4, 6}})
+		{
+			const Id edgeId = storage.addEdge(StorageEdgeData(
+				Edge::typeToInt(reference.type),
+				nodeIds[serializeName(reference.sourceName)],
+				nodeIds[serializeName({L"unsolved"})]));
+			const Id locationId = storage.addSourceLocation(StorageSourceLocationData(
+				fileId,
+				reference.line,
+				reference.startColumn,
+				reference.line,
+				reference.endColumn,
+				locationTypeToInt(LOCATION_UNSOLVED)));
+			storage.addOccurrence(StorageOccurrence(edgeId, locationId));
+		}
+	}
+
+	storage.finishInjection();
+	storage.buildCaches();
+}
+
+// the python post processing before the PythonReferenceResolver was introduced
+void resolveWithRegex(PersistentStorage& storage)
+{
+	std::vector<Id> unsolvedLocationIds;
+	for (const StorageSourceLocation& location: storage.getStorageSourceLocations())
+	{
+		if (intToLocationType(location.type) == LOCATION_UNSOLVED)
+		{
+			unsolvedLocationIds.push_back(location.id);
+		}
+	}
+
+	std::shared_ptr<SourceLocationCollection> locationCollection =
+		storage.getSourceLocationsForLocationIds(unsolvedLocationIds);
+
+	std::map<std::wstring, std::vector<StorageNode>> nodeNameToStorageNodes;
+	for (const StorageNode& node: storage.getStorageNodes())
+	{
+		nodeNameToStorageNodes[NameHierarchy::deserialize(node.serializedName).back().getName()]
+			.push_back(node);
+	}
+
+	std::vector<std::pair<StorageEdgeData, Id>> dataToInsert;
+	std::vector<StorageOccurrence> occurrencesToDelete;
+	locationCollection->forEachSourceLocationFile([&](std::shared_ptr<SourceLocationFile> locationFile) {
+		std::shared_ptr<TextAccess> textAccess = storage.getFileContent(
+			locationFile->getFilePath(), false);
+		std::map<std::wstring, std::vector<std::wstring>> childToParentNodesMap;
+
+		locationFile->forEachStartSourceLocation([&](const SourceLocation* startLoc) {
+			const SourceLocation* endLoc = startLoc->getOtherLocation();
+			const std::string tokenLine = textAccess->getLine(
+				static_cast<unsigned int>(startLoc->getLineNumber()));
+			const std::wstring token = utility::decodeFromUtf8(tokenLine.substr(
+				startLoc->getColumnNumber() - 1,
+				endLoc->getColumnNumber() - startLoc->getColumnNumber() + 1));
+
+			const std::string prefixString = tokenLine.substr(0, startLoc->getColumnNumber() - 1);
+			const std::string accessedName = getAccessedNameWithRegex(prefixString);
+
+			std::wstring definitionContextName;
+			if (accessedName == "super()")
+			{
+				for (const Id elementId: startLoc->getTokenIds())
+				{
+					const StorageEdge edge = storage.getEdgeById(elementId);
+					if (edge.id != 0)
+					{
+						NameHierarchy nameHierarchy = storage.getNameHierarchyForNodeId(
+							edge.sourceNodeId);
+						if (nameHierarchy.size() > 1)
+						{
+							const std::wstring name =
+								nameHierarchy.getRange(0, nameHierarchy.size() - 1).back().getName();
+							if (!childToParentNodesMap[name].empty())
+							{
+								definitionContextName = childToParentNodesMap[name].front();
+							}
+						}
+					}
+				}
+			}
+			else
+			{
+				definitionContextName = utility::decodeFromUtf8(accessedName);
+			}
+
+			std::vector<StorageNode> targetNodes;
+			if (!definitionContextName.empty())
+			{
+				for (const StorageNode& node: nodeNameToStorageNodes[token])
+				{
+					NameHierarchy nameHierarchy = NameHierarchy::deserialize(node.serializedName);
+					if (nameHierarchy.size() > 1 &&
+						nameHierarchy.getRange(0, nameHierarchy.size() - 1).back().getName() ==
+							definitionContextName)
+					{
+						targetNodes.push_back(node);
+					}
+				}
+			}
+			if (targetNodes.empty())
+			{
+				targetNodes = nodeNameToStorageNodes[token];
+			}
+
+			for (const StorageNode& targetNode: targetNodes)
+			{
+				for (const Id elementId: startLoc->getTokenIds())
+				{
+					const StorageEdge edge = storage.getEdgeById(elementId);
+					if (edge.id == 0)
+					{
+						continue;
+					}
+
+					if (Edge::intToType(edge.type) == Edge::EDGE_INHERITANCE)
+					{
+						if (intToNodeKind(targetNode.type) != NODE_CLASS)
+						{
+							continue;
+						}
+						childToParentNodesMap[storage.getNameHierarchyForNodeId(edge.sourceNodeId)
+												  .back()
+												  .getName()]
+							.push_back(NameHierarchy::deserialize(targetNode.serializedName)
+										   .back()
+										   .getName());
+					}
+
+					dataToInsert.emplace_back(
+						StorageEdgeData(edge.type, edge.sourceNodeId, targetNode.id),
+						startLoc->getLocationId());
+					occurrencesToDelete.emplace_back(edge.id, startLoc->getLocationId());
+				}
+			}
+		});
+	});
+
+	storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+	storage.startInjection();
+	std::set<Id> edgeIds;
+	for (const std::pair<StorageEdgeData, Id>& data: dataToInsert)
+	{
+		const Id ambiguousEdgeId = storage.addEdge(data.first);
+		if (edgeIds.insert(ambiguousEdgeId).second)
+		{
+			storage.addElementComponent(StorageElementComponent(
+				ambiguousEdgeId, elementComponentKindToInt(ElementComponentKind::IS_AMBIGUOUS), L""));
+		}
+		storage.addOccurrence(StorageOccurrence(ambiguousEdgeId, data.second));
+	}
+
+	storage.setMode(SqliteIndexStorage::STORAGE_MODE_CLEAR);
+	storage.removeOccurrences(occurrencesToDelete);
+	std::set<Id> unsolvedEdgeIds;
+	for (const StorageOccurrence& occurrence: occurrencesToDelete)
+	{
+		unsolvedEdgeIds.insert(occurrence.elementId);
+	}
+	storage.removeElementsWithoutOccurrences(utility::toVector(unsolvedEdgeIds));
+	storage.finishInjection();
+}
+
+// describes the stored references independent of the ids, e.g. "call f -> A.foo at main.py 14:4" or
+// "ambiguous call f -> A.foo"
+std::set<std::wstring> getStoredReferences(PersistentStorage& storage)
+{
+	std::map<Id, std::wstring> nodeNames;
+	for (const StorageNode& node: storage.getStorageNodes())
+	{
+		nodeNames[node.id] = NameHierarchy::deserialize(node.serializedName).getQualifiedName();
+	}
+
+	std::map<Id, std::wstring> edgeNames;
+	for (const StorageEdge& edge: storage.getStorageEdges())
+	{
+		edgeNames[edge.id] = Edge::getReadableTypeString(Edge::intToType(edge.type)) + L" " +
+			nodeNames[edge.sourceNodeId] + L" -> " + nodeNames[edge.targetNodeId];
+	}
+
+	std::map<Id, std::wstring> fileNames;
+	for (const StorageFile& file: storage.getStorageFiles())
+	{
+		fileNames[file.id] = FilePath(file.filePath).fileName();
+	}
+
+	std::map<Id, std::wstring> locationNames;
+	for (const StorageSourceLocation& location: storage.getStorageSourceLocations())
+	{
+		locationNames[location.id] = fileNames[location.fileNodeId] + L" " +
+			std::to_wstring(location.startLine) + L":" + std::to_wstring(location.startCol);
+	}
+
+	std::set<std::wstring> references;
+	for (const auto& edgeName: edgeNames)
+	{
+		references.insert(edgeName.second);
+	}
+	for (const StorageOccurrence& occurrence: storage.getStorageOccurrences())
+	{
+		auto it = edgeNames.find(occurrence.elementId);
+		if (it != edgeNames.end())
+		{
+			references.insert(it->second + L" at " + locationNames[occurrence.sourceLocationId]);
+		}
+	}
+	for (const StorageElementComponent& component: storage.getElementComponents())
+	{
+		if (component.type == elementComponentKindToInt(ElementComponentKind::IS_AMBIGUOUS))
+		{
+			references.insert(L"ambiguous " + edgeNames[component.elementId]);
+		}
+	}
+	return references;
+}
+}	 // namespace
+
+TEST_CASE("python reference resolver stores the references the regular expressions resolved")
+{
+	const FilePath indexDbPath(L"data/PythonReferenceResolverTestSuite/resolver.srctrldb");
+	const FilePath regexIndexDbPath(L"data/PythonReferenceResolverTestSuite/regex.srctrldb");
+
+	std::set<std::wstring> references;
+	size_t resolvedEdgeCount = 0;
+	bool resolved = false;
+	{
+		PersistentStorage storage(indexDbPath, FilePath());
+		fillStorage(storage);
+
+		PythonReferenceResolver resolver(storage);
+		resolved = resolver.resolve();
+		resolvedEdgeCount = resolver.getResolvedEdgeCount();
+
+		storage.buildCaches();
+		references = getStoredReferences(storage);
+	}
+
+	std::set<std::wstring> regexReferences;
+	{
+		PersistentStorage storage(regexIndexDbPath, FilePath());
+		fillStorage(storage);
+
+		resolveWithRegex(storage);
+
+		storage.buildCaches();
+		regexReferences = getStoredReferences(storage);
+	}
+
+	SqliteStorage::removeDatabaseFile(indexDbPath);
+	SqliteStorage::removeDatabaseFile(regexIndexDbPath);
+
+	// 'x.foo' can't be narrowed down, 'A.foo' and 'super().foo' name the member of class 'A'
+	const std::set<std::wstring> expectedReferences = {
+		L"inheritance C -> A",
+		L"inheritance C -> A at main.py 9:9",
+		L"inheritance C -> A at other.py 9:9",
+		L"ambiguous inheritance C -> A",
+		L"call C.bar -> A.foo",
+		L"call C.bar -> A.foo at main.py 11:11",
+		L"call C.bar -> A.foo at other.py 11:11",
+		L"ambiguous call C.bar -> A.foo",
+		L"call f -> A.foo",
+		L"call f -> A.foo at main.py 14:4",
+		L"call f -> A.foo at main.py 15:4",
+		L"call f -> A.foo at other.py 14:4",
+		L"call f -> A.foo at other.py 15:4",
+		L"ambiguous call f -> A.foo",
+		L"call f -> B.foo",
+		L"call f -> B.foo at main.py 14:4",
+		L"call f -> B.foo at other.py 14:4",
+		L"ambiguous call f -> B.foo"};
+
+	REQUIRE(resolved);
+	REQUIRE(10 == resolvedEdgeCount);
+	REQUIRE(expectedReferences == references);
+	REQUIRE(regexReferences == references);
+}
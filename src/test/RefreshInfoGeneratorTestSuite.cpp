@@ -1070,3 +1070,82 @@ TEST_CASE(
 	}
 	cleanup();
 }
+
+namespace
+{
+// every source file includes its own header, none of them exist on disk anymore
+std::vector<std::shared_ptr<SourceGroup>> addRemovedFilesToStorage(
+	size_t sourceFileCount, std::shared_ptr<PersistentStorage> storage)
+{
+	std::set<FilePath> sourceFilePaths;
+	std::set<FilePath> allFilePaths;
+	storage->startInjection();
+	for (size_t i = 0; i < sourceFileCount; i++)
+	{
+		const FilePath directoryPath = m_sourceFolder.getConcatenated(
+			L"dir" + std::to_wstring(i % 100));
+		const FilePath sourceFilePath = directoryPath.getConcatenated(
+			L"file" + std::to_wstring(i) + L".cpp");
+		const FilePath headerFilePath = directoryPath.getConcatenated(
+			L"file" + std::to_wstring(i) + L".h");
+
+		const Id sourceFileId = addVeryNewFileToStorage(sourceFilePath, true, true, storage);
+		const Id headerFileId = addVeryNewFileToStorage(headerFilePath, true, true, storage);
+		storage->addEdge(StorageEdgeData(Edge::EDGE_INCLUDE, sourceFileId, headerFileId));
+
+		sourceFilePaths.insert(sourceFilePath);
+		allFilePaths.insert(sourceFilePath);
+		allFilePaths.insert(headerFilePath);
+	}
+	storage->finishInjection();
+	storage->buildCaches();
+
+	std::vector<std::shared_ptr<SourceGroup>> sourceGroups;
+	sourceGroups.push_back(
+		std::shared_ptr<SourceGroupTest>(new SourceGroupTest(sourceFilePaths, allFilePaths)));
+	return sourceGroups;
+}
+}	 // namespace
+
+TEST_CASE("refresh info for updated files clears removed files of project")
+{
+	cleanup();
+	{
+		const size_t sourceFileCount = 500;
+
+		std::shared_ptr<PersistentStorage> storage = std::make_shared<PersistentStorage>(
+			m_indexDbPath, m_bookmarkDbPath);
+		storage->setup();
+
+		const std::vector<std::shared_ptr<SourceGroup>> sourceGroups = addRemovedFilesToStorage(
+			sourceFileCount, storage);
+
+		const RefreshInfo refreshInfo = RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(
+			sourceGroups, storage);
+
+		REQUIRE(REFRESH_UPDATED_FILES == refreshInfo.mode);
+		REQUIRE(0 == refreshInfo.nonIndexedFilesToClear.size());
+		REQUIRE(2 * sourceFileCount == refreshInfo.filesToClear.size());
+		REQUIRE(0 == refreshInfo.filesToIndex.size());
+	}
+	cleanup();
+}
+
+TEST_CASE("refresh info for updated files of large project benchmark", "[!benchmark]")
+{
+	cleanup();
+	{
+		std::shared_ptr<PersistentStorage> storage = std::make_shared<PersistentStorage>(
+			m_indexDbPath, m_bookmarkDbPath);
+		storage->setup();
+
+		const std::vector<std::shared_ptr<SourceGroup>> sourceGroups = addRemovedFilesToStorage(
+			50000, storage);
+
+		BENCHMARK("refresh info for 100k updated files")
+		{
+			return RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(sourceGroups, storage);
+		};
+	}
+	cleanup();
+}
@@ -96,3 +96,47 @@ TEST_CASE("shared memory")
 		}
 	}
 }
+
+namespace
+{
+// increments a counter in the memory with one access each and returns the counter afterwards
+int incrementCount(SharedMemory& memory, int accessCount)
+{
+	for (int i = 0; i < accessCount; i++)
+	{
+		SharedMemory::ScopedAccess access(&memory);
+		(*access.accessValue<int>("count"))++;
+	}
+
+	SharedMemory::ScopedAccess access(&memory);
+	return *access.accessValue<int>("count");
+}
+}	 // namespace
+
+TEST_CASE("shared memory stays mapped between accesses")
+{
+	SharedMemory memory("access", 65536, SharedMemory::CREATE_AND_DELETE);
+
+	REQUIRE(incrementCount(memory, 100) == 100);
+
+	{
+		SharedMemory otherMemory("access", 0, SharedMemory::OPEN_ONLY);
+		SharedMemory::ScopedAccess otherAccess(&otherMemory);
+		otherAccess.growMemory(65536);
+	}
+
+	{
+		SharedMemory::ScopedAccess access(&memory);
+		REQUIRE(access.getMemorySize() == 2 * 65536);
+	}
+}
+
+TEST_CASE("shared memory access benchmark", "[!benchmark]")
+{
+	SharedMemory memory("access", 65536, SharedMemory::CREATE_AND_DELETE);
+
+	BENCHMARK("10k accesses")
+	{
+		return incrementCount(memory, 10000);
+	};
+}
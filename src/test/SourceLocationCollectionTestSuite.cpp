@@ -183,3 +183,127 @@ TEST_CASE("get source locations filtered by lines")
 	REQUIRE(copy.getSourceLocationById(e->getLocationId())->getStartLocation());
 	REQUIRE(!copy.getSourceLocationById(e->getLocationId())->getEndLocation());
 }
+
+TEST_CASE("source locations are iterated in source order")
+{
+	SourceLocationFile file(FilePath(L"file.c"), L"cpp", true, true, true);
+	file.addSourceLocation(LOCATION_TOKEN, 3, {3}, 2, 1, 2, 4);
+	file.addSourceLocation(LOCATION_SCOPE, 2, {1, 2}, 1, 5, 3, 1);
+	file.addSourceLocation(LOCATION_TOKEN, 1, {1}, 1, 5, 1, 8);
+
+	std::vector<std::pair<Id, bool>> locations;
+	file.forEachSourceLocation([&locations](SourceLocation* location) {
+		locations.emplace_back(location->getLocationId(), location->isStartLocation());
+	});
+
+	REQUIRE(
+		locations ==
+		std::vector<std::pair<Id, bool>> {
+			{1, true}, {2, true}, {1, false}, {3, true}, {3, false}, {2, false}});
+	REQUIRE(file.getFirstSourceLocation()->getLocationId() == 1);
+	REQUIRE(file.getUnscopedStartLocationCount() == 2);
+
+	// locations added after iterating get merged in
+	file.addSourceLocation(LOCATION_TOKEN, 4, {4}, 1, 1, 1, 2);
+	REQUIRE(file.getFirstSourceLocation()->getLocationId() == 4);
+
+	const std::span<const Id> tokenIds = file.getSourceLocationById(2)->getTokenIds();
+	REQUIRE(std::vector<Id>(tokenIds.begin(), tokenIds.end()) == std::vector<Id> {1, 2});
+}
+
+TEST_CASE("copied source location file refers to its own locations")
+{
+	SourceLocationFile file(FilePath(L"file.c"), L"cpp", true, true, true);
+	file.addSourceLocation(LOCATION_TOKEN, 1, {1}, 2, 3, 4, 5);
+
+	SourceLocationFile copy(file);
+	SourceLocation* location = copy.getSourceLocationById(1);
+
+	REQUIRE(location != file.getSourceLocationById(1));
+	REQUIRE(location->getSourceLocationFile() == &copy);
+	REQUIRE(location->getOtherLocation()->getSourceLocationFile() == &copy);
+	REQUIRE(location->getOtherLocation()->getLineNumber() == 4);
+	REQUIRE(location->getOtherLocation()->getColumnNumber() == 5);
+}
+
+namespace
+{
+std::vector<FilePath> getFilePaths(size_t fileCount)
+{
+	std::vector<FilePath> filePaths;
+	for (size_t i = 0; i < fileCount; i++)
+	{
+		filePaths.push_back(FilePath(L"file" + std::to_wstring(i) + L".cpp"));
+	}
+	return filePaths;
+}
+
+// spreads the locations over the files in a shuffled order, every 8th location is a scope
+void addShuffledLocations(
+	SourceLocationCollection& collection, const std::vector<FilePath>& filePaths, size_t locationCount)
+{
+	for (size_t i = 0; i < locationCount; i++)
+	{
+		const size_t line = (i * 7919) % (locationCount / filePaths.size()) + 1;
+		collection.addSourceLocation(
+			i % 8 == 0 ? LOCATION_SCOPE : LOCATION_TOKEN,
+			i + 1,
+			{i % 5000 + 1},
+			filePaths[i % filePaths.size()],
+			line,
+			i % 80 + 1,
+			line + i % 3,
+			i % 80 + 10);
+	}
+}
+
+size_t getTokenIdCountOfTokenLocations(const SourceLocationCollection& collection)
+{
+	size_t tokenCount = 0;
+	collection.forEachSourceLocation([&tokenCount](SourceLocation* location) {
+		if (location->isStartLocation() && !location->isScopeLocation())
+		{
+			tokenCount += location->getTokenIds().size();
+		}
+	});
+	return tokenCount;
+}
+}	 // namespace
+
+TEST_CASE("source location collection with many locations")
+{
+	const size_t fileCount = 10;
+	const size_t locationCount = 1000;
+
+	SourceLocationCollection collection;
+	addShuffledLocations(collection, getFilePaths(fileCount), locationCount);
+
+	REQUIRE(collection.getSourceLocationFileCount() == fileCount);
+	REQUIRE(collection.getSourceLocationCount() == locationCount);
+	REQUIRE(getTokenIdCountOfTokenLocations(collection) == locationCount - locationCount / 8);
+}
+
+TEST_CASE("source location collection benchmark", "[!benchmark]")
+{
+	const size_t locationCount = 1000000;
+	const std::vector<FilePath> filePaths = getFilePaths(10);
+
+	SourceLocationCollection collection;
+	addShuffledLocations(collection, filePaths, locationCount);
+
+	// building the whole collection is dominated by the file lookup, so only one file is rebuilt
+	BENCHMARK("build file of 1M locations")
+	{
+		SourceLocationFile file(filePaths[0], L"cpp", false, false, false);
+		for (size_t i = 0; i < locationCount; i++)
+		{
+			file.addSourceLocation(LOCATION_TOKEN, i + 1, {i % 5000 + 1}, i / 10 + 1, 1, i / 10 + 1, 5);
+		}
+		return file.getFirstSourceLocation() != nullptr;
+	};
+
+	BENCHMARK("scan collection of 1M locations")
+	{
+		return getTokenIdCountOfTokenLocations(collection);
+	};
+}
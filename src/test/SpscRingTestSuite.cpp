@@ -0,0 +1,102 @@
+#include "Catch2.hpp"
+
+#include <thread>
+
+#include "SpscRing.h"
+
+TEST_CASE("spsc ring pops values in order of pushing")
+{
+	SpscRing<int, 4> ring;
+
+	int value = 0;
+	REQUIRE(!ring.pop(value));
+	REQUIRE(0 == ring.size());
+
+	for (int i = 0; i < 10; i++)
+	{
+		REQUIRE(ring.push(2 * i));
+		REQUIRE(ring.push(2 * i + 1));
+		REQUIRE(2 == ring.size());
+
+		REQUIRE(ring.pop(value));
+		REQUIRE(2 * i == value);
+		REQUIRE(ring.pop(value));
+		REQUIRE(2 * i + 1 == value);
+	}
+
+	REQUIRE(!ring.pop(value));
+}
+
+TEST_CASE("spsc ring rejects values when full")
+{
+	SpscRing<int, 3> ring;
+
+	REQUIRE(ring.push(1));
+	REQUIRE(ring.push(2));
+	REQUIRE(ring.push(3));
+	REQUIRE(ring.isFull());
+	REQUIRE(!ring.push(4));
+
+	int value = 0;
+	REQUIRE(ring.pop(value));
+	REQUIRE(1 == value);
+	REQUIRE(!ring.isFull());
+	REQUIRE(ring.push(4));
+
+	REQUIRE(ring.pop(value));
+	REQUIRE(2 == value);
+	REQUIRE(ring.pop(value));
+	REQUIRE(3 == value);
+	REQUIRE(ring.pop(value));
+	REQUIRE(4 == value);
+}
+
+namespace
+{
+// pushes the values on another thread and returns the number of values popped out of order
+size_t transferValues(size_t valueCount)
+{
+	SpscRing<size_t, 1024> ring;
+
+	std::thread producer([&ring, valueCount]() {
+		for (size_t i = 0; i < valueCount; i++)
+		{
+			while (!ring.push(i))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	size_t mismatchCount = 0;
+	for (size_t i = 0; i < valueCount; i++)
+	{
+		size_t value = 0;
+		while (!ring.pop(value))
+		{
+			std::this_thread::yield();
+		}
+
+		if (value != i)
+		{
+			mismatchCount++;
+		}
+	}
+
+	producer.join();
+	return mismatchCount;
+}
+}	 // namespace
+
+TEST_CASE("spsc ring transfers values between threads")
+{
+	REQUIRE(0 == transferValues(10000));
+}
+
+TEST_CASE("spsc ring transfer benchmark", "[!benchmark]")
+{
+	BENCHMARK("push and pop 1M values")
+	{
+		return transferValues(1000000);
+	};
+}
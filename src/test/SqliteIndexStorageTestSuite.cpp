@@ -1,7 +1,16 @@
 #include "Catch2.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "CppSQLite3.h"
 #include "FileSystem.h"
+#include "PersistentStorage.h"
+#include "SourceLocation.h"
+#include "SourceLocationFile.h"
 #include "SqliteIndexStorage.h"
+#include "TextAccess.h"
 
 TEST_CASE("storage adds node successfully")
 {
@@ -76,3 +85,638 @@ TEST_CASE("storage removes edge successfully")
 
 	REQUIRE(0 == edgeCount);
 }
+
+TEST_CASE("storage gets edges by bound source ids")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	std::vector<StorageEdge> edges;
+	std::vector<StorageEdge> edgesOfSecondCall;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		Id aId = storage.addNode(StorageNodeData(0, L"a"));
+		Id bId = storage.addNode(StorageNodeData(0, L"b"));
+		Id cId = storage.addNode(StorageNodeData(0, L"c"));
+		storage.addEdge(StorageEdgeData(0, aId, bId));
+		storage.addEdge(StorageEdgeData(0, bId, cId));
+		storage.addEdge(StorageEdgeData(0, cId, aId));
+		storage.commitTransaction();
+
+		edges = storage.getEdgesBySourceIds({aId, bId});
+		edgesOfSecondCall = storage.getEdgesBySourceIds({cId});
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(2 == edges.size());
+	REQUIRE(1 == edgesOfSecondCall.size());
+}
+
+TEST_CASE("storage runs nested queries of the same shape")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	std::vector<std::wstring> names;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		Id aId = storage.addNode(StorageNodeData(0, L"a"));
+		Id bId = storage.addNode(StorageNodeData(0, L"b"));
+		storage.commitTransaction();
+
+		storage.forEachByIds<StorageNode>({aId, bId}, [&](StorageNode&& node) {
+			for (const StorageNode& innerNode: storage.getAllByIds<StorageNode>({node.id}))
+			{
+				names.push_back(innerNode.serializedName);
+			}
+		});
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(2 == names.size());
+	REQUIRE(L"a" == names[0]);
+	REQUIRE(L"b" == names[1]);
+}
+
+TEST_CASE("storage reads from other threads while a transaction is open")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	std::atomic<size_t> readerNodeCount = 0;
+	size_t writerNodeCount = 0;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, L"a"));
+		storage.commitTransaction();
+
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; i++)
+		{
+			readers.emplace_back([&]() {
+				for (int j = 0; j < 50; j++)
+				{
+					readerNodeCount += storage.getAll<StorageNode>().empty() ? 0 : 1;
+				}
+			});
+		}
+
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, L"b"));
+		writerNodeCount = storage.getAll<StorageNode>().size();
+		storage.commitTransaction();
+
+		for (std::thread& reader: readers)
+		{
+			reader.join();
+		}
+	}
+	FileSystem::remove(databasePath);
+	FileSystem::remove(FilePath(databasePath.wstr() + L"-wal"));
+	FileSystem::remove(FilePath(databasePath.wstr() + L"-shm"));
+
+	REQUIRE(200 == readerNodeCount);
+	REQUIRE(2 == writerNodeCount);
+}
+
+TEST_CASE("storage reads committed data on new threads after many threads exited")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	size_t readerNodeCount = 0;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, L"a"));
+		storage.commitTransaction();
+
+		// every thread opens its own read connection, more threads than connections are allowed
+		for (int i = 0; i < 40; i++)
+		{
+			std::thread([&]() { storage.getAll<StorageNode>(); }).join();
+		}
+
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, L"b"));
+		std::thread([&]() { readerNodeCount = storage.getAll<StorageNode>().size(); }).join();
+		storage.commitTransaction();
+	}
+	FileSystem::remove(databasePath);
+	FileSystem::remove(FilePath(databasePath.wstr() + L"-wal"));
+	FileSystem::remove(FilePath(databasePath.wstr() + L"-shm"));
+
+	// the uncommitted node of the other thread is not visible
+	REQUIRE(1 == readerNodeCount);
+}
+
+TEST_CASE("storage moves database file with the changes left in its write-ahead log")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	FilePath crashedDatabasePath(L"data/SQLiteTestSuite/crashed.sqlite");
+	FilePath movedDatabasePath(L"data/SQLiteTestSuite/moved.sqlite");
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		storage.addNode(StorageNodeData(0, L"a"));
+		storage.commitTransaction();
+
+		// the files left behind if the process crashes now
+		FileSystem::copyFile(databasePath, crashedDatabasePath);
+		FileSystem::copyFile(
+			SqliteStorage::getWalFilePaths(databasePath)[0],
+			SqliteStorage::getWalFilePaths(crashedDatabasePath)[0]);
+	}
+	SqliteStorage::removeDatabaseFile(databasePath);
+
+	const bool moved = SqliteStorage::renameDatabaseFile(crashedDatabasePath, movedDatabasePath);
+
+	int nodeCount = -1;
+	{
+		SqliteIndexStorage storage(movedDatabasePath);
+		nodeCount = storage.getNodeCount();
+	}
+
+	const bool crashedFilesLeft = crashedDatabasePath.recheckExists() ||
+		SqliteStorage::getWalFilePaths(crashedDatabasePath)[0].recheckExists();
+	SqliteStorage::removeDatabaseFile(movedDatabasePath);
+
+	REQUIRE(moved);
+	REQUIRE(!crashedFilesLeft);
+	REQUIRE(1 == nodeCount);
+}
+
+namespace
+{
+// adds a chain of nodes, each node has an edge to the next one
+std::vector<Id> addNodeChain(SqliteIndexStorage& storage, int nodeCount)
+{
+	storage.beginTransaction();
+	std::vector<Id> nodeIds;
+	for (int i = 0; i < nodeCount; i++)
+	{
+		nodeIds.push_back(storage.addNode(StorageNodeData(0, L"node" + std::to_wstring(i))));
+	}
+	for (size_t i = 1; i < nodeIds.size(); i++)
+	{
+		storage.addEdge(StorageEdgeData(0, nodeIds[i - 1], nodeIds[i]));
+	}
+	storage.commitTransaction();
+	return nodeIds;
+}
+}	 // namespace
+
+TEST_CASE("storage queries nodes and edges by id sets")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		const std::vector<Id> nodeIds = addNodeChain(storage, 100);
+
+		const std::vector<Id> someNodeIds(nodeIds.begin(), nodeIds.begin() + 50);
+		const std::vector<StorageNode> nodes = storage.getAllByIds<StorageNode>(someNodeIds);
+		const std::vector<StorageEdge> edges = storage.getEdgesBySourceIds(someNodeIds);
+
+		REQUIRE(50 == nodes.size());
+		REQUIRE(50 == edges.size());
+		REQUIRE(L"node50" == storage.getNodeById(nodeIds[50]).serializedName);
+		for (const StorageEdge& edge: edges)
+		{
+			REQUIRE(
+				std::find(someNodeIds.begin(), someNodeIds.end(), edge.sourceNodeId) !=
+				someNodeIds.end());
+		}
+	}
+	FileSystem::remove(databasePath);
+}
+
+TEST_CASE("storage id set queries benchmark", "[!benchmark]")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		const std::vector<Id> nodeIds = addNodeChain(storage, 10000);
+
+		const std::vector<Id> someNodeIds(nodeIds.begin(), nodeIds.begin() + 500);
+
+		BENCHMARK("get node by id")
+		{
+			return storage.getNodeById(nodeIds[nodeIds.size() / 2]);
+		};
+
+		BENCHMARK("get 500 nodes by ids")
+		{
+			return storage.getAllByIds<StorageNode>(someNodeIds);
+		};
+
+		BENCHMARK("get edges of 500 source ids")
+		{
+			return storage.getEdgesBySourceIds(someNodeIds);
+		};
+	}
+	FileSystem::remove(databasePath);
+}
+
+TEST_CASE("storage returns stored file content")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	FilePath filePath(L"data/TextAccessTestSuite/text.txt");
+	std::vector<std::string> lines;
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		const Id fileId = storage.addNode(StorageNodeData(0, L"text.txt"));
+		storage.addFile(StorageFile(fileId, filePath.wstr(), L"", "", true, true));
+		storage.commitTransaction();
+
+		lines = storage.getFileContentById(fileId)->getAllLines();
+	}
+	FileSystem::remove(databasePath);
+
+	REQUIRE(TextAccess::createFromFile(filePath)->getAllLines() == lines);
+}
+
+TEST_CASE("storage returns file content compressed with a trained dictionary")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		std::vector<std::pair<Id, FilePath>> files;
+		for (const FilePath& filePath: FileSystem::getFilePathsFromDirectory(
+				 FilePath(L"data/SourceGroupTestSuite"), {L".java", L".cpp", L".h"}))
+		{
+			const Id fileId = storage.addNode(StorageNodeData(0, filePath.wstr()));
+			storage.addFile(StorageFile(fileId, filePath.wstr(), L"", "", true, true));
+			files.emplace_back(fileId, filePath);
+		}
+		storage.commitTransaction();
+		storage.trainFileContentDictionary();
+
+		REQUIRE(!files.empty());
+		for (const std::pair<Id, FilePath>& p: files)
+		{
+			REQUIRE(
+				TextAccess::createFromFile(p.second)->getAllLines() ==
+				storage.getFileContentById(p.first)->getAllLines());
+		}
+	}
+	FileSystem::remove(databasePath);
+}
+
+TEST_CASE("storage file content compression benchmark", "[!benchmark]")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		std::vector<std::pair<Id, FilePath>> files;
+		size_t rawSize = 0;
+		for (const FilePath& filePath:
+			 FileSystem::getFilePathsFromDirectory(FilePath(L"data"), {L".java", L".cpp", L".h"}))
+		{
+			const Id fileId = storage.addNode(StorageNodeData(0, filePath.wstr()));
+			storage.addFile(StorageFile(fileId, filePath.wstr(), L"", "", true, true));
+			files.emplace_back(fileId, filePath);
+			rawSize += FileSystem::getFileByteSize(filePath);
+		}
+		storage.commitTransaction();
+		storage.trainFileContentDictionary();
+
+		CppSQLite3DB database;
+		database.open(databasePath.str().c_str());
+		const int storedSize = database.execScalar("SELECT SUM(LENGTH(content)) FROM filecontent;");
+		database.close();
+
+		WARN(
+			"file content of " << files.size() << " files: " << rawSize << " bytes, stored "
+							   << storedSize << " bytes");
+
+		const std::pair<Id, FilePath>& file = files[files.size() / 2];
+		std::shared_ptr<TextAccess> rawContent = TextAccess::createFromFile(file.second);
+		const unsigned int lastLine = std::min(20u, rawContent->getLineCount());
+
+		BENCHMARK("load snippet from file")
+		{
+			return TextAccess::createFromFile(file.second)->getLines(1, lastLine);
+		};
+
+		BENCHMARK("load snippet from storage")
+		{
+			return storage.getFileContentById(file.first)->getLines(1, lastLine);
+		};
+
+		REQUIRE(storedSize < static_cast<int>(rawSize));
+		for (const std::pair<Id, FilePath>& p: files)
+		{
+			REQUIRE(
+				TextAccess::createFromFile(p.second)->getAllLines() ==
+				storage.getFileContentById(p.first)->getAllLines());
+		}
+	}
+	FileSystem::remove(databasePath);
+}
+
+namespace
+{
+std::vector<std::wstring> getLocationStrings(std::shared_ptr<SourceLocationFile> file)
+{
+	std::vector<std::wstring> locations;
+	file->forEachSourceLocation([&locations](SourceLocation* location) {
+		std::wstring str = to_wstring(location->getLocationId()) + L" " +
+			std::to_wstring(location->getLineNumber()) + L":" +
+			std::to_wstring(location->getColumnNumber()) + L" " +
+			std::to_wstring(locationTypeToInt(location->getType()));
+		std::vector<Id> tokenIds(location->getTokenIds().begin(), location->getTokenIds().end());
+		std::sort(tokenIds.begin(), tokenIds.end());
+		for (const Id tokenId: tokenIds)
+		{
+			str += L" " + to_wstring(tokenId);
+		}
+		locations.push_back(str);
+	});
+	return locations;
+}
+}	 // namespace
+
+TEST_CASE("storage loads packed source locations")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	FilePath filePath(L"data/SQLiteTestSuite/file.cpp");
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.beginTransaction();
+		const Id fileId = storage.addNode(StorageNodeData(0, filePath.wstr()));
+		storage.addFile(StorageFile(fileId, filePath.wstr(), L"cpp", "", false, true));
+		const Id aId = storage.addNode(StorageNodeData(0, L"a"));
+		const Id bId = storage.addNode(StorageNodeData(0, L"b"));
+
+		std::vector<StorageSourceLocation> locations;
+		for (size_t i = 0; i < 100; i++)
+		{
+			const size_t line = 1 + (i * 37) % 50;
+			locations.emplace_back(0, fileId, line, i + 1, line + i % 3, i + 5, int(i % 4));
+		}
+		const std::vector<Id> locationIds = storage.addSourceLocations(locations);
+
+		std::vector<StorageOccurrence> occurrences;
+		for (size_t i = 0; i < locationIds.size(); i++)
+		{
+			occurrences.emplace_back(i % 2 ? aId : bId, locationIds[i]);
+		}
+		occurrences.emplace_back(aId, locationIds[2]);
+		storage.addOccurrences(occurrences);
+		storage.commitTransaction();
+
+		const std::vector<std::wstring> all = getLocationStrings(
+			storage.getSourceLocationsForFile(filePath));
+		const std::vector<std::wstring> lines = getLocationStrings(
+			storage.getSourceLocationsForLinesInFile(filePath, 10, 20));
+		const std::vector<std::wstring> type = getLocationStrings(
+			storage.getSourceLocationsOfTypeInFile(filePath, intToLocationType(1)));
+
+		storage.packSourceLocations();
+
+		REQUIRE(100 == storage.getSourceLocationsForFile(filePath)->getSourceLocationCount());
+		REQUIRE(all == getLocationStrings(storage.getSourceLocationsForFile(filePath)));
+		REQUIRE(
+			lines ==
+			getLocationStrings(storage.getSourceLocationsForLinesInFile(filePath, 10, 20)));
+		REQUIRE(
+			type ==
+			getLocationStrings(
+				storage.getSourceLocationsOfTypeInFile(filePath, intToLocationType(1))));
+
+		// adding an occurrence drops the packed locations of the file
+		storage.beginTransaction();
+		storage.addOccurrences({StorageOccurrence(bId, locationIds[1])});
+		storage.commitTransaction();
+
+		REQUIRE(all != getLocationStrings(storage.getSourceLocationsForFile(filePath)));
+
+		// removing an element drops the packed locations of the files of its occurrences
+		storage.packSourceLocations();
+		const std::vector<std::wstring> packed = getLocationStrings(
+			storage.getSourceLocationsForFile(filePath));
+		storage.removeElement(aId);
+
+		REQUIRE(packed != getLocationStrings(storage.getSourceLocationsForFile(filePath)));
+	}
+	FileSystem::remove(databasePath);
+}
+
+TEST_CASE("storage injects attached database")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	FilePath injectedDatabasePath(L"data/SQLiteTestSuite/injected.sqlite");
+	FilePath filePath(L"data/SQLiteTestSuite/file.cpp");
+	{
+		SqliteIndexStorage injected(injectedDatabasePath);
+		injected.setup();
+		injected.beginTransaction();
+		const Id fileId = injected.addNode(StorageNodeData(0, filePath.wstr()));
+		injected.addFile(StorageFile(fileId, filePath.wstr(), L"cpp", "", false, true));
+		const Id aId = injected.addNode(StorageNodeData(0, L"a"));
+		const Id bId = injected.addNode(StorageNodeData(2, L"b"));
+		const Id cId = injected.addNode(StorageNodeData(0, L"c"));
+		injected.addSymbol(StorageSymbol(cId, 1));
+		injected.addEdge(StorageEdgeData(0, aId, bId));
+		const Id edgeId = injected.addEdge(StorageEdgeData(0, bId, cId));
+		const Id localSymbolId = injected.addLocalSymbol(StorageLocalSymbolData(L"x<1:2>"));
+		const std::vector<Id> locationIds = injected.addSourceLocations(
+			{StorageSourceLocation(0, fileId, 1, 1, 1, 5, 0),
+			 StorageSourceLocation(0, fileId, 2, 1, 2, 5, 0)});
+		injected.addOccurrences(
+			{StorageOccurrence(aId, locationIds[0]),
+			 StorageOccurrence(edgeId, locationIds[1]),
+			 StorageOccurrence(localSymbolId, locationIds[1])});
+		injected.addComponentAccess(StorageComponentAccess(cId, 1));
+		injected.addError(StorageErrorData(L"error", filePath.wstr(), false, true));
+		injected.addError(StorageErrorData(L"fatal", filePath.wstr(), true, true));
+		injected.commitTransaction();
+	}
+	{
+		SqliteIndexStorage storage(databasePath);
+		storage.setup();
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+		storage.beginTransaction();
+		const Id fileId = storage.addNode(StorageNodeData(0, filePath.wstr()));
+		storage.addFile(StorageFile(fileId, filePath.wstr(), L"cpp", "", false, false));
+		const Id aId = storage.addNode(StorageNodeData(0, L"a"));
+		const Id bId = storage.addNode(StorageNodeData(1, L"b"));
+		const Id edgeId = storage.addEdge(StorageEdgeData(0, aId, bId));
+		const Id localSymbolId = storage.addLocalSymbol(StorageLocalSymbolData(L"x<1:2>"));
+		const Id locationId = storage.addSourceLocation(
+			StorageSourceLocationData(fileId, 1, 1, 1, 5, 0));
+		storage.addOccurrence(StorageOccurrence(aId, locationId));
+		storage.addError(StorageErrorData(L"error", filePath.wstr(), false, true));
+		storage.commitTransaction();
+
+		REQUIRE(storage.injectDatabase(injectedDatabasePath));
+
+		REQUIRE(4 == storage.getNodeCount());
+		REQUIRE(2 == storage.getEdgeCount());
+		REQUIRE(2 == storage.getSourceLocationCount());
+		REQUIRE(1 == storage.getAll<StorageLocalSymbol>().size());
+		REQUIRE(2 == storage.getAll<StorageError>().size());
+		REQUIRE(3 == storage.getAll<StorageOccurrence>().size());
+
+		REQUIRE(2 == storage.getNodeById(bId).type);
+		REQUIRE(storage.getFileByPath(filePath.wstr()).complete);
+
+		const Id cId = storage.getNodeBySerializedName(L"c").id;
+		REQUIRE(0 != cId);
+		REQUIRE(1 == storage.getFirstById<StorageSymbol>(cId).definitionKind);
+		REQUIRE(1 == storage.getComponentAccessByNodeId(cId).type);
+		REQUIRE(edgeId == storage.getEdgeBySourceTargetType(aId, bId, 0).id);
+		REQUIRE(0 != storage.getEdgeBySourceTargetType(bId, cId, 0).id);
+		REQUIRE(1 == storage.getOccurrencesForElementIds({localSymbolId}).size());
+
+		// elements added afterwards are still merged with the injected ones
+		storage.beginTransaction();
+		REQUIRE(cId == storage.addNode(StorageNodeData(0, L"c")));
+		storage.commitTransaction();
+	}
+	FileSystem::remove(databasePath);
+	FileSystem::remove(injectedDatabasePath);
+}
+
+namespace
+{
+// every storage shares half of its nodes with the other ones, like the storages of parallel
+// indexer threads that see the same headers
+void fillInjectedStorage(const FilePath& databasePath, size_t storageIndex, size_t nodeCount)
+{
+	SqliteIndexStorage storage(databasePath);
+	storage.setup();
+	storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+	storage.beginTransaction();
+
+	const std::wstring filePath = L"file" + std::to_wstring(storageIndex) + L".py";
+	const Id fileId = storage.addNode(StorageNodeData(0, filePath));
+	storage.addFile(StorageFile(fileId, filePath, L"python", "", false, true));
+
+	std::vector<StorageNode> nodes;
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		const std::wstring prefix = i % 2 ? L"shared" : L"own" + std::to_wstring(storageIndex);
+		nodes.emplace_back(0, StorageNodeData(0, prefix + L"." + std::to_wstring(i)));
+	}
+	const std::vector<Id> nodeIds = storage.addNodes(nodes);
+
+	std::vector<StorageEdge> edges;
+	std::vector<StorageSourceLocation> locations;
+	for (size_t i = 1; i < nodeIds.size(); i++)
+	{
+		edges.emplace_back(0, StorageEdgeData(0, nodeIds[i - 1], nodeIds[i]));
+		locations.emplace_back(0, fileId, i, 1, i, 10, 0);
+	}
+	storage.addEdges(edges);
+
+	const std::vector<Id> locationIds = storage.addSourceLocations(locations);
+	std::vector<StorageOccurrence> occurrences;
+	for (size_t i = 0; i < locationIds.size(); i++)
+	{
+		occurrences.emplace_back(nodeIds[i + 1], locationIds[i]);
+	}
+	storage.addOccurrences(occurrences);
+
+	storage.commitTransaction();
+}
+
+std::vector<FilePath> createInjectedStorages(size_t storageCount, size_t nodeCount)
+{
+	std::vector<FilePath> injectedDatabasePaths;
+	for (size_t i = 0; i < storageCount; i++)
+	{
+		injectedDatabasePaths.emplace_back(
+			L"data/SQLiteTestSuite/injected" + std::to_wstring(i) + L".sqlite");
+		fillInjectedStorage(injectedDatabasePaths.back(), i, nodeCount);
+	}
+	return injectedDatabasePaths;
+}
+
+// returns the node count of the storage the databases were injected into
+int injectDatabases(const FilePath& databasePath, const std::vector<FilePath>& injectedDatabasePaths)
+{
+	SqliteIndexStorage storage(databasePath);
+	storage.setup();
+	storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+	for (const FilePath& injectedDatabasePath: injectedDatabasePaths)
+	{
+		storage.injectDatabase(injectedDatabasePath);
+	}
+	return storage.getNodeCount();
+}
+
+// injects the databases like custom commands did before the databases were attached
+int injectStorages(const FilePath& databasePath, const std::vector<FilePath>& injectedDatabasePaths)
+{
+	{
+		PersistentStorage storage(databasePath, FilePath());
+		storage.setup();
+		storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+		storage.buildCaches();
+		for (const FilePath& injectedDatabasePath: injectedDatabasePaths)
+		{
+			PersistentStorage injectedStorage(injectedDatabasePath, FilePath());
+			injectedStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+			injectedStorage.buildCaches();
+			storage.inject(&injectedStorage);
+		}
+	}
+	return SqliteIndexStorage(databasePath).getNodeCount();
+}
+}	 // namespace
+
+TEST_CASE("storage injects databases that share nodes")
+{
+	const size_t storageCount = 4;
+	const size_t nodeCount = 100;
+
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	const std::vector<FilePath> injectedDatabasePaths = createInjectedStorages(
+		storageCount, nodeCount);
+
+	const int injectedNodeCount = injectDatabases(databasePath, injectedDatabasePaths);
+
+	FileSystem::remove(databasePath);
+	for (const FilePath& injectedDatabasePath: injectedDatabasePaths)
+	{
+		FileSystem::remove(injectedDatabasePath);
+	}
+
+	// the file and own nodes of every storage and the shared nodes once
+	REQUIRE(int(storageCount * (nodeCount / 2 + 1) + nodeCount / 2) == injectedNodeCount);
+}
+
+TEST_CASE("storage database injection benchmark", "[!benchmark]")
+{
+	FilePath databasePath(L"data/SQLiteTestSuite/test.sqlite");
+	const std::vector<FilePath> injectedDatabasePaths = createInjectedStorages(4, 50000);
+
+	BENCHMARK("inject 4 storages")
+	{
+		const int count = injectDatabases(databasePath, injectedDatabasePaths);
+		FileSystem::remove(databasePath);
+		return count;
+	};
+
+	BENCHMARK("inject 4 storages row by row")
+	{
+		const int count = injectStorages(databasePath, injectedDatabasePaths);
+		FileSystem::remove(databasePath);
+		return count;
+	};
+
+	for (const FilePath& injectedDatabasePath: injectedDatabasePaths)
+	{
+		FileSystem::remove(injectedDatabasePath);
+	}
+}
@@ -0,0 +1,236 @@
+#include "Catch2.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "SourceLocationCollection.h"
+#include "SourceLocationFile.h"
+#include "StorageCache.h"
+#include "TextAccess.h"
+
+namespace
+{
+// token 1 is referenced in file 'a.cpp' by a location of token 2, token 4 in file 'b.cpp' by
+// token 3 that has 1000 references, token 6 in file 'c.cpp' by token 5 whose active token ids are
+// only returned after the test released them
+class TestStorageAccess: public StorageAccessProxy
+{
+public:
+	std::vector<Id> getActiveTokenIdsForId(Id tokenId, Id* declarationId) const override
+	{
+		activeTokenIdsCount++;
+		*declarationId = tokenId;
+
+		if (tokenId == 3)
+		{
+			std::vector<Id> tokenIds = {tokenId};
+			for (size_t i = 0; i < 1000; i++)
+			{
+				tokenIds.push_back(100 + i);
+			}
+			return tokenIds;
+		}
+
+		if (tokenId == 5)
+		{
+			std::unique_lock<std::mutex> lock(blockMutex);
+			blocked = true;
+			blockCondition.notify_all();
+			blockCondition.wait_for(lock, std::chrono::seconds(5), [this]() { return released; });
+		}
+
+		return {tokenId};
+	}
+
+	std::shared_ptr<SourceLocationCollection> getSourceLocationsForTokenIds(
+		const std::vector<Id>& tokenIds) const override
+	{
+		sourceLocationsCount++;
+
+		std::shared_ptr<SourceLocationCollection> collection =
+			std::make_shared<SourceLocationCollection>();
+		if (tokenIds == std::vector<Id> {1})
+		{
+			collection->addSourceLocation(LOCATION_TOKEN, 1, {2}, FilePath(L"a.cpp"), 1, 1, 1, 5);
+		}
+		else if (tokenIds == std::vector<Id> {4})
+		{
+			collection->addSourceLocation(LOCATION_TOKEN, 1, {3}, FilePath(L"b.cpp"), 1, 1, 1, 5);
+		}
+		else if (tokenIds == std::vector<Id> {6})
+		{
+			collection->addSourceLocation(LOCATION_TOKEN, 1, {5}, FilePath(L"c.cpp"), 1, 1, 1, 5);
+		}
+		return collection;
+	}
+
+	std::shared_ptr<SourceLocationFile> getSourceLocationsOfTypeInFile(
+		const FilePath& filePath, LocationType  /*type*/) const override
+	{
+		sourceLocationsOfTypeCount++;
+		return std::make_shared<SourceLocationFile>(filePath, L"", false, false, false);
+	}
+
+	std::shared_ptr<TextAccess> getFileContent(const FilePath&  /*filePath*/, bool  /*showsErrors*/) const override
+	{
+		fileContentCount++;
+		return TextAccess::createFromString("int a;\n");
+	}
+
+	TooltipInfo getTooltipInfoForTokenIds(
+		const std::vector<Id>&  /*tokenIds*/, TooltipOrigin  /*origin*/) const override
+	{
+		tooltipInfoCount++;
+		TooltipInfo info;
+		info.title = L"title";
+		return info;
+	}
+
+	mutable std::atomic<int> activeTokenIdsCount = 0;
+	mutable std::atomic<int> sourceLocationsCount = 0;
+	mutable std::atomic<int> sourceLocationsOfTypeCount = 0;
+	mutable std::atomic<int> fileContentCount = 0;
+	mutable std::atomic<int> tooltipInfoCount = 0;
+
+	mutable std::mutex blockMutex;
+	mutable std::condition_variable blockCondition;
+	mutable bool blocked = false;
+	bool released = false;
+};
+}	 // namespace
+
+TEST_CASE("storage cache serves repeated requests from cache")
+{
+	std::shared_ptr<TestStorageAccess> storage = std::make_shared<TestStorageAccess>();
+	StorageCache cache;
+	cache.setSubject(storage);
+
+	std::shared_ptr<SourceLocationCollection> first = cache.getSourceLocationsForTokenIds({1});
+	std::shared_ptr<SourceLocationCollection> second = cache.getSourceLocationsForTokenIds({1});
+
+	REQUIRE(1 == storage->sourceLocationsCount);
+	REQUIRE(1 == second->getSourceLocationCount());
+	REQUIRE(first != second);
+
+	// changing a returned collection does not change the cached one
+	first->addSourceLocation(LOCATION_TOKEN, 2, {3}, FilePath(L"a.cpp"), 2, 1, 2, 5);
+	REQUIRE(1 == cache.getSourceLocationsForTokenIds({1})->getSourceLocationCount());
+
+	REQUIRE("int a;\n" == cache.getFileContent(FilePath(L"b.cpp"), false)->getText());
+	REQUIRE("int a;\n" == cache.getFileContent(FilePath(L"b.cpp"), false)->getText());
+
+	const StorageCache::CacheStats stats = cache.getCacheStats();
+	REQUIRE(3 == stats.hitCount);
+	REQUIRE(2 == stats.missCount);
+	REQUIRE(stats.getHitRate() == Catch2::Approx(0.6f));
+}
+
+TEST_CASE("storage cache prefetches referenced tokens and files when idle")
+{
+	std::shared_ptr<TestStorageAccess> storage = std::make_shared<TestStorageAccess>();
+	StorageCache cache;
+	cache.setSubject(storage);
+
+	cache.getSourceLocationsForTokenIds({1});
+
+	// token 2: active token ids, source locations and tooltip, file a.cpp: content and the scope
+	// and comment locations
+	REQUIRE(cache.waitForPrefetchCount(6, std::chrono::seconds(5)));
+
+	Id declarationId = 0;
+	REQUIRE(std::vector<Id> {2} == cache.getActiveTokenIdsForId(2, &declarationId));
+	REQUIRE(2 == declarationId);
+	cache.getSourceLocationsForTokenIds({2});
+	REQUIRE(L"title" == cache.getTooltipInfoForTokenIds({2}, TOOLTIP_ORIGIN_CODE).title);
+	cache.getFileContent(FilePath(L"a.cpp"), false);
+	cache.getSourceLocationsOfTypeInFile(FilePath(L"a.cpp"), LOCATION_SCOPE);
+	cache.getSourceLocationsOfTypeInFile(FilePath(L"a.cpp"), LOCATION_COMMENT);
+
+	REQUIRE(1 == storage->activeTokenIdsCount);
+	REQUIRE(2 == storage->sourceLocationsCount);
+	REQUIRE(1 == storage->tooltipInfoCount);
+	REQUIRE(1 == storage->fileContentCount);
+	REQUIRE(2 == storage->sourceLocationsOfTypeCount);
+	REQUIRE(6 == cache.getCacheStats().hitCount);
+}
+
+TEST_CASE("storage cache does not prefetch locations of tokens with many references")
+{
+	std::shared_ptr<TestStorageAccess> storage = std::make_shared<TestStorageAccess>();
+	StorageCache cache;
+	cache.setSubject(storage);
+
+	cache.getSourceLocationsForTokenIds({4});
+
+	// token 3: active token ids and tooltip, file b.cpp: content and the scope and comment locations
+	REQUIRE(cache.waitForPrefetchCount(5, std::chrono::seconds(5)));
+
+	REQUIRE(1 == storage->activeTokenIdsCount);
+	REQUIRE(1 == storage->sourceLocationsCount);
+	REQUIRE(1 == storage->tooltipInfoCount);
+}
+
+TEST_CASE("storage cache stops prefetching when the storage is queried")
+{
+	std::shared_ptr<TestStorageAccess> storage = std::make_shared<TestStorageAccess>();
+	StorageCache cache;
+	cache.setSubject(storage);
+
+	cache.getSourceLocationsForTokenIds({6});
+	{
+		std::unique_lock<std::mutex> lock(storage->blockMutex);
+		REQUIRE(storage->blockCondition.wait_for(
+			lock, std::chrono::seconds(5), [&storage]() { return storage->blocked; }));
+	}
+
+	// the query is not kept waiting by the prefetch that is still running
+	cache.getFileContent(FilePath(L"d.cpp"), false);
+	{
+		std::lock_guard<std::mutex> lock(storage->blockMutex);
+		storage->released = true;
+	}
+	storage->blockCondition.notify_all();
+
+	// only file c.cpp gets prefetched, the interrupted token 5 is dropped
+	REQUIRE(cache.waitForPrefetchCount(3, std::chrono::seconds(5)));
+
+	REQUIRE(1 == storage->sourceLocationsCount);
+	REQUIRE(0 == storage->tooltipInfoCount);
+	REQUIRE(3 == cache.getCacheStats().prefetchCount);
+}
+
+TEST_CASE("storage cache drops cached values when subject changes")
+{
+	std::shared_ptr<TestStorageAccess> storage = std::make_shared<TestStorageAccess>();
+	StorageCache cache;
+	cache.setSubject(storage);
+
+	cache.getFileContent(FilePath(L"a.cpp"), false);
+
+	std::shared_ptr<TestStorageAccess> otherStorage = std::make_shared<TestStorageAccess>();
+	cache.setSubject(otherStorage);
+
+	cache.getFileContent(FilePath(L"a.cpp"), false);
+
+	REQUIRE(1 == storage->fileContentCount);
+	REQUIRE(1 == otherStorage->fileContentCount);
+}
+
+TEST_CASE("storage cache does not cache while indexing")
+{
+	std::shared_ptr<TestStorageAccess> storage = std::make_shared<TestStorageAccess>();
+	StorageCache cache;
+	cache.setSubject(storage);
+
+	cache.setUseErrorCache(true);
+	cache.getTooltipInfoForTokenIds({1}, TOOLTIP_ORIGIN_GRAPH);
+	cache.getTooltipInfoForTokenIds({1}, TOOLTIP_ORIGIN_GRAPH);
+	REQUIRE(2 == storage->tooltipInfoCount);
+
+	cache.setUseErrorCache(false);
+	cache.getTooltipInfoForTokenIds({1}, TOOLTIP_ORIGIN_GRAPH);
+	cache.getTooltipInfoForTokenIds({1}, TOOLTIP_ORIGIN_GRAPH);
+	REQUIRE(3 == storage->tooltipInfoCount);
+}
@@ -1,12 +1,18 @@
 #include "Catch2.hpp"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "Blackboard.h"
 #include "Task.h"
+#include "TaskGroupParallel.h"
 #include "TaskGroupSelector.h"
 #include "TaskGroupSequence.h"
+#include "TaskLambda.h"
 #include "TaskScheduler.h"
 
 namespace
@@ -97,6 +103,19 @@ public:
 	std::shared_ptr<TestTask> subTask;
 };
 
+// pushes a task that consists of the given group and waits until it was executed
+void runRoundTrip(TaskScheduler& scheduler, std::shared_ptr<TaskGroup> taskGroup)
+{
+	std::atomic<bool> executed = false;
+	taskGroup->addTask(std::make_shared<TaskLambda>([&executed]() { executed = true; }));
+	scheduler.pushTask(taskGroup);
+
+	while (!executed)
+	{
+		std::this_thread::yield();
+	}
+}
+
 void waitForThread(TaskScheduler& scheduler)
 {
 	static const int THREAD_WAIT_TIME_MS = 20;
@@ -277,3 +296,72 @@ TEST_CASE("task scheduling within task processing")
 	REQUIRE(5 == task->subTask->updateCallOrder);
 	REQUIRE(6 == task->subTask->exitCallOrder);
 }
+
+TEST_CASE("scheduled tasks wake up the idle scheduler loop in order")
+{
+	TaskScheduler scheduler(0);
+	scheduler.startSchedulerLoopThreaded();
+
+	waitForThread(scheduler);
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<int> order;
+
+	// the idle loop waits without timeout, so it only runs these tasks if pushing wakes it up
+	const int taskCount = 10;
+	for (int i = 0; i < taskCount; i++)
+	{
+		std::shared_ptr<TaskGroup> taskGroup;
+		if (i % 2)
+		{
+			taskGroup = std::make_shared<TaskGroupParallel>();
+		}
+		else
+		{
+			taskGroup = std::make_shared<TaskGroupSequence>();
+		}
+
+		taskGroup->addTask(std::make_shared<TaskLambda>([&, i]() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				order.push_back(i);
+			}
+			condition.notify_one();
+		}));
+		scheduler.pushTask(taskGroup);
+	}
+
+	bool executed = false;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		executed = condition.wait_for(
+			lock, std::chrono::seconds(10), [&]() { return order.size() == taskCount; });
+	}
+
+	scheduler.stopSchedulerLoop();
+
+	const std::vector<int> expectedOrder = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	REQUIRE(executed);
+	REQUIRE(expectedOrder == order);
+}
+
+TEST_CASE("scheduled task round trip benchmark", "[!benchmark]")
+{
+	TaskScheduler scheduler(0);
+	scheduler.startSchedulerLoopThreaded();
+
+	waitForThread(scheduler);
+
+	BENCHMARK("sequential task round trip")
+	{
+		runRoundTrip(scheduler, std::make_shared<TaskGroupSequence>());
+	};
+
+	BENCHMARK("parallel task round trip")
+	{
+		runRoundTrip(scheduler, std::make_shared<TaskGroupParallel>());
+	};
+
+	scheduler.stopSchedulerLoop();
+}
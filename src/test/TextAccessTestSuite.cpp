@@ -1,5 +1,6 @@
 #include "Catch2.hpp"
 
+#include "CompressedText.h"
 #include "TextAccess.h"
 
 namespace
@@ -148,3 +149,47 @@ TEST_CASE("textAccessFile get filePath")
 
 	REQUIRE(textAccess->getFilePath() == filePath);
 }
+
+TEST_CASE("textAccessCompressed lines content")
+{
+	std::string text = getTestText();
+
+	std::shared_ptr<TextAccess> textAccess = TextAccess::createFromCompressedText(
+		CompressedText::create(
+			CompressedText::compress(TextAccess::createFromString(text)->getAllLines(), nullptr),
+			nullptr));
+
+	REQUIRE(textAccess->getLineCount() == 8);
+	REQUIRE(textAccess->getLine(4) == "\"With a torch.\"\n");
+	REQUIRE(textAccess->getText() == text);
+}
+
+TEST_CASE("textAccessCompressed lines across chunks")
+{
+	std::vector<std::string> lines;
+	for (unsigned int i = 0; i < 3 * CompressedText::s_chunkLineCount + 1; i++)
+	{
+		lines.push_back("line " + std::to_string(i + 1) + "\n");
+	}
+
+	std::shared_ptr<CompressedText> compressedText = CompressedText::create(
+		CompressedText::compress(lines, nullptr), nullptr);
+	std::shared_ptr<TextAccess> textAccess = TextAccess::createFromCompressedText(compressedText);
+
+	REQUIRE(compressedText->getChunkCount() == 4);
+	REQUIRE(textAccess->getLineCount() == lines.size());
+	REQUIRE(textAccess->getLine(textAccess->getLineCount()) == lines.back());
+
+	const unsigned int chunkEnd = CompressedText::s_chunkLineCount;
+	std::vector<std::string> chunkBorderLines = textAccess->getLines(chunkEnd, chunkEnd + 1);
+	REQUIRE(chunkBorderLines.size() == 2);
+	REQUIRE(chunkBorderLines[0] == lines[chunkEnd - 1]);
+	REQUIRE(chunkBorderLines[1] == lines[chunkEnd]);
+
+	REQUIRE(textAccess->getAllLines() == lines);
+}
+
+TEST_CASE("compressedText rejects unknown data")
+{
+	REQUIRE(CompressedText::create("not compressed", nullptr) == nullptr);
+}
@@ -0,0 +1,93 @@
+#include "Catch2.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.h"
+
+TEST_CASE("thread pool returns results of submitted tasks")
+{
+	ThreadPool pool(4);
+
+	std::vector<std::future<int>> futures;
+	for (int i = 0; i < 100; i++)
+	{
+		futures.push_back(pool.submit([i]() { return i * i; }));
+	}
+
+	for (int i = 0; i < 100; i++)
+	{
+		REQUIRE(futures[i].get() == i * i);
+	}
+}
+
+TEST_CASE("thread pool parallel for visits every index once")
+{
+	ThreadPool pool(4);
+
+	std::vector<std::atomic<int>> visitCounts(1000);
+	pool.parallelFor(visitCounts.size(), [&](size_t i) { visitCounts[i]++; });
+
+	for (const std::atomic<int>& visitCount: visitCounts)
+	{
+		REQUIRE(visitCount == 1);
+	}
+}
+
+TEST_CASE("thread pool does not deadlock on nested parallel for")
+{
+	ThreadPool pool(2);
+
+	std::atomic<int> count = 0;
+	pool.parallelFor(8, [&](size_t) { pool.parallelFor(8, [&](size_t) { count++; }); });
+
+	REQUIRE(count == 64);
+}
+
+TEST_CASE("thread pool propagates exceptions of parallel for")
+{
+	ThreadPool pool(4);
+
+	REQUIRE_THROWS_AS(
+		pool.parallelFor(
+			100,
+			[](size_t i) {
+				if (i == 50)
+				{
+					throw std::runtime_error("failed");
+				}
+			}),
+		std::runtime_error);
+}
+
+TEST_CASE("thread pool skips cancelled tasks")
+{
+	ThreadPool pool(1);
+
+	std::atomic<bool> blockerStarted = false;
+	std::atomic<bool> releaseBlocker = false;
+	std::future<void> blocker = pool.submit([&]() {
+		blockerStarted = true;
+		while (!releaseBlocker)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+	while (!blockerStarted)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+	std::atomic<bool> executed = false;
+	std::future<void> future = pool.submit([&]() { executed = true; }, cancelled);
+
+	*cancelled = true;
+	releaseBlocker = true;
+
+	REQUIRE_THROWS_AS(future.get(), std::future_error);
+	REQUIRE(!executed);
+	blocker.get();
+}
@@ -0,0 +1,130 @@
+#include "Catch2.hpp"
+
+#include <thread>
+
+#include "tracing.h"
+
+namespace
+{
+void traceNested()
+{
+	TRACE("outer");
+	{
+		TRACE("inner");
+	}
+}
+}	 // namespace
+
+TEST_CASE("tracer does not record events when disabled")
+{
+	Tracer* tracer = Tracer::getInstance();
+	tracer->setEnabled(false);
+	tracer->clear();
+
+	traceNested();
+
+	REQUIRE(tracer->getChromeTrace().find("\"name\":\"outer\"") == std::string::npos);
+}
+
+TEST_CASE("tracer exports recorded events as chrome trace")
+{
+	Tracer* tracer = Tracer::getInstance();
+	tracer->setEnabled(true);
+	tracer->clear();
+
+	traceNested();
+
+	tracer->setEnabled(false);
+	const std::string trace = tracer->getChromeTrace();
+	tracer->clear();
+
+	REQUIRE(trace.find("\"traceEvents\":[") != std::string::npos);
+	REQUIRE(trace.find("\"ph\":\"X\"") != std::string::npos);
+	REQUIRE(trace.find("\"name\":\"outer\"") != std::string::npos);
+	REQUIRE(trace.find("\"name\":\"inner\"") != std::string::npos);
+	REQUIRE(trace.find("\"location\":\"TracingTestSuite.cpp:") != std::string::npos);
+}
+
+TEST_CASE("tracer keeps only the latest events of a thread")
+{
+	Tracer* tracer = Tracer::getInstance();
+	tracer->setEnabled(true);
+	tracer->clear();
+
+	for (size_t i = 0; i < TraceBuffer::s_capacity + 10; i++)
+	{
+		TRACE("repeated");
+	}
+
+	tracer->setEnabled(false);
+	const std::string trace = tracer->getChromeTrace();
+	tracer->clear();
+
+	size_t eventCount = 0;
+	for (size_t pos = trace.find("\"name\":\"repeated\""); pos != std::string::npos;
+		 pos = trace.find("\"name\":\"repeated\"", pos + 1))
+	{
+		eventCount++;
+	}
+	REQUIRE(eventCount == TraceBuffer::s_capacity);
+}
+
+TEST_CASE("tracer reuses the buffers of finished threads")
+{
+	Tracer* tracer = Tracer::getInstance();
+	tracer->setEnabled(true);
+	tracer->clear();
+
+	std::thread([]() { TRACE("first thread"); }).join();
+	const size_t bufferCount = tracer->getBufferCount();
+	const std::string firstTrace = tracer->getChromeTrace();
+
+	std::thread([]() { TRACE("second thread"); }).join();
+	const std::string secondTrace = tracer->getChromeTrace();
+
+	tracer->setEnabled(false);
+	tracer->clear();
+
+	REQUIRE(firstTrace.find("\"name\":\"first thread\"") != std::string::npos);
+	REQUIRE(secondTrace.find("\"name\":\"second thread\"") != std::string::npos);
+	REQUIRE(bufferCount == tracer->getBufferCount());
+}
+
+TEST_CASE("trace buffer copies complete events while they get overwritten")
+{
+	TraceBuffer buffer(0);
+
+	std::atomic<bool> done = false;
+	std::thread writer([&]() {
+		for (uint64_t i = 0; i < 10 * TraceBuffer::s_capacity; i++)
+		{
+			TraceEvent event;
+			event.lineNumber = static_cast<int>(i);
+			event.startTime = i;
+			event.duration = 2 * i;
+			buffer.addEvent(event);
+		}
+		done = true;
+	});
+
+	size_t copyCount = 0;
+	bool complete = true;
+	bool ordered = true;
+	while (!done || copyCount == 0)
+	{
+		const std::vector<TraceEvent> events = buffer.getEvents();
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			const TraceEvent& event = events[i];
+			complete = complete && event.startTime == static_cast<uint64_t>(event.lineNumber) &&
+				event.duration == 2 * event.startTime;
+			ordered = ordered && (i == 0 || events[i - 1].startTime < event.startTime);
+		}
+		copyCount++;
+	}
+	writer.join();
+
+	REQUIRE(complete);
+	REQUIRE(ordered);
+	REQUIRE(TraceBuffer::s_capacity == buffer.getEvents().size());
+}